@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""
+Cliente del demonio de alineamiento (alineador --daemon <socket>)
+Envía trabajos por el socket Unix usando el protocolo enmarcado:
+longitud de 4 bytes big-endian seguida de la carga
+"""
+
+import sys
+import socket
+import struct
+import time
+import argparse
+import statistics
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+
+def encode_frame(payload):
+    """Antepone la longitud big-endian de 4 bytes a la carga"""
+    if isinstance(payload, str):
+        payload = payload.encode()
+    return struct.pack(">I", len(payload)) + payload
+
+
+def read_exact(sock, length):
+    """Lee exactamente `length` bytes o lanza ConnectionError"""
+    chunks = []
+    remaining = length
+    while remaining > 0:
+        chunk = sock.recv(remaining)
+        if not chunk:
+            raise ConnectionError("El demonio cerró la conexión")
+        chunks.append(chunk)
+        remaining -= len(chunk)
+    return b"".join(chunks)
+
+
+def read_frame(sock):
+    """Lee un mensaje enmarcado completo"""
+    (length,) = struct.unpack(">I", read_exact(sock, 4))
+    return read_exact(sock, length)
+
+
+def parse_response(payload):
+    """Separa la línea de estado del cuerpo de la respuesta"""
+    text = payload.decode()
+    status, _, body = text.partition("\n")
+    return status, body
+
+
+class MSAClient:
+    def __init__(self, socket_path, timeout=None):
+        self.socket_path = socket_path
+        self.timeout = timeout
+        self.sock = None
+
+    def __enter__(self):
+        self.connect()
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def connect(self):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.settimeout(self.timeout)
+        self.sock.connect(self.socket_path)
+
+    def close(self):
+        if self.sock is not None:
+            self.sock.close()
+            self.sock = None
+
+    def request(self, payload):
+        """Envía una petición y devuelve (estado, cuerpo)"""
+        try:
+            self.sock.sendall(encode_frame(payload))
+        except (BrokenPipeError, ConnectionResetError):
+            # Con la cola llena el demonio responde BUSY y cierra sin leer la petición
+            pass
+        return parse_response(read_frame(self.sock))
+
+    def ping(self):
+        return self.request("PING")
+
+    def stats(self):
+        status, body = self.request("STATS")
+        values = {}
+        for line in body.splitlines():
+            key, _, value = line.partition("=")
+            if key:
+                values[key] = value
+        return status, values
+
+    def align(self, fasta_text, output_format="fasta", budget_ms=None):
+        options = f" budget_ms={budget_ms:g}" if budget_ms else ""
+        return self.request(f"ALIGN {output_format}{options}\n{fasta_text}")
+
+
+def run_bench(socket_path, fasta_text, output_format, requests, concurrency, budget_ms=None):
+    """Lanza `requests` alineamientos con `concurrency` conexiones simultáneas"""
+    def one_request(_):
+        start = time.perf_counter()
+        try:
+            with MSAClient(socket_path) as client:
+                status, _ = client.align(fasta_text, output_format, budget_ms)
+        except (OSError, ConnectionError) as e:
+            status = f"ERROR {e}"
+        return status, (time.perf_counter() - start) * 1000.0
+
+    start = time.perf_counter()
+    with ThreadPoolExecutor(max_workers=concurrency) as executor:
+        results = list(executor.map(one_request, range(requests)))
+    elapsed = time.perf_counter() - start
+
+    latencies = sorted(ms for status, ms in results if status.startswith("OK"))
+    busy = sum(1 for status, _ in results if status == "BUSY")
+    errors = len(results) - len(latencies) - busy
+
+    print(f"Peticiones: {requests} (ok: {len(latencies)}, busy: {busy}, error: {errors})")
+    print(f"Throughput: {len(latencies) / elapsed:.1f} alineamientos/s")
+    if latencies:
+        p95 = latencies[min(len(latencies) - 1, int(0.95 * len(latencies)))]
+        print(f"Latencia cliente: media {statistics.mean(latencies):.2f} ms, "
+              f"p50 {statistics.median(latencies):.2f} ms, p95 {p95:.2f} ms")
+    return 0 if errors == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Cliente del demonio de alineamiento MSA",
+        epilog="""
+Ejemplos:
+  python msa_client.py /tmp/msa.sock ping
+  python msa_client.py /tmp/msa.sock align secuencias.fasta --format a3m
+  python msa_client.py /tmp/msa.sock stats
+  python msa_client.py /tmp/msa.sock bench secuencias.fasta -n 200 -c 8
+        """,
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+    )
+    parser.add_argument("socket", help="Ruta del socket del demonio")
+    parser.add_argument("command", choices=["ping", "stats", "align", "bench"])
+    parser.add_argument("fasta", nargs="?", help="Archivo FASTA (align/bench)")
+    parser.add_argument("--format", default="fasta", choices=["fasta", "a3m", "rle"],
+                        help="Formato del alineamiento devuelto")
+    parser.add_argument("--output", "-o", help="Archivo donde guardar el alineamiento")
+    parser.add_argument("--budget-ms", type=float, help="Presupuesto de tiempo por alineamiento")
+    parser.add_argument("-n", "--requests", type=int, default=100, help="Peticiones (bench)")
+    parser.add_argument("-c", "--concurrency", type=int, default=4, help="Conexiones simultáneas (bench)")
+    args = parser.parse_args()
+
+    if args.command in ("align", "bench") and not args.fasta:
+        parser.error(f"'{args.command}' requiere un archivo FASTA")
+
+    try:
+        if args.command == "bench":
+            fasta_text = Path(args.fasta).read_text()
+            return run_bench(args.socket, fasta_text, args.format, args.requests, args.concurrency,
+                             args.budget_ms)
+
+        with MSAClient(args.socket) as client:
+            if args.command == "ping":
+                status, _ = client.ping()
+                print(status)
+            elif args.command == "stats":
+                status, values = client.stats()
+                for key, value in values.items():
+                    print(f"{key}={value}")
+            else:
+                status, body = client.align(Path(args.fasta).read_text(), args.format, args.budget_ms)
+                print(status, file=sys.stderr)
+                if status.startswith("OK"):
+                    if args.output:
+                        Path(args.output).write_text(body)
+                    else:
+                        sys.stdout.write(body)
+    except (OSError, ConnectionError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    return 0 if status.startswith("OK") else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
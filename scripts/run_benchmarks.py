@@ -5,6 +5,7 @@ Ejecuta múltiples benchmarks y genera reportes detallados
 """
 
 import os
+import re
 import sys
 import subprocess
 import json
@@ -64,6 +65,7 @@ class MSABenchmarkRunner:
                     "output": str(output_file),
                     "stdout": result.stdout,
                     "stderr": result.stderr,
+                    "timings": self._parse_stage_timings(result.stdout),
                     "success": True,
                     "timestamp": timestamp
                 }
@@ -100,14 +102,17 @@ class MSABenchmarkRunner:
             timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
             output_dir = self.results_dir / f"batch_{timestamp}"
             output_dir.mkdir(exist_ok=True)
+        else:
+            output_dir = Path(output_dir)
+            output_dir.mkdir(parents=True, exist_ok=True)
         
         results = []
         
-        print("\\n🚀 Iniciando {} benchmarks...".format(len(datasets)))
+        print("\n🚀 Iniciando {} benchmarks...".format(len(datasets)))
         print("=" * 60)
         
         for i, dataset in enumerate(datasets, 1):
-            print(f"\\n[{i}/{len(datasets)}] {Path(dataset).name}")
+            print(f"\n[{i}/{len(datasets)}] {Path(dataset).name}")
             print("-" * 40)
             
             result = self.run_single_benchmark(dataset, output_dir)
@@ -125,7 +130,7 @@ class MSABenchmarkRunner:
         self._generate_csv_report(results, csv_file)
         self._generate_json_report(results, json_file)
         
-        print("\\n📊 Reportes generados:")
+        print("\n📊 Reportes generados:")
         print(f"  📄 Resumen: {report_file}")
         print(f"  📈 CSV: {csv_file}")
         print(f"  🔧 JSON: {json_file}")
@@ -143,35 +148,35 @@ class MSABenchmarkRunner:
     
     def _write_report_header(self, f, results):
         """Escribe el encabezado del reporte"""
-        f.write("REPORTE DE BENCHMARKS - MSA Aligner\\n")
-        f.write("=" * 50 + "\\n\\n")
-        f.write(f"Fecha: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}\\n")
-        f.write(f"Total de benchmarks: {len(results)}\\n")
+        f.write("REPORTE DE BENCHMARKS - MSA Aligner\n")
+        f.write("=" * 50 + "\n\n")
+        f.write(f"Fecha: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}\n")
+        f.write(f"Total de benchmarks: {len(results)}\n")
     
     def _write_summary_stats(self, f, successful, failed):
         """Escribe estadísticas de resumen"""
-        f.write(f"Exitosos: {len(successful)}\\n")
-        f.write(f"Fallidos: {len(failed)}\\n\\n")
+        f.write(f"Exitosos: {len(successful)}\n")
+        f.write(f"Fallidos: {len(failed)}\n\n")
     
     def _write_failed_benchmarks(self, f, failed):
         """Escribe sección de benchmarks fallidos"""
         if not failed:
             return
         
-        f.write("BENCHMARKS FALLIDOS:\\n")
-        f.write("-" * 20 + "\\n")
+        f.write("BENCHMARKS FALLIDOS:\n")
+        f.write("-" * 20 + "\n")
         for fail in failed:
-            f.write(f"  {Path(fail['dataset']).name}: {fail.get('error', 'Error desconocido')}\\n")
-        f.write("\\n")
+            f.write(f"  {Path(fail['dataset']).name}: {fail.get('error', 'Error desconocido')}\n")
+        f.write("\n")
     
     def _write_successful_benchmarks(self, f, successful):
         """Escribe sección de benchmarks exitosos"""
-        f.write("BENCHMARKS EXITOSOS:\\n")
-        f.write("-" * 20 + "\\n")
+        f.write("BENCHMARKS EXITOSOS:\n")
+        f.write("-" * 20 + "\n")
         for success in successful:
-            f.write(f"  {Path(success['dataset']).name}\\n")
+            f.write(f"  {Path(success['dataset']).name}\n")
             self._write_metrics_if_available(f, success)
-            f.write("\\n")
+            f.write("\n")
     
     def _write_metrics_if_available(self, f, success):
         """Escribe métricas si están disponibles en stdout"""
@@ -182,11 +187,33 @@ class MSABenchmarkRunner:
         if "Tiempo total:" not in stdout:
             return
         
-        lines = stdout.split('\\n')
-        keywords = ["Tiempo total:", "Secuencias procesadas:", "Gaps insertados:"]
+        lines = stdout.split('\n')
+        keywords = ["Tiempo total:", "Secuencias procesadas:", "Gaps insertados:",
+                    "Tiempo por etapa", "Subetapas", "Celdas DP:"]
         for line in lines:
             if any(keyword in line for keyword in keywords):
-                f.write(f"    {line.strip()}\\n")
+                f.write(f"    {line.strip()}\n")
+    
+    def _parse_stage_timings(self, stdout):
+        """Extrae del resumen del alineador los tiempos por etapa, subetapas y celdas DP"""
+        names = {
+            "distancias": "distances_ms", "arbol": "tree_ms",
+            "progresivo": "progressive_ms", "filas": "rows_ms",
+            "dp": "dp_fill_ms", "traceback": "traceback_ms",
+            "consenso": "consensus_ms", "union_perfiles": "profile_merge_ms",
+        }
+        timings = {}
+        for line in (stdout or "").splitlines():
+            if line.startswith("Tiempo por etapa") or line.startswith("Subetapas"):
+                for key, value in re.findall(r'(\w+)=([\d.]+)', line):
+                    if key in names:
+                        timings[names[key]] = float(value)
+            cells = re.match(r'Celdas DP: (\d+) en (\d+) alineamientos \(([\d.]+) GCUPS\)', line)
+            if cells:
+                timings["dp_cells"] = int(cells.group(1))
+                timings["dp_alignments"] = int(cells.group(2))
+                timings["gcups"] = float(cells.group(3))
+        return timings
     
     def _generate_csv_report(self, results, csv_file):
         """Genera reporte CSV"""
@@ -210,7 +237,7 @@ class MSABenchmarkRunner:
     
     def run_scalability_test(self, base_dataset, max_sequences=50, step=10):
         """Ejecuta test de escalabilidad"""
-        print("\\n🔬 Test de escalabilidad con {}".format(base_dataset))
+        print("\n🔬 Test de escalabilidad con {}".format(base_dataset))
         print("Desde {} hasta {} secuencias".format(step, max_sequences))
         
         # Este método requeriría integración con el código C++ de benchmark
@@ -223,7 +250,7 @@ class MSABenchmarkRunner:
             output_dir = self.datasets_dir / "synthetic"
             output_dir.mkdir(exist_ok=True)
         
-        print("\\n🧪 Creando datasets sintéticos...")
+        print("\n🧪 Creando datasets sintéticos...")
         
         for size in sizes:
             print("  Creando dataset con {} secuencias...".format(size))
@@ -265,7 +292,7 @@ Ejemplos de uso:
     if not os.path.exists(args.executable):
         print("❌ Error: No se encuentra el ejecutable {}".format(args.executable))
         print("💡 Asegúrate de compilar el proyecto primero:")
-        print("   g++ -std=c++17 -O3 -Wall -Wextra src/MSAligner.cpp src/alignment.cpp src/io.cpp -o alineador")
+        print("   g++ -std=c++17 -O3 -Wall -Wextra -pthread src/MSAligner.cpp src/alignment.cpp src/engines.cpp src/io.cpp src/thread_pool.cpp src/trace.cpp src/batch.cpp src/daemon.cpp src/distance_shards.cpp src/result_cache.cpp src/logger.cpp -o alineador")
         sys.exit(1)
     
     runner = MSABenchmarkRunner(args.executable)
@@ -305,7 +332,7 @@ Ejemplos de uso:
         print("❌ No se encontraron datasets para ejecutar")
         sys.exit(1)
     
-    print("\\n📋 Datasets encontrados ({}):".format(len(datasets)))
+    print("\n📋 Datasets encontrados ({}):".format(len(datasets)))
     for dataset in datasets:
         print("  📁 {}".format(dataset))
     
@@ -315,7 +342,7 @@ Ejemplos de uso:
     # Generar reportes
     runner.generate_summary_report(results, output_dir)
     
-    print("\\n✅ Benchmarks completados!")
+    print("\n✅ Benchmarks completados!")
     print("📂 Resultados en: {}".format(output_dir))
 
 
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Test suite for msa_client.py
+Covers the framing protocol against an in-process fake daemon
+"""
+
+import unittest
+import socket
+import struct
+import threading
+
+import msa_client
+
+
+class FakeDaemon(threading.Thread):
+    """Responds to every frame on one end of a socketpair"""
+
+    def __init__(self, sock):
+        super().__init__(daemon=True)
+        self.sock = sock
+        self.requests = []
+
+    def run(self):
+        try:
+            while True:
+                payload = msa_client.read_frame(self.sock).decode()
+                self.requests.append(payload)
+                if payload == "PING":
+                    reply = "OK pong"
+                elif payload == "STATS":
+                    reply = "OK\nrequests_ok=3\nlatency_p95_ms=1.500\n"
+                elif payload.startswith("ALIGN"):
+                    reply = "OK queue_ms=0.000 align_ms=1.000\n>s1\nAC-G\n>s2\nACTG\n"
+                else:
+                    reply = "ERROR Comando desconocido"
+                self.sock.sendall(msa_client.encode_frame(reply))
+        except OSError:
+            pass
+
+
+class TestMSAClient(unittest.TestCase):
+
+    def setUp(self):
+        client_sock, server_sock = socket.socketpair()
+        self.server = FakeDaemon(server_sock)
+        self.server.start()
+        self.client = msa_client.MSAClient("unused")
+        self.client.sock = client_sock
+
+    def tearDown(self):
+        self.client.close()
+        self.server.join(timeout=5)
+        self.server.sock.close()
+
+    def test_encode_frame_prefixes_big_endian_length(self):
+        frame = msa_client.encode_frame("PING")
+        self.assertEqual(frame[:4], struct.pack(">I", 4))
+        self.assertEqual(frame[4:], b"PING")
+
+    def test_ping(self):
+        status, body = self.client.ping()
+        self.assertEqual(status, "OK pong")
+        self.assertEqual(body, "")
+
+    def test_stats_parses_key_values(self):
+        status, values = self.client.stats()
+        self.assertEqual(status, "OK")
+        self.assertEqual(values["requests_ok"], "3")
+        self.assertEqual(values["latency_p95_ms"], "1.500")
+
+    def test_align_sends_format_and_fasta(self):
+        status, body = self.client.align(">s1\nACG\n>s2\nACTG\n", "a3m")
+        self.assertTrue(status.startswith("OK"))
+        self.assertIn(">s1", body)
+        self.assertEqual(self.server.requests[-1], "ALIGN a3m\n>s1\nACG\n>s2\nACTG\n")
+
+    def test_align_sends_budget_option(self):
+        status, _ = self.client.align(">s1\nACG\n>s2\nACTG\n", "fasta", budget_ms=250)
+        self.assertTrue(status.startswith("OK"))
+        self.assertEqual(self.server.requests[-1], "ALIGN fasta budget_ms=250\n>s1\nACG\n>s2\nACTG\n")
+
+    def test_unknown_command(self):
+        status, _ = self.client.request("FOO")
+        self.assertTrue(status.startswith("ERROR"))
+
+    def test_read_frame_raises_on_closed_connection(self):
+        a, b = socket.socketpair()
+        a.sendall(b"\x00\x00")
+        a.close()
+        with self.assertRaises(ConnectionError):
+            msa_client.read_frame(b)
+        b.close()
+
+
+if __name__ == '__main__':
+    unittest.main()
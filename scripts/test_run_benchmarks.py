@@ -267,6 +267,27 @@ class TestMSABenchmarkRunner(unittest.TestCase):
         self.assertIn("Gaps insertados: 5", content)
         Path(temp_file).unlink()
     
+    def test_parse_stage_timings(self):
+        """Test parsing of per-stage timings from the aligner summary"""
+        stdout = (
+            "Tiempo total: 0.050 segundos\n"
+            "Tiempo por etapa (ms): distancias=0.8 arbol=0.1 progresivo=20.8 filas=19.5\n"
+            "Subetapas (ms, suma de hilos): dp=33.8 traceback=0.5 consenso=0.3 union_perfiles=1.6\n"
+            "Celdas DP: 4174695 en 59 alineamientos (0.124 GCUPS)\n"
+        )
+        
+        timings = self.runner._parse_stage_timings(stdout)
+        
+        self.assertEqual(timings["distances_ms"], 0.8)
+        self.assertEqual(timings["progressive_ms"], 20.8)
+        self.assertEqual(timings["rows_ms"], 19.5)
+        self.assertEqual(timings["dp_fill_ms"], 33.8)
+        self.assertEqual(timings["profile_merge_ms"], 1.6)
+        self.assertEqual(timings["dp_cells"], 4174695)
+        self.assertEqual(timings["dp_alignments"], 59)
+        self.assertEqual(timings["gcups"], 0.124)
+        self.assertEqual(self.runner._parse_stage_timings(""), {})
+    
     def test_generate_csv_report(self):
         """Test CSV report generation"""
         results = [
@@ -343,29 +364,48 @@ class TestMainFunction(unittest.TestCase):
     """Test the main function and argument parsing"""
     
     @patch('os.path.exists')
-    @patch('sys.exit')
+    @patch('sys.exit', side_effect=SystemExit)
     @patch('builtins.print')
     def test_main_executable_not_found(self, mock_print, mock_exit, mock_exists):
         """Test main function when executable doesn't exist"""
         mock_exists.return_value = False
         
         with patch('sys.argv', ['run_benchmarks.py', '--all']):
-            run_benchmarks.main()
+            with self.assertRaises(SystemExit):
+                run_benchmarks.main()
         
         mock_exit.assert_called_with(1)
         mock_print.assert_called()
     
     @patch('os.path.exists')
-    @patch('sys.exit')
+    @patch('sys.exit', side_effect=SystemExit)
     @patch('builtins.print')
     def test_main_no_arguments(self, mock_print, mock_exit, mock_exists):
         """Test main function with no arguments"""
         mock_exists.return_value = True
         
         with patch('sys.argv', ['run_benchmarks.py']):
-            run_benchmarks.main()
+            with self.assertRaises(SystemExit):
+                run_benchmarks.main()
+        
+        mock_exit.assert_called_with(1)
+    
+    @patch('os.path.exists')
+    @patch('sys.exit', side_effect=SystemExit)
+    @patch('builtins.print')
+    @patch.object(run_benchmarks.MSABenchmarkRunner, 'run_multiple_benchmarks')
+    @patch.object(run_benchmarks.MSABenchmarkRunner, 'find_datasets')
+    def test_main_no_datasets_writes_no_reports(self, mock_find, mock_run, mock_print, mock_exit, mock_exists):
+        """Test that main stops before running (and writing empty reports) when no dataset is found"""
+        mock_exists.return_value = True
+        mock_find.return_value = []
+        
+        with patch('sys.argv', ['run_benchmarks.py', '--category', 'small']):
+            with self.assertRaises(SystemExit):
+                run_benchmarks.main()
         
         mock_exit.assert_called_with(1)
+        mock_run.assert_not_called()
     
     @patch('os.path.exists')
     @patch.object(run_benchmarks.MSABenchmarkRunner, 'create_synthetic_datasets')
@@ -1,66 +1,174 @@
 #include <iostream>
 #include <chrono>
 #include <iomanip>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include "io.h"
 #include "alignment.h"
+#include "thread_pool.h"
+#include "batch.h"
+#include "daemon.h"
+#include "distance_shards.h"
+#include "engines.h"
+#include "result_cache.h"
+#include "logger.h"
+#include "trace.h"
+
+// Límites de las opciones numéricas
+const size_t MAX_THREADS = 4096;
+const size_t MAX_QUEUE = 1000000;
+const double MAX_SECONDS = 365.0 * 24.0 * 3600.0;
+// Tamaños en MB que todavía caben en bytes como size_t
+const double MAX_MEGABYTES = static_cast<double>(std::numeric_limits<size_t>::max() >> 21);
 
 void printUsage(const char* program_name) {
-    std::cout << "\nALINEADOR MULTIPLE DE SECUENCIAS (MSA)\n" << std::endl;
-    std::cout << "Uso: " << program_name << " <archivo_entrada.fasta> <archivo_salida.fasta>" << std::endl;
-    std::cout << "\nDescripcion:" << std::endl;
-    std::cout << "  Este programa realiza alineamiento multiple de secuencias usando:" << std::endl;
-    std::cout << "  1. Matriz de distancias basada en identidad porcentual" << std::endl;
-    std::cout << "  2. Construccion de arbol guia con algoritmo UPGMA" << std::endl;
-    std::cout << "  3. Alineamiento progresivo con programacion dinamica" << std::endl;
-    std::cout << "\nEjemplo:" << std::endl;
-    std::cout << "  " << program_name << " sequences.fasta aligned_sequences.fasta" << std::endl;
-    std::cout << "\nFormato de entrada:" << std::endl;
-    std::cout << "  - Archivo FASTA estandar con multiples secuencias" << std::endl;
-    std::cout << "  - Minimo 2 secuencias requeridas" << std::endl;
-    std::cout << "  - Soporta secuencias de ADN y proteinas" << std::endl;
-    std::cout << std::endl;
+    LOG_INFO("cli") << "\nALINEADOR MULTIPLE DE SECUENCIAS (MSA)\n";
+    LOG_INFO("cli") << "Uso: " << program_name << " <archivo_entrada.fasta> <archivo_salida.fasta> [opciones]";
+    LOG_INFO("cli") << "     " << program_name << " --batch <manifiesto|directorio> <directorio_salida> [opciones]";
+    LOG_INFO("cli") << "     " << program_name << " --daemon <socket> [opciones]";
+    LOG_INFO("cli") << "     " << program_name << " distances --shard <i/k> <archivo_entrada.fasta> <fragmento>";
+    LOG_INFO("cli") << "     " << program_name << " distances --merge <almacen> <fragmento>...";
+    LOG_INFO("cli") << "\nDescripcion:";
+    LOG_INFO("cli") << "  Este programa realiza alineamiento multiple de secuencias usando:";
+    LOG_INFO("cli") << "  1. Matriz de distancias basada en identidad porcentual";
+    LOG_INFO("cli") << "  2. Construccion de arbol guia con algoritmo UPGMA";
+    LOG_INFO("cli") << "  3. Alineamiento progresivo con programacion dinamica";
+    LOG_INFO("cli") << "\nOpciones:";
+    LOG_INFO("cli") << "  --format <fasta|a3m|rle>  Formato de salida (por defecto: fasta)";
+    LOG_INFO("cli") << "                            a3m: inserciones en minusculas, sin gaps de relleno";
+    LOG_INFO("cli") << "                            rle: corridas de gaps codificadas como -<n>";
+    LOG_INFO("cli") << "  --engine <etapa>=<nombre> Engine de una etapa: distance, tree, pairwise, merge u";
+    LOG_INFO("cli") << "                            output (equivale a --format); repetible";
+    LOG_INFO("cli") << "  --list-engines            Lista los engines registrados por etapa";
+    LOG_INFO("cli") << "  --threads <n>             Hilos de trabajo (por defecto: todos los nucleos)";
+    LOG_INFO("cli") << "  --batch                   Alinea muchas familias FASTA en un solo proceso";
+    LOG_INFO("cli") << "  --add <alineamiento>      Agrega las secuencias de entrada a un alineamiento";
+    LOG_INFO("cli") << "                            existente (FASTA alineado, .a3m o .rle) sin realinearlo";
+    LOG_INFO("cli") << "  --merge <alineamiento2>   Une el alineamiento de entrada con otro alineamiento";
+    LOG_INFO("cli") << "                            mediante un unico alineamiento perfil-perfil";
+    LOG_INFO("cli") << "  --big-family-cells <n>    Celdas DP a partir de las cuales una familia usa";
+    LOG_INFO("cli") << "                            paralelismo interno en modo lote (por defecto: 5e7)";
+    LOG_INFO("cli") << "  --daemon <socket>         Atiende trabajos en un socket Unix (cliente: scripts/msa_client.py)";
+    LOG_INFO("cli") << "  --workers <n>             Trabajos simultaneos del demonio (por defecto: 2)";
+    LOG_INFO("cli") << "  --queue <n>               Conexiones en espera antes de responder BUSY (por defecto: 64)";
+    LOG_INFO("cli") << "  --idle-timeout <s>        Cierra las conexiones del demonio sin datos durante s segundos";
+    LOG_INFO("cli") << "                            (por defecto: 30, 0 = sin limite)";
+    LOG_INFO("cli") << "  --shard <i/k>             Con 'distances': calcula el bloque i de k de la matriz";
+    LOG_INFO("cli") << "                            de distancias y lo guarda en un fragmento binario";
+    LOG_INFO("cli") << "  --distances <almacen>     Usa un almacen de distancias unido en lugar de calcularlas";
+    LOG_INFO("cli") << "  --cache-size <MB>         Cache de resultados para trabajos repetidos (lote y demonio)";
+    LOG_INFO("cli") << "  --cache-dir <directorio>  Cache persistente entre ejecuciones (por defecto 256 MB)";
+    LOG_INFO("cli") << "  --time-budget <segundos>  Presupuesto de tiempo; al agotarse se degrada a estrategias";
+    LOG_INFO("cli") << "                            mas rapidas (k-mers, DP en banda, sin refinamiento)";
+    LOG_INFO("cli") << "  --max-memory <MB>         Limite de memoria; se eligen estrategias mas compactas";
+    LOG_INFO("cli") << "                            (traza empaquetada, Hirschberg, distancias empaquetadas,";
+    LOG_INFO("cli") << "                            perfiles en disco) y se falla solo si ninguna cabe";
+    LOG_INFO("cli") << "  --trace <archivo.json>    Traza Chrome/Perfetto de etapas, uniones, E/S y ocio de los hilos";
+    LOG_INFO("cli") << "  --quiet                   Solo muestra errores y advertencias";
+    LOG_INFO("cli") << "  --log-level <nivel>       quiet, info, debug o trace (por defecto: info)";
+    LOG_INFO("cli") << "  --log-format <formato>    text, kv (clave=valor) o json (por defecto: text)";
+    LOG_INFO("cli") << "\nEjemplo:";
+    LOG_INFO("cli") << "  " << program_name << " sequences.fasta aligned_sequences.fasta";
+    LOG_INFO("cli") << "  " << program_name << " sequences.fasta aligned_sequences.a3m --format a3m";
+    LOG_INFO("cli") << "  " << program_name << " sequences.fasta aligned_sequences.fasta --engine pairwise=linear --engine tree=nj";
+    LOG_INFO("cli") << "  " << program_name << " --batch familias/ alineadas/ --threads 8";
+    LOG_INFO("cli") << "  " << program_name << " nuevas.fasta ampliado.fasta --add existente.fasta";
+    LOG_INFO("cli") << "  " << program_name << " clado_a.fasta unido.fasta --merge clado_b.fasta";
+    LOG_INFO("cli") << "  " << program_name << " --daemon /tmp/msa.sock --workers 4 --threads 8";
+    LOG_INFO("cli") << "  " << program_name << " distances --shard 0/4 sequences.fasta frag_0.dist";
+    LOG_INFO("cli") << "  " << program_name << " distances --merge sequences.dist frag_*.dist";
+    LOG_INFO("cli") << "  " << program_name << " sequences.fasta aligned_sequences.fasta --distances sequences.dist";
+    LOG_INFO("cli") << "\nFormato de entrada:";
+    LOG_INFO("cli") << "  - Archivo FASTA estandar con multiples secuencias";
+    LOG_INFO("cli") << "  - Minimo 2 secuencias requeridas";
+    LOG_INFO("cli") << "  - Soporta secuencias de ADN y proteinas";
+    LOG_INFO("cli");
 }
 
 void printHeader() {
-    std::cout << "\n" << std::string(60, '=') << std::endl;
-    std::cout << "ALINEADOR MULTIPLE DE SECUENCIAS (MSA) v1.0" << std::endl;
-    std::cout << "   Implementacion en C++ con algoritmo progresivo" << std::endl;
-    std::cout << std::string(60, '=') << std::endl;
+    LOG_INFO("cli") << "\n" << std::string(60, '=');
+    LOG_INFO("cli") << "ALINEADOR MULTIPLE DE SECUENCIAS (MSA) v1.0";
+    LOG_INFO("cli") << "   Implementacion en C++ con algoritmo progresivo";
+    LOG_INFO("cli") << std::string(60, '=');
 }
 
 void printSummary(const std::chrono::duration<double>& duration, 
                  const std::map<std::string, int>& stats,
+                 const AlignmentTimings& timings,
                  int num_sequences) {
-    std::cout << "\n" << std::string(50, '-') << std::endl;
-    std::cout << "RESUMEN DEL ALINEAMIENTO" << std::endl;
-    std::cout << std::string(50, '-') << std::endl;
-    std::cout << "Tiempo total: " << std::fixed << std::setprecision(3) 
-              << duration.count() << " segundos" << std::endl;
-    std::cout << "Secuencias procesadas: " << num_sequences << std::endl;
-    std::cout << "Longitud final: " << stats.at("final_length") << " posiciones" << std::endl;
-    std::cout << "Gaps insertados: " << stats.at("total_gaps") << std::endl;
+    LOG_INFO("cli") << "\n" << std::string(50, '-');
+    LOG_INFO("cli") << "RESUMEN DEL ALINEAMIENTO";
+    LOG_INFO("cli") << std::string(50, '-');
+    LOG_INFO("cli.summary").field("seconds", duration.count())
+        << "Tiempo total: " << std::fixed << std::setprecision(3) << duration.count() << " segundos";
+    LOG_INFO("cli") << "Secuencias procesadas: " << num_sequences;
+    LOG_INFO("cli") << "Longitud final: " << stats.at("final_length") << " posiciones";
+    LOG_INFO("cli") << "Gaps insertados: " << stats.at("total_gaps");
     
     if (stats.at("final_length") > 0) {
         double gap_percentage = (static_cast<double>(stats.at("total_gaps")) / 
                                (num_sequences * stats.at("final_length"))) * 100.0;
-        std::cout << "Porcentaje de gaps: " << std::fixed << std::setprecision(1) 
-                  << gap_percentage << "%" << std::endl;
+        LOG_INFO("cli") << "Porcentaje de gaps: " << std::fixed << std::setprecision(1) 
+                        << gap_percentage << "%";
+    }
+    
+    auto degradations = stats.find("degradations");
+    if (degradations != stats.end() && degradations->second != DEGRADE_NONE) {
+        LOG_INFO("cli") << "Degradaciones por presupuesto: "
+                        << describeDegradations(static_cast<unsigned>(degradations->second));
+    }
+    
+    auto memory = stats.find("memory_strategies");
+    if (memory != stats.end() && memory->second != MEMORY_FULL) {
+        LOG_INFO("cli") << "Estrategias por limite de memoria: "
+                        << describeMemoryStrategies(static_cast<unsigned>(memory->second));
+    }
+    
+    // Sin tiempos cuando el resultado salio de la cache
+    if (timings.total_ms > 0.0) {
+        LOG_INFO("cli.timing").field("distances_ms", timings.distances_ms)
+                              .field("tree_ms", timings.tree_ms)
+                              .field("progressive_ms", timings.progressive_ms)
+                              .field("rows_ms", timings.rows_ms)
+                              .field("total_ms", timings.total_ms)
+            << "Tiempo por etapa (ms): " << std::fixed << std::setprecision(1)
+            << "distancias=" << timings.distances_ms << " arbol=" << timings.tree_ms
+            << " progresivo=" << timings.progressive_ms << " filas=" << timings.rows_ms;
+        LOG_INFO("cli.timing").field("dp_fill_ms", timings.dp_fill_ms)
+                              .field("traceback_ms", timings.traceback_ms)
+                              .field("consensus_ms", timings.consensus_ms)
+                              .field("profile_merge_ms", timings.profile_merge_ms)
+            << "Subetapas (ms, suma de hilos): " << std::fixed << std::setprecision(1)
+            << "dp=" << timings.dp_fill_ms << " traceback=" << timings.traceback_ms
+            << " consenso=" << timings.consensus_ms << " union_perfiles=" << timings.profile_merge_ms;
+        LOG_INFO("cli.timing").field("dp_alignments", timings.dp_alignments)
+                              .field("dp_cells", timings.dp_cells)
+                              .field("gcups", timings.gcups())
+            << "Celdas DP: " << timings.dp_cells << " en " << timings.dp_alignments << " alineamientos ("
+            << std::setprecision(3) << timings.gcups() << " GCUPS)";
     }
     
-    std::cout << std::string(50, '-') << std::endl;
-    std::cout << "Alineamiento completado exitosamente!" << std::endl;
+    LOG_INFO("cli") << std::string(50, '-');
+    LOG_INFO("cli") << "Alineamiento completado exitosamente!";
 }
 
 bool validateInputFile(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cerr << "Error: No se puede abrir el archivo de entrada: " << filename << std::endl;
+        LOG_ERROR("cli.error") << "Error: No se puede abrir el archivo de entrada: " << filename;
         return false;
     }
     
     file.seekg(0, std::ios::end);
     if (file.tellg() == 0) {
-        std::cerr << "Error: El archivo de entrada esta vacio: " << filename << std::endl;
+        LOG_ERROR("cli.error") << "Error: El archivo de entrada esta vacio: " << filename;
         return false;
     }
     
@@ -71,7 +179,7 @@ bool validateInputFile(const std::string& filename) {
 bool validateOutputPath(const std::string& filename) {
     std::ofstream test_file(filename);
     if (!test_file.is_open()) {
-        std::cerr << "Error: No se puede escribir en el archivo de salida: " << filename << std::endl;
+        LOG_ERROR("cli.error") << "Error: No se puede escribir en el archivo de salida: " << filename;
         return false;
     }
     test_file.close();
@@ -80,16 +188,452 @@ bool validateOutputPath(const std::string& filename) {
     return true;
 }
 
+/**
+ * Lee el valor entero de una opción: solo dígitos, dentro de [min_value, max_value]
+ * @return false (con el error ya informado) si el valor no es válido
+ */
+bool parseCountOption(const std::string& option, const std::string& text,
+                      size_t min_value, size_t max_value, size_t& value) {
+    bool digits = !text.empty() && text.size() <= 20 &&
+                  std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c) != 0; });
+    errno = 0;
+    unsigned long long parsed = digits ? std::strtoull(text.c_str(), nullptr, 10) : 0;
+    if (!digits || errno == ERANGE || parsed < min_value || parsed > max_value) {
+        LOG_ERROR("cli.error") << "Error: Valor invalido para " << option << ": '" << text
+                               << "' (se espera un entero entre " << min_value << " y " << max_value << ")";
+        return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+/**
+ * Lee el valor decimal de una opción: número finito sin signo ni texto sobrante,
+ * dentro de [min_value, max_value] (con allow_zero, 0 también se admite)
+ * @return false (con el error ya informado) si el valor no es válido
+ */
+bool parseAmountOption(const std::string& option, const std::string& text, double min_value,
+                       double max_value, bool allow_zero, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = 0.0;
+    bool valid = !text.empty() && (std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '.');
+    if (valid) {
+        parsed = std::strtod(text.c_str(), &end);
+        valid = end == text.c_str() + text.size() && errno != ERANGE && std::isfinite(parsed) &&
+                ((allow_zero && parsed == 0.0) || (parsed >= min_value && parsed <= max_value));
+    }
+    if (!valid) {
+        LOG_ERROR("cli.error") << "Error: Valor invalido para " << option << ": '" << text
+                               << "' (se espera un numero entre " << min_value << " y " << max_value
+                               << (allow_zero ? ", o 0 para desactivarlo)" : ")");
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+int runBatchMode(const BatchOptions& options) {
+    try {
+        BatchRunner runner(options);
+        BatchSummary summary = runner.run();
+        
+        LOG_INFO("cli") << "\n" << std::string(50, '-');
+        LOG_INFO("cli") << "RESUMEN DEL LOTE";
+        LOG_INFO("cli") << std::string(50, '-');
+        LOG_INFO("cli") << "Familias: " << summary.families_ok << "/" << summary.families_total
+                        << " alineadas (" << summary.families_failed << " con error, "
+                        << summary.big_families << " grandes)";
+        LOG_INFO("cli") << "Secuencias procesadas: " << summary.total_sequences;
+        LOG_INFO("cli") << "Tiempo total: " << std::fixed << std::setprecision(3)
+                        << summary.elapsed_seconds << " segundos";
+        LOG_INFO("cli") << "Rendimiento: " << std::fixed << std::setprecision(1)
+                        << summary.familiesPerHour() << " familias/hora";
+        if (summary.cache_hits + summary.cache_misses > 0) {
+            LOG_INFO("cli") << "Cache: " << summary.cache_hits << " aciertos, "
+                            << summary.cache_misses << " fallos";
+        }
+        LOG_INFO("cli") << std::string(50, '-');
+        
+        return (summary.families_total > 0 && summary.families_failed == 0) ? 0 : 1;
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR("cli.error") << "\nError inesperado: " << e.what();
+        return 1;
+    }
+}
+
+int runDistanceShard(const std::string& input_file, const std::string& shard_file,
+                     const std::string& shard_spec, size_t num_threads, const AlignerPreset& preset) {
+    uint32_t shard_index = 0, shard_count = 1;
+    if (!DistanceShards::parseShardSpec(shard_spec, shard_index, shard_count)) {
+        LOG_ERROR("cli.error") << "Error: Fragmento invalido (se espera i/k con 0 <= i < k): " << shard_spec;
+        return 1;
+    }
+    
+    try {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        auto sequences = FastaIO::readFasta(input_file);
+        if (sequences.size() < 2) {
+            LOG_ERROR("cli.error") << "Error: Se necesitan al menos 2 secuencias para el alineamiento.";
+            return 1;
+        }
+        
+        DistanceShard shard;
+        shard.shard_index = shard_index;
+        shard.shard_count = shard_count;
+        shard.num_sequences = sequences.size();
+        shard.fingerprint = DistanceShards::fingerprint(sequences);
+        shard.distance_engine = preset.distance;
+        DistanceShards::shardPairRange(shard.num_sequences, shard_index, shard_count,
+                                       shard.pair_begin, shard.pair_end);
+        
+        LOG_INFO("cli") << "\nCalculando fragmento " << shard_index << "/" << shard_count
+                        << " de la matriz de distancias (pares " << shard.pair_begin
+                        << "-" << shard.pair_end << " de " << DistanceShards::totalPairs(shard.num_sequences) << ")...";
+        
+        MSAAligner aligner;
+        aligner.setVerbose(false);
+        aligner.setPreset(preset);
+        std::unique_ptr<ThreadPool> pool;
+        if (num_threads != 1) {
+            pool = std::make_unique<ThreadPool>(num_threads);
+            aligner.setThreadPool(pool.get());
+        }
+        shard.values = aligner.calculateDistanceBlock(sequences, shard.pair_begin, shard.pair_end);
+        
+        if (!DistanceShards::writeShard(shard, shard_file)) {
+            return 1;
+        }
+        
+        auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(
+            std::chrono::high_resolution_clock::now() - start_time);
+        LOG_INFO("distances.shard").field("file", shard_file).field("pairs", shard.values.size())
+                                   .field("seconds", duration.count())
+            << "Fragmento guardado en: " << shard_file << " (" << shard.values.size() << " pares, "
+            << std::fixed << std::setprecision(3) << duration.count() << " segundos)";
+        return 0;
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR("cli.error") << "\nError inesperado: " << e.what();
+        return 1;
+    }
+}
+
+int runDistanceMerge(const std::string& store_file, const std::vector<std::string>& shard_files) {
+    DistanceShard store;
+    if (!DistanceShards::mergeShards(shard_files, store) ||
+        !DistanceShards::writeShard(store, store_file)) {
+        return 1;
+    }
+    
+    LOG_INFO("distances.merge").field("file", store_file).field("shards", shard_files.size())
+                               .field("sequences", store.num_sequences)
+        << "\nAlmacen de distancias guardado en: " << store_file << " (" << shard_files.size()
+        << " fragmentos, " << store.num_sequences << " secuencias)";
+    return 0;
+}
+
+/**
+ * Escribe filas alineadas con un engine de salida; los formatos integrados van
+ * por FastaIO y los registrados fuera de él por su función
+ * @return false si no se pudo escribir
+ */
+bool writeRowsWithEngine(const std::vector<AlignedRow>& rows, const std::string& output_file,
+                         const std::string& output_format) {
+    if (EngineRegistry::instance().isBuiltin(EngineStage::OUTPUT, output_format)) {
+        FastaIO::writeRows(rows, output_file, output_format);
+        return true;
+    }
+    std::ofstream file(output_file);
+    if (!file.is_open()) {
+        LOG_ERROR("cli.error") << "Error: No se pudo crear el archivo " << output_file;
+        return false;
+    }
+    EngineRegistry::instance().output(output_format)(rows, file);
+    if (!file) {
+        LOG_ERROR("cli.error") << "Error: Fallo la escritura de " << output_file;
+        return false;
+    }
+    return true;
+}
+
+bool writeAlignment(const std::vector<Sequence>& alignment, const std::string& output_file,
+                    const std::string& output_format) {
+    if (output_format == "fasta") {
+        FastaIO::writeFasta(alignment, output_file, true);
+        return true;
+    }
+    
+    std::vector<AlignedRow> rows;
+    rows.reserve(alignment.size());
+    for (const auto& seq : alignment) {
+        rows.push_back(AlignedRow::fromAlignedSequence(seq));
+    }
+    return writeRowsWithEngine(rows, output_file, output_format);
+}
+
+int runAddMode(const std::string& existing_file, const std::string& input_file,
+               const std::string& output_file, const std::string& output_format,
+               size_t num_threads, const AlignerPreset& preset) {
+    try {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        LOG_INFO("cli") << "\nLeyendo alineamiento existente: " << existing_file;
+        auto alignment = FastaIO::readAlignment(existing_file);
+        
+        LOG_INFO("cli") << "Leyendo secuencias nuevas: " << input_file;
+        auto new_sequences = FastaIO::readFasta(input_file);
+        
+        if (alignment.empty() || new_sequences.empty()) {
+            LOG_ERROR("cli.error") << "Error: No se pudieron leer las secuencias de entrada.";
+            return 1;
+        }
+        
+        MSAAligner aligner;
+        aligner.setPreset(preset);
+        std::unique_ptr<ThreadPool> pool;
+        if (num_threads != 1) {
+            pool = std::make_unique<ThreadPool>(num_threads);
+            aligner.setThreadPool(pool.get());
+        }
+        
+        auto merged = aligner.addToAlignment(alignment, new_sequences);
+        if (merged.empty()) {
+            LOG_ERROR("cli.error") << "Error: Fallo al agregar las secuencias al alineamiento.";
+            return 1;
+        }
+        
+        LOG_INFO("cli") << "\nGuardando secuencias alineadas en: " << output_file;
+        if (!writeAlignment(merged, output_file, output_format)) {
+            return 1;
+        }
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+        
+        auto stats = aligner.getAlignmentStats();
+        printSummary(duration, stats, aligner.getAlignmentTimings(), static_cast<int>(merged.size()));
+        
+        return 0;
+        
+    } catch (const FormatError& e) {
+        LOG_ERROR("cli.error") << "Error: " << e.what();
+        return 1;
+    } catch (const std::exception& e) {
+        LOG_ERROR("cli.error") << "\nError inesperado: " << e.what();
+        return 1;
+    }
+}
+
+int runMergeMode(const std::string& first_file, const std::string& second_file,
+                 const std::string& output_file, const std::string& output_format,
+                 size_t num_threads, const AlignerPreset& preset) {
+    try {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        LOG_INFO("cli") << "\nLeyendo alineamientos: " << first_file << " + " << second_file;
+        auto alignment1 = FastaIO::readAlignment(first_file);
+        auto alignment2 = FastaIO::readAlignment(second_file);
+        
+        if (alignment1.empty() || alignment2.empty()) {
+            LOG_ERROR("cli.error") << "Error: No se pudieron leer los alineamientos de entrada.";
+            return 1;
+        }
+        
+        MSAAligner aligner;
+        aligner.setPreset(preset);
+        std::unique_ptr<ThreadPool> pool;
+        if (num_threads != 1) {
+            pool = std::make_unique<ThreadPool>(num_threads);
+            aligner.setThreadPool(pool.get());
+        }
+        
+        auto merged = aligner.mergeAlignments(alignment1, alignment2);
+        if (merged.empty()) {
+            LOG_ERROR("cli.error") << "Error: Fallo al unir los alineamientos.";
+            return 1;
+        }
+        
+        LOG_INFO("cli") << "\nGuardando secuencias alineadas en: " << output_file;
+        if (!writeAlignment(merged, output_file, output_format)) {
+            return 1;
+        }
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+        
+        auto stats = aligner.getAlignmentStats();
+        printSummary(duration, stats, aligner.getAlignmentTimings(), static_cast<int>(merged.size()));
+        
+        return 0;
+        
+    } catch (const FormatError& e) {
+        LOG_ERROR("cli.error") << "Error: " << e.what();
+        return 1;
+    } catch (const std::exception& e) {
+        LOG_ERROR("cli.error") << "\nError inesperado: " << e.what();
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[]) {
+    std::vector<char*> args;
+    if (!applyLogOptions(argc, argv, args)) {
+        return 1;
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+    
     printHeader();
     
-    if (argc != 3) {
+    std::vector<std::string> positional;
+    std::string output_format = "fasta";
+    size_t num_threads = 0;
+    bool batch_mode = false;
+    double big_family_cells = BatchOptions().big_family_cells;
+    std::string existing_alignment;
+    std::string second_alignment;
+    DaemonOptions daemon_options;
+    double time_budget = 0.0;
+    double max_memory_mb = 0.0;
+    std::string shard_spec;
+    std::string distance_store;
+    double cache_mb = 0.0;
+    std::string cache_dir;
+    std::string trace_file;
+    AlignerPreset preset;
+    bool engines_selected = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool valid = true;
+        if (arg == "--format" && i + 1 < argc) {
+            output_format = argv[++i];
+        } else if (arg == "--engine" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            if (spec.compare(0, 7, "output=") == 0) {
+                output_format = spec.substr(7);
+            } else if (!preset.select(spec)) {
+                return 1;
+            } else {
+                engines_selected = true;
+            }
+        } else if (arg == "--list-engines") {
+            EngineRegistry::instance().print();
+            return 0;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            valid = parseCountOption(arg, argv[++i], 0, MAX_THREADS, num_threads);
+        } else if (arg == "--batch") {
+            batch_mode = true;
+        } else if (arg == "--big-family-cells" && i + 1 < argc) {
+            valid = parseAmountOption(arg, argv[++i], 1.0, 1e18, false, big_family_cells);
+        } else if (arg == "--add" && i + 1 < argc) {
+            existing_alignment = argv[++i];
+        } else if (arg == "--merge" && i + 1 < argc) {
+            second_alignment = argv[++i];
+        } else if (arg == "--daemon" && i + 1 < argc) {
+            daemon_options.socket_path = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            valid = parseCountOption(arg, argv[++i], 1, MAX_THREADS, daemon_options.workers);
+        } else if (arg == "--queue" && i + 1 < argc) {
+            valid = parseCountOption(arg, argv[++i], 1, MAX_QUEUE, daemon_options.queue_capacity);
+        } else if (arg == "--idle-timeout" && i + 1 < argc) {
+            valid = parseAmountOption(arg, argv[++i], 0.001, MAX_SECONDS, true, daemon_options.idle_timeout_s);
+        } else if (arg == "--shard" && i + 1 < argc) {
+            shard_spec = argv[++i];
+        } else if (arg == "--distances" && i + 1 < argc) {
+            distance_store = argv[++i];
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            valid = parseAmountOption(arg, argv[++i], 0.001, MAX_MEGABYTES, true, cache_mb);
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--time-budget" && i + 1 < argc) {
+            valid = parseAmountOption(arg, argv[++i], 0.001, MAX_SECONDS, true, time_budget);
+        } else if (arg == "--max-memory" && i + 1 < argc) {
+            valid = parseAmountOption(arg, argv[++i], 0.001, MAX_MEGABYTES, true, max_memory_mb);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else {
+            positional.push_back(arg);
+        }
+        if (!valid) {
+            return 1;
+        }
+    }
+    
+    // La traza se escribe al salir de main por cualquier camino
+    TraceSession trace_session(trace_file);
+    
+    // La cache es opcional: se activa con --cache-size o --cache-dir
+    if (!cache_dir.empty() && cache_mb <= 0.0) {
+        cache_mb = 256.0;
+    }
+    size_t cache_bytes = cache_mb > 0.0 ? static_cast<size_t>(cache_mb * 1024.0 * 1024.0) : 0;
+    daemon_options.cache_bytes = cache_bytes;
+    daemon_options.cache_dir = cache_dir;
+    
+    if (!daemon_options.socket_path.empty()) {
+        if (!positional.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (engines_selected) {
+            LOG_ERROR("cli.error") << "Error: --engine solo se admite al alinear un archivo (no en el demonio)";
+            return 1;
+        }
+        daemon_options.pool_threads = num_threads;
+        AlignmentDaemon daemon(daemon_options);
+        return daemon.run();
+    }
+    
+    if (!positional.empty() && positional[0] == "distances") {
+        if (!second_alignment.empty() && positional.size() >= 2) {
+            return runDistanceMerge(second_alignment,
+                                    std::vector<std::string>(positional.begin() + 1, positional.end()));
+        }
+        if (shard_spec.empty() || positional.size() != 3) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!validateInputFile(positional[1]) || !validateOutputPath(positional[2])) {
+            return 1;
+        }
+        return runDistanceShard(positional[1], positional[2], shard_spec, num_threads, preset);
+    }
+    
+    if (positional.size() != 2) {
         printUsage(argv[0]);
         return 1;
     }
     
-    std::string input_file = argv[1];
-    std::string output_file = argv[2];
+    if (!EngineRegistry::instance().contains(EngineStage::OUTPUT, output_format)) {
+        LOG_ERROR("cli.error") << "Error: Formato de salida desconocido: " << output_format;
+        return 1;
+    }
+    
+    // El lote conserva sus alineadores por defecto y solo escribe formatos integrados
+    if (batch_mode && (engines_selected ||
+                       !EngineRegistry::instance().isBuiltin(EngineStage::OUTPUT, output_format))) {
+        LOG_ERROR("cli.error") << "Error: --engine solo se admite al alinear un archivo (no en modo lote)";
+        return 1;
+    }
+    
+    if (batch_mode) {
+        BatchOptions options;
+        options.input = positional[0];
+        options.output_dir = positional[1];
+        options.output_format = output_format;
+        options.num_threads = num_threads;
+        options.big_family_cells = big_family_cells;
+        options.cache_bytes = cache_bytes;
+        options.cache_dir = cache_dir;
+        return runBatchMode(options);
+    }
+    
+    std::string input_file = positional[0];
+    std::string output_file = positional[1];
     
     if (!validateInputFile(input_file)) {
         return 1;
@@ -99,54 +643,110 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (!existing_alignment.empty()) {
+        if (!validateInputFile(existing_alignment)) {
+            return 1;
+        }
+        return runAddMode(existing_alignment, input_file, output_file, output_format, num_threads, preset);
+    }
+    
+    if (!second_alignment.empty()) {
+        if (!validateInputFile(second_alignment)) {
+            return 1;
+        }
+        return runMergeMode(input_file, second_alignment, output_file, output_format, num_threads, preset);
+    }
+    
     try {
         auto start_time = std::chrono::high_resolution_clock::now();
         
-        std::cout << "\nLeyendo archivo de entrada: " << input_file << std::endl;
+        LOG_INFO("cli") << "\nLeyendo archivo de entrada: " << input_file;
         auto sequences = FastaIO::readFasta(input_file);
         
         if (sequences.empty()) {
-            std::cerr << "Error: No se pudieron leer secuencias del archivo." << std::endl;
+            LOG_ERROR("cli.error") << "Error: No se pudieron leer secuencias del archivo.";
             return 1;
         }
         
         if (sequences.size() < 2) {
-            std::cerr << "Error: Se necesitan al menos 2 secuencias para el alineamiento." << std::endl;
+            LOG_ERROR("cli.error") << "Error: Se necesitan al menos 2 secuencias para el alineamiento.";
             return 1;
         }
         
         FastaIO::printSequenceStats(sequences, "Secuencias de entrada");
         
         MSAAligner aligner;
-        std::cout << "\nIniciando proceso de alineamiento..." << std::endl;
+        aligner.setPreset(preset);
+        if (engines_selected) {
+            LOG_INFO("cli").field("preset", preset.name()) << "Engines: " << preset.name();
+        }
+        std::unique_ptr<ThreadPool> pool;
+        if (num_threads != 1) {
+            pool = std::make_unique<ThreadPool>(num_threads);
+            aligner.setThreadPool(pool.get());
+        }
+        aligner.setTimeBudget(time_budget);
+        size_t max_memory = max_memory_mb > 0.0 ? static_cast<size_t>(max_memory_mb * 1024.0 * 1024.0) : 0;
+        aligner.setMemoryBudget(max_memory);
+        if (!distance_store.empty()) {
+            // Con limite de memoria el almacen se conserva empaquetado
+            DistanceMatrix distances;
+            if (!DistanceShards::loadMatrix(distance_store, sequences, preset.distance, distances, max_memory > 0)) {
+                return 1;
+            }
+            LOG_INFO("cli") << "Usando almacen de distancias: " << distance_store;
+            aligner.setPrecomputedDistances(std::move(distances));
+        }
+        LOG_INFO("cli") << "\nIniciando proceso de alineamiento...";
         
-        auto aligned_sequences = aligner.alignSequences(sequences);
+        std::unique_ptr<ResultCache> cache;
+        if (cache_bytes > 0 && distance_store.empty()) {
+            ResultCacheOptions cache_options;
+            cache_options.max_bytes = cache_bytes;
+            cache_options.directory = cache_dir;
+            cache = std::make_unique<ResultCache>(cache_options);
+        }
+        bool cache_hit = false;
+        auto aligned_rows = cache ? cache->align(aligner, sequences, &cache_hit)
+                                  : aligner.alignSequencesToRows(sequences);
         
-        if (aligned_sequences.empty()) {
-            std::cerr << "Error: Fallo en el proceso de alineamiento." << std::endl;
+        if (aligned_rows.empty()) {
+            LOG_ERROR("cli.error") << "Error: Fallo en el proceso de alineamiento.";
             return 1;
         }
         
-        aligner.printGuideTree();
-        
-        std::cout << "\nGuardando secuencias alineadas en: " << output_file << std::endl;
-        FastaIO::writeFasta(aligned_sequences, output_file, true);
+        if (cache_hit) {
+            LOG_INFO("cli.cache").field("hit", "true") << "Resultado recuperado de la cache de alineamientos.";
+        } else {
+            aligner.printGuideTree();
+        }
         
-        FastaIO::printSequenceStats(aligned_sequences, "Secuencias alineadas");
+        LOG_INFO("cli") << "\nGuardando secuencias alineadas en: " << output_file;
+        if (output_format == "fasta") {
+            std::vector<Sequence> aligned_sequences;
+            aligned_sequences.reserve(aligned_rows.size());
+            for (const auto& row : aligned_rows) {
+                aligned_sequences.emplace_back(row.header, row.toAlignedString());
+            }
+            FastaIO::writeFasta(aligned_sequences, output_file, true);
+            FastaIO::printSequenceStats(aligned_sequences, "Secuencias alineadas");
+        } else if (!writeRowsWithEngine(aligned_rows, output_file, output_format)) {
+            return 1;
+        }
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
         
         auto stats = aligner.getAlignmentStats();
-        printSummary(duration, stats, static_cast<int>(sequences.size()));
+        printSummary(duration, stats, aligner.getAlignmentTimings(), static_cast<int>(sequences.size()));
         
         return 0;
         
     } catch (const std::exception& e) {
-        std::cerr << "\nError inesperado: " << e.what() << std::endl;
+        LOG_ERROR("cli.error") << "\nError inesperado: " << e.what();
         return 1;
     } catch (...) {
-        std::cerr << "\nError desconocido durante la ejecucion." << std::endl;
+        LOG_ERROR("cli.error") << "\nError desconocido durante la ejecucion.";
         return 1;
     }
 }
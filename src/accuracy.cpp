@@ -0,0 +1,203 @@
+#include "accuracy.h"
+#include "logger.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+bool isGap(char c) {
+    return c == '-' || c == '.';
+}
+
+bool sameResidue(char a, char b) {
+    return std::toupper(static_cast<unsigned char>(a)) == std::toupper(static_cast<unsigned char>(b));
+}
+
+/**
+ * Fila de la referencia que corresponde a cada fila del alineamiento: por
+ * encabezado si todos son únicos y aparecen en ambos, por orden si no
+ */
+std::vector<size_t> matchRows(const std::vector<Sequence>& alignment, const std::vector<Sequence>& reference) {
+    std::vector<size_t> rows(alignment.size());
+    std::unordered_map<std::string, size_t> by_header;
+    for (size_t r = 0; r < reference.size(); ++r) {
+        if (!by_header.emplace(reference[r].header, r).second) {
+            by_header.clear();
+            break;
+        }
+    }
+    std::vector<bool> used(reference.size(), false);
+    bool by_name = !by_header.empty();
+    for (size_t t = 0; by_name && t < alignment.size(); ++t) {
+        auto it = by_header.find(alignment[t].header);
+        if (it == by_header.end() || used[it->second]) {
+            by_name = false;
+            break;
+        }
+        used[it->second] = true;
+        rows[t] = it->second;
+    }
+    if (!by_name) {
+        for (size_t t = 0; t < alignment.size(); ++t) {
+            rows[t] = t;
+        }
+    }
+    return rows;
+}
+
+struct BlockCounts {
+    uint64_t reference_pairs = 0;
+    uint64_t correct_pairs = 0;
+    uint64_t reference_columns = 0;
+    uint64_t correct_columns = 0;
+};
+
+} // namespace
+
+AccuracyScore AlignmentAccuracy::score(const std::vector<Sequence>& alignment, const std::vector<Sequence>& reference,
+                                       ThreadPool* pool) {
+    AccuracyScore result;
+    if (alignment.empty() || alignment.size() != reference.size()) {
+        LOG_ERROR("accuracy.error") << "Error: El alineamiento tiene " << alignment.size()
+                                    << " secuencias y la referencia " << reference.size();
+        return result;
+    }
+
+    const size_t rows = reference.size();
+    const size_t reference_width = reference[0].sequence.size();
+    for (const auto& row : reference) {
+        if (row.sequence.size() != reference_width) {
+            LOG_ERROR("accuracy.error") << "Error: Las filas de la referencia no tienen la misma longitud ("
+                                        << row.header << ")";
+            return result;
+        }
+    }
+
+    // Columna del alineamiento de cada residuo, indexada por fila de la referencia
+    std::vector<size_t> reference_row = matchRows(alignment, reference);
+    std::vector<std::vector<uint32_t>> target_column(rows);
+    size_t alignment_width = 0;
+    for (const auto& row : alignment) {
+        alignment_width = std::max(alignment_width, row.sequence.size());
+    }
+    if (alignment_width >= std::numeric_limits<uint32_t>::max()) {
+        LOG_ERROR("accuracy.error") << "Error: Alineamiento demasiado ancho para evaluar";
+        return result;
+    }
+    std::vector<uint32_t> column_residues(alignment_width, 0);
+    for (size_t t = 0; t < rows; ++t) {
+        const std::string& aligned = alignment[t].sequence;
+        const std::string& expected = reference[reference_row[t]].sequence;
+        std::vector<uint32_t>& columns = target_column[reference_row[t]];
+        size_t k = 0;
+        for (size_t c = 0; c < aligned.size(); ++c) {
+            if (isGap(aligned[c])) {
+                continue;
+            }
+            while (k < expected.size() && isGap(expected[k])) {
+                ++k;
+            }
+            if (k == expected.size() || !sameResidue(aligned[c], expected[k])) {
+                LOG_ERROR("accuracy.error") << "Error: Los residuos de " << alignment[t].header
+                                            << " no coinciden con la referencia";
+                return result;
+            }
+            ++k;
+            columns.push_back(static_cast<uint32_t>(c));
+            ++column_residues[c];
+        }
+        while (k < expected.size() && isGap(expected[k])) {
+            ++k;
+        }
+        if (k != expected.size()) {
+            LOG_ERROR("accuracy.error") << "Error: A " << alignment[t].header
+                                        << " le faltan residuos de la referencia";
+            return result;
+        }
+    }
+
+    // Bloques de columnas de la referencia; cada uno arranca con el índice de
+    // residuo que tiene cada fila en su primera columna
+    size_t blocks = 1;
+    if (pool && pool->size() > 1) {
+        blocks = std::max<size_t>(1, std::min(reference_width, pool->size() * 4));
+    }
+    const size_t block_width = (reference_width + blocks - 1) / std::max<size_t>(1, blocks);
+    std::vector<std::vector<uint32_t>> block_start(blocks, std::vector<uint32_t>(rows, 0));
+    for (size_t r = 0; r < rows; ++r) {
+        const std::string& row = reference[r].sequence;
+        uint32_t residues = 0;
+        for (size_t c = 0; c < reference_width; ++c) {
+            if (c % block_width == 0) {
+                block_start[c / block_width][r] = residues;
+            }
+            if (!isGap(row[c])) {
+                ++residues;
+            }
+        }
+    }
+
+    std::vector<BlockCounts> counts(blocks);
+    auto scoreBlock = [&](size_t block) {
+        const size_t first = block * block_width;
+        const size_t last = std::min(reference_width, first + block_width);
+        std::vector<uint32_t> cursor = block_start[block];
+        // Tabla por columna destino: sello (columna de referencia + 1) y residuos del grupo
+        std::vector<uint32_t> stamp(alignment_width, 0);
+        std::vector<uint32_t> group(alignment_width, 0);
+        std::vector<uint32_t> targets;
+        BlockCounts& local = counts[block];
+        for (size_t c = first; c < last; ++c) {
+            const uint32_t mark = static_cast<uint32_t>(c + 1);
+            targets.clear();
+            uint64_t residues = 0;
+            for (size_t r = 0; r < rows; ++r) {
+                if (isGap(reference[r].sequence[c])) {
+                    continue;
+                }
+                uint32_t target = target_column[r][cursor[r]++];
+                if (stamp[target] != mark) {
+                    stamp[target] = mark;
+                    group[target] = 0;
+                    targets.push_back(target);
+                }
+                ++group[target];
+                ++residues;
+            }
+            if (residues < 2) {
+                continue;
+            }
+            local.reference_pairs += residues * (residues - 1) / 2;
+            for (uint32_t target : targets) {
+                uint64_t k = group[target];
+                local.correct_pairs += k * (k - 1) / 2;
+            }
+            ++local.reference_columns;
+            if (targets.size() == 1 && column_residues[targets[0]] == residues) {
+                ++local.correct_columns;
+            }
+        }
+    };
+    if (blocks > 1) {
+        pool->parallelFor(0, blocks, scoreBlock);
+    } else if (reference_width > 0) {
+        scoreBlock(0);
+    }
+
+    for (const auto& block : counts) {
+        result.reference_pairs += block.reference_pairs;
+        result.correct_pairs += block.correct_pairs;
+        result.reference_columns += block.reference_columns;
+        result.correct_columns += block.correct_columns;
+    }
+    result.valid = true;
+    result.sp = result.reference_pairs > 0
+        ? static_cast<double>(result.correct_pairs) / result.reference_pairs : 0.0;
+    result.tc = result.reference_columns > 0
+        ? static_cast<double>(result.correct_columns) / result.reference_columns : 0.0;
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef ACCURACY_H
+#define ACCURACY_H
+
+#include "io.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Precisión de un alineamiento frente a una referencia
+ */
+struct AccuracyScore {
+    bool valid;                    // false si los alineamientos no son comparables
+    double sp;                     // Suma de pares: pares alineados de la referencia que se reproducen
+    double tc;                     // Columna total: columnas de la referencia reproducidas completas
+    uint64_t reference_pairs;      // Pares de residuos alineados en la referencia
+    uint64_t correct_pairs;        // De esos, los que quedan en la misma columna del alineamiento
+    uint64_t reference_columns;    // Columnas de la referencia con al menos dos residuos
+    uint64_t correct_columns;
+
+    AccuracyScore() : valid(false), sp(0.0), tc(0.0), reference_pairs(0), correct_pairs(0),
+                      reference_columns(0), correct_columns(0) {}
+};
+
+/**
+ * Puntuaciones SP (sum-of-pairs) y TC (total column) en O(N·L).
+ *
+ * Las filas se emparejan por encabezado (o por orden si los encabezados no
+ * identifican las filas) y deben tener los mismos residuos. Cada residuo se
+ * identifica por (fila, índice de residuo) y se traduce a su columna en el
+ * alineamiento evaluado; en cada columna de la referencia, los residuos que
+ * comparten columna destino forman un grupo de k residuos que aporta
+ * k(k-1)/2 pares correctos. La columna es correcta para TC si hay un solo
+ * grupo y la columna destino no tiene otros residuos. El conteo por columna
+ * destino usa una tabla indexada por columna con sello de la columna actual,
+ * así que cada columna cuesta O(N) sin limpiar la tabla. Las columnas de la
+ * referencia se reparten en bloques entre los hilos del pool.
+ */
+class AlignmentAccuracy {
+public:
+    /**
+     * Compara un alineamiento con la referencia
+     * @param alignment Alineamiento evaluado
+     * @param reference Alineamiento de referencia
+     * @param pool Pool de hilos (nullptr = un solo hilo)
+     * @return Puntuaciones (valid == false si las filas no coinciden)
+     */
+    static AccuracyScore score(const std::vector<Sequence>& alignment, const std::vector<Sequence>& reference,
+                               ThreadPool* pool = nullptr);
+};
+
+#endif // ACCURACY_H
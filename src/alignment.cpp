@@ -1,85 +1,819 @@
 ﻿#include "alignment.h"
+#include "thread_pool.h"
+#include "logger.h"
+#include "cancellation.h"
+#include "distance_shards.h"
+#include "memory_accounting.h"
+#include "trace.h"
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <stdexcept>
 
 // Definición de constantes estáticas
 const std::string MSAAligner::DNA_ALPHABET = "ATCG";
 const std::string MSAAligner::PROTEIN_ALPHABET = "ARNDCQEGHILKMFPSTWYV";
 const int MSAAligner::ALPHABET_SIZE = 4; // Usaremos DNA por simplicidad
 
+namespace {
+    // Fracción del presupuesto a partir de la cual cada etapa cambia de estrategia
+    const double KMER_DISTANCE_THRESHOLD = 0.25;
+    const double BANDED_DP_THRESHOLD = 0.6;
+    const double NO_REFINEMENT_THRESHOLD = 0.8;
+    
+    const size_t MIN_DP_BAND = 32;
+    const int BAND_OUTSIDE = INT_MIN / 4;
+    
+    // Con límite de memoria, los perfiles en espera se vuelcan a disco cuando
+    // superarían esta fracción; el resto queda para la DP y la unión
+    const double PROFILE_SPILL_FRACTION = 0.5;
+    
+    // Subproblemas de Hirschberg que se resuelven directamente con camino empaquetado
+    const size_t HIRSCHBERG_BASE_CELLS = size_t(1) << 20;
+    
+    // Workspace DP por hilo: crece hasta la mayor DP, las celdas interiores las sobrescribe fillDPMatrix
+    thread_local std::vector<std::vector<int>> dp_workspace;
+    
+    // Tamaño máximo del workspace que un hilo conserva al terminar una DP; uno mayor
+    // se libera para que los hilos del pool y del demonio no retengan su mayor matriz
+    const size_t DP_WORKSPACE_RETAIN_BYTES = size_t(64) << 20;
+    
+    void addElapsed(std::atomic<uint64_t>& nanoseconds, std::chrono::steady_clock::time_point since) {
+        auto elapsed = std::chrono::steady_clock::now() - since;
+        nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                              std::memory_order_relaxed);
+    }
+    
+    // Suma a un contador los nanosegundos que dura el ámbito
+    class StageTimer {
+    public:
+        explicit StageTimer(std::atomic<uint64_t>& nanoseconds)
+            : nanoseconds(nanoseconds), start(std::chrono::steady_clock::now()) {}
+        
+        ~StageTimer() {
+            addElapsed(nanoseconds, start);
+        }
+        
+    private:
+        std::atomic<uint64_t>& nanoseconds;
+        std::chrono::steady_clock::time_point start;
+    };
+    
+    double elapsedMs(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+    
+    double nanosecondsToMs(const std::atomic<uint64_t>& nanoseconds) {
+        return nanoseconds.load(std::memory_order_relaxed) / 1e6;
+    }
+    
+    size_t sequenceBytes(const std::vector<Sequence>& sequences) {
+        size_t bytes = 0;
+        for (const auto& seq : sequences) {
+            bytes += sizeof(Sequence) + seq.header.capacity() + seq.sequence.capacity();
+        }
+        return bytes;
+    }
+    
+    // Matriz completa; cuenta lo que ya retiene el workspace del hilo
+    size_t fullDPBytes(size_t m, size_t n) {
+        size_t rows = std::max(dp_workspace.size(), m + 1);
+        size_t columns = std::max(dp_workspace.empty() ? 0 : dp_workspace[0].size(), n + 1);
+        return rows * (sizeof(std::vector<int>) + columns * sizeof(int));
+    }
+    
+    // Libera el workspace del hilo si supera lo que se conserva entre DPs
+    void trimDPWorkspace() {
+        if (!dp_workspace.empty() &&
+            dp_workspace.size() * (sizeof(std::vector<int>) + dp_workspace[0].capacity() * sizeof(int)) >
+            DP_WORKSPACE_RETAIN_BYTES) {
+            std::vector<std::vector<int>>().swap(dp_workspace);
+        }
+    }
+    
+    // 2 bits de camino por celda, dos filas de puntajes y el camino
+    size_t packedDPBytes(size_t m, size_t n) {
+        return (m + 1) * ((n + 4) / 4) + 2 * (n + 1) * sizeof(int) + (m + n);
+    }
+    
+    // Dos filas por nivel de la recursión, el camino y el caso base empaquetado
+    size_t hirschbergBytes(size_t m, size_t n) {
+        return 4 * (n + 1) * sizeof(int) + (m + n) + HIRSCHBERG_BASE_CELLS / 4;
+    }
+    
+    // Nombre legible de un engine de árbol para los mensajes
+    std::string treeEngineLabel(const std::string& engine) {
+        return engine == "upgma" ? "UPGMA" : engine == "nj" ? "neighbor joining" : engine;
+    }
+}
+
+std::string describeDegradations(unsigned degradations) {
+    std::string names;
+    auto add = [&names](const char* name) {
+        if (!names.empty()) names += ",";
+        names += name;
+    };
+    
+    if (degradations & DEGRADE_KMER_DISTANCES) add("kmer_distances");
+    if (degradations & DEGRADE_BANDED_DP) add("banded_dp");
+    if (degradations & DEGRADE_NO_REFINEMENT) add("no_refinement");
+    return names.empty() ? "none" : names;
+}
+
+std::string describeMemoryStrategies(unsigned strategies) {
+    std::string names;
+    auto add = [&names](const char* name) {
+        if (!names.empty()) names += ",";
+        names += name;
+    };
+    
+    if (strategies & MEMORY_PACKED_TRACEBACK) add("packed_traceback");
+    if (strategies & MEMORY_HIRSCHBERG) add("hirschberg");
+    if (strategies & MEMORY_PACKED_DISTANCES) add("packed_distances");
+    if (strategies & MEMORY_SPILLED_PROFILES) add("spilled_profiles");
+    return names.empty() ? "full" : names;
+}
+
+std::string AlignerPreset::name() const {
+    return distance + "/" + tree + "/" + pairwise + "/" + merge + "/" + (refinement ? "refine" : "norefine");
+}
+
+bool AlignerPreset::select(const std::string& spec) {
+    size_t equals = spec.find('=');
+    EngineStage stage;
+    if (equals == std::string::npos || !parseEngineStage(spec.substr(0, equals), stage) ||
+        stage == EngineStage::OUTPUT) {
+        LOG_ERROR("align.error") << "Error: Engine invalido '" << spec
+                                 << "' (se espera distance|tree|pairwise|merge=<nombre>)";
+        return false;
+    }
+    std::string engine = spec.substr(equals + 1);
+    if (!EngineRegistry::instance().contains(stage, engine)) {
+        LOG_ERROR("align.error") << "Error: No hay un engine '" << engine << "' para la etapa "
+                                 << engineStageName(stage);
+        return false;
+    }
+    switch (stage) {
+        case EngineStage::DISTANCE: distance = engine; break;
+        case EngineStage::TREE: tree = engine; break;
+        case EngineStage::PAIRWISE: pairwise = engine; break;
+        default: merge = engine; break;
+    }
+    return true;
+}
+
+std::vector<AlignerPreset> AlignerPreset::all() {
+    const EngineRegistry& registry = EngineRegistry::instance();
+    std::vector<AlignerPreset> presets;
+    for (const auto& distance : registry.list(EngineStage::DISTANCE)) {
+        for (const auto& tree : registry.list(EngineStage::TREE)) {
+            for (const auto& pairwise : registry.list(EngineStage::PAIRWISE)) {
+                for (const auto& merge : registry.list(EngineStage::MERGE)) {
+                    for (bool refinement : {true, false}) {
+                        AlignerPreset preset;
+                        preset.distance = distance.name;
+                        preset.tree = tree.name;
+                        preset.pairwise = pairwise.name;
+                        preset.merge = merge.name;
+                        preset.refinement = refinement;
+                        presets.push_back(preset);
+                    }
+                }
+            }
+        }
+    }
+    return presets;
+}
+
 MSAAligner::MSAAligner() 
     : match_score(2), mismatch_score(-1), gap_penalty(-2), gap_extension_penalty(-1),
-      total_gaps(0), final_length(0), guide_tree(nullptr) {
+      arena_enabled(true), total_gaps(0), final_length(0), guide_tree(nullptr),
+      thread_pool(nullptr), verbose(true), merges_done(0), merges_total(0),
+      time_budget_seconds(0.0), cancel_token(nullptr), degradations(DEGRADE_NONE),
+      banded_dp(false), last_cancelled(false), max_memory(0), memory_in_use(0),
+      memory_strategies(MEMORY_FULL), hirschberg_base_cells(HIRSCHBERG_BASE_CELLS) {
+}
+
+void MSAAligner::setThreadPool(ThreadPool* pool) {
+    thread_pool = pool;
+}
+
+void MSAAligner::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+void MSAAligner::setProgressCallback(ProgressCallback callback) {
+    progress_callback = std::move(callback);
+}
+
+void MSAAligner::reportProgress(const char* stage, double fraction) {
+    if (progress_callback) {
+        progress_callback(stage, fraction);
+    }
+}
+
+void MSAAligner::setTimeBudget(double seconds) {
+    time_budget_seconds = seconds > 0.0 ? seconds : 0.0;
+}
+
+void MSAAligner::setCancellationToken(const CancellationToken* token) {
+    cancel_token = token;
+}
+
+unsigned MSAAligner::getDegradations() const {
+    return degradations;
+}
+
+bool MSAAligner::wasCancelled() const {
+    return last_cancelled;
+}
+
+void MSAAligner::setMemoryBudget(size_t bytes) {
+    max_memory = bytes;
+}
+
+unsigned MSAAligner::getMemoryStrategies() const {
+    return memory_strategies.load();
+}
+
+double MSAAligner::budgetUsed() const {
+    if (time_budget_seconds <= 0.0) {
+        return 0.0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - run_start;
+    return elapsed.count() / time_budget_seconds;
+}
+
+bool MSAAligner::isCancelled() const {
+    return cancel_token && cancel_token->cancelled();
 }
 
 std::vector<Sequence> MSAAligner::alignSequences(const std::vector<Sequence>& sequences) {
     if (sequences.size() < 2) {
-        std::cerr << "Error: Se necesitan al menos 2 secuencias para el alineamiento." << std::endl;
+        LOG_ERROR("align") << "Error: Se necesitan al menos 2 secuencias para el alineamiento.";
         return sequences;
     }
 
-    std::cout << "\nIniciando alineamiento multiple de secuencias..." << std::endl;
-    std::cout << "Numero de secuencias: " << sequences.size() << std::endl;
+    auto rows = alignSequencesToRows(sequences);
+
+    MemoryPhaseScope memory_phase(MemoryPhase::OUTPUT);
+    std::vector<Sequence> aligned_sequences;
+    aligned_sequences.reserve(rows.size());
+    for (const auto& row : rows) {
+        aligned_sequences.emplace_back(row.header, row.toAlignedString());
+    }
+
+    return aligned_sequences;
+}
+
+std::vector<AlignedRow> MSAAligner::alignSequencesToRows(const std::vector<Sequence>& sequences) {
+    if (sequences.size() < 2) {
+        LOG_ERROR("align") << "Error: Se necesitan al menos 2 secuencias para el alineamiento.";
+        return {};
+    }
+
+    if (verbose) {
+        LOG_INFO("align.start") << "\nIniciando alineamiento multiple de secuencias...";
+        LOG_INFO("align.start").field("sequences", sequences.size())
+                                << "Numero de secuencias: " << sequences.size();
+    }
 
     // Reiniciar estadisticas
     total_gaps = 0;
     final_length = 0;
+    merges_done = 0;
+    merges_total = static_cast<int>(sequences.size()) - 1;
+    run_start = std::chrono::steady_clock::now();
+    degradations = DEGRADE_NONE;
+    banded_dp = engines.banded;
+    last_cancelled = false;
+    memory_strategies = MEMORY_FULL;
+    memory_in_use = sequenceBytes(sequences);
+    beginArena();
+    resetTimings();
+
+    if (!checkMemoryBudget(sequences)) {
+        return {};
+    }
 
     // Paso 1: Calcular matriz de distancias
-    std::cout << "Calculando matriz de distancias..." << std::endl;
-    auto distance_matrix = calculateDistanceMatrix(sequences);
+    MemoryPhaseScope memory_phase(MemoryPhase::DISTANCES);
+    TraceSpan align_span("align", "stage");
+    align_span.arg("sequences", static_cast<double>(sequences.size()));
+    TraceSpan stage_span("distances", "stage");
+    auto stage_start = std::chrono::steady_clock::now();
+    if (verbose) {
+        LOG_INFO("align.stage").field("stage", "distances") << "Calculando matriz de distancias...";
+    }
+    reportProgress("distances", 0.0);
+    bool packed_distances = max_memory > 0 &&
+        memory_in_use + DistanceMatrix::bytesFor(sequences.size(), false) > max_memory;
+    DistanceMatrix distance_matrix;
+    if (precomputed_distances.size() == sequences.size()) {
+        distance_matrix = std::move(precomputed_distances);
+    } else {
+        distance_matrix = calculateDistanceMatrix(sequences, packed_distances);
+    }
+    precomputed_distances.clear();
+    if (distance_matrix.packed()) {
+        memory_strategies |= MEMORY_PACKED_DISTANCES;
+    }
 
     // Paso 2: Construir arbol guia
-    std::cout << "Construyendo arbol guia con UPGMA..." << std::endl;
+    if (verbose) {
+        LOG_INFO("align.stage").field("stage", "tree").field("engine", preset.tree)
+            << "Construyendo arbol guia con " << treeEngineLabel(preset.tree) << "...";
+    }
+    reportProgress("tree", 0.2);
+    memory_phase.set(MemoryPhase::TREE);
+    stage_span.next("tree");
+    timings.distances_ms = elapsedMs(stage_start);
+    stage_start = std::chrono::steady_clock::now();
     guide_tree = buildGuideTree(sequences, distance_matrix);
+    distance_matrix.clear();
+    timings.tree_ms = elapsedMs(stage_start);
+    stage_start = std::chrono::steady_clock::now();
 
-    // Paso 3: Alineamiento progresivo
-    std::cout << "Realizando alineamiento progresivo..." << std::endl;
-    Profile final_profile = progressiveAlignment(sequences, guide_tree);
+    // Paso 3: Alineamiento progresivo. Con presupuesto (o sin refinamiento) se propagan
+    // tambien las filas por el arbol, para poder omitir el paso 4
+    if (verbose) {
+        LOG_INFO("align.stage").field("stage", "progressive") << "Realizando alineamiento progresivo...";
+    }
+    reportProgress("progressive", 0.3);
+    memory_phase.set(MemoryPhase::PROGRESSIVE);
+    stage_span.next("progressive");
+    bool track_rows = time_budget_seconds > 0.0 || !preset.refinement;
+    std::vector<Sequence> tree_rows;
+    Profile final_profile = progressiveAlignment(sequences, guide_tree, track_rows ? &tree_rows : nullptr);
+    timings.progressive_ms = elapsedMs(stage_start);
+    stage_start = std::chrono::steady_clock::now();
 
-    // Paso 4: Convertir perfil a secuencias
-    std::cout << "Generando secuencias alineadas..." << std::endl;
-    std::vector<int> sequence_order;
-    for (int i = 0; i < static_cast<int>(sequences.size()); ++i) {
-        sequence_order.push_back(i);
+    // Paso 4: Alinear cada secuencia contra el consenso final
+    if (verbose) {
+        LOG_INFO("align.stage").field("stage", "rows") << "Generando secuencias alineadas...";
+    }
+    reportProgress("rows", 0.8);
+    stage_span.next("rows");
+    memory_in_use += profileBytes(final_profile.length) + sequenceBytes(sequences);
+    std::vector<AlignedRow> rows;
+    if (!isCancelled() && track_rows && (!preset.refinement || budgetUsed() > NO_REFINEMENT_THRESHOLD)) {
+        // Sin refinamiento o sin tiempo para realinear: se usan las filas propagadas
+        // (orden de guide_tree->sequences)
+        if (preset.refinement) {
+            degradations |= DEGRADE_NO_REFINEMENT;
+        }
+        rows.resize(sequences.size());
+        for (size_t k = 0; k < tree_rows.size(); ++k) {
+            rows[guide_tree->sequences[k]] = AlignedRow::fromAlignedSequence(tree_rows[k]);
+        }
+    } else if (!isCancelled()) {
+        if (!banded_dp && budgetUsed() > BANDED_DP_THRESHOLD) {
+            banded_dp = true;
+            degradations |= DEGRADE_BANDED_DP;
+        }
+        rows = profileToRows(final_profile, sequences);
     }
+    // La banda por presupuesto es de esta ejecución; la del preset sigue para --add/--merge
+    banded_dp = engines.banded;
+    stage_span.end();
+    align_span.end();
+    timings.rows_ms = elapsedMs(stage_start);
+    timings.total_ms = elapsedMs(run_start);
 
-    auto aligned_sequences = profileToSequences(final_profile, sequences, sequence_order);
+    if (isCancelled()) {
+        last_cancelled = true;
+        LOG_WARN("align.cancelled") << "Advertencia: Alineamiento cancelado.";
+        return {};
+    }
 
-    // Actualizar estadisticas
-    if (!aligned_sequences.empty()) {
-        final_length = aligned_sequences[0].sequence.length();
+    if (degradations != DEGRADE_NONE) {
+        LOG_WARN("align.degraded").field("degradations", describeDegradations(degradations))
+                                  .field("budget_used", budgetUsed())
+            << "Advertencia: Presupuesto de tiempo agotado; degradaciones aplicadas: "
+            << describeDegradations(degradations);
+    }
 
-        // Contar gaps totales
-        for (const auto& seq : aligned_sequences) {
+    if (memory_strategies != MEMORY_FULL && verbose) {
+        LOG_INFO("align.memory").field("strategies", describeMemoryStrategies(memory_strategies))
+                                .field("max_memory", max_memory)
+            << "Limite de memoria: estrategias aplicadas: " << describeMemoryStrategies(memory_strategies);
+    }
+
+    updateStatsFromRows(rows);
+
+    AlignmentTimings stage_timings = getAlignmentTimings();
+    LOG_DEBUG("align.timing").field("distances_ms", stage_timings.distances_ms)
+                             .field("tree_ms", stage_timings.tree_ms)
+                             .field("progressive_ms", stage_timings.progressive_ms)
+                             .field("rows_ms", stage_timings.rows_ms)
+                             .field("dp_cells", stage_timings.dp_cells)
+                             .field("gcups", stage_timings.gcups());
+
+    if (verbose) {
+        LOG_INFO("align.done") << "Alineamiento completado!";
+        LOG_INFO("align.done").field("final_length", final_length) << "Longitud final: " << final_length;
+        LOG_INFO("align.done").field("total_gaps", total_gaps) << "Gaps totales insertados: " << total_gaps;
+    }
+    reportProgress("done", 1.0);
+
+    return rows;
+}
+
+std::vector<Sequence> MSAAligner::addToAlignment(const std::vector<Sequence>& alignment,
+                                                const std::vector<Sequence>& new_sequences) {
+    if (alignment.empty()) {
+        LOG_ERROR("align") << "Error: El alineamiento existente esta vacio.";
+        return {};
+    }
+
+    if (!hasUniformLength(alignment)) {
+        LOG_ERROR("align") << "Error: Las filas del alineamiento existente no tienen la misma longitud.";
+        return {};
+    }
+
+    if (verbose) {
+        LOG_INFO("align.add") << "\nAgregando " << new_sequences.size() << " secuencias a un alineamiento de "
+                              << alignment.size() << " filas...";
+    }
+
+    total_gaps = 0;
+    final_length = 0;
+    memory_strategies = MEMORY_FULL;
+    memory_in_use = 2 * sequenceBytes(alignment) + 2 * sequenceBytes(new_sequences);
+    beginArena();
+    resetTimings();
+    auto start = std::chrono::steady_clock::now();
+
+    // Paso 1: Perfil del alineamiento existente (una sola vez)
+    Profile profile = buildProfileFromAlignment(alignment);
+
+    // Paso 2: Cada secuencia nueva contra el consenso; las columnas del perfil
+    // son las columnas del alineamiento existente
+    auto rows_start = std::chrono::steady_clock::now();
+    auto new_rows = profileToRows(profile, new_sequences);
+    timings.rows_ms = elapsedMs(rows_start);
+
+    // Paso 3: Unificar inserciones; las filas existentes solo reciben gaps
+    std::vector<AlignedRow> rows;
+    rows.reserve(alignment.size() + new_rows.size());
+    for (const auto& aligned : alignment) {
+        rows.push_back(AlignedRow::fromAlignedSequence(aligned));
+    }
+    for (auto& row : new_rows) {
+        rows.push_back(std::move(row));
+    }
+
+    auto merged = FastaIO::expandRows(rows);
+
+    if (!merged.empty()) {
+        final_length = static_cast<int>(merged[0].sequence.length());
+        for (const auto& seq : merged) {
             total_gaps += std::count(seq.sequence.begin(), seq.sequence.end(), '-');
         }
     }
 
-    std::cout << "Alineamiento completado!" << std::endl;
-    std::cout << "Longitud final: " << final_length << std::endl;
-    std::cout << "Gaps totales insertados: " << total_gaps << std::endl;
+    timings.total_ms = elapsedMs(start);
 
-    return aligned_sequences;
+    if (verbose) {
+        LOG_INFO("align.add") << "Alineamiento ampliado: " << merged.size() << " filas, longitud "
+                              << final_length;
+    }
+
+    return merged;
+}
+
+std::vector<Sequence> MSAAligner::mergeAlignments(const std::vector<Sequence>& alignment1,
+                                                 const std::vector<Sequence>& alignment2) {
+    if (alignment1.empty() || alignment2.empty()) {
+        LOG_ERROR("align") << "Error: Se necesitan dos alineamientos no vacios para unirlos.";
+        return {};
+    }
+
+    if (!hasUniformLength(alignment1) || !hasUniformLength(alignment2)) {
+        LOG_ERROR("align") << "Error: Las filas de cada alineamiento deben tener la misma longitud.";
+        return {};
+    }
+
+    if (verbose) {
+        LOG_INFO("align.merge") << "\nUniendo alineamientos de " << alignment1.size() << " y "
+                                << alignment2.size() << " filas...";
+    }
+
+    total_gaps = 0;
+    final_length = 0;
+    memory_strategies = MEMORY_FULL;
+    memory_in_use = 2 * sequenceBytes(alignment1) + 2 * sequenceBytes(alignment2);
+    beginArena();
+    resetTimings();
+    auto start = std::chrono::steady_clock::now();
+
+    // Un solo alineamiento perfil-perfil en lugar de realinear todas las secuencias
+    Profile profile1 = buildProfileFromAlignment(alignment1);
+    Profile profile2 = buildProfileFromAlignment(alignment2);
+    auto merge_start = std::chrono::steady_clock::now();
+    auto aligned_pair = alignProfileConsensus(profile1, profile2);
+    timings.progressive_ms = elapsedMs(merge_start);
+
+    auto merged = propagateGaps(alignment1, alignment2, aligned_pair);
+
+    final_length = static_cast<int>(aligned_pair.first.length());
+    for (const auto& seq : merged) {
+        total_gaps += std::count(seq.sequence.begin(), seq.sequence.end(), '-');
+    }
+
+    timings.total_ms = elapsedMs(start);
+
+    if (verbose) {
+        LOG_INFO("align.merge") << "Alineamiento unido: " << merged.size() << " filas, longitud "
+                                << final_length;
+    }
+
+    return merged;
 }
 
-std::vector<std::vector<double>> MSAAligner::calculateDistanceMatrix(const std::vector<Sequence>& sequences) {
+DistanceMatrix MSAAligner::calculateDistanceMatrix(const std::vector<Sequence>& sequences, bool packed) {
     size_t n = sequences.size();
-    std::vector<std::vector<double>> matrix(n, std::vector<double>(n, 0.0));
+    DistanceMatrix matrix;
+    matrix.reset(n, packed);
     
-    for (size_t i = 0; i < n; ++i) {
+    // Con presupuesto, las filas que empiezan tras consumir su parte pasan a k-meros
+    bool kmer_preset = engines.kmer_distances;
+    size_t k = 0;
+    std::vector<std::vector<unsigned short>> kmer_counts;
+    if (time_budget_seconds > 0.0 || kmer_preset) {
+        kmer_counts = countKmers(sequences, k);
+    }
+    std::atomic<bool> use_kmers(kmer_preset);
+    
+    auto computeRow = [&](size_t i) {
+        if (isCancelled()) {
+            return;
+        }
+        if (!kmer_counts.empty() && !use_kmers.load(std::memory_order_relaxed) &&
+            budgetUsed() > KMER_DISTANCE_THRESHOLD) {
+            use_kmers = true;
+        }
+        bool kmers = use_kmers.load(std::memory_order_relaxed);
+        stage_counters.distance_pairs.fetch_add(n - i - 1, std::memory_order_relaxed);
+        
         for (size_t j = i + 1; j < n; ++j) {
-            double distance = calculateSequenceDistance(sequences[i].sequence, sequences[j].sequence);
-            matrix[i][j] = matrix[j][i] = distance;
+            double distance = kmers
+                ? calculateKmerDistance(kmer_counts[i], sequences[i].sequence.length(),
+                                        kmer_counts[j], sequences[j].sequence.length(), k)
+                : pairDistance(sequences[i].sequence, sequences[j].sequence);
+            matrix.set(i, j, distance);
         }
+    };
+    
+    if (thread_pool) {
+        thread_pool->parallelFor(0, n, computeRow);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            computeRow(i);
+        }
+    }
+    
+    if (use_kmers && !kmer_preset) {
+        degradations |= DEGRADE_KMER_DISTANCES;
     }
     
     return matrix;
 }
 
+std::vector<double> MSAAligner::calculateDistanceBlock(const std::vector<Sequence>& sequences,
+                                                      uint64_t pair_begin, uint64_t pair_end) {
+    uint64_t n = sequences.size();
+    std::vector<double> values(static_cast<size_t>(pair_end - pair_begin), 0.0);
+    if (pair_begin >= pair_end) {
+        return values;
+    }
+    
+    // Filas que intersectan el bloque; cada una escribe su tramo de columnas
+    uint64_t first_row = DistanceShards::rowOfPair(n, pair_begin);
+    uint64_t last_row = DistanceShards::rowOfPair(n, pair_end - 1);
+    
+    // Los k-meros se cuentan sobre todas las secuencias: el alfabeto depende del dataset
+    size_t k = 0;
+    std::vector<std::vector<unsigned short>> kmer_counts;
+    if (engines.kmer_distances) {
+        kmer_counts = countKmers(sequences, k);
+    }
+    
+    auto computeRow = [&](size_t offset) {
+        uint64_t i = first_row + offset;
+        uint64_t row_begin = DistanceShards::rowOffset(n, i);
+        uint64_t from = std::max(pair_begin, row_begin);
+        uint64_t to = std::min(pair_end, row_begin + (n - i - 1));
+        stage_counters.distance_pairs.fetch_add(to > from ? to - from : 0, std::memory_order_relaxed);
+        for (uint64_t pair = from; pair < to; ++pair) {
+            uint64_t j = i + 1 + (pair - row_begin);
+            values[static_cast<size_t>(pair - pair_begin)] = kmer_counts.empty()
+                ? pairDistance(sequences[i].sequence, sequences[j].sequence)
+                : calculateKmerDistance(kmer_counts[i], sequences[i].sequence.length(),
+                                        kmer_counts[j], sequences[j].sequence.length(), k);
+        }
+    };
+    
+    size_t rows = static_cast<size_t>(last_row - first_row + 1);
+    if (thread_pool) {
+        thread_pool->parallelFor(0, rows, computeRow);
+    } else {
+        for (size_t r = 0; r < rows; ++r) {
+            computeRow(r);
+        }
+    }
+    
+    return values;
+}
+
+void MSAAligner::setPrecomputedDistances(DistanceMatrix matrix) {
+    precomputed_distances = std::move(matrix);
+}
+
+void MSAAligner::setArenaEnabled(bool enabled) {
+    arena_enabled = enabled;
+}
+
+bool MSAAligner::setPreset(const AlignerPreset& preset) {
+    const EngineRegistry& registry = EngineRegistry::instance();
+    const std::pair<EngineStage, const std::string*> stages[] = {
+        {EngineStage::DISTANCE, &preset.distance}, {EngineStage::TREE, &preset.tree},
+        {EngineStage::PAIRWISE, &preset.pairwise}, {EngineStage::MERGE, &preset.merge}};
+    for (const auto& stage : stages) {
+        if (!registry.contains(stage.first, *stage.second)) {
+            LOG_ERROR("align.error") << "Error: No hay un engine '" << *stage.second << "' para la etapa "
+                                     << engineStageName(stage.first);
+            return false;
+        }
+    }
+    
+    ResolvedEngines resolved;
+    resolved.kmer_distances = preset.distance == "kmer";
+    resolved.nj_tree = preset.tree == "nj";
+    resolved.banded = preset.pairwise == "banded";
+    resolved.dp_strategy = preset.pairwise == "linear" ? DPStrategy::HIRSCHBERG :
+                           preset.pairwise == "packed" ? DPStrategy::PACKED_TRACEBACK : DPStrategy::FULL;
+    resolved.distance = registry.distance(preset.distance);
+    resolved.tree = registry.tree(preset.tree);
+    resolved.pairwise = registry.pairwise(preset.pairwise);
+    resolved.merge = registry.merge(preset.merge);
+    engines = std::move(resolved);
+    // Fuera de alignSequencesToRows (--add, --merge) la banda depende solo del preset
+    banded_dp = engines.banded;
+    this->preset = preset;
+    return true;
+}
+
+const AlignerPreset& MSAAligner::getPreset() const {
+    return preset;
+}
+
+void MSAAligner::releaseMemory() {
+    guide_tree.reset();
+    arena.reset();
+    std::vector<std::vector<int>>().swap(dp_workspace);
+}
+
+AllocationStats MSAAligner::getAllocationStats() const {
+    return arena ? arena->stats() : AllocationStats();
+}
+
+AlignmentTimings MSAAligner::getAlignmentTimings() const {
+    AlignmentTimings result = timings;
+    result.dp_fill_ms = nanosecondsToMs(stage_counters.dp_fill_ns);
+    result.traceback_ms = nanosecondsToMs(stage_counters.traceback_ns);
+    result.consensus_ms = nanosecondsToMs(stage_counters.consensus_ns);
+    result.profile_merge_ms = nanosecondsToMs(stage_counters.merge_ns);
+    result.distance_pairs = stage_counters.distance_pairs.load(std::memory_order_relaxed);
+    result.dp_alignments = stage_counters.dp_alignments.load(std::memory_order_relaxed);
+    result.dp_cells = stage_counters.dp_cells.load(std::memory_order_relaxed);
+    return result;
+}
+
+void MSAAligner::resetTimings() {
+    timings = AlignmentTimings();
+    for (std::atomic<uint64_t>* counter : {&stage_counters.dp_fill_ns, &stage_counters.traceback_ns,
+                                           &stage_counters.consensus_ns, &stage_counters.merge_ns,
+                                           &stage_counters.distance_pairs, &stage_counters.dp_alignments,
+                                           &stage_counters.dp_cells}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+void MSAAligner::beginArena() {
+    guide_tree.reset();
+    arena.reset();
+    arena = std::make_unique<AlignmentArena>(arena_enabled);
+}
+
+std::pmr::memory_resource* MSAAligner::memoryResource() {
+    return arena ? arena->resource() : std::pmr::get_default_resource();
+}
+
+void MSAAligner::adoptResult(const std::vector<AlignedRow>& rows) {
+    guide_tree = nullptr;
+    degradations = DEGRADE_NONE;
+    last_cancelled = false;
+    resetTimings();
+    updateStatsFromRows(rows);
+}
+
+void MSAAligner::updateStatsFromRows(const std::vector<AlignedRow>& rows) {
+    // Estadisticas directamente desde los guiones de edicion
+    total_gaps = 0;
+    final_length = 0;
+    for (size_t r = 0; r < rows.size(); ++r) {
+        int row_length = 0;
+        for (const auto& edit : rows[r].script) {
+            row_length += edit.length;
+            if (edit.op == 'D') {
+                total_gaps += edit.length;
+            }
+        }
+        if (r == 0) {
+            final_length = row_length;
+        }
+    }
+}
+
+std::string MSAAligner::parameterSignature() const {
+    return "progressive-upgma/1 match=" + std::to_string(match_score) +
+           " mismatch=" + std::to_string(mismatch_score) +
+           " gap=" + std::to_string(gap_penalty) +
+           " gap_ext=" + std::to_string(gap_extension_penalty) +
+           // El preset por defecto conserva la firma anterior (y las entradas de caché)
+           (preset.name() == AlignerPreset().name() ? "" : " preset=" + preset.name());
+}
+
+std::vector<std::vector<unsigned short>> MSAAligner::countKmers(const std::vector<Sequence>& sequences,
+                                                                 size_t& k) const {
+    // ADN si todos los residuos son nucleótidos; en otro caso alfabeto de proteínas
+    bool is_dna = true;
+    for (const auto& seq : sequences) {
+        for (char c : seq.sequence) {
+            char upper = static_cast<char>(std::toupper(c));
+            if (upper != 'A' && upper != 'C' && upper != 'G' && upper != 'T' && upper != 'U' && upper != 'N') {
+                is_dna = false;
+                break;
+            }
+        }
+        if (!is_dna) break;
+    }
+    
+    const std::string& alphabet = is_dna ? DNA_ALPHABET : PROTEIN_ALPHABET;
+    k = is_dna ? 4 : 2;
+    size_t bins = 1;
+    for (size_t i = 0; i < k; ++i) {
+        bins *= alphabet.size();
+    }
+    
+    std::vector<std::vector<unsigned short>> counts(sequences.size(), std::vector<unsigned short>(bins, 0));
+    for (size_t s = 0; s < sequences.size(); ++s) {
+        size_t code = 0;
+        size_t valid = 0;   // Residuos válidos consecutivos en la ventana
+        for (char c : sequences[s].sequence) {
+            char upper = static_cast<char>(std::toupper(c));
+            size_t index = alphabet.find(upper == 'U' ? 'T' : upper);
+            if (index == std::string::npos) {
+                valid = 0;
+                code = 0;
+                continue;
+            }
+            code = (code * alphabet.size() + index) % bins;
+            if (++valid >= k && counts[s][code] < USHRT_MAX) {
+                counts[s][code]++;
+            }
+        }
+    }
+    
+    return counts;
+}
+
+double MSAAligner::calculateKmerDistance(const std::vector<unsigned short>& counts1, size_t length1,
+                                         const std::vector<unsigned short>& counts2, size_t length2,
+                                         size_t k) const {
+    size_t min_length = std::min(length1, length2);
+    if (min_length < k) {
+        return 1.0;
+    }
+    
+    // Fracción de k-meros compartidos respecto a la secuencia más corta
+    size_t shared = 0;
+    for (size_t b = 0; b < counts1.size(); ++b) {
+        shared += std::min(counts1[b], counts2[b]);
+    }
+    
+    double similarity = static_cast<double>(shared) / (min_length - k + 1);
+    return 1.0 - std::min(1.0, similarity);
+}
+
+double MSAAligner::pairDistance(const std::string& seq1, const std::string& seq2) {
+    return engines.distance ? engines.distance(seq1, seq2) : calculateSequenceDistance(seq1, seq2);
+}
+
 double MSAAligner::calculateSequenceDistance(const std::string& seq1, const std::string& seq2) {
     if (seq1.empty() || seq2.empty()) {
         return 1.0; // Máxima distancia
@@ -106,19 +840,182 @@ double MSAAligner::calculateSequenceDistance(const std::string& seq1, const std:
 }
 
 std::shared_ptr<TreeNode> MSAAligner::buildGuideTree(const std::vector<Sequence>& sequences,
-                                                     const std::vector<std::vector<double>>& distance_matrix) {
+                                                     const DistanceMatrix& distance_matrix) {
+    guide_tree_engine = preset.tree;
+    if (engines.tree) {
+        auto root = buildTreeFromMerges(sequences, engines.tree(distance_matrix));
+        if (root) {
+            return root;
+        }
+        guide_tree_engine = "upgma";
+        LOG_ERROR("align.error").field("engine", preset.tree)
+            << "Error: El engine de arbol " << preset.tree << " no devolvio un arbol valido; se usa UPGMA";
+        return buildUpgmaTree(sequences, distance_matrix);
+    }
+    if (engines.nj_tree) {
+        // Neighbor joining trabaja sobre una copia empaquetada de las distancias,
+        // que conviven con la matriz original durante la construcción
+        size_t working_bytes = DistanceMatrix::bytesFor(sequences.size(), true);
+        size_t distance_bytes = DistanceMatrix::bytesFor(distance_matrix.size(), distance_matrix.packed());
+        if (max_memory == 0 || memory_in_use + distance_bytes + working_bytes <= max_memory) {
+            return buildNeighborJoiningTree(sequences, distance_matrix);
+        }
+        LOG_WARN("align.memory").field("needed", working_bytes)
+            << "Advertencia: Las distancias de trabajo de neighbor joining no caben en el limite de memoria; "
+            << "se usa UPGMA";
+        guide_tree_engine = "upgma";
+    }
+    return buildUpgmaTree(sequences, distance_matrix);
+}
+
+std::shared_ptr<TreeNode> MSAAligner::buildTreeFromMerges(const std::vector<Sequence>& sequences,
+                                                          const std::vector<TreeMerge>& merges) {
+    size_t n = sequences.size();
+    if (n == 0 || merges.size() != n - 1) {
+        return nullptr;
+    }
+    std::pmr::polymorphic_allocator<TreeNode> node_allocator(memoryResource());
+    std::vector<std::shared_ptr<TreeNode>> clusters(2 * n - 1);
+    for (size_t i = 0; i < n; ++i) {
+        clusters[i] = std::allocate_shared<TreeNode>(node_allocator, static_cast<int>(i));
+        clusters[i]->sequences.push_back(static_cast<int>(i));
+        memory_in_use += sizeof(TreeNode) + clusters[i]->sequences.capacity() * sizeof(int);
+    }
+    
+    // Cada cluster existente se une una sola vez: lo consumido queda en nullptr
+    for (size_t k = 0; k < merges.size(); ++k) {
+        const TreeMerge& merge = merges[k];
+        if (merge.left >= n + k || merge.right >= n + k || merge.left == merge.right ||
+            !clusters[merge.left] || !clusters[merge.right]) {
+            return nullptr;
+        }
+        auto node = std::allocate_shared<TreeNode>(node_allocator);
+        node->distance = merge.height;
+        node->left = std::move(clusters[merge.left]);
+        node->right = std::move(clusters[merge.right]);
+        node->sequences = node->left->sequences;
+        node->sequences.insert(node->sequences.end(), node->right->sequences.begin(),
+                               node->right->sequences.end());
+        memory_in_use += sizeof(TreeNode) + node->sequences.capacity() * sizeof(int);
+        clusters[n + k] = std::move(node);
+    }
+    return clusters.back();
+}
+
+std::shared_ptr<TreeNode> MSAAligner::buildNeighborJoiningTree(const std::vector<Sequence>& sequences,
+                                                               const DistanceMatrix& distance_matrix) {
+    size_t n = sequences.size();
+    std::pmr::polymorphic_allocator<TreeNode> node_allocator(memoryResource());
+    std::vector<std::shared_ptr<TreeNode>> nodes(n);
+    for (size_t i = 0; i < n; ++i) {
+        nodes[i] = std::allocate_shared<TreeNode>(node_allocator, static_cast<int>(i));
+        nodes[i]->sequences.push_back(static_cast<int>(i));
+        memory_in_use += sizeof(TreeNode) + nodes[i]->sequences.capacity() * sizeof(int);
+    }
+    if (n < 2) {
+        return n == 0 ? nullptr : nodes.front();
+    }
+    
+    // Distancias de trabajo entre nodos activos (solo el triángulo superior): el
+    // nodo unido ocupa el lugar del primero
+    size_t working_bytes = DistanceMatrix::bytesFor(n, true);
+    memory_in_use += working_bytes;
+    DistanceMatrix d;
+    d.reset(n, true);
+    std::vector<double> row_sum(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            double dist = distance_matrix.get(i, j);
+            d.set(i, j, dist);
+            row_sum[i] += dist;
+            row_sum[j] += dist;
+        }
+    }
+    std::vector<size_t> active(n);
+    for (size_t i = 0; i < n; ++i) {
+        active[i] = i;
+    }
+    
+    auto join = [&](size_t a, size_t b, double dist) {
+        auto node = std::allocate_shared<TreeNode>(node_allocator);
+        node->distance = dist / 2.0;
+        node->left = nodes[a];
+        node->right = nodes[b];
+        node->sequences = nodes[a]->sequences;
+        node->sequences.insert(node->sequences.end(), nodes[b]->sequences.begin(), nodes[b]->sequences.end());
+        memory_in_use += sizeof(TreeNode) + node->sequences.capacity() * sizeof(int);
+        return node;
+    };
+    
+    while (active.size() > 2) {
+        if (isCancelled()) {
+            memory_in_use -= working_bytes;
+            return nullptr;
+        }
+        
+        // Par que minimiza Q(i, j) = (m - 2) d(i, j) - r(i) - r(j)
+        double m = static_cast<double>(active.size());
+        size_t best_a = 0, best_b = 1;
+        double best_q = std::numeric_limits<double>::max();
+        for (size_t a = 0; a < active.size(); ++a) {
+            size_t i = active[a];
+            for (size_t b = a + 1; b < active.size(); ++b) {
+                size_t j = active[b];
+                double q = (m - 2.0) * d.get(i, j) - row_sum[i] - row_sum[j];
+                if (q < best_q) {
+                    best_q = q;
+                    best_a = a;
+                    best_b = b;
+                }
+            }
+        }
+        
+        size_t i = active[best_a];
+        size_t j = active[best_b];
+        double dij = d.get(i, j);
+        nodes[i] = join(i, j, dij);
+        nodes[j].reset();
+        active.erase(active.begin() + best_b);
+        
+        // d(u, k) = (d(i, k) + d(j, k) - d(i, j)) / 2, con u en el lugar de i
+        row_sum[i] = 0.0;
+        for (size_t k : active) {
+            if (k == i) {
+                continue;
+            }
+            double dik = d.get(i, k);
+            double djk = d.get(j, k);
+            double duk = (dik + djk - dij) / 2.0;
+            row_sum[k] += duk - dik - djk;
+            row_sum[i] += duk;
+            d.set(i, k, duk);
+        }
+    }
+    
+    memory_in_use -= working_bytes;
+    return join(active[0], active[1], d.get(active[0], active[1]));
+}
+
+std::shared_ptr<TreeNode> MSAAligner::buildUpgmaTree(const std::vector<Sequence>& sequences,
+                                                     const DistanceMatrix& distance_matrix) {
     size_t n = sequences.size();
     
-    // Crear nodos hoja
+    // Crear nodos hoja (en la arena del alineamiento)
+    std::pmr::polymorphic_allocator<TreeNode> node_allocator(memoryResource());
     std::vector<std::shared_ptr<TreeNode>> nodes;
     for (size_t i = 0; i < n; ++i) {
-        auto node = std::make_shared<TreeNode>(static_cast<int>(i));
+        auto node = std::allocate_shared<TreeNode>(node_allocator, static_cast<int>(i));
         node->sequences.push_back(static_cast<int>(i));
+        memory_in_use += sizeof(TreeNode) + node->sequences.capacity() * sizeof(int);
         nodes.push_back(node);
     }
 
     // Algoritmo UPGMA
     while (nodes.size() > 1) {
+        if (isCancelled()) {
+            return nullptr;
+        }
+
         size_t min_i = 0, min_j = 1;
         double min_distance = std::numeric_limits<double>::max();
 
@@ -128,7 +1025,7 @@ std::shared_ptr<TreeNode> MSAAligner::buildGuideTree(const std::vector<Sequence>
                 double dist = 0.0;
                 for (int si : nodes[i]->sequences) {
                     for (int sj : nodes[j]->sequences) {
-                        dist += distance_matrix[si][sj];
+                        dist += distance_matrix.get(si, sj);
                     }
                 }
                 dist /= (nodes[i]->sequences.size() * nodes[j]->sequences.size());
@@ -142,7 +1039,7 @@ std::shared_ptr<TreeNode> MSAAligner::buildGuideTree(const std::vector<Sequence>
         }
 
         // Crear nuevo nodo interno
-        auto new_node = std::make_shared<TreeNode>();
+        auto new_node = std::allocate_shared<TreeNode>(node_allocator);
         new_node->distance = min_distance / 2.0;
         new_node->left = nodes[min_i];
         new_node->right = nodes[min_j];
@@ -152,6 +1049,7 @@ std::shared_ptr<TreeNode> MSAAligner::buildGuideTree(const std::vector<Sequence>
         new_node->sequences.insert(new_node->sequences.end(),
                                    nodes[min_j]->sequences.begin(),
                                    nodes[min_j]->sequences.end());
+        memory_in_use += sizeof(TreeNode) + new_node->sequences.capacity() * sizeof(int);
 
         // Reemplazar el nodo min_i con el nuevo nodo y eliminar min_j
         if (min_i < min_j) {
@@ -170,21 +1068,88 @@ std::shared_ptr<TreeNode> MSAAligner::buildGuideTree(const std::vector<Sequence>
 
 Profile MSAAligner::progressiveAlignment(const std::vector<Sequence>& sequences,
                                        const std::shared_ptr<TreeNode>& node) {
-    if (!node) {
+    return progressiveAlignment(sequences, node, nullptr);
+}
+
+Profile MSAAligner::progressiveAlignment(const std::vector<Sequence>& sequences,
+                                       const std::shared_ptr<TreeNode>& node,
+                                       std::vector<Sequence>* rows) {
+    if (!node || isCancelled()) {
         return Profile();
     }
     
     // Nodo hoja - crear perfil de una sola secuencia
     if (!node->sequences.empty() && !node->left && !node->right) {
         int seq_idx = node->sequences[0];
+        if (rows) {
+            rows->assign(1, sequences[seq_idx]);
+        }
         return createProfile(sequences[seq_idx].sequence);
     }
     
     // Nodo interno - alinear subperfiles
     if (node->left && node->right) {
-        Profile left_profile = progressiveAlignment(sequences, node->left);
-        Profile right_profile = progressiveAlignment(sequences, node->right);
-        return alignProfiles(left_profile, right_profile);
+        std::vector<Sequence> left_rows, right_rows;
+        Profile left_profile = progressiveAlignment(sequences, node->left, rows ? &left_rows : nullptr);
+        
+        // El perfil izquierdo espera mientras se alinea el subárbol derecho; con
+        // límite de memoria se vuelca a disco si los perfiles retenidos crecen demasiado
+        size_t left_bytes = profileBytes(left_profile.length);
+        std::FILE* spilled = nullptr;
+        if (max_memory > 0 && memory_in_use + left_bytes > max_memory * PROFILE_SPILL_FRACTION) {
+            spilled = spillProfile(left_profile);
+        }
+        if (!spilled) {
+            memory_in_use += left_bytes;
+        }
+        
+        Profile right_profile = progressiveAlignment(sequences, node->right, rows ? &right_rows : nullptr);
+        
+        if (spilled) {
+            left_profile = restoreProfile(spilled);
+        } else {
+            memory_in_use -= left_bytes;
+        }
+        if (isCancelled()) {
+            return Profile();
+        }
+        
+        if (!banded_dp && budgetUsed() > BANDED_DP_THRESHOLD) {
+            banded_dp = true;
+            degradations |= DEGRADE_BANDED_DP;
+        }
+        
+        size_t merge_bytes = left_bytes + profileBytes(right_profile.length);
+        memory_in_use += merge_bytes;
+        // Nodo = número de la unión en postorden; las celdas son las de esta unión (las uniones son secuenciales)
+        TraceSpan merge_span("merge", "merge");
+        uint64_t cells_before = stage_counters.dp_cells.load(std::memory_order_relaxed);
+        auto aligned_pair = alignProfileConsensus(left_profile, right_profile);
+        Profile merged = combineProfiles(left_profile, right_profile, aligned_pair);
+        if (rows) {
+            *rows = propagateGaps(left_rows, right_rows, aligned_pair);
+        }
+        memory_in_use -= merge_bytes;
+        merge_span.arg("node", merges_done)
+                  .arg("left_length", left_profile.length)
+                  .arg("right_length", right_profile.length)
+                  .arg("merged_length", merged.length)
+                  .arg("sequences", merged.num_sequences)
+                  .arg("dp_cells", static_cast<double>(stage_counters.dp_cells.load(std::memory_order_relaxed) -
+                                                       cells_before));
+        merge_span.end();
+        
+        LOG_TRACE("align.merge_node")
+            .field("left_length", left_profile.length)
+            .field("right_length", right_profile.length)
+            .field("merged_length", merged.length)
+            .field("sequences", merged.num_sequences);
+        
+        merges_done++;
+        if (merges_total > 0) {
+            reportProgress("progressive", 0.3 + 0.5 * merges_done / merges_total);
+        }
+        return merged;
     }
     
     return Profile();
@@ -195,16 +1160,367 @@ std::pair<std::string, std::string> MSAAligner::pairwiseAlignment(const std::str
     size_t m = seq1.length();
     size_t n = seq2.length();
     
-    std::vector<std::vector<int>> dp = initializeDPMatrix(m, n);
-    fillDPMatrix(dp, seq1, seq2, m, n);
+    if (engines.pairwise) {
+        return pathToAlignment(externalPath(seq1, seq2), seq1, seq2);
+    }
+    DPStrategy strategy = selectDPStrategy(m, n, 1);
+    if (strategy != DPStrategy::FULL) {
+        return pathToAlignment(lowMemoryPath(seq1, seq2, strategy), seq1, seq2);
+    }
+    
+    std::vector<std::vector<int>>& dp = computeDPMatrix(seq1, seq2);
+    auto aligned = reconstructAlignment(dp, seq1, seq2, m, n);
+    trimDPWorkspace();
+    return aligned;
+}
+
+MSAAligner::DPStrategy MSAAligner::selectDPStrategy(size_t m, size_t n, size_t concurrent) {
+    // El engine pairwise fija la estrategia mínima; el límite de memoria solo la endurece
+    if (engines.dp_strategy == DPStrategy::HIRSCHBERG || max_memory == 0) {
+        return engines.dp_strategy;
+    }
+    
+    size_t available = max_memory > memory_in_use
+        ? (max_memory - memory_in_use) / std::max<size_t>(concurrent, 1) : 0;
+    if (engines.dp_strategy == DPStrategy::FULL && fullDPBytes(m, n) <= available) {
+        return DPStrategy::FULL;
+    }
+    
+    // La matriz completa no cabe: se libera lo que retenga el workspace de este hilo
+    std::vector<std::vector<int>>().swap(dp_workspace);
+    if (packedDPBytes(m, n) <= available) {
+        if (engines.dp_strategy == DPStrategy::FULL) {
+            memory_strategies |= MEMORY_PACKED_TRACEBACK;
+        }
+        return DPStrategy::PACKED_TRACEBACK;
+    }
+    memory_strategies |= MEMORY_HIRSCHBERG;
+    return DPStrategy::HIRSCHBERG;
+}
+
+ScoringScheme MSAAligner::scoringScheme() const {
+    return {match_score, mismatch_score, gap_penalty};
+}
+
+std::vector<AlignmentStep> MSAAligner::externalPath(const std::string& seq1, const std::string& seq2) {
+    std::vector<AlignmentStep> path;
+    {
+        StageTimer fill_timer(stage_counters.dp_fill_ns);
+        stage_counters.dp_alignments.fetch_add(1, std::memory_order_relaxed);
+        stage_counters.dp_cells.fetch_add(seq1.length() * seq2.length(), std::memory_order_relaxed);
+        path = engines.pairwise(seq1, seq2, scoringScheme());
+    }
+    
+    size_t consumed1 = 0;
+    size_t consumed2 = 0;
+    for (AlignmentStep step : path) {
+        consumed1 += step != AlignmentStep::INSERT;
+        consumed2 += step != AlignmentStep::DELETE;
+    }
+    if (consumed1 == seq1.length() && consumed2 == seq2.length()) {
+        return path;
+    }
+    LOG_ERROR("align.error").field("engine", preset.pairwise)
+        << "Error: El engine pairwise " << preset.pairwise << " devolvio un camino invalido ("
+        << consumed1 << "/" << seq1.length() << ", " << consumed2 << "/" << seq2.length()
+        << "); se usa la traza empaquetada";
+    return packedTracebackPath(seq1, seq2);
+}
+
+std::vector<AlignmentStep> MSAAligner::lowMemoryPath(const std::string& seq1, const std::string& seq2,
+                                                     DPStrategy strategy) {
+    stage_counters.dp_alignments.fetch_add(1, std::memory_order_relaxed);
+    if (strategy == DPStrategy::PACKED_TRACEBACK) {
+        return packedTracebackPath(seq1, seq2);
+    }
+    
+    std::vector<AlignmentStep> path;
+    path.reserve(seq1.length() + seq2.length());
+    hirschbergPath(seq1, 0, seq1.length(), seq2, 0, seq2.length(), path);
+    return path;
+}
+
+std::vector<AlignmentStep> MSAAligner::packedTracebackPath(const std::string& seq1, const std::string& seq2) {
+    size_t m = seq1.length();
+    size_t n = seq2.length();
+    size_t row_bytes = (n + 4) / 4;     // n + 1 celdas de 2 bits
+    
+    std::vector<unsigned char> trace((m + 1) * row_bytes, 0);
+    auto setStep = [&](size_t i, size_t j, AlignmentStep step) {
+        trace[i * row_bytes + j / 4] |= static_cast<unsigned char>(static_cast<unsigned>(step) << (2 * (j % 4)));
+    };
+    
+    std::vector<int> previous(n + 1), current(n + 1);
+    for (size_t j = 0; j <= n; ++j) {
+        previous[j] = static_cast<int>(j) * gap_penalty;
+        if (j > 0) {
+            setStep(0, j, AlignmentStep::INSERT);
+        }
+    }
+    
+    auto fill_start = std::chrono::steady_clock::now();
+    stage_counters.dp_cells.fetch_add(static_cast<uint64_t>(m) * n, std::memory_order_relaxed);
+    for (size_t i = 1; i <= m; ++i) {
+        if ((i & 63) == 0 && isCancelled()) {
+            return {};
+        }
+        current[0] = static_cast<int>(i) * gap_penalty;
+        setStep(i, 0, AlignmentStep::DELETE);
+        
+        for (size_t j = 1; j <= n; ++j) {
+            int match = previous[j-1] + calculateMatchScore(seq1[i-1], seq2[j-1]);
+            int delete_op = previous[j] + gap_penalty;
+            int insert_op = current[j-1] + gap_penalty;
+            
+            // Misma preferencia que determineAlignmentStep: coincidencia, eliminación, inserción
+            if (match >= delete_op && match >= insert_op) {
+                current[j] = match;
+            } else if (delete_op >= insert_op) {
+                current[j] = delete_op;
+                setStep(i, j, AlignmentStep::DELETE);
+            } else {
+                current[j] = insert_op;
+                setStep(i, j, AlignmentStep::INSERT);
+            }
+        }
+        previous.swap(current);
+    }
+    addElapsed(stage_counters.dp_fill_ns, fill_start);
+    
+    StageTimer traceback_timer(stage_counters.traceback_ns);
+    std::vector<AlignmentStep> path;
+    path.reserve(m + n);
+    size_t i = m, j = n;
+    while (i > 0 || j > 0) {
+        auto step = static_cast<AlignmentStep>((trace[i * row_bytes + j / 4] >> (2 * (j % 4))) & 3);
+        path.push_back(step);
+        if (step == AlignmentStep::MATCH) {
+            i--; j--;
+        } else if (step == AlignmentStep::DELETE) {
+            i--;
+        } else {
+            j--;
+        }
+    }
+    
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void MSAAligner::lastScoreRow(const std::string& seq1, size_t begin1, size_t end1,
+                              const std::string& seq2, size_t begin2, size_t end2,
+                              bool reversed, std::vector<int>& row) {
+    size_t m = end1 - begin1;
+    size_t n = end2 - begin2;
+    StageTimer fill_timer(stage_counters.dp_fill_ns);
+    stage_counters.dp_cells.fetch_add(static_cast<uint64_t>(m) * n, std::memory_order_relaxed);
+    row.resize(n + 1);
+    for (size_t j = 0; j <= n; ++j) {
+        row[j] = static_cast<int>(j) * gap_penalty;
+    }
+    
+    for (size_t i = 1; i <= m; ++i) {
+        char a = reversed ? seq1[end1 - i] : seq1[begin1 + i - 1];
+        int diagonal = row[0];
+        row[0] = static_cast<int>(i) * gap_penalty;
+        for (size_t j = 1; j <= n; ++j) {
+            char b = reversed ? seq2[end2 - j] : seq2[begin2 + j - 1];
+            int up = row[j];
+            row[j] = std::max({diagonal + calculateMatchScore(a, b), up + gap_penalty, row[j-1] + gap_penalty});
+            diagonal = up;
+        }
+    }
+}
+
+void MSAAligner::hirschbergPath(const std::string& seq1, size_t begin1, size_t end1,
+                                const std::string& seq2, size_t begin2, size_t end2,
+                                std::vector<AlignmentStep>& path) {
+    size_t m = end1 - begin1;
+    size_t n = end2 - begin2;
+    if (m == 0) {
+        path.insert(path.end(), n, AlignmentStep::INSERT);
+        return;
+    }
+    if (n == 0) {
+        path.insert(path.end(), m, AlignmentStep::DELETE);
+        return;
+    }
+    if (m == 1 || (m + 1) * (n + 1) <= hirschberg_base_cells) {
+        auto base = packedTracebackPath(seq1.substr(begin1, m), seq2.substr(begin2, n));
+        path.insert(path.end(), base.begin(), base.end());
+        return;
+    }
+    if (isCancelled()) {
+        return;
+    }
+    
+    // Columna de seq2 donde un camino óptimo cruza la fila central de seq1
+    size_t middle = begin1 + m / 2;
+    size_t split = 0;
+    {
+        std::vector<int> forward, backward;
+        lastScoreRow(seq1, begin1, middle, seq2, begin2, end2, false, forward);
+        lastScoreRow(seq1, middle, end1, seq2, begin2, end2, true, backward);
+        int best = INT_MIN;
+        for (size_t j = 0; j <= n; ++j) {
+            int score = forward[j] + backward[n - j];
+            if (score > best) {
+                best = score;
+                split = j;
+            }
+        }
+    }
+    
+    hirschbergPath(seq1, begin1, middle, seq2, begin2, begin2 + split, path);
+    hirschbergPath(seq1, middle, end1, seq2, begin2 + split, end2, path);
+}
+
+std::pair<std::string, std::string> MSAAligner::pathToAlignment(const std::vector<AlignmentStep>& path,
+                                                                const std::string& seq1,
+                                                                const std::string& seq2) {
+    StageTimer traceback_timer(stage_counters.traceback_ns);
+    std::string aligned_seq1, aligned_seq2;
+    aligned_seq1.reserve(path.size());
+    aligned_seq2.reserve(path.size());
+    size_t i = 0, j = 0;
+    
+    for (AlignmentStep step : path) {
+        switch (step) {
+            case AlignmentStep::MATCH:
+                aligned_seq1 += seq1[i++];
+                aligned_seq2 += seq2[j++];
+                break;
+            case AlignmentStep::DELETE:
+                aligned_seq1 += seq1[i++];
+                aligned_seq2 += '-';
+                break;
+            case AlignmentStep::INSERT:
+                aligned_seq1 += '-';
+                aligned_seq2 += seq2[j++];
+                break;
+        }
+    }
+    
+    return {std::move(aligned_seq1), std::move(aligned_seq2)};
+}
+
+std::vector<EditOp> MSAAligner::pathToEditScript(const std::vector<AlignmentStep>& path) {
+    StageTimer traceback_timer(stage_counters.traceback_ns);
+    std::vector<EditOp> script;
+    for (AlignmentStep step : path) {
+        char op = step == AlignmentStep::MATCH ? 'M' : (step == AlignmentStep::DELETE ? 'I' : 'D');
+        if (!script.empty() && script.back().op == op) {
+            script.back().length++;
+        } else {
+            script.emplace_back(op, 1);
+        }
+    }
+    return script;
+}
+
+size_t MSAAligner::profileBytes(size_t length) {
+    return sizeof(Profile) +
+           length * (sizeof(std::pmr::vector<double>) + (ALPHABET_SIZE + 1) * sizeof(double));
+}
+
+std::FILE* MSAAligner::spillProfile(Profile& profile) {
+    TraceSpan span("spill_profile", "io");
+    span.arg("columns", profile.length);
+    std::FILE* file = std::tmpfile();
+    if (!file) {
+        LOG_WARN("align.memory") << "Advertencia: No se pudo crear un archivo temporal; el perfil queda en memoria.";
+        return nullptr;
+    }
+    
+    size_t length = static_cast<size_t>(profile.length);
+    bool ok = std::fwrite(&profile.length, sizeof(profile.length), 1, file) == 1 &&
+              std::fwrite(&profile.num_sequences, sizeof(profile.num_sequences), 1, file) == 1;
+    for (size_t pos = 0; ok && pos < length; ++pos) {
+        ok = std::fwrite(profile.frequencies[pos].data(), sizeof(double), ALPHABET_SIZE, file) ==
+             static_cast<size_t>(ALPHABET_SIZE);
+    }
+    ok = ok && std::fwrite(profile.gap_frequencies.data(), sizeof(double), length, file) == length;
+    if (!ok) {
+        std::fclose(file);
+        LOG_WARN("align.memory") << "Advertencia: No se pudo volcar un perfil a disco; queda en memoria.";
+        return nullptr;
+    }
+    
+    // Las columnas vuelven a la arena y las reutiliza el subárbol siguiente
+    profile.frequencies.clear();
+    profile.frequencies.shrink_to_fit();
+    profile.gap_frequencies.clear();
+    profile.gap_frequencies.shrink_to_fit();
+    memory_strategies |= MEMORY_SPILLED_PROFILES;
+    return file;
+}
+
+Profile MSAAligner::restoreProfile(std::FILE* file) {
+    TraceSpan span("restore_profile", "io");
+    Profile profile(memoryResource());
+    std::rewind(file);
+    bool ok = std::fread(&profile.length, sizeof(profile.length), 1, file) == 1 &&
+              std::fread(&profile.num_sequences, sizeof(profile.num_sequences), 1, file) == 1 &&
+              profile.length >= 0;
+    
+    size_t length = ok ? static_cast<size_t>(profile.length) : 0;
+    profile.frequencies.resize(length, std::pmr::vector<double>(ALPHABET_SIZE, 0.0));
+    profile.gap_frequencies.resize(length, 0.0);
+    for (size_t pos = 0; ok && pos < length; ++pos) {
+        ok = std::fread(profile.frequencies[pos].data(), sizeof(double), ALPHABET_SIZE, file) ==
+             static_cast<size_t>(ALPHABET_SIZE);
+    }
+    ok = ok && std::fread(profile.gap_frequencies.data(), sizeof(double), length, file) == length;
+    std::fclose(file);
+    
+    if (!ok) {
+        throw std::runtime_error("No se pudo recuperar un perfil volcado a disco");
+    }
+    return profile;
+}
+
+bool MSAAligner::checkMemoryBudget(const std::vector<Sequence>& sequences) {
+    if (max_memory == 0) {
+        return true;
+    }
+    
+    size_t n = sequences.size();
+    size_t max_length = 0;
+    for (const auto& seq : sequences) {
+        max_length = std::max(max_length, seq.sequence.length());
+    }
+    size_t workers = thread_pool ? std::max<size_t>(1, thread_pool->size()) : 1;
+    size_t input = sequenceBytes(sequences);
+    
+    // Mínimo de cada etapa con las estrategias más compactas: distancias
+    // empaquetadas; entrada y filas de salida, árbol, una unión de perfiles y
+    // una DP de Hirschberg por hilo. Neighbor joining no entra en el mínimo: si
+    // su copia de trabajo no cabe, buildGuideTree usa UPGMA
+    size_t distances = input + DistanceMatrix::bytesFor(n, true);
+    size_t alignment = 2 * input + n * (2 * sizeof(TreeNode) + sizeof(int)) +
+                       3 * profileBytes(max_length) + workers * hirschbergBytes(max_length, max_length);
+    size_t needed = std::max(distances, alignment);
+    if (needed <= max_memory) {
+        return true;
+    }
     
-    return reconstructAlignment(dp, seq1, seq2, m, n);
+    LOG_ERROR("align.memory").field("max_memory", max_memory).field("needed", needed)
+        << "Error: El limite de memoria (" << std::fixed << std::setprecision(1)
+        << max_memory / (1024.0 * 1024.0) << " MB) no alcanza ni con las estrategias mas compactas; "
+        << "se necesitan al menos " << needed / (1024.0 * 1024.0) << " MB.";
+    return false;
 }
 
-std::vector<std::vector<int>> MSAAligner::initializeDPMatrix(size_t m, size_t n) {
-    std::vector<std::vector<int>> dp(m + 1, std::vector<int>(n + 1, 0));
+std::vector<std::vector<int>>& MSAAligner::initializeDPMatrix(size_t m, size_t n) {
+    std::vector<std::vector<int>>& dp = dp_workspace;
     
+    if (dp.size() < m + 1) {
+        dp.resize(m + 1);
+    }
     for (size_t i = 0; i <= m; ++i) {
+        if (dp[i].size() < n + 1) {
+            dp[i].resize(n + 1);
+        }
         dp[i][0] = static_cast<int>(i) * gap_penalty;
     }
     for (size_t j = 0; j <= n; ++j) {
@@ -214,10 +1530,33 @@ std::vector<std::vector<int>> MSAAligner::initializeDPMatrix(size_t m, size_t n)
     return dp;
 }
 
+std::vector<std::vector<int>>& MSAAligner::computeDPMatrix(const std::string& seq1, const std::string& seq2) {
+    size_t m = seq1.length();
+    size_t n = seq2.length();
+    std::vector<std::vector<int>>& dp = initializeDPMatrix(m, n);
+    StageTimer fill_timer(stage_counters.dp_fill_ns);
+    stage_counters.dp_alignments.fetch_add(1, std::memory_order_relaxed);
+    
+    // La banda debe cubrir al menos el avance de la diagonal escalada por fila
+    size_t band = std::max({MIN_DP_BAND, std::max(m, n) / 10, n / std::max<size_t>(m, 1) + 1});
+    size_t cells = m * n;
+    if (banded_dp && 2 * band + 1 < n) {
+        cells = fillBandedDPMatrix(dp, seq1, seq2, m, n, band);
+    } else {
+        fillDPMatrix(dp, seq1, seq2, m, n);
+    }
+    stage_counters.dp_cells.fetch_add(cells, std::memory_order_relaxed);
+    
+    return dp;
+}
+
 void MSAAligner::fillDPMatrix(std::vector<std::vector<int>>& dp, 
                              const std::string& seq1, const std::string& seq2,
                              size_t m, size_t n) {
     for (size_t i = 1; i <= m; ++i) {
+        if ((i & 63) == 0 && isCancelled()) {
+            return;
+        }
         for (size_t j = 1; j <= n; ++j) {
             int match_score_val = calculateMatchScore(seq1[i-1], seq2[j-1]);
             int match = dp[i-1][j-1] + match_score_val;
@@ -229,6 +1568,49 @@ void MSAAligner::fillDPMatrix(std::vector<std::vector<int>>& dp,
     }
 }
 
+size_t MSAAligner::fillBandedDPMatrix(std::vector<std::vector<int>>& dp,
+                                      const std::string& seq1, const std::string& seq2,
+                                      size_t m, size_t n, size_t band) {
+    auto bandStart = [&](size_t i) {
+        size_t center = i * n / m;
+        return center > band ? std::max<size_t>(1, center - band) : 1;
+    };
+    auto bandEnd = [&](size_t i) {
+        return std::min(n, i * n / m + band);
+    };
+    
+    size_t cells = 0;
+    for (size_t i = 1; i <= m; ++i) {
+        if ((i & 63) == 0 && isCancelled()) {
+            return cells;
+        }
+        
+        size_t lo = bandStart(i);
+        size_t hi = bandEnd(i);
+        cells += hi >= lo ? hi - lo + 1 : 0;
+        if (lo > 1) {
+            dp[i][lo - 1] = BAND_OUTSIDE;
+        }
+        
+        for (size_t j = lo; j <= hi; ++j) {
+            int match = dp[i-1][j-1] + calculateMatchScore(seq1[i-1], seq2[j-1]);
+            int delete_op = dp[i-1][j] + gap_penalty;
+            int insert_op = dp[i][j-1] + gap_penalty;
+            
+            dp[i][j] = std::max({match, delete_op, insert_op});
+        }
+        
+        // Celdas que la fila siguiente lee por encima de esta banda
+        if (i < m) {
+            size_t next_hi = bandEnd(i + 1);
+            for (size_t j = hi + 1; j <= next_hi; ++j) {
+                dp[i][j] = BAND_OUTSIDE;
+            }
+        }
+    }
+    return cells;
+}
+
 int MSAAligner::calculateMatchScore(char c1, char c2) {
     return (std::toupper(c1) == std::toupper(c2)) ? match_score : mismatch_score;
 }
@@ -238,32 +1620,77 @@ std::pair<std::string, std::string> MSAAligner::reconstructAlignment(
     const std::string& seq1, const std::string& seq2,
     size_t m, size_t n) {
     
+    // Se construye al reves con una sola reserva por cadena y se invierte al final
+    StageTimer traceback_timer(stage_counters.traceback_ns);
     std::string aligned_seq1, aligned_seq2;
+    aligned_seq1.reserve(m + n);
+    aligned_seq2.reserve(m + n);
+    size_t i = m, j = n;
+    
+    while (i > 0 || j > 0) {
+        AlignmentStep step = determineAlignmentStep(dp, seq1, seq2, i, j);
+        
+        switch (step) {
+            case AlignmentStep::MATCH:
+                aligned_seq1 += seq1[i-1];
+                aligned_seq2 += seq2[j-1];
+                i--; j--;
+                break;
+            case AlignmentStep::DELETE:
+                aligned_seq1 += seq1[i-1];
+                aligned_seq2 += '-';
+                i--;
+                break;
+            case AlignmentStep::INSERT:
+                aligned_seq1 += '-';
+                aligned_seq2 += seq2[j-1];
+                j--;
+                break;
+        }
+    }
+    
+    std::reverse(aligned_seq1.begin(), aligned_seq1.end());
+    std::reverse(aligned_seq2.begin(), aligned_seq2.end());
+    return {std::move(aligned_seq1), std::move(aligned_seq2)};
+}
+
+std::vector<EditOp> MSAAligner::reconstructEditScript(
+    const std::vector<std::vector<int>>& dp,
+    const std::string& seq1, const std::string& seq2,
+    size_t m, size_t n) {
+    
+    // Se recorre igual que reconstructAlignment, pero acumulando corridas al reves
+    StageTimer traceback_timer(stage_counters.traceback_ns);
+    std::vector<EditOp> reversed_script;
     size_t i = m, j = n;
     
     while (i > 0 || j > 0) {
         AlignmentStep step = determineAlignmentStep(dp, seq1, seq2, i, j);
+        char op = 'M';
         
         switch (step) {
             case AlignmentStep::MATCH:
-                aligned_seq1 = seq1[i-1] + aligned_seq1;
-                aligned_seq2 = seq2[j-1] + aligned_seq2;
+                op = 'M';
                 i--; j--;
                 break;
             case AlignmentStep::DELETE:
-                aligned_seq1 = seq1[i-1] + aligned_seq1;
-                aligned_seq2 = '-' + aligned_seq2;
+                op = 'I';
                 i--;
                 break;
             case AlignmentStep::INSERT:
-                aligned_seq1 = '-' + aligned_seq1;
-                aligned_seq2 = seq2[j-1] + aligned_seq2;
+                op = 'D';
                 j--;
                 break;
         }
+        
+        if (!reversed_script.empty() && reversed_script.back().op == op) {
+            reversed_script.back().length++;
+        } else {
+            reversed_script.emplace_back(op, 1);
+        }
     }
     
-    return {aligned_seq1, aligned_seq2};
+    return std::vector<EditOp>(reversed_script.rbegin(), reversed_script.rend());
 }
 
 AlignmentStep MSAAligner::determineAlignmentStep(
@@ -303,7 +1730,9 @@ Profile MSAAligner::alignSequenceToProfile(const std::string& sequence, const Pr
 }
 
 std::string MSAAligner::generateConsensusFromProfile(const Profile& profile) {
+    StageTimer consensus_timer(stage_counters.consensus_ns);
     std::string consensus;
+    consensus.reserve(profile.length);
     for (int pos = 0; pos < profile.length; ++pos) {
         consensus += findBestCharacterAtPosition(profile, pos);
     }
@@ -325,10 +1754,10 @@ char MSAAligner::findBestCharacterAtPosition(const Profile& profile, int pos) {
 
 Profile MSAAligner::initializeCombinedProfile(const std::pair<std::string, std::string>& aligned_pair, 
                                             const Profile& profile) {
-    Profile new_profile;
+    Profile new_profile(memoryResource());
     new_profile.length = aligned_pair.first.length();
     new_profile.num_sequences = profile.num_sequences + 1;
-    new_profile.frequencies.resize(new_profile.length, std::vector<double>(ALPHABET_SIZE, 0.0));
+    new_profile.frequencies.resize(new_profile.length, std::pmr::vector<double>(ALPHABET_SIZE, 0.0));
     new_profile.gap_frequencies.resize(new_profile.length, 0.0);
     return new_profile;
 }
@@ -397,42 +1826,17 @@ void MSAAligner::normalizeFrequenciesAtPosition(Profile& new_profile, int pos) {
 }
 
 Profile MSAAligner::alignProfiles(const Profile& profile1, const Profile& profile2) {
-    // Simplificación: convertir perfiles a secuencias consenso y alinear
-    std::string consensus1, consensus2;
-    
-    for (int pos = 0; pos < profile1.length; ++pos) {
-        char best_char = 'A';
-        double best_freq = 0.0;
-        
-        for (int base = 0; base < ALPHABET_SIZE; ++base) {
-            if (profile1.frequencies[pos][base] > best_freq) {
-                best_freq = profile1.frequencies[pos][base];
-                best_char = getAlphabetChar(base);
-            }
-        }
-        consensus1 += best_char;
-    }
-    
-    for (int pos = 0; pos < profile2.length; ++pos) {
-        char best_char = 'A';
-        double best_freq = 0.0;
-        
-        for (int base = 0; base < ALPHABET_SIZE; ++base) {
-            if (profile2.frequencies[pos][base] > best_freq) {
-                best_freq = profile2.frequencies[pos][base];
-                best_char = getAlphabetChar(base);
-            }
-        }
-        consensus2 += best_char;
-    }
-    
-    auto aligned_pair = pairwiseAlignment(consensus1, consensus2);
-    
+    return combineProfiles(profile1, profile2, alignProfileConsensus(profile1, profile2));
+}
+
+Profile MSAAligner::combineProfiles(const Profile& profile1, const Profile& profile2,
+                                    const std::pair<std::string, std::string>& aligned_pair) {
+    StageTimer merge_timer(stage_counters.merge_ns);
     // Crear perfil combinado
-    Profile combined_profile;
+    Profile combined_profile(memoryResource());
     combined_profile.length = aligned_pair.first.length();
     combined_profile.num_sequences = profile1.num_sequences + profile2.num_sequences;
-    combined_profile.frequencies.resize(combined_profile.length, std::vector<double>(ALPHABET_SIZE, 0.0));
+    combined_profile.frequencies.resize(combined_profile.length, std::pmr::vector<double>(ALPHABET_SIZE, 0.0));
     combined_profile.gap_frequencies.resize(combined_profile.length, 0.0);
     
     // Combinar los perfiles basándose en el alineamiento
@@ -473,48 +1877,146 @@ Profile MSAAligner::alignProfiles(const Profile& profile1, const Profile& profil
     return combined_profile;
 }
 
-std::vector<Sequence> MSAAligner::profileToSequences(const Profile& profile,
-                                                   const std::vector<Sequence>& sequences,
-                                                   const std::vector<int>& sequence_order) {
-    (void)sequence_order; // Suprimir advertencia de parámetro no utilizado
-    std::vector<Sequence> aligned_sequences;
+std::pair<std::string, std::string> MSAAligner::alignProfileConsensus(const Profile& profile1,
+                                                                    const Profile& profile2) {
+    // El engine de unión externo devuelve el par de consensos alineados; se valida
+    // que cada lado conserve sus columnas y que ambos tengan la misma longitud
+    if (engines.merge) {
+        auto aligned_pair = engines.merge(profile1, profile2, scoringScheme());
+        auto columns = [](const std::string& aligned) {
+            return static_cast<int>(aligned.length() - std::count(aligned.begin(), aligned.end(), '-'));
+        };
+        if (aligned_pair.first.length() == aligned_pair.second.length() &&
+            columns(aligned_pair.first) == profile1.length && columns(aligned_pair.second) == profile2.length) {
+            return aligned_pair;
+        }
+        LOG_ERROR("align.error").field("engine", preset.merge)
+            << "Error: El engine de union " << preset.merge << " devolvio un alineamiento invalido; "
+            << "se alinean los consensos";
+    }
+    
+    // Simplificación: convertir perfiles a secuencias consenso y alinear
+    std::string consensus1 = generateConsensusFromProfile(profile1);
+    std::string consensus2 = generateConsensusFromProfile(profile2);
     
-    // Simplificación: generar secuencias alineadas basadas en el perfil
-    // En una implementación completa, se mantendría el rastro de cada secuencia individual
+    return pairwiseAlignment(consensus1, consensus2);
+}
+
+std::vector<Sequence> MSAAligner::propagateGaps(const std::vector<Sequence>& rows1,
+                                              const std::vector<Sequence>& rows2,
+                                              const std::pair<std::string, std::string>& aligned_pair) {
+    std::vector<Sequence> merged(rows1.size() + rows2.size());
     
-    for (size_t i = 0; i < sequences.size(); ++i) {
-        Sequence aligned_seq;
-        aligned_seq.header = sequences[i].header;
+    // Cada fila recorre el camino de consensos: toma su siguiente columna cuando
+    // su lado tiene residuo de consenso y un gap cuando el otro lado inserta
+    auto propagateRow = [&](size_t r) {
+        bool first = r < rows1.size();
+        const Sequence& source = first ? rows1[r] : rows2[r - rows1.size()];
+        const std::string& path = first ? aligned_pair.first : aligned_pair.second;
         
-        // Para esta implementación simplificada, alineamos cada secuencia individual al perfil
-        std::string consensus;
-        for (int pos = 0; pos < profile.length; ++pos) {
-            char best_char = 'A';
-            double best_freq = 0.0;
-            
-            for (int base = 0; base < ALPHABET_SIZE; ++base) {
-                if (profile.frequencies[pos][base] > best_freq) {
-                    best_freq = profile.frequencies[pos][base];
-                    best_char = getAlphabetChar(base);
-                }
-            }
-            consensus += best_char;
+        Sequence& target = merged[r];
+        target.header = source.header;
+        target.sequence.reserve(path.length());
+        
+        size_t column = 0;
+        for (char c : path) {
+            target.sequence += (c == '-') ? '-' : source.sequence[column++];
+        }
+    };
+    
+    if (thread_pool) {
+        thread_pool->parallelFor(0, merged.size(), propagateRow);
+    } else {
+        for (size_t r = 0; r < merged.size(); ++r) {
+            propagateRow(r);
+        }
+    }
+    
+    return merged;
+}
+
+bool MSAAligner::hasUniformLength(const std::vector<Sequence>& alignment) const {
+    for (const auto& row : alignment) {
+        if (row.sequence.length() != alignment[0].sequence.length()) {
+            return false;
         }
+    }
+    return true;
+}
+
+std::vector<AlignedRow> MSAAligner::profileToRows(const Profile& profile,
+                                                const std::vector<Sequence>& sequences) {
+    std::vector<AlignedRow> rows(sequences.size());
+    
+    // Simplificación: cada secuencia individual se alinea contra el consenso del perfil.
+    // El consenso es el mismo para todas las filas, por lo que se calcula una sola vez.
+    std::string consensus = generateConsensusFromProfile(profile);
+    size_t workers = thread_pool ? std::max<size_t>(1, thread_pool->size()) : 1;
+    
+    // Las filas son independientes entre sí
+    auto alignRow = [&](size_t r) {
+        const Sequence& seq = sequences[r];
+        AlignedRow& row = rows[r];
+        row.header = seq.header;
+        row.residues = seq.sequence;
         
-        auto aligned_pair = pairwiseAlignment(sequences[i].sequence, consensus);
-        aligned_seq.sequence = aligned_pair.first;
+        if (isCancelled()) {
+            return;
+        }
         
-        aligned_sequences.push_back(aligned_seq);
+        size_t m = seq.sequence.length();
+        size_t n = consensus.length();
+        if (engines.pairwise) {
+            row.script = pathToEditScript(externalPath(seq.sequence, consensus));
+            return;
+        }
+        DPStrategy strategy = selectDPStrategy(m, n, workers);
+        if (strategy != DPStrategy::FULL) {
+            row.script = pathToEditScript(lowMemoryPath(seq.sequence, consensus, strategy));
+            return;
+        }
+        std::vector<std::vector<int>>& dp = computeDPMatrix(seq.sequence, consensus);
+        row.script = reconstructEditScript(dp, seq.sequence, consensus, m, n);
+        trimDPWorkspace();
+    };
+    
+    if (thread_pool) {
+        thread_pool->parallelFor(0, sequences.size(), alignRow);
+    } else {
+        for (size_t r = 0; r < sequences.size(); ++r) {
+            alignRow(r);
+        }
     }
     
-    return aligned_sequences;
+    return rows;
+}
+
+Profile MSAAligner::buildProfileFromAlignment(const std::vector<Sequence>& alignment) {
+    Profile profile(memoryResource());
+    profile.length = alignment.empty() ? 0 : static_cast<int>(alignment[0].sequence.length());
+    profile.num_sequences = static_cast<int>(alignment.size());
+    profile.frequencies.resize(profile.length, std::pmr::vector<double>(ALPHABET_SIZE, 0.0));
+    profile.gap_frequencies.resize(profile.length, 0.0);
+    
+    // Mismo conteo que al combinar una secuencia nueva con un perfil
+    for (const auto& row : alignment) {
+        for (int pos = 0; pos < profile.length; ++pos) {
+            addNewSequenceFrequencies(profile, row.sequence[pos], pos);
+        }
+    }
+    
+    for (int pos = 0; pos < profile.length; ++pos) {
+        normalizeFrequenciesAtPosition(profile, pos);
+    }
+    
+    return profile;
 }
 
 Profile MSAAligner::createProfile(const std::string& sequence) {
-    Profile profile;
+    Profile profile(memoryResource());
     profile.length = sequence.length();
     profile.num_sequences = 1;
-    profile.frequencies.resize(profile.length, std::vector<double>(ALPHABET_SIZE, 0.0));
+    profile.frequencies.resize(profile.length, std::pmr::vector<double>(ALPHABET_SIZE, 0.0));
     profile.gap_frequencies.resize(profile.length, 0.0);
     
     for (int pos = 0; pos < profile.length; ++pos) {
@@ -536,18 +2038,21 @@ std::map<std::string, int> MSAAligner::getAlignmentStats() const {
     std::map<std::string, int> stats;
     stats["total_gaps"] = total_gaps;
     stats["final_length"] = final_length;
+    stats["degradations"] = static_cast<int>(degradations);
+    stats["memory_strategies"] = static_cast<int>(memory_strategies.load());
     return stats;
 }
 
 void MSAAligner::printGuideTree() const {
     if (!guide_tree) {
-        std::cout << "No hay arbol guia disponible." << std::endl;
+        LOG_INFO("align.tree") << "No hay arbol guia disponible.";
         return;
     }
 
-    std::cout << "\nArbol Guia (UPGMA):" << std::endl;
+    LOG_INFO("align.tree").field("engine", guide_tree_engine)
+        << "\nArbol Guia (" << treeEngineLabel(guide_tree_engine) << "):";
     printTreeNode(guide_tree, 0);
-    std::cout << std::endl;
+    LOG_INFO("align.tree");
 }
 
 void MSAAligner::printTreeNode(const std::shared_ptr<TreeNode>& node, int depth) const {
@@ -557,12 +2062,12 @@ void MSAAligner::printTreeNode(const std::shared_ptr<TreeNode>& node, int depth)
     
     if (node->id >= 0) {
         // Nodo hoja
-        std::cout << indent << "├─ Secuencia " << node->id << " (dist: " 
-                  << std::fixed << std::setprecision(3) << node->distance << ")" << std::endl;
+        LOG_INFO("align.tree") << indent << "├─ Secuencia " << node->id << " (dist: " 
+                               << std::fixed << std::setprecision(3) << node->distance << ")";
     } else {
         // Nodo interno
-        std::cout << indent << "├─ Nodo interno (dist: " 
-                  << std::fixed << std::setprecision(3) << node->distance << ")" << std::endl;
+        LOG_INFO("align.tree") << indent << "├─ Nodo interno (dist: " 
+                               << std::fixed << std::setprecision(3) << node->distance << ")";
         if (node->left) {
             printTreeNode(node->left, depth + 1);
         }
@@ -2,15 +2,139 @@
 #define ALIGNMENT_H
 
 #include "io.h"
+#include "arena.h"
+#include "distance_matrix.h"
+#include "engines.h"
 #include <vector>
 #include <string>
 #include <map>
 #include <memory>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory_resource>
+
+class ThreadPool;
+class CancellationToken;
+
+/**
+ * Degradaciones aplicadas para cumplir el presupuesto de tiempo (máscara de bits)
+ */
+enum Degradation : unsigned {
+    DEGRADE_NONE = 0,
+    DEGRADE_KMER_DISTANCES = 1u << 0,   // Distancias por conteo de k-meros
+    DEGRADE_BANDED_DP = 1u << 1,        // Programación dinámica en banda
+    DEGRADE_NO_REFINEMENT = 1u << 2     // Sin realinear cada fila contra el consenso final
+};
+
+/**
+ * Describe una máscara de degradaciones
+ * @param degradations Máscara de bits Degradation
+ * @return Nombres separados por comas ("none" si no hay)
+ */
+std::string describeDegradations(unsigned degradations);
+
+/**
+ * Estrategias elegidas para respetar el límite de memoria (máscara de bits)
+ */
+enum MemoryStrategy : unsigned {
+    MEMORY_FULL = 0,
+    MEMORY_PACKED_TRACEBACK = 1u << 0,  // DP con dos filas de puntajes y 2 bits de camino por celda
+    MEMORY_HIRSCHBERG = 1u << 1,        // DP en espacio lineal (Hirschberg)
+    MEMORY_PACKED_DISTANCES = 1u << 2,  // Solo el triángulo superior de la matriz de distancias
+    MEMORY_SPILLED_PROFILES = 1u << 3   // Perfiles en espera volcados a archivos temporales
+};
+
+/**
+ * Describe una máscara de estrategias de memoria
+ * @param strategies Máscara de bits MemoryStrategy
+ * @return Nombres separados por comas ("full" si no hay)
+ */
+std::string describeMemoryStrategies(unsigned strategies);
+
+/**
+ * Tiempos por etapa del último alineamiento (reloj monótono, milisegundos).
+ *
+ * Las etapas se miden en el hilo que alinea y suman aproximadamente total_ms.
+ * Las subetapas se acumulan desde todos los hilos del pool, por lo que con
+ * varios hilos pueden superar el tiempo de la etapa que las contiene.
+ */
+struct AlignmentTimings {
+    // Etapas (tiempo de pared)
+    double distances_ms;            // Matriz de distancias
+    double tree_ms;                 // Árbol guía (UPGMA)
+    double progressive_ms;          // Uniones progresivas de perfiles
+    double rows_ms;                 // Realineamiento de cada fila contra el consenso final
+    double total_ms;                // Alineamiento completo
+    
+    // Subetapas (tiempo sumado sobre los hilos)
+    double dp_fill_ms;              // Llenado de matrices DP (completa, en banda, empaquetada, Hirschberg)
+    double traceback_ms;            // Reconstrucción de caminos y guiones de edición
+    double consensus_ms;            // Consensos de perfiles
+    double profile_merge_ms;        // Combinación de perfiles
+    
+    // Trabajo realizado
+    uint64_t distance_pairs;        // Pares de secuencias comparados
+    uint64_t dp_alignments;         // Alineamientos por programación dinámica
+    uint64_t dp_cells;              // Celdas DP calculadas
+    
+    AlignmentTimings() : distances_ms(0.0), tree_ms(0.0), progressive_ms(0.0), rows_ms(0.0), total_ms(0.0),
+                         dp_fill_ms(0.0), traceback_ms(0.0), consensus_ms(0.0), profile_merge_ms(0.0),
+                         distance_pairs(0), dp_alignments(0), dp_cells(0) {}
+    
+    /**
+     * Miles de millones de celdas DP por segundo de llenado (0 sin DP)
+     */
+    double gcups() const {
+        return dp_fill_ms > 0.0 ? dp_cells / (dp_fill_ms * 1e6) : 0.0;
+    }
+};
+
+/**
+ * Engines con los que alinea MSAAligner, por nombre en EngineRegistry. El
+ * preset por defecto es el alineador clásico; el presupuesto de tiempo puede
+ * degradar además etapas concretas durante un alineamiento
+ */
+struct AlignerPreset {
+    std::string distance;           // "identity", "kmer" o uno registrado
+    std::string tree;               // "upgma", "nj" o uno registrado
+    std::string pairwise;           // "full", "banded", "packed", "linear" o uno registrado
+    std::string merge;              // "consensus" o uno registrado
+    bool refinement;                // Realinear cada fila contra el consenso final
+
+    AlignerPreset() : distance("identity"), tree("upgma"), pairwise("full"), merge("consensus"),
+                      refinement(true) {}
+
+    /**
+     * Nombre del preset ("identity/upgma/full/consensus/refine")
+     */
+    std::string name() const;
+
+    /**
+     * Cambia el engine de una etapa
+     * @param spec "etapa=nombre" (distance, tree, pairwise o merge)
+     * @return false (con el error ya registrado) si la etapa o el engine no existen
+     */
+    bool select(const std::string& spec);
+
+    /**
+     * Todas las combinaciones de los engines registrados, empezando por el preset por defecto
+     */
+    static std::vector<AlignerPreset> all();
+};
+
+/**
+ * Función de progreso: recibe la etapa actual ("distances", "tree",
+ * "progressive", "rows", "done") y la fracción completada en [0, 1]
+ */
+using ProgressCallback = std::function<void(const std::string& stage, double fraction)>;
 
 /**
  * Enumeración para los pasos del alineamiento
  */
-enum class AlignmentStep {
+enum class AlignmentStep : unsigned char {
     MATCH,
     DELETE,
     INSERT
@@ -33,18 +157,29 @@ struct TreeNode {
  * Estructura para representar un perfil de alineamiento
  */
 struct Profile {
-    std::vector<std::vector<double>> frequencies; // Frecuencias de cada base/amino�cido por posici�n
-    std::vector<double> gap_frequencies;          // Frecuencias de gaps por posici�n
+    std::pmr::vector<std::pmr::vector<double>> frequencies; // Frecuencias de cada base/amino�cido por posici�n
+    std::pmr::vector<double> gap_frequencies;     // Frecuencias de gaps por posici�n
     int length;                                   // Longitud del perfil
     int num_sequences;                            // N�mero de secuencias en el perfil
     
     Profile() : length(0), num_sequences(0) {}
+    
+    /**
+     * Perfil cuyas columnas se reservan en el recurso indicado (la arena del alineamiento)
+     */
+    explicit Profile(std::pmr::memory_resource* resource)
+        : frequencies(resource), gap_frequencies(resource), length(0), num_sequences(0) {}
 };
 
 /**
  * Clase principal para el alineamiento m�ltiple de secuencias
  */
 class MSAAligner {
+    // Los microbenchmarks miden los kernels privados de forma aislada y el
+    // comparador diferencial los contrasta con la DP de referencia
+    friend class KernelBenchmark;
+    friend class DifferentialTester;
+    
 public:
     /**
      * Constructor
@@ -63,6 +198,35 @@ public:
      */
     std::vector<Sequence> alignSequences(const std::vector<Sequence>& sequences);
     
+    /**
+     * Realiza el alineamiento múltiple y devuelve cada fila como guion de edición
+     * respecto a las columnas del consenso final, sin materializar los gaps
+     * @param sequences Vector de secuencias no alineadas
+     * @return Filas alineadas (residuos + guion de edición)
+     */
+    std::vector<AlignedRow> alignSequencesToRows(const std::vector<Sequence>& sequences);
+    
+    /**
+     * Agrega secuencias nuevas a un alineamiento existente sin realinearlo:
+     * construye el perfil del alineamiento una sola vez, alinea cada secuencia
+     * nueva contra su consenso y propaga las inserciones a las filas existentes
+     * @param alignment Alineamiento existente (todas las filas con la misma longitud)
+     * @param new_sequences Secuencias nuevas sin alinear
+     * @return Alineamiento combinado (filas existentes seguidas de las nuevas)
+     */
+    std::vector<Sequence> addToAlignment(const std::vector<Sequence>& alignment,
+                                         const std::vector<Sequence>& new_sequences);
+    
+    /**
+     * Une dos alineamientos precalculados con un único alineamiento perfil-perfil
+     * y propaga los gaps resultantes a las filas de ambos
+     * @param alignment1 Primer alineamiento (filas de igual longitud)
+     * @param alignment2 Segundo alineamiento (filas de igual longitud)
+     * @return Alineamiento unido (filas del primero seguidas de las del segundo)
+     */
+    std::vector<Sequence> mergeAlignments(const std::vector<Sequence>& alignment1,
+                                          const std::vector<Sequence>& alignment2);
+    
     /**
      * Obtiene estad�sticas del �ltimo alineamiento
      * @return Mapa con estad�sticas (gaps, longitud final, etc.)
@@ -70,9 +234,138 @@ public:
     std::map<std::string, int> getAlignmentStats() const;
     
     /**
-     * Imprime el �rbol gu�a en consola
+     * Imprime el �rbol gu�a en consola junto con el engine que lo construyó
      */
     void printGuideTree() const;
+    
+    /**
+     * Asigna un pool de hilos para paralelizar las etapas dentro de una familia
+     * @param pool Pool compartido (nullptr = ejecución en serie)
+     */
+    void setThreadPool(ThreadPool* pool);
+    
+    /**
+     * Activa o desactiva los mensajes de progreso en consola
+     * @param enabled true para imprimir el progreso
+     */
+    void setVerbose(bool enabled);
+    
+    /**
+     * Registra una función de progreso que se invoca al inicio de cada etapa
+     * y tras cada unión del alineamiento progresivo
+     * @param callback Función de progreso (vacía = sin notificaciones)
+     */
+    void setProgressCallback(ProgressCallback callback);
+    
+    /**
+     * Fija un presupuesto de tiempo por alineamiento. Al consumirse, el alineador
+     * pasa a estrategias más rápidas y devuelve igualmente un alineamiento completo
+     * @param seconds Segundos disponibles (0 = sin límite)
+     */
+    void setTimeBudget(double seconds);
+    
+    /**
+     * Asigna un token de cancelación consultado dentro de la DP y las uniones
+     * @param token Token compartido (nullptr = sin cancelación)
+     */
+    void setCancellationToken(const CancellationToken* token);
+    
+    /**
+     * Fija un límite de memoria por alineamiento. Antes de cada etapa y de cada
+     * DP se estima la memoria necesaria y, si no cabe, se pasa a una estrategia
+     * más compacta (matriz completa -> camino empaquetado -> Hirschberg, matriz de
+     * distancias densa -> empaquetada, perfiles en memoria -> volcados a disco)
+     * @param bytes Bytes disponibles (0 = sin límite)
+     */
+    void setMemoryBudget(size_t bytes);
+    
+    /**
+     * Estrategias de memoria aplicadas en el último alineamiento
+     * @return Máscara de bits MemoryStrategy
+     */
+    unsigned getMemoryStrategies() const;
+    
+    /**
+     * Degradaciones aplicadas en el último alineamiento
+     * @return Máscara de bits Degradation
+     */
+    unsigned getDegradations() const;
+    
+    /**
+     * Indica si el último alineamiento se canceló (y por tanto no devolvió filas)
+     */
+    bool wasCancelled() const;
+    
+    /**
+     * Calcula un bloque contiguo del triángulo superior de la matriz de distancias
+     * (pares numerados por filas, ver DistanceShards) usando el pool si existe
+     * @param sequences Vector de secuencias
+     * @param pair_begin Primer par del bloque
+     * @param pair_end Par siguiente al último
+     * @return Distancias de los pares en orden
+     */
+    std::vector<double> calculateDistanceBlock(const std::vector<Sequence>& sequences,
+                                               uint64_t pair_begin, uint64_t pair_end);
+    
+    /**
+     * Usa una matriz de distancias ya calculada (p. ej. unida desde fragmentos)
+     * en el siguiente alineamiento en lugar de calcularla
+     * @param matrix Matriz de distancias (densa o empaquetada) en el orden de la entrada
+     */
+    void setPrecomputedDistances(DistanceMatrix matrix);
+    
+    /**
+     * Firma de los parámetros que determinan el resultado (puntuaciones y versión
+     * del algoritmo); forma parte de la clave de la caché de resultados
+     * @return Cadena estable entre ejecuciones
+     */
+    std::string parameterSignature() const;
+    
+    /**
+     * Registra como último alineamiento un resultado obtenido sin calcularlo
+     * (p. ej. de la caché): actualiza las estadísticas y descarta el árbol guía
+     * @param rows Filas alineadas
+     */
+    void adoptResult(const std::vector<AlignedRow>& rows);
+    
+    /**
+     * Activa o desactiva la arena por alineamiento (activada por defecto). Sin
+     * arena, perfiles y nodos se reservan con new/delete; los contadores se
+     * mantienen para poder comparar
+     * @param enabled true para usar la arena
+     */
+    void setArenaEnabled(bool enabled);
+    
+    /**
+     * Elige los engines de cada etapa para los siguientes alineamientos
+     * @param preset Distancias, árbol guía, DP par a par, unión y refinamiento
+     * @return false (con el error ya registrado) si algún engine no está registrado;
+     *         el preset anterior se conserva
+     */
+    bool setPreset(const AlignerPreset& preset);
+    
+    /**
+     * Engines con los que alinea
+     */
+    const AlignerPreset& getPreset() const;
+    
+    /**
+     * Libera lo que se retiene entre alineamientos (árbol guía, arena y el
+     * workspace DP del hilo actual), para medir el pico de memoria desde cero
+     */
+    void releaseMemory();
+    
+    /**
+     * Reservas de memoria temporal del último alineamiento
+     * @return Reservas, reservas al montículo, bytes y tiempo de reserva
+     */
+    AllocationStats getAllocationStats() const;
+    
+    /**
+     * Tiempos por etapa y subetapa del último alineamiento
+     * @return Tiempos, celdas DP y pares de distancias
+     */
+    AlignmentTimings getAlignmentTimings() const;
 
 private:
     // Matrices de puntuaci�n y par�metros
@@ -81,17 +374,221 @@ private:
     int gap_penalty;
     int gap_extension_penalty;
     
+    // Arena del alineamiento en curso (se declara antes que guide_tree, cuyos
+    // nodos viven en ella, para destruirse después)
+    bool arena_enabled;
+    std::unique_ptr<AlignmentArena> arena;
+    
     // Estad�sticas del alineamiento
     int total_gaps;
     int final_length;
     std::shared_ptr<TreeNode> guide_tree;
+    std::string guide_tree_engine;      // Engine que construyó guide_tree ("upgma" si hubo respaldo)
+    
+    // Ejecución
+    AlignerPreset preset;
+    ThreadPool* thread_pool;
+    bool verbose;
+    ProgressCallback progress_callback;
+    int merges_done;
+    int merges_total;
+    
+    // Presupuesto de tiempo y cancelación
+    double time_budget_seconds;
+    const CancellationToken* cancel_token;
+    std::chrono::steady_clock::time_point run_start;
+    unsigned degradations;
+    bool banded_dp;
+    bool last_cancelled;
+    
+    // Límite de memoria: bytes en uso fuera de la DP (entrada, distancias, árbol,
+    // perfiles retenidos) y estrategias aplicadas (se actualizan desde los hilos)
+    size_t max_memory;
+    size_t memory_in_use;
+    std::atomic<unsigned> memory_strategies;
+    
+    // Subproblemas de Hirschberg que se resuelven con traza empaquetada
+    size_t hirschberg_base_cells;
+    
+    /**
+     * Estrategia de programación dinámica elegida según el límite de memoria
+     */
+    enum class DPStrategy {
+        FULL,
+        PACKED_TRACEBACK,
+        HIRSCHBERG
+    };
+    
+    // Engines del preset resueltos en setPreset: las variantes integradas como
+    // indicadores y las funciones de los engines externos (vacías = integrado)
+    struct ResolvedEngines {
+        bool kmer_distances = false;
+        bool nj_tree = false;
+        bool banded = false;
+        DPStrategy dp_strategy = DPStrategy::FULL;      // Mínima; el límite de memoria puede endurecerla
+        DistanceEngineFn distance;
+        TreeEngineFn tree;
+        PairwiseEngineFn pairwise;
+        MergeEngineFn merge;
+    } engines;
+    
+    // Tiempos del último alineamiento: las etapas las fija el hilo que alinea;
+    // subetapas y contadores se acumulan desde los hilos del pool
+    AlignmentTimings timings;
+    struct StageCounters {
+        std::atomic<uint64_t> dp_fill_ns{0};
+        std::atomic<uint64_t> traceback_ns{0};
+        std::atomic<uint64_t> consensus_ns{0};
+        std::atomic<uint64_t> merge_ns{0};
+        std::atomic<uint64_t> distance_pairs{0};
+        std::atomic<uint64_t> dp_alignments{0};
+        std::atomic<uint64_t> dp_cells{0};
+    } stage_counters;
+    
+    // Distancias precalculadas para el siguiente alineamiento
+    DistanceMatrix precomputed_distances;
+    
+    /**
+     * Fracción del presupuesto consumida desde el inicio del alineamiento (0 sin presupuesto)
+     */
+    double budgetUsed() const;
+    
+    /**
+     * Indica si se solicitó la cancelación
+     */
+    bool isCancelled() const;
+    
+    /**
+     * Pone a cero los tiempos y contadores del alineamiento anterior
+     */
+    void resetTimings();
+    
+    /**
+     * Descarta el árbol y la arena del alineamiento anterior y crea una nueva
+     */
+    void beginArena();
+    
+    /**
+     * Recurso de memoria para perfiles y nodos del alineamiento en curso
+     */
+    std::pmr::memory_resource* memoryResource();
+    
+    /**
+     * Comprueba antes de empezar que al menos la combinación más compacta de
+     * estrategias cabe en el límite de memoria
+     * @return false (con el error ya registrado) si ninguna cabe
+     */
+    bool checkMemoryBudget(const std::vector<Sequence>& sequences);
+    
+    /**
+     * Elige la estrategia de una DP de m x n según la memoria libre
+     * @param concurrent DPs que pueden ejecutarse a la vez (hilos del pool)
+     */
+    DPStrategy selectDPStrategy(size_t m, size_t n, size_t concurrent);
+    
+    /**
+     * Camino del engine pairwise externo; si el camino no consume exactamente
+     * ambas secuencias se registra el error y se usa la traza empaquetada
+     */
+    std::vector<AlignmentStep> externalPath(const std::string& seq1, const std::string& seq2);
+    
+    /**
+     * Puntuaciones actuales para los engines externos
+     */
+    ScoringScheme scoringScheme() const;
+    
+    /**
+     * Camino de alineamiento de seq1 contra seq2 con una estrategia de poca memoria
+     * @return Pasos en orden (vacío si se canceló)
+     */
+    std::vector<AlignmentStep> lowMemoryPath(const std::string& seq1, const std::string& seq2,
+                                             DPStrategy strategy);
+    
+    /**
+     * DP con dos filas de puntajes; guarda 2 bits por celda con el paso que
+     * elegiría reconstructAlignment, por lo que el camino es el mismo
+     */
+    std::vector<AlignmentStep> packedTracebackPath(const std::string& seq1, const std::string& seq2);
+    
+    /**
+     * Hirschberg: divide seq1 por la mitad, busca con dos pasadas lineales la
+     * columna de seq2 por la que pasa un camino óptimo y resuelve las dos mitades
+     */
+    void hirschbergPath(const std::string& seq1, size_t begin1, size_t end1,
+                        const std::string& seq2, size_t begin2, size_t end2,
+                        std::vector<AlignmentStep>& path);
+    
+    /**
+     * Última fila de puntajes de seq1[begin1, end1) contra seq2[begin2, end2),
+     * hacia adelante o sobre ambas subcadenas invertidas
+     */
+    void lastScoreRow(const std::string& seq1, size_t begin1, size_t end1,
+                      const std::string& seq2, size_t begin2, size_t end2,
+                      bool reversed, std::vector<int>& row);
+    
+    /**
+     * Convierte un camino en el par de cadenas con gaps
+     */
+    std::pair<std::string, std::string> pathToAlignment(const std::vector<AlignmentStep>& path,
+                                                        const std::string& seq1,
+                                                        const std::string& seq2);
+    
+    /**
+     * Convierte un camino en el guion de edición de seq1 (ver reconstructEditScript)
+     */
+    std::vector<EditOp> pathToEditScript(const std::vector<AlignmentStep>& path);
+    
+    /**
+     * Memoria de un perfil de la longitud indicada
+     */
+    static size_t profileBytes(size_t length);
+    
+    /**
+     * Vuelca un perfil a un archivo temporal y libera sus columnas
+     * @return Archivo abierto o nullptr si no se pudo (el perfil queda intacto)
+     */
+    std::FILE* spillProfile(Profile& profile);
+    
+    /**
+     * Recupera un perfil volcado y cierra (borra) su archivo
+     */
+    Profile restoreProfile(std::FILE* file);
+    
+    /**
+     * Calcula longitud final y gaps totales desde los guiones de edición
+     */
+    void updateStatsFromRows(const std::vector<AlignedRow>& rows);
+    
+    /**
+     * Notifica el progreso si hay una función registrada
+     */
+    void reportProgress(const char* stage, double fraction);
     
     /**
      * Calcula la matriz de distancias entre todas las secuencias
      * @param sequences Vector de secuencias
+     * @param packed true para guardar solo el triángulo superior
      * @return Matriz de distancias
      */
-    std::vector<std::vector<double>> calculateDistanceMatrix(const std::vector<Sequence>& sequences);
+    DistanceMatrix calculateDistanceMatrix(const std::vector<Sequence>& sequences, bool packed);
+    
+    /**
+     * Cuenta los k-meros de cada secuencia para el cálculo rápido de distancias
+     * (k = 4 sobre ADN, k = 2 sobre proteínas)
+     * @param sequences Vector de secuencias
+     * @param k Longitud de k-mero elegida
+     * @return Vector de conteos por secuencia
+     */
+    std::vector<std::vector<unsigned short>> countKmers(const std::vector<Sequence>& sequences,
+                                                        size_t& k) const;
+    
+    /**
+     * Distancia por k-meros compartidos; su costo no depende de la longitud
+     * @return Distancia en [0, 1]
+     */
+    double calculateKmerDistance(const std::vector<unsigned short>& counts1, size_t length1,
+                                 const std::vector<unsigned short>& counts2, size_t length2,
+                                 size_t k) const;
     
     /**
      * Calcula la distancia entre dos secuencias usando identidad porcentual
@@ -101,14 +598,45 @@ private:
      */
     double calculateSequenceDistance(const std::string& seq1, const std::string& seq2);
     
+    /**
+     * Distancia de un par con el engine de distancias (identidad si es integrado)
+     */
+    double pairDistance(const std::string& seq1, const std::string& seq2);
+    
+    /**
+     * Construye el árbol guía con el método del preset
+     * @param sequences Vector de secuencias originales
+     * @param distance_matrix Matriz de distancias
+     * @return Nodo raíz del árbol guía
+     */
+    std::shared_ptr<TreeNode> buildGuideTree(const std::vector<Sequence>& sequences,
+                                           const DistanceMatrix& distance_matrix);
+    
     /**
      * Construye el �rbol gu�a usando UPGMA
      * @param sequences Vector de secuencias originales
      * @param distance_matrix Matriz de distancias
      * @return Nodo ra�z del �rbol gu�a
      */
-    std::shared_ptr<TreeNode> buildGuideTree(const std::vector<Sequence>& sequences,
-                                           const std::vector<std::vector<double>>& distance_matrix);
+    std::shared_ptr<TreeNode> buildUpgmaTree(const std::vector<Sequence>& sequences,
+                                           const DistanceMatrix& distance_matrix);
+    
+    /**
+     * Construye el árbol guía por neighbor joining (Saitou y Nei) en O(n³),
+     * enraizado en la unión de los dos últimos nodos
+     * @param sequences Vector de secuencias originales
+     * @param distance_matrix Matriz de distancias
+     * @return Nodo raíz del árbol guía
+     */
+    std::shared_ptr<TreeNode> buildNeighborJoiningTree(const std::vector<Sequence>& sequences,
+                                                       const DistanceMatrix& distance_matrix);
+    
+    /**
+     * Construye el árbol guía a partir de las uniones de un engine externo
+     * @return Nodo raíz, o nullptr si las uniones no forman un árbol sobre todas las secuencias
+     */
+    std::shared_ptr<TreeNode> buildTreeFromMerges(const std::vector<Sequence>& sequences,
+                                                  const std::vector<TreeMerge>& merges);
     
     /**
      * Realiza el alineamiento progresivo siguiendo el �rbol gu�a
@@ -119,6 +647,14 @@ private:
     Profile progressiveAlignment(const std::vector<Sequence>& sequences,
                                const std::shared_ptr<TreeNode>& node);
     
+    /**
+     * Alineamiento progresivo que además propaga las filas por el árbol
+     * @param rows Filas alineadas del subárbol en el orden de node->sequences (nullptr = no propagar)
+     */
+    Profile progressiveAlignment(const std::vector<Sequence>& sequences,
+                               const std::shared_ptr<TreeNode>& node,
+                               std::vector<Sequence>* rows);
+    
     /**
      * Alinea dos secuencias usando Needleman-Wunsch
      * @param seq1 Primera secuencia
@@ -145,15 +681,54 @@ private:
     Profile alignProfiles(const Profile& profile1, const Profile& profile2);
     
     /**
-     * Convierte un perfil final a secuencias alineadas
+     * Combina dos perfiles siguiendo el alineamiento de sus consensos
+     * @param aligned_pair Consensos alineados
+     * @return Perfil combinado
+     */
+    Profile combineProfiles(const Profile& profile1, const Profile& profile2,
+                            const std::pair<std::string, std::string>& aligned_pair);
+    
+    /**
+     * Alinea los consensos de dos perfiles; el par resultante indica, columna a
+     * columna, si cada perfil aporta una columna propia o un gap
+     * @param profile1 Primer perfil
+     * @param profile2 Segundo perfil
+     * @return Par de consensos alineados
+     */
+    std::pair<std::string, std::string> alignProfileConsensus(const Profile& profile1,
+                                                              const Profile& profile2);
+    
+    /**
+     * Propaga un alineamiento de consensos a las filas de dos alineamientos
+     * @param rows1 Filas correspondientes al primer consenso
+     * @param rows2 Filas correspondientes al segundo consenso
+     * @param aligned_pair Consensos alineados
+     * @return Filas unidas con columnas comunes
+     */
+    std::vector<Sequence> propagateGaps(const std::vector<Sequence>& rows1,
+                                        const std::vector<Sequence>& rows2,
+                                        const std::pair<std::string, std::string>& aligned_pair);
+    
+    /**
+     * Verifica que todas las filas de un alineamiento tengan la misma longitud
+     */
+    bool hasUniformLength(const std::vector<Sequence>& alignment) const;
+    
+    /**
+     * Convierte un perfil final a filas alineadas contra su consenso
      * @param profile Perfil final del alineamiento
      * @param sequences Secuencias originales
-     * @param sequence_order Orden de las secuencias en el perfil
-     * @return Vector de secuencias alineadas
+     * @return Filas alineadas (residuos + guion de edición)
      */
-    std::vector<Sequence> profileToSequences(const Profile& profile,
-                                           const std::vector<Sequence>& sequences,
-                                           const std::vector<int>& sequence_order);
+    std::vector<AlignedRow> profileToRows(const Profile& profile,
+                                        const std::vector<Sequence>& sequences);
+    
+    /**
+     * Construye el perfil de un alineamiento existente columna a columna
+     * @param alignment Secuencias alineadas de igual longitud
+     * @return Perfil del alineamiento
+     */
+    Profile buildProfileFromAlignment(const std::vector<Sequence>& alignment);
     
     /**
      * Crea un perfil a partir de una sola secuencia
@@ -184,9 +759,16 @@ private:
     char getAlphabetChar(int index) const;
     
     /**
-     * Inicializa la matriz de programación dinámica
+     * Inicializa la matriz de programación dinámica sobre el workspace del hilo actual,
+     * que se conserva entre llamadas para evitar reasignaciones (tras una DP de más
+     * de 64 MB se libera, para no retener la mayor matriz durante todo el proceso)
+     */
+    std::vector<std::vector<int>>& initializeDPMatrix(size_t m, size_t n);
+    
+    /**
+     * Inicializa y llena la matriz DP con la estrategia vigente (completa o en banda)
      */
-    std::vector<std::vector<int>> initializeDPMatrix(size_t m, size_t n);
+    std::vector<std::vector<int>>& computeDPMatrix(const std::string& seq1, const std::string& seq2);
     
     /**
      * Llena la matriz de programación dinámica
@@ -195,6 +777,15 @@ private:
                      const std::string& seq1, const std::string& seq2,
                      size_t m, size_t n);
     
+    /**
+     * Llena solo una banda alrededor de la diagonal escalada; las celdas vecinas
+     * a la banda quedan con un valor muy negativo para que la reconstrucción no las elija
+     * @return Celdas calculadas
+     */
+    size_t fillBandedDPMatrix(std::vector<std::vector<int>>& dp,
+                              const std::string& seq1, const std::string& seq2,
+                              size_t m, size_t n, size_t band);
+    
     /**
      * Calcula el puntaje de coincidencia entre dos caracteres
      */
@@ -208,6 +799,15 @@ private:
         const std::string& seq1, const std::string& seq2,
         size_t m, size_t n);
     
+    /**
+     * Reconstruye el guion de edición de seq1 respecto a seq2 a partir de la matriz DP
+     * ('M' = alineado, 'I' = residuo de seq1 frente a gap, 'D' = gap en seq1)
+     */
+    std::vector<EditOp> reconstructEditScript(
+        const std::vector<std::vector<int>>& dp,
+        const std::string& seq1, const std::string& seq2,
+        size_t m, size_t n);
+    
     /**
      * Determina el próximo paso en la reconstrucción del alineamiento
      */
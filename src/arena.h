@@ -0,0 +1,126 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * Contadores de reservas de memoria temporal de un alineamiento
+ */
+struct AllocationStats {
+    unsigned long allocations;      // Reservas pedidas por perfiles, nodos y temporales
+    unsigned long heap_allocations; // Reservas que llegaron al montículo (new/delete)
+    size_t bytes_allocated;         // Bytes pedidos en total
+    double allocation_ms;           // Tiempo dentro de reservas y liberaciones
+
+    AllocationStats() : allocations(0), heap_allocations(0), bytes_allocated(0), allocation_ms(0.0) {}
+};
+
+/**
+ * Recurso de memoria que reenvía a otro y cuenta reservas, bytes y, si se pide,
+ * el tiempo dedicado a reservar y liberar
+ */
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    /**
+     * Constructor
+     * @param upstream Recurso al que se reenvían las reservas
+     * @param timed Mide el tiempo de cada reserva y liberación
+     */
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(),
+                                    bool timed = false)
+        : upstream(upstream), timed(timed), allocations(0), bytes(0), nanoseconds(0) {}
+
+    unsigned long allocationCount() const { return allocations.load(std::memory_order_relaxed); }
+    size_t bytesAllocated() const { return bytes.load(std::memory_order_relaxed); }
+    double elapsedMs() const { return nanoseconds.load(std::memory_order_relaxed) / 1e6; }
+
+private:
+    std::pmr::memory_resource* upstream;
+    bool timed;
+    std::atomic<unsigned long> allocations;
+    std::atomic<size_t> bytes;
+    std::atomic<long long> nanoseconds;
+
+    void* do_allocate(size_t size, size_t alignment) override {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        if (!timed) {
+            return upstream->allocate(size, alignment);
+        }
+        auto start = std::chrono::steady_clock::now();
+        void* pointer = upstream->allocate(size, alignment);
+        addElapsed(start);
+        return pointer;
+    }
+
+    void do_deallocate(void* pointer, size_t size, size_t alignment) override {
+        if (!timed) {
+            upstream->deallocate(pointer, size, alignment);
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        upstream->deallocate(pointer, size, alignment);
+        addElapsed(start);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void addElapsed(std::chrono::steady_clock::time_point start) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                              std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Arena de un alineamiento: perfiles, nodos del árbol guía y temporales se
+ * reservan de un pool sin sincronización que reutiliza los bloques liberados
+ * y devuelve todo al montículo de una vez al destruirse.
+ *
+ * Con la arena desactivada, las mismas reservas van directamente a new/delete
+ * pasando por los mismos contadores, para poder comparar ambos modos.
+ */
+class AlignmentArena {
+public:
+    /**
+     * Constructor
+     * @param pooled true = pool de arena, false = new/delete directo
+     */
+    explicit AlignmentArena(bool pooled)
+        : heap(std::pmr::new_delete_resource()),
+          pool(pooled ? new std::pmr::unsynchronized_pool_resource(&heap) : nullptr),
+          front(pool ? static_cast<std::pmr::memory_resource*>(pool.get()) : &heap, true) {}
+
+    AlignmentArena(const AlignmentArena&) = delete;
+    AlignmentArena& operator=(const AlignmentArena&) = delete;
+
+    /**
+     * Recurso a usar para las reservas del alineamiento
+     */
+    std::pmr::memory_resource* resource() { return &front; }
+
+    /**
+     * Contadores acumulados desde la creación de la arena
+     */
+    AllocationStats stats() const {
+        AllocationStats result;
+        result.allocations = front.allocationCount();
+        result.heap_allocations = heap.allocationCount();
+        result.bytes_allocated = front.bytesAllocated();
+        result.allocation_ms = front.elapsedMs();
+        return result;
+    }
+
+private:
+    CountingMemoryResource heap;
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool;
+    CountingMemoryResource front;
+};
+
+#endif // ARENA_H
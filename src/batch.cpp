@@ -0,0 +1,225 @@
+#include "batch.h"
+#include "logger.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+double BatchSummary::familiesPerHour() const {
+    return elapsed_seconds > 0.0 ? families_ok * 3600.0 / elapsed_seconds : 0.0;
+}
+
+BatchRunner::BatchRunner(const BatchOptions& options)
+    : options(options), pool(options.num_threads) {
+    if (options.cache_bytes > 0) {
+        ResultCacheOptions cache_options;
+        cache_options.max_bytes = options.cache_bytes;
+        cache_options.directory = options.cache_dir;
+        cache = std::make_unique<ResultCache>(cache_options);
+    }
+}
+
+std::vector<std::string> BatchRunner::collectFamilies(const std::string& input) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+
+    if (fs::is_directory(input, ec)) {
+        for (const auto& entry : fs::directory_iterator(input, ec)) {
+            std::string ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".fasta" || ext == ".fa" || ext == ".fas")) {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::ifstream manifest(input);
+    if (!manifest.is_open()) {
+        LOG_ERROR("batch.error") << "Error: No se pudo abrir el manifiesto " << input;
+        return paths;
+    }
+
+    // Rutas relativas del manifiesto se resuelven respecto a su directorio
+    fs::path base_dir = fs::path(input).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        fs::path path(line.substr(start));
+        if (path.is_relative() && !base_dir.empty()) {
+            path = base_dir / path;
+        }
+        paths.push_back(path.string());
+    }
+
+    return paths;
+}
+
+BatchSummary BatchRunner::run() {
+    BatchSummary summary;
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<std::string> paths = collectFamilies(options.input);
+    summary.families_total = static_cast<int>(paths.size());
+
+    if (paths.empty()) {
+        LOG_ERROR("batch.error") << "Error: No se encontraron familias FASTA en " << options.input;
+        return summary;
+    }
+
+    std::error_code ec;
+    fs::create_directories(options.output_dir, ec);
+    if (ec) {
+        LOG_ERROR("batch.error") << "Error: No se pudo crear el directorio " << options.output_dir;
+        return summary;
+    }
+
+    LOG_INFO("batch") << "Familias encontradas: " << paths.size()
+                      << " (hilos: " << pool.size() << ")";
+
+    // Lectura en paralelo; los mensajes por archivo se silencian en modo lote
+    FastaIO::setVerbose(false);
+    std::vector<Family> families(paths.size());
+    pool.parallelFor(0, paths.size(), [&](size_t i) {
+        families[i].path = paths[i];
+        families[i].sequences = FastaIO::readFasta(paths[i]);
+        families[i].estimated_cells = estimateCells(families[i].sequences);
+    });
+
+    std::vector<size_t> big, small;
+    for (size_t i = 0; i < families.size(); ++i) {
+        summary.total_sequences += families[i].sequences.size();
+        if (families[i].estimated_cells >= options.big_family_cells) {
+            big.push_back(i);
+        } else {
+            small.push_back(i);
+        }
+    }
+
+    // Las mas costosas primero (LPT) para equilibrar la carga al final del lote
+    auto byCost = [&](size_t a, size_t b) {
+        return families[a].estimated_cells > families[b].estimated_cells;
+    };
+    std::sort(big.begin(), big.end(), byCost);
+    std::sort(small.begin(), small.end(), byCost);
+
+    // Familias grandes: una a la vez, con paralelismo dentro de la familia
+    MSAAligner big_aligner;
+    big_aligner.setVerbose(false);
+    big_aligner.setThreadPool(&pool);
+    for (size_t index : big) {
+        LOG_INFO("batch") << "Familia grande: " << families[index].path
+                          << " (" << families[index].sequences.size() << " secuencias)";
+        alignFamily(families[index], big_aligner);
+    }
+    summary.big_families = static_cast<int>(big.size());
+
+    // Familias pequenas: una por hilo, reutilizando el alineador (y su workspace) del hilo
+    std::vector<std::future<void>> pending;
+    pending.reserve(small.size());
+    for (size_t index : small) {
+        pending.push_back(pool.submit([this, &families, index]() {
+            thread_local MSAAligner worker_aligner;
+            worker_aligner.setVerbose(false);
+            alignFamily(families[index], worker_aligner);
+        }));
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+
+    FastaIO::setVerbose(true);
+
+    for (const auto& family : families) {
+        if (family.ok) {
+            summary.families_ok++;
+        } else {
+            summary.families_failed++;
+        }
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    summary.elapsed_seconds = std::chrono::duration<double>(end_time - start_time).count();
+    if (cache) {
+        summary.cache_hits = cache->hits();
+        summary.cache_misses = cache->misses();
+    }
+
+    writeSummaryFile(families);
+    return summary;
+}
+
+void BatchRunner::alignFamily(Family& family, MSAAligner& aligner) {
+    auto start_time = std::chrono::steady_clock::now();
+    TraceSpan span("family", "batch");
+    span.arg("sequences", static_cast<double>(family.sequences.size()));
+
+    if (family.sequences.size() < 2) {
+        LOG_ERROR("batch.error") << "Error: Se necesitan al menos 2 secuencias en " << family.path;
+        return;
+    }
+
+    try {
+        auto rows = cache ? cache->align(aligner, family.sequences)
+                          : aligner.alignSequencesToRows(family.sequences);
+        if (!rows.empty()) {
+            FastaIO::writeRows(rows, outputPathFor(family.path), options.output_format);
+            family.ok = true;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("batch.error") << "Error alineando " << family.path << ": " << e.what();
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    family.elapsed_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+}
+
+double BatchRunner::estimateCells(const std::vector<Sequence>& sequences) {
+    if (sequences.empty()) {
+        return 0.0;
+    }
+
+    double total_length = 0.0;
+    for (const auto& seq : sequences) {
+        total_length += seq.sequence.length();
+    }
+    double n = static_cast<double>(sequences.size());
+    double avg_length = total_length / n;
+
+    // Realineamiento final (N * L^2) mas la matriz de distancias (N^2 * L / 2)
+    return n * avg_length * avg_length + n * n * avg_length / 2.0;
+}
+
+std::string BatchRunner::outputPathFor(const std::string& family_path) const {
+    std::string extension = options.output_format == "fasta" ? ".fasta" : "." + options.output_format;
+    return (fs::path(options.output_dir) / (fs::path(family_path).stem().string() + extension)).string();
+}
+
+void BatchRunner::writeSummaryFile(const std::vector<Family>& families) const {
+    std::string summary_path = (fs::path(options.output_dir) / "batch_summary.tsv").string();
+    std::ofstream file(summary_path);
+
+    if (!file.is_open()) {
+        LOG_ERROR("batch.error") << "Error: No se pudo crear el archivo " << summary_path;
+        return;
+    }
+
+    file << "family\tsequences\testimated_cells\ttime_ms\tstatus\n";
+    for (const auto& family : families) {
+        file << family.path << '\t' << family.sequences.size() << '\t'
+             << std::fixed << std::setprecision(0) << family.estimated_cells << '\t'
+             << std::setprecision(3) << family.elapsed_ms << '\t'
+             << (family.ok ? "ok" : "error") << '\n';
+    }
+}
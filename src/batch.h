@@ -0,0 +1,114 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "alignment.h"
+#include "io.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Opciones del modo por lotes
+ */
+struct BatchOptions {
+    std::string input;              // Manifiesto (una ruta FASTA por línea) o directorio
+    std::string output_dir;         // Directorio donde se escriben los alineamientos
+    std::string output_format;      // fasta, a3m o rle
+    size_t num_threads;             // Hilos del pool compartido (0 = núcleos disponibles)
+    double big_family_cells;        // Celdas DP estimadas a partir de las cuales una familia es "grande"
+    size_t cache_bytes;             // Caché de resultados (0 = desactivada)
+    std::string cache_dir;          // Directorio persistente de la caché (opcional)
+    
+    BatchOptions() : output_format("fasta"), num_threads(0), big_family_cells(5e7), cache_bytes(0) {}
+};
+
+/**
+ * Resumen de una ejecución por lotes
+ */
+struct BatchSummary {
+    int families_total;             // Familias encontradas
+    int families_ok;                // Familias alineadas correctamente
+    int families_failed;            // Familias con error
+    int big_families;               // Familias alineadas con paralelismo interno
+    size_t total_sequences;         // Secuencias procesadas en total
+    double elapsed_seconds;         // Tiempo total de la ejecución
+    unsigned long cache_hits;       // Familias servidas desde la caché
+    unsigned long cache_misses;     // Familias alineadas con la caché activa
+    
+    BatchSummary() : families_total(0), families_ok(0), families_failed(0),
+                     big_families(0), total_sequences(0), elapsed_seconds(0.0),
+                     cache_hits(0), cache_misses(0) {}
+    
+    /**
+     * Rendimiento agregado en familias por hora
+     */
+    double familiesPerHour() const;
+};
+
+/**
+ * Alinea muchas familias FASTA en un solo proceso repartiéndolas entre núcleos.
+ * Las familias pequeñas se alinean en paralelo entre sí (una por hilo) y las grandes
+ * una a una usando todos los hilos del pool dentro de la familia.
+ */
+class BatchRunner {
+public:
+    /**
+     * Constructor
+     * @param options Opciones del lote
+     */
+    explicit BatchRunner(const BatchOptions& options);
+    
+    /**
+     * Ejecuta el lote completo
+     * @return Resumen de la ejecución
+     */
+    BatchSummary run();
+    
+    /**
+     * Obtiene la lista de archivos FASTA de un manifiesto o directorio
+     * @param input Ruta al manifiesto o directorio
+     * @return Rutas de las familias en orden estable
+     */
+    static std::vector<std::string> collectFamilies(const std::string& input);
+
+private:
+    struct Family {
+        std::string path;
+        std::vector<Sequence> sequences;
+        double estimated_cells;
+        double elapsed_ms;
+        bool ok;
+        
+        Family() : estimated_cells(0.0), elapsed_ms(0.0), ok(false) {}
+    };
+    
+    BatchOptions options;
+    ThreadPool pool;
+    std::unique_ptr<ResultCache> cache;
+    
+    /**
+     * Alinea una familia y escribe su resultado
+     * @param family Familia a alinear
+     * @param aligner Alineador (y workspace) a utilizar
+     */
+    void alignFamily(Family& family, MSAAligner& aligner);
+    
+    /**
+     * Estima las celdas DP del alineamiento final de una familia
+     */
+    static double estimateCells(const std::vector<Sequence>& sequences);
+    
+    /**
+     * Ruta de salida para una familia según el formato elegido
+     */
+    std::string outputPathFor(const std::string& family_path) const;
+    
+    /**
+     * Escribe el resumen por familia en formato TSV
+     */
+    void writeSummaryFile(const std::vector<Family>& families) const;
+};
+
+#endif // BATCH_H
@@ -1,12 +1,16 @@
 #include "benchmark.h"
+#include "json_util.h"
+#include "logger.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <chrono>
-#include <random>
 #include <algorithm>
 #include <iomanip>
 #include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <thread>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -18,23 +22,176 @@
 #include <mach/mach.h>
 #endif
 
-Benchmark::Benchmark() {
-    // Constructor vacío, el alineador se inicializa por defecto
+namespace {
+
+// Prefijo de columna CSV de una fase ("Parse", "Distances", ...)
+std::string phaseColumn(int phase) {
+    std::string name = memoryPhaseName(static_cast<MemoryPhase>(phase));
+    name[0] = static_cast<char>(std::toupper(name[0]));
+    return name;
+}
+
+// Valor de un contador o razón; vacío (CSV) o null (JSON) si no hay dato
+std::string counterValue(const PerfSample& sample, PerfEvent event, const char* missing) {
+    return sample.has(event) ? std::to_string(sample.value(event)) : missing;
+}
+
+// Etapas con exponente ajustado en el estudio de escalabilidad; las cuatro
+// primeras son de pared, las siguientes suman el tiempo de todos los hilos
+struct ScalingStage {
+    const char* name;
+    double AlignmentTimings::*field;
+};
+
+const ScalingStage SCALING_STAGES[] = {
+    {"distances", &AlignmentTimings::distances_ms},
+    {"tree", &AlignmentTimings::tree_ms},
+    {"progressive", &AlignmentTimings::progressive_ms},
+    {"rows", &AlignmentTimings::rows_ms},
+    {"dp_fill", &AlignmentTimings::dp_fill_ms},
+    {"traceback", &AlignmentTimings::traceback_ms},
+    {"consensus", &AlignmentTimings::consensus_ms},
+    {"profile_merge", &AlignmentTimings::profile_merge_ms},
+    {"total", &AlignmentTimings::total_ms},
+};
+
+template <typename T>
+T median(std::vector<T> values) {
+    if (values.empty()) {
+        return T();
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// Medianas campo a campo de varias ejecuciones del mismo punto
+ScalabilityPoint medianPoint(const std::vector<BenchmarkResult>& runs) {
+    ScalabilityPoint point;
+    point.repetitions = static_cast<int>(runs.size());
+    std::vector<double> values;
+    for (const auto& run : runs) {
+        values.push_back(run.execution_time_ms);
+    }
+    point.execution_time_ms = median(values);
+    for (const ScalingStage& stage : SCALING_STAGES) {
+        values.clear();
+        for (const auto& run : runs) {
+            values.push_back(run.timings.*stage.field);
+        }
+        point.timings.*stage.field = median(values);
+    }
+    std::vector<uint64_t> counts;
+    for (const auto& run : runs) {
+        counts.push_back(run.timings.dp_cells);
+    }
+    point.timings.dp_cells = median(counts);
+    counts.clear();
+    for (const auto& run : runs) {
+        counts.push_back(run.timings.dp_alignments);
+    }
+    point.timings.dp_alignments = median(counts);
+    counts.clear();
+    for (const auto& run : runs) {
+        counts.push_back(run.timings.distance_pairs);
+    }
+    point.timings.distance_pairs = median(counts);
+    return point;
+}
+
+// Puntos no dominados: ningún otro es igual o mejor en todos los costos y mejor en alguno
+std::vector<bool> nonDominated(const std::vector<std::vector<double>>& costs) {
+    std::vector<bool> front(costs.size(), true);
+    for (size_t a = 0; a < costs.size(); ++a) {
+        for (size_t b = 0; b < costs.size() && front[a]; ++b) {
+            bool no_worse = true;
+            bool better = false;
+            for (size_t c = 0; c < costs[a].size(); ++c) {
+                no_worse = no_worse && costs[b][c] <= costs[a][c];
+                better = better || costs[b][c] < costs[a][c];
+            }
+            if (b != a && no_worse && better) {
+                front[a] = false;
+            }
+        }
+    }
+    return front;
+}
+
+std::string ratioValue(double ratio, const char* missing) {
+    if (ratio < 0.0) {
+        return missing;
+    }
+    std::ostringstream out;
+    out << ratio;
+    return out.str();
+}
+
+} // namespace
+
+Benchmark::Benchmark() : pool(nullptr), perf_checked(false) {
+    // El alineador se inicializa por defecto
 }
 
 BenchmarkResult Benchmark::runSingleBenchmark(const std::string& dataset_path,
-                                             const std::string& output_path) {
+                                             const std::string& output_path,
+                                             const std::string& reference_path) {
+    if (reference_path.empty()) {
+        return runBenchmark(dataset_path, nullptr, output_path);
+    }
+    std::vector<Sequence> reference = FastaIO::readFasta(reference_path);
+    if (reference.empty()) {
+        LOG_WARN("benchmark").field("reference", reference_path)
+            << "Advertencia: No se pudo leer la referencia " << reference_path;
+    }
+    return runBenchmark(dataset_path, nullptr, output_path, &reference);
+}
+
+BenchmarkResult Benchmark::runSequenceBenchmark(const std::vector<Sequence>& sequences,
+                                               const std::string& dataset_name,
+                                               const std::vector<Sequence>* reference) {
+    return runBenchmark(dataset_name, &sequences, "", reference);
+}
+
+BenchmarkResult Benchmark::runBenchmark(const std::string& dataset_path,
+                                       const std::vector<Sequence>* in_memory,
+                                       const std::string& output_path,
+                                       const std::vector<Sequence>* reference) {
     BenchmarkResult result;
     result.dataset_name = dataset_path;
     result.timestamp = getCurrentTimestamp();
     
+    // Las reservas de cada fase se miden desde aquí
+    MemoryAccounting::reset();
+    result.memory_accounting = MemoryAccounting::enabled();
+    
+    // Contadores de hardware: sin ellos (contenedores, VMs sin PMU) se reportan solo tiempos
+    if (!perf_checked) {
+        perf_checked = true;
+        if (!perf_counters.open()) {
+            LOG_WARN("benchmark.perf").field("reason", perf_counters.unavailableReason())
+                << "Advertencia: Contadores de hardware no disponibles (" << perf_counters.unavailableReason()
+                << "); se reportan solo tiempos.";
+        }
+    }
+    // El grupo cuenta solo el hilo que lo abrió: con pool el trabajo de los hilos
+    // trabajadores quedaría fuera, así que los contadores se marcan como no disponibles
+    PhasePerfRecorder perf_recorder(perf_counters);
+    if (!pool) {
+        perf_recorder.start();
+    }
+    
     try {
-        // Leer secuencias del dataset
-        std::vector<Sequence> sequences = FastaIO::readFasta(dataset_path);
+        // Leer secuencias del dataset (salvo que ya estén en memoria)
+        std::vector<Sequence> parsed;
+        if (!in_memory) {
+            MemoryPhaseScope memory_phase(MemoryPhase::PARSE);
+            parsed = FastaIO::readFasta(dataset_path);
+        }
+        const std::vector<Sequence>& sequences = in_memory ? *in_memory : parsed;
         result.num_sequences = sequences.size();
         
         if (sequences.empty()) {
-            std::cerr << "Error: No se pudieron leer secuencias de " << dataset_path << std::endl;
+            LOG_ERROR("benchmark.error") << "Error: No se pudieron leer secuencias de " << dataset_path;
             return result;
         }
         
@@ -65,6 +222,13 @@ BenchmarkResult Benchmark::runSingleBenchmark(const std::string& dataset_path,
         auto alignment_stats = aligner.getAlignmentStats();
         result.final_length = alignment_stats["final_length"];
         result.total_gaps = alignment_stats["total_gaps"];
+        result.timings = aligner.getAlignmentTimings();
+        
+        AllocationStats allocation = aligner.getAllocationStats();
+        result.allocations = allocation.allocations;
+        result.heap_allocations = allocation.heap_allocations;
+        result.allocated_bytes = allocation.bytes_allocated;
+        result.allocation_ms = allocation.allocation_ms;
         
         // Calcular porcentaje de gaps
         if (result.final_length > 0 && result.num_sequences > 0) {
@@ -74,53 +238,129 @@ BenchmarkResult Benchmark::runSingleBenchmark(const std::string& dataset_path,
         
         // Guardar resultado si se especifica ruta
         if (!output_path.empty()) {
+            MemoryPhaseScope memory_phase(MemoryPhase::OUTPUT);
             FastaIO::writeFasta(aligned_sequences, output_path);
         }
+        result.phase_memory = MemoryAccounting::snapshot();
+        result.phase_counters = perf_recorder.stop();
+        result.perf_available = perf_counters.available() && !pool;
+        const PerfSample& progressive = result.phase_counters[static_cast<int>(MemoryPhase::PROGRESSIVE)];
+        if (progressive.has(PerfEvent::INSTRUCTIONS) && result.timings.dp_cells > 0) {
+            result.instructions_per_cell =
+                static_cast<double>(progressive.value(PerfEvent::INSTRUCTIONS)) / result.timings.dp_cells;
+        }
         
-        std::cout << "Benchmark completado para " << dataset_path << std::endl;
-        std::cout << "  Tiempo: " << result.execution_time_ms << " ms" << std::endl;
-        std::cout << "  Memoria: " << result.memory_usage_mb << " MB" << std::endl;
-        std::cout << "  Secuencias: " << result.num_sequences << std::endl;
-        std::cout << "  Gaps: " << result.gap_percentage << "%" << std::endl;
+        // Precisión frente a la referencia: después de medir, para no mezclarla con el alineamiento
+        if (reference && !reference->empty()) {
+            auto accuracy_start = std::chrono::steady_clock::now();
+            AccuracyScore accuracy = AlignmentAccuracy::score(aligned_sequences, *reference, pool);
+            result.accuracy_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - accuracy_start).count();
+            if (accuracy.valid) {
+                result.has_reference = true;
+                result.accuracy_score = accuracy.sp;
+                result.tc_score = accuracy.tc;
+            } else {
+                LOG_WARN("benchmark") << "Advertencia: No se pudo comparar " << dataset_path << " con su referencia";
+            }
+        }
+        
+        LOG_INFO("benchmark") << "Benchmark completado para " << dataset_path;
+        LOG_INFO("benchmark") << "  Tiempo: " << result.execution_time_ms << " ms";
+        LOG_INFO("benchmark").field("distances_ms", result.timings.distances_ms)
+                             .field("tree_ms", result.timings.tree_ms)
+                             .field("progressive_ms", result.timings.progressive_ms)
+                             .field("rows_ms", result.timings.rows_ms)
+            << "  Etapas: distancias " << result.timings.distances_ms << " ms, arbol "
+            << result.timings.tree_ms << " ms, progresivo " << result.timings.progressive_ms
+            << " ms, filas " << result.timings.rows_ms << " ms";
+        LOG_INFO("benchmark").field("dp_cells", result.timings.dp_cells).field("gcups", result.timings.gcups())
+            << "  DP: " << result.timings.dp_cells << " celdas en " << result.timings.dp_fill_ms
+            << " ms (" << result.timings.gcups() << " GCUPS), traceback " << result.timings.traceback_ms
+            << " ms, consenso " << result.timings.consensus_ms << " ms, union de perfiles "
+            << result.timings.profile_merge_ms << " ms";
+        LOG_INFO("benchmark") << "  Memoria: " << result.memory_usage_mb << " MB";
+        LOG_INFO("benchmark") << "  Reservas: " << result.allocations << " (" << result.heap_allocations
+                              << " al monticulo, " << result.allocation_ms << " ms)";
+        if (result.memory_accounting) {
+            for (int p = 1; p < MemoryAccounting::PHASE_COUNT; ++p) {
+                const PhaseMemory& phase = result.phase_memory[p];
+                LOG_INFO("benchmark").field("phase", memoryPhaseName(static_cast<MemoryPhase>(p)))
+                                     .field("bytes", phase.bytes_allocated)
+                                     .field("allocations", phase.allocations)
+                                     .field("peak_live_bytes", phase.peak_live_bytes)
+                    << "  Memoria " << memoryPhaseName(static_cast<MemoryPhase>(p)) << ": "
+                    << phase.bytes_allocated << " bytes en " << phase.allocations << " reservas, pico vivo "
+                    << phase.peak_live_bytes << " bytes";
+            }
+        }
+        if (result.perf_available) {
+            for (int p = 1; p < MemoryAccounting::PHASE_COUNT; ++p) {
+                const PerfSample& counters = result.phase_counters[p];
+                LOG_INFO("benchmark").field("phase", memoryPhaseName(static_cast<MemoryPhase>(p)))
+                                     .field("instructions", counters.value(PerfEvent::INSTRUCTIONS))
+                                     .field("ipc", counters.ipc())
+                                     .field("cache_miss_rate", counters.cacheMissRate())
+                                     .field("branch_miss_rate", counters.branchMissRate())
+                    << "  Contadores " << memoryPhaseName(static_cast<MemoryPhase>(p)) << ": "
+                    << counters.value(PerfEvent::INSTRUCTIONS) << " instrucciones, IPC "
+                    << ratioValue(counters.ipc(), "n/d") << ", fallos de cache "
+                    << ratioValue(counters.cacheMissRate(), "n/d") << ", fallos de salto "
+                    << ratioValue(counters.branchMissRate(), "n/d");
+            }
+            LOG_INFO("benchmark").field("instructions_per_cell", result.instructions_per_cell)
+                << "  Instrucciones por celda DP: " << ratioValue(result.instructions_per_cell, "n/d");
+        }
+        LOG_INFO("benchmark") << "  Secuencias: " << result.num_sequences;
+        LOG_INFO("benchmark") << "  Gaps: " << result.gap_percentage << "%";
+        if (result.has_reference) {
+            LOG_INFO("benchmark").field("sp", result.accuracy_score).field("tc", result.tc_score)
+                << "  Precision vs referencia: SP " << result.accuracy_score << ", TC " << result.tc_score
+                << " (" << result.accuracy_ms << " ms)";
+        }
         
     } catch (const std::exception& e) {
-        std::cerr << "Error en benchmark: " << e.what() << std::endl;
+        LOG_ERROR("benchmark.error") << "Error en benchmark: " << e.what();
     }
     
     return result;
 }
 
-std::vector<BenchmarkResult> Benchmark::runMultipleBenchmarks(const std::vector<std::string>& dataset_paths) {
+std::vector<BenchmarkResult> Benchmark::runMultipleBenchmarks(const std::vector<std::string>& dataset_paths,
+                                                              const std::vector<std::string>& reference_paths) {
     std::vector<BenchmarkResult> results;
     
-    std::cout << "Ejecutando " << dataset_paths.size() << " benchmarks..." << std::endl;
+    LOG_INFO("benchmark") << "Ejecutando " << dataset_paths.size() << " benchmarks...";
     
     for (size_t i = 0; i < dataset_paths.size(); ++i) {
-        std::cout << "\\nBenchmark " << (i + 1) << "/" << dataset_paths.size() << ": " << dataset_paths[i] << std::endl;
+        LOG_INFO("benchmark") << "\nBenchmark " << (i + 1) << "/" << dataset_paths.size() << ": " << dataset_paths[i];
         
-        BenchmarkResult result = runSingleBenchmark(dataset_paths[i]);
+        std::string reference = i < reference_paths.size() ? reference_paths[i] : "";
+        BenchmarkResult result = runSingleBenchmark(dataset_paths[i], "", reference);
         results.push_back(result);
     }
     
     return results;
 }
 
-double Benchmark::compareWithReference(const std::string& alignment_path,
-                                     const std::string& reference_path) {
+AccuracyScore Benchmark::compareWithReference(const std::string& alignment_path,
+                                            const std::string& reference_path) {
     try {
         std::vector<Sequence> alignment = FastaIO::readFasta(alignment_path);
         std::vector<Sequence> reference = FastaIO::readFasta(reference_path);
         
-        return calculateAlignmentAccuracy(alignment, reference);
+        return AlignmentAccuracy::score(alignment, reference, pool);
     } catch (const std::exception& e) {
-        std::cerr << "Error comparando con referencia: " << e.what() << std::endl;
-        return 0.0;
+        LOG_ERROR("benchmark.error") << "Error comparando con referencia: " << e.what();
+        return AccuracyScore();
     }
 }
 
 void Benchmark::generateReport(const std::vector<BenchmarkResult>& results,
                               const std::string& output_file) {
-    std::ostream* out = &std::cout;
+    // Sin archivo, el reporte se arma en memoria y se emite como un solo registro
+    std::ostringstream console;
+    std::ostream* out = &console;
     std::ofstream file;
     
     if (!output_file.empty()) {
@@ -128,12 +368,23 @@ void Benchmark::generateReport(const std::vector<BenchmarkResult>& results,
         out = &file;
     }
     
-    *out << "\\n" << std::string(80, '=') << std::endl;
+    auto emitToConsole = [&console]() {
+        std::string report = console.str();
+        if (!report.empty() && report.back() == '\n') {
+            report.pop_back();
+        }
+        LOG_INFO("benchmark.report") << report;
+    };
+    
+    *out << "\n" << std::string(80, '=') << std::endl;
     *out << "REPORTE DE BENCHMARKS - MSA Aligner" << std::endl;
     *out << std::string(80, '=') << std::endl;
     
     if (results.empty()) {
         *out << "No hay resultados para mostrar." << std::endl;
+        if (!file.is_open()) {
+            emitToConsole();
+        }
         return;
     }
     
@@ -148,7 +399,7 @@ void Benchmark::generateReport(const std::vector<BenchmarkResult>& results,
         total_sequences += result.num_sequences;
     }
     
-    *out << "\\nRESUMEN GENERAL:" << std::endl;
+    *out << "\nRESUMEN GENERAL:" << std::endl;
     *out << "  Total de benchmarks: " << results.size() << std::endl;
     *out << "  Tiempo total: " << total_time << " ms" << std::endl;
     *out << "  Tiempo promedio: " << (total_time / results.size()) << " ms" << std::endl;
@@ -156,7 +407,7 @@ void Benchmark::generateReport(const std::vector<BenchmarkResult>& results,
     *out << "  Total secuencias procesadas: " << total_sequences << std::endl;
     
     // Resultados detallados
-    *out << "\\nRESULTADOS DETALLADOS:" << std::endl;
+    *out << "\nRESULTADOS DETALLADOS:" << std::endl;
     *out << std::string(80, '-') << std::endl;
     
     for (const auto& result : results) {
@@ -166,85 +417,732 @@ void Benchmark::generateReport(const std::vector<BenchmarkResult>& results,
         *out << "  Longitud original promedio: " << result.original_avg_length << std::endl;
         *out << "  Longitud final: " << result.final_length << std::endl;
         *out << "  Tiempo de ejecución: " << result.execution_time_ms << " ms" << std::endl;
+        *out << "  Etapas: distancias " << result.timings.distances_ms << " ms, árbol "
+             << result.timings.tree_ms << " ms, progresivo " << result.timings.progressive_ms
+             << " ms, filas " << result.timings.rows_ms << " ms" << std::endl;
+        *out << "  Subetapas (suma de hilos): DP " << result.timings.dp_fill_ms << " ms, traceback "
+             << result.timings.traceback_ms << " ms, consenso " << result.timings.consensus_ms
+             << " ms, unión de perfiles " << result.timings.profile_merge_ms << " ms" << std::endl;
+        *out << "  Celdas DP: " << result.timings.dp_cells << " en " << result.timings.dp_alignments
+             << " alineamientos (" << result.timings.gcups() << " GCUPS), pares de distancias: "
+             << result.timings.distance_pairs << std::endl;
         *out << "  Uso de memoria: " << result.memory_usage_mb << " MB" << std::endl;
+        *out << "  Reservas temporales: " << result.allocations << " (" << result.heap_allocations
+             << " al montículo, " << result.allocated_bytes << " bytes, "
+             << result.allocation_ms << " ms)" << std::endl;
+        if (result.memory_accounting) {
+            *out << "  Memoria por fase (bytes reservados / reservas / pico vivo):" << std::endl;
+            for (int p = 1; p < MemoryAccounting::PHASE_COUNT; ++p) {
+                const PhaseMemory& phase = result.phase_memory[p];
+                *out << "    " << std::left << std::setw(12) << memoryPhaseName(static_cast<MemoryPhase>(p))
+                     << std::right << phase.bytes_allocated << " / " << phase.allocations << " / "
+                     << phase.peak_live_bytes << std::endl;
+            }
+        }
+        if (result.perf_available) {
+            *out << "  Contadores por fase (ciclos / instrucciones / IPC / fallos de caché / fallos de salto):"
+                 << std::endl;
+            for (int p = 1; p < MemoryAccounting::PHASE_COUNT; ++p) {
+                const PerfSample& counters = result.phase_counters[p];
+                *out << "    " << std::left << std::setw(12) << memoryPhaseName(static_cast<MemoryPhase>(p))
+                     << std::right << counterValue(counters, PerfEvent::CYCLES, "n/d") << " / "
+                     << counterValue(counters, PerfEvent::INSTRUCTIONS, "n/d") << " / "
+                     << ratioValue(counters.ipc(), "n/d") << " / "
+                     << ratioValue(counters.cacheMissRate(), "n/d") << " / "
+                     << ratioValue(counters.branchMissRate(), "n/d") << std::endl;
+            }
+            *out << "  Instrucciones por celda DP: " << ratioValue(result.instructions_per_cell, "n/d") << std::endl;
+        }
         *out << "  Total de gaps: " << result.total_gaps << std::endl;
         *out << "  Porcentaje de gaps: " << std::fixed << std::setprecision(2) << result.gap_percentage << "%" << std::endl;
         
         if (result.has_reference) {
-            *out << "  Precisión vs referencia: " << std::fixed << std::setprecision(3) << result.accuracy_score << std::endl;
+            *out << "  Precisión vs referencia: SP " << std::fixed << std::setprecision(3) << result.accuracy_score
+                 << ", TC " << result.tc_score << std::endl;
         }
         
         *out << std::string(40, '-') << std::endl;
     }
     
     if (file.is_open()) {
-        std::cout << "Reporte guardado en: " << output_file << std::endl;
+        LOG_INFO("benchmark") << "Reporte guardado en: " << output_file;
+    } else {
+        emitToConsole();
     }
 }
 
 std::vector<BenchmarkResult> Benchmark::runScalabilityBenchmark(const std::vector<Sequence>& base_sequences,
                                                                int max_sequences,
                                                                int step) {
-    std::vector<BenchmarkResult> results;
+    ScalabilityOptions options;
+    options.max_sequences = max_sequences;
+    options.step = step;
+    options.lengths = {-1};     // Sin barrido en L: solo la longitud completa
+    options.repetitions = 1;
+    return runScalabilityStudy(base_sequences, options).runs;
+}
+
+ScalabilityStudy Benchmark::runScalabilityStudy(const std::vector<Sequence>& base_sequences,
+                                                const ScalabilityOptions& options) {
+    ScalabilityStudy study;
+    int step = std::max(1, options.step);
+    int repetitions = std::max(1, options.repetitions);
+    int available = static_cast<int>(base_sequences.size());
     
-    std::cout << "Ejecutando benchmark de escalabilidad..." << std::endl;
-    std::cout << "Desde " << step << " hasta " << max_sequences << " secuencias (step: " << step << ")" << std::endl;
+    LOG_INFO("benchmark") << "Ejecutando benchmark de escalabilidad...";
+    LOG_INFO("benchmark") << "Desde " << step << " hasta " << options.max_sequences << " secuencias (step: " << step
+                          << "), " << repetitions << " repeticiones por punto";
     
-    for (int n = step; n <= max_sequences && n <= static_cast<int>(base_sequences.size()); n += step) {
-        std::cout << "\\nProbando con " << n << " secuencias..." << std::endl;
-        
-        // Crear subset de secuencias
+    // Cada punto se alinea en memoria: sin archivos temporales ni lectura FASTA en el tiempo medido
+    auto measurePoint = [&](char axis, const std::vector<Sequence>& subset, const std::string& label) {
+        std::vector<BenchmarkResult> runs;
+        for (int r = 0; r < repetitions; ++r) {
+            BenchmarkResult result = runSequenceBenchmark(subset, label + "_r" + std::to_string(r + 1));
+            runs.push_back(result);
+            study.runs.push_back(result);
+        }
+        ScalabilityPoint point = medianPoint(runs);
+        point.axis = axis;
+        point.num_sequences = static_cast<int>(subset.size());
+        double residues = 0.0;
+        for (const auto& seq : subset) {
+            residues += seq.sequence.size();
+        }
+        point.avg_length = subset.empty() ? 0.0 : residues / subset.size();
+        study.points.push_back(point);
+    };
+    
+    for (int n = step; n <= options.max_sequences && n <= available; n += step) {
+        LOG_INFO("benchmark") << "\nProbando con " << n << " secuencias...";
         std::vector<Sequence> subset(base_sequences.begin(), base_sequences.begin() + n);
+        measurePoint('N', subset, "Scalability_" + std::to_string(n) + "_sequences");
+    }
+    
+    // Barrido en L: las mismas secuencias truncadas a cada longitud
+    int fixed = std::min(options.fixed_sequences > 0 ? options.fixed_sequences : step, available);
+    std::vector<int> lengths = options.lengths;
+    if (lengths.empty() && fixed > 0) {
+        size_t shortest = base_sequences[0].sequence.size();
+        for (int s = 1; s < fixed; ++s) {
+            shortest = std::min(shortest, base_sequences[s].sequence.size());
+        }
+        for (int divisor : {8, 4, 2, 1}) {
+            int length = static_cast<int>(shortest / divisor);
+            if (length >= 10 && (lengths.empty() || lengths.back() != length)) {
+                lengths.push_back(length);
+            }
+        }
+    }
+    for (int length : lengths) {
+        if (length <= 0 || fixed < 2) {
+            continue;
+        }
+        LOG_INFO("benchmark") << "\nProbando con " << fixed << " secuencias de longitud " << length << "...";
+        std::vector<Sequence> subset(base_sequences.begin(), base_sequences.begin() + fixed);
+        for (auto& seq : subset) {
+            seq.sequence.resize(std::min(seq.sequence.size(), static_cast<size_t>(length)));
+        }
+        measurePoint('L', subset, "Scalability_" + std::to_string(fixed) + "_sequences_L" + std::to_string(length));
+    }
+    
+    study.fits = fitScaling(study.points);
+    for (const auto& fit : study.fits) {
+        LOG_INFO("benchmark").field("axis", std::string(1, fit.axis)).field("stage", fit.stage)
+                             .field("exponent", fit.exponent).field("r_squared", fit.r_squared)
+            << "  " << fit.stage << " ~ " << fit.axis << "^" << std::fixed << std::setprecision(2)
+            << fit.exponent << " (R2 " << fit.r_squared << ", " << fit.points << " puntos)";
+    }
+    return study;
+}
+
+std::vector<ThreadScalingPoint> Benchmark::runThreadScaling(const std::vector<Sequence>& sequences,
+                                                            const ThreadScalingOptions& options) {
+    std::vector<ThreadScalingPoint> points;
+    std::vector<int> thread_counts = options.threads;
+    if (thread_counts.empty()) {
+        int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int t = 1; t < cores; t *= 2) {
+            thread_counts.push_back(t);
+        }
+        thread_counts.push_back(cores);
+    }
+    // Siempre se mide un hilo: es la base del speedup
+    thread_counts.erase(std::remove_if(thread_counts.begin(), thread_counts.end(),
+                                       [](int t) { return t < 1; }), thread_counts.end());
+    thread_counts.push_back(1);
+    std::sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+    int repetitions = std::max(1, options.repetitions);
+    
+    // Un hilo se ejecuta sin pool (como el alineador con -t 1); con más, un pool nuevo por punto
+    auto measure = [&](const std::string& mode, int threads, const std::vector<Sequence>& subset) {
+        std::unique_ptr<ThreadPool> pool;
+        if (threads > 1) {
+            pool = std::make_unique<ThreadPool>(threads);
+        }
+        setThreadPool(pool.get());
         
-        // Crear archivo temporal
-        std::string temp_file = "temp_scalability_" + std::to_string(n) + ".fasta";
-        FastaIO::writeFasta(subset, temp_file);
-        
-        // Ejecutar benchmark
-        BenchmarkResult result = runSingleBenchmark(temp_file);
-        result.dataset_name = "Scalability_" + std::to_string(n) + "_sequences";
-        
-        results.push_back(result);
+        std::vector<BenchmarkResult> runs;
+        std::vector<double> busy, wall;
+        std::vector<uint64_t> tasks;
+        for (int r = 0; r < repetitions; ++r) {
+            if (pool) {
+                pool->resetStats();
+            }
+            runs.push_back(runSequenceBenchmark(subset, "Threads_" + mode + "_" + std::to_string(threads) +
+                                                        "_r" + std::to_string(r + 1)));
+            if (pool) {
+                ThreadPoolStats stats = pool->stats();
+                busy.push_back(stats.busy_ms);
+                wall.push_back(stats.wall_ms);
+                tasks.push_back(stats.tasks);
+            }
+        }
+        setThreadPool(nullptr);
         
-        // Limpiar archivo temporal
-        std::remove(temp_file.c_str());
+        ScalabilityPoint medians = medianPoint(runs);
+        ThreadScalingPoint point;
+        point.mode = mode;
+        point.threads = threads;
+        point.num_sequences = static_cast<int>(subset.size());
+        point.repetitions = repetitions;
+        point.execution_time_ms = medians.execution_time_ms;
+        point.timings = medians.timings;
+        if (pool) {
+            point.pool.workers = pool->size();
+            point.pool.busy_ms = median(busy);
+            point.pool.wall_ms = median(wall);
+            point.pool.tasks = median(tasks);
+        }
+        return point;
+    };
+    
+    // Fuerte: speedup T1/Tp y eficiencia speedup/p. Débil: el trabajo crece con los
+    // hilos, así que la eficiencia es T1/Tp y el speedup escalado p·T1/Tp. La base
+    // es el primer punto de la serie y p se mide en múltiplos de sus hilos
+    auto finish = [&](std::vector<ThreadScalingPoint>& series) {
+        if (series.empty()) {
+            return;
+        }
+        const double base = series.front().execution_time_ms;
+        const double base_threads = series.front().threads;
+        const bool weak = series.front().mode == "weak";
+        for (auto& point : series) {
+            double scale = point.threads / base_threads;
+            double ratio = point.execution_time_ms > 0.0 ? base / point.execution_time_ms : 0.0;
+            if (weak) {
+                point.efficiency = ratio;
+                point.speedup = scale * ratio;
+            } else {
+                point.speedup = ratio;
+                point.efficiency = ratio / scale;
+            }
+            LOG_INFO("benchmark").field("mode", point.mode).field("threads", point.threads)
+                                 .field("speedup", point.speedup).field("efficiency", point.efficiency)
+                                 .field("pool_idle_ms", point.pool.idleMs())
+                << "  " << point.mode << " " << point.threads << " hilos, " << point.num_sequences
+                << " secuencias: " << point.execution_time_ms << " ms, speedup " << point.speedup
+                << ", eficiencia " << point.efficiency;
+            LOG_INFO("benchmark") << "    Etapas (ms): distancias " << point.timings.distances_ms << ", arbol "
+                                  << point.timings.tree_ms << ", progresivo " << point.timings.progressive_ms
+                                  << ", filas " << point.timings.rows_ms;
+            if (point.pool.workers > 0) {
+                LOG_INFO("benchmark") << "    Pool: " << point.pool.tasks << " tareas, ocupado "
+                                      << point.pool.busy_ms << " ms, ocioso " << point.pool.idleMs()
+                                      << " ms (utilizacion " << point.pool.utilization() * 100.0 << "%)";
+            }
+            points.push_back(point);
+        }
+    };
+    
+    if (options.strong) {
+        LOG_INFO("benchmark") << "\nEscalado fuerte: " << sequences.size() << " secuencias";
+        std::vector<ThreadScalingPoint> series;
+        for (int threads : thread_counts) {
+            series.push_back(measure("strong", threads, sequences));
+        }
+        finish(series);
     }
     
-    return results;
+    if (options.weak && !sequences.empty()) {
+        int max_threads = thread_counts.back();
+        int per_thread = options.weak_base_sequences > 0
+                             ? options.weak_base_sequences
+                             : std::max(2, static_cast<int>(sequences.size()) / max_threads);
+        LOG_INFO("benchmark") << "\nEscalado debil: " << per_thread << " secuencias por hilo";
+        if (static_cast<size_t>(per_thread) * max_threads > sequences.size()) {
+            LOG_WARN("benchmark.weak").field("needed", per_thread * max_threads).field("available", sequences.size())
+                << "Advertencia: El dataset tiene menos de " << per_thread * max_threads
+                << " secuencias; se repiten para el escalado debil";
+        }
+        std::vector<ThreadScalingPoint> series;
+        for (int threads : thread_counts) {
+            std::vector<Sequence> subset;
+            for (int s = 0; s < per_thread * threads; ++s) {
+                Sequence seq = sequences[s % sequences.size()];
+                if (static_cast<size_t>(s) >= sequences.size()) {
+                    seq.header += "_copia" + std::to_string(s / sequences.size());
+                }
+                subset.push_back(seq);
+            }
+            series.push_back(measure("weak", threads, subset));
+        }
+        finish(series);
+    }
+    return points;
 }
 
-void Benchmark::createSyntheticDataset(int num_sequences, int base_length,
-                                      double mutation_rate, const std::string& output_path) {
-    std::vector<Sequence> synthetic_sequences;
+void Benchmark::exportThreadScaling(const std::vector<ThreadScalingPoint>& points, const std::string& csv_file,
+                                   const std::string& json_file) {
+    // Solo las etapas de pared tienen speedup propio; las subetapas suman tiempo de todos los hilos
+    const ScalingStage* wall_stages = SCALING_STAGES;
+    const size_t wall_stage_count = 4;
+    // La base es el primer punto de cada serie, igual que en el speedup total
+    auto stageSpeedup = [&](const ThreadScalingPoint& point, const ScalingStage& stage) {
+        for (const auto& base : points) {
+            if (base.mode == point.mode) {
+                double t = point.timings.*stage.field;
+                return t > 0.0 ? (base.timings.*stage.field) / t : 0.0;
+            }
+        }
+        return 0.0;
+    };
     
-    // Generar secuencia base aleatoria
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 3);
+    std::ofstream file(csv_file);
+    if (!file.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo CSV " << csv_file;
+        return;
+    }
+    file << "Mode,Threads,NumSequences,Repetitions,ExecutionTime_ms,Speedup,Efficiency";
+    for (const ScalingStage& stage : SCALING_STAGES) {
+        file << "," << stage.name << "_ms";
+    }
+    for (size_t s = 0; s < wall_stage_count; ++s) {
+        file << "," << wall_stages[s].name << "_speedup";
+    }
+    file << ",PoolTasks,PoolBusy_ms,PoolIdle_ms,PoolUtilization\n";
+    for (const auto& point : points) {
+        file << point.mode << "," << point.threads << "," << point.num_sequences << "," << point.repetitions << ","
+             << point.execution_time_ms << "," << point.speedup << "," << point.efficiency;
+        for (const ScalingStage& stage : SCALING_STAGES) {
+            file << "," << point.timings.*stage.field;
+        }
+        for (size_t s = 0; s < wall_stage_count; ++s) {
+            file << "," << stageSpeedup(point, wall_stages[s]);
+        }
+        file << "," << point.pool.tasks << "," << point.pool.busy_ms << "," << point.pool.idleMs() << ","
+             << point.pool.utilization() << "\n";
+    }
     
-    std::string bases = "ATCG";
-    std::string base_sequence;
+    std::ofstream json(json_file);
+    if (!json.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo JSON " << json_file;
+        return;
+    }
+    json << "[";
+    for (size_t i = 0; i < points.size(); ++i) {
+        const ThreadScalingPoint& point = points[i];
+        json << (i > 0 ? ",\n" : "\n") << "  {\"mode\": " << jsonString(point.mode) << ", \"threads\": "
+             << point.threads << ", \"num_sequences\": " << point.num_sequences << ", \"repetitions\": "
+             << point.repetitions << ", \"execution_time_ms\": " << point.execution_time_ms
+             << ", \"speedup\": " << point.speedup << ", \"efficiency\": " << point.efficiency << ",\n   \"stages_ms\": {";
+        for (size_t s = 0; s < sizeof(SCALING_STAGES) / sizeof(SCALING_STAGES[0]); ++s) {
+            json << (s > 0 ? ", " : "") << jsonString(SCALING_STAGES[s].name) << ": "
+                 << point.timings.*SCALING_STAGES[s].field;
+        }
+        json << "},\n   \"stage_speedup\": {";
+        for (size_t s = 0; s < wall_stage_count; ++s) {
+            json << (s > 0 ? ", " : "") << jsonString(wall_stages[s].name) << ": "
+                 << stageSpeedup(point, wall_stages[s]);
+        }
+        json << "},\n   \"pool\": {\"workers\": " << point.pool.workers << ", \"tasks\": " << point.pool.tasks
+             << ", \"busy_ms\": " << point.pool.busy_ms << ", \"idle_ms\": " << point.pool.idleMs()
+             << ", \"utilization\": " << point.pool.utilization() << "}}";
+    }
+    json << "\n]\n";
     
-    for (int i = 0; i < base_length; ++i) {
-        base_sequence += bases[dis(gen)];
+    LOG_INFO("benchmark") << "Escalabilidad en hilos exportada a: " << csv_file << " y " << json_file;
+}
+
+double ScalingFit::predict(double x) const {
+    return x > 0.0 ? coefficient * std::pow(x, exponent) : 0.0;
+}
+
+std::vector<ScalingFit> Benchmark::fitScaling(const std::vector<ScalabilityPoint>& points) {
+    std::vector<ScalingFit> fits;
+    for (char axis : {'N', 'L'}) {
+        for (const ScalingStage& stage : SCALING_STAGES) {
+            // Regresión lineal de log(t) sobre log(x)
+            std::vector<std::pair<double, double>> samples;
+            for (const auto& point : points) {
+                double x = axis == 'N' ? point.num_sequences : point.avg_length;
+                double t = point.timings.*stage.field;
+                if (point.axis == axis && x > 0.0 && t > 0.0) {
+                    samples.emplace_back(std::log(x), std::log(t));
+                }
+            }
+            if (samples.size() < 2) {
+                continue;
+            }
+            double mean_x = 0.0, mean_y = 0.0;
+            for (const auto& s : samples) {
+                mean_x += s.first;
+                mean_y += s.second;
+            }
+            mean_x /= samples.size();
+            mean_y /= samples.size();
+            double sxx = 0.0, sxy = 0.0, syy = 0.0;
+            for (const auto& s : samples) {
+                sxx += (s.first - mean_x) * (s.first - mean_x);
+                sxy += (s.first - mean_x) * (s.second - mean_y);
+                syy += (s.second - mean_y) * (s.second - mean_y);
+            }
+            if (sxx <= 0.0) {
+                continue;
+            }
+            ScalingFit fit;
+            fit.axis = axis;
+            fit.stage = stage.name;
+            fit.exponent = sxy / sxx;
+            fit.coefficient = std::exp(mean_y - fit.exponent * mean_x);
+            fit.r_squared = syy > 0.0 ? (sxy * sxy) / (sxx * syy) : 1.0;
+            fit.points = samples.size();
+            fits.push_back(fit);
+        }
+    }
+    return fits;
+}
+
+void Benchmark::exportScalabilityStudy(const ScalabilityStudy& study, const std::string& points_csv,
+                                       const std::string& fits_csv, const std::string& json_file) {
+    std::ofstream points_file(points_csv);
+    if (!points_file.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo CSV " << points_csv;
+        return;
+    }
+    points_file << "Axis,NumSequences,AvgLength,Repetitions,ExecutionTime_ms";
+    for (const ScalingStage& stage : SCALING_STAGES) {
+        points_file << "," << stage.name << "_ms";
+    }
+    points_file << ",DistancePairs,DPAlignments,DPCells\n";
+    for (const auto& point : study.points) {
+        points_file << point.axis << "," << point.num_sequences << "," << point.avg_length << ","
+                    << point.repetitions << "," << point.execution_time_ms;
+        for (const ScalingStage& stage : SCALING_STAGES) {
+            points_file << "," << point.timings.*stage.field;
+        }
+        points_file << "," << point.timings.distance_pairs << "," << point.timings.dp_alignments << ","
+                    << point.timings.dp_cells << "\n";
     }
     
-    // Crear secuencias mutadas
-    for (int i = 0; i < num_sequences; ++i) {
-        Sequence seq;
-        seq.header = "Synthetic_Seq_" + std::to_string(i + 1) + " | Generated with mutation rate " + std::to_string(mutation_rate);
-        seq.sequence = mutateSequence(base_sequence, mutation_rate);
+    std::ofstream fits_file(fits_csv);
+    if (!fits_file.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo CSV " << fits_csv;
+        return;
+    }
+    fits_file << "Axis,Stage,Exponent,Coefficient_ms,RSquared,Points\n";
+    for (const auto& fit : study.fits) {
+        fits_file << fit.axis << "," << fit.stage << "," << fit.exponent << "," << fit.coefficient << ","
+                  << fit.r_squared << "," << fit.points << "\n";
+    }
+    
+    std::ofstream json(json_file);
+    if (!json.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo JSON " << json_file;
+        return;
+    }
+    json << "{\n  \"points\": [";
+    for (size_t i = 0; i < study.points.size(); ++i) {
+        const ScalabilityPoint& point = study.points[i];
+        json << (i > 0 ? ",\n" : "\n") << "    {\"axis\": \"" << point.axis << "\", \"num_sequences\": "
+             << point.num_sequences << ", \"avg_length\": " << point.avg_length << ", \"repetitions\": "
+             << point.repetitions << ", \"execution_time_ms\": " << point.execution_time_ms;
+        for (const ScalingStage& stage : SCALING_STAGES) {
+            json << ", " << jsonString(std::string(stage.name) + "_ms") << ": " << point.timings.*stage.field;
+        }
+        json << ", \"distance_pairs\": " << point.timings.distance_pairs << ", \"dp_alignments\": "
+             << point.timings.dp_alignments << ", \"dp_cells\": " << point.timings.dp_cells << "}";
+    }
+    json << "\n  ],\n  \"fits\": [";
+    for (size_t i = 0; i < study.fits.size(); ++i) {
+        const ScalingFit& fit = study.fits[i];
+        json << (i > 0 ? ",\n" : "\n") << "    {\"axis\": \"" << fit.axis << "\", \"stage\": "
+             << jsonString(fit.stage) << ", \"exponent\": " << fit.exponent << ", \"coefficient_ms\": "
+             << fit.coefficient << ", \"r_squared\": " << fit.r_squared << ", \"points\": " << fit.points << "}";
+    }
+    json << "\n  ]\n}\n";
+    
+    LOG_INFO("benchmark") << "Curvas de escalabilidad exportadas a: " << points_csv << ", " << fits_csv
+                          << " y " << json_file;
+}
+
+bool Benchmark::createSyntheticDataset(const SyntheticOptions& options, const std::string& output_path,
+                                      const std::string& alignment_path, ThreadPool* pool) {
+    SyntheticGenerator generator(options, pool);
+    if (!generator.generateToFiles(output_path, alignment_path)) {
+        return false;
+    }
+    
+    LOG_INFO("benchmark") << "Dataset sintético creado: " << output_path;
+    if (!alignment_path.empty()) {
+        LOG_INFO("benchmark") << "  Alineamiento verdadero: " << alignment_path << " ("
+                              << generator.summary().columns << " columnas)";
+    }
+    LOG_INFO("benchmark") << "  Secuencias: " << options.num_sequences;
+    LOG_INFO("benchmark") << "  Longitud base: " << options.length;
+    LOG_INFO("benchmark") << "  Divergencia raiz-hoja: " << options.divergence;
+    LOG_INFO("benchmark") << "  Semilla: " << options.seed;
+    LOG_INFO("benchmark") << "  Tiempo: " << generator.summary().seconds << " s";
+    return true;
+}
+
+bool Benchmark::syntheticTier(const std::string& tier, ParetoDataset& dataset, ThreadPool* pool) {
+    SyntheticOptions options;
+    options.divergence = 0.2;
+    if (tier == "small") {
+        options.num_sequences = 16;
+        options.length = 150;
+    } else if (tier == "medium") {
+        options.num_sequences = 48;
+        options.length = 300;
+    } else if (tier == "large") {
+        options.num_sequences = 128;
+        options.length = 400;
+    } else {
+        LOG_ERROR("benchmark.error") << "Error: Nivel sintetico desconocido '" << tier
+                                     << "' (small, medium, large)";
+        return false;
+    }
+    
+    SyntheticGenerator generator(options, pool);
+    dataset.name = "synthetic_" + tier;
+    dataset.size_class = tier;
+    return generator.generate(dataset.sequences, &dataset.reference);
+}
+
+ParetoStudy Benchmark::runParetoStudy(const std::vector<ParetoDataset>& datasets, const ParetoOptions& options) {
+    ParetoStudy study;
+    // Solo participan los presets cuyos engines están registrados
+    const AlignerPreset selected = aligner.getPreset();
+    std::vector<AlignerPreset> presets;
+    for (const auto& preset : options.presets.empty() ? AlignerPreset::all() : options.presets) {
+        if (aligner.setPreset(preset)) {
+            presets.push_back(preset);
+        }
+    }
+    int repetitions = std::max(1, options.repetitions);
+    
+    for (const auto& dataset : datasets) {
+        if (dataset.sequences.size() < 2 || dataset.reference.empty()) {
+            LOG_WARN("benchmark") << "Advertencia: " << dataset.name << " no tiene secuencias o referencia; se omite";
+            continue;
+        }
+        std::string size_class = dataset.size_class;
+        if (size_class.empty()) {
+            size_class = dataset.sequences.size() < 100 ? "small" : dataset.sequences.size() < 1000 ? "medium" : "large";
+        }
+        auto stats = calculateSequenceStats(dataset.sequences);
+        
+        size_t first = study.points.size();
+        for (const auto& preset : presets) {
+            LOG_INFO("benchmark") << "\nPreset " << preset.name() << " sobre " << dataset.name;
+            aligner.setPreset(preset);
+            std::vector<BenchmarkResult> runs;
+            for (int r = 0; r < repetitions; ++r) {
+                // Cada ejecución parte sin workspace ni arena retenidos: el pico incluye la matriz DP
+                aligner.releaseMemory();
+                runs.push_back(runSequenceBenchmark(dataset.sequences, dataset.name, &dataset.reference));
+            }
+            
+            ParetoPoint point;
+            point.dataset = dataset.name;
+            point.size_class = size_class;
+            point.preset = preset.name();
+            point.num_sequences = static_cast<int>(dataset.sequences.size());
+            point.avg_length = static_cast<int>(stats["avg_length"]);
+            point.repetitions = repetitions;
+            point.execution_time_ms = medianPoint(runs).execution_time_ms;
+            const BenchmarkResult& run = runs.front();
+            std::vector<size_t> peaks;
+            for (const auto& repetition : runs) {
+                size_t peak = 0;
+                for (const auto& phase : repetition.phase_memory) {
+                    peak = std::max<size_t>(peak, phase.peak_live_bytes);
+                }
+                peaks.push_back(repetition.memory_accounting ? peak : repetition.memory_usage_mb * 1024 * 1024);
+            }
+            point.peak_memory_bytes = median(peaks);
+            point.sp_score = run.accuracy_score;
+            point.tc_score = run.tc_score;
+            study.points.push_back(point);
+        }
+        
+        // Frontera dentro del dataset: menos tiempo, menos memoria y más SP
+        std::vector<std::vector<double>> full_costs, speed_costs;
+        for (size_t p = first; p < study.points.size(); ++p) {
+            const ParetoPoint& point = study.points[p];
+            full_costs.push_back({point.execution_time_ms, static_cast<double>(point.peak_memory_bytes), -point.sp_score});
+            speed_costs.push_back({point.execution_time_ms, -point.sp_score});
+        }
+        std::vector<bool> full_front = nonDominated(full_costs);
+        std::vector<bool> speed_front = nonDominated(speed_costs);
+        for (size_t p = first; p < study.points.size(); ++p) {
+            study.points[p].pareto = full_front[p - first];
+            study.points[p].pareto_speed = speed_front[p - first];
+        }
+    }
+    aligner.setPreset(selected);
+    
+    // Resumen por clase: tiempos y memoria relativos al mejor preset de cada dataset
+    std::map<std::string, double> fastest, smallest;
+    for (const auto& point : study.points) {
+        auto time = fastest.find(point.dataset);
+        if (time == fastest.end() || point.execution_time_ms < time->second) {
+            fastest[point.dataset] = point.execution_time_ms;
+        }
+        auto memory = smallest.find(point.dataset);
+        if (memory == smallest.end() || point.peak_memory_bytes < memory->second) {
+            smallest[point.dataset] = static_cast<double>(point.peak_memory_bytes);
+        }
+    }
+    std::vector<std::string> classes;
+    for (const auto& point : study.points) {
+        if (std::find(classes.begin(), classes.end(), point.size_class) == classes.end()) {
+            classes.push_back(point.size_class);
+        }
+    }
+    for (const auto& size_class : classes) {
+        size_t first = study.classes.size();
+        for (const auto& preset : presets) {
+            ParetoClassSummary summary;
+            summary.size_class = size_class;
+            summary.preset = preset.name();
+            double log_time = 0.0, log_memory = 0.0;
+            for (const auto& point : study.points) {
+                if (point.size_class != size_class || point.preset != summary.preset) {
+                    continue;
+                }
+                // Los desplazamientos evitan razones indefinidas con tiempos o picos nulos
+                log_time += std::log((point.execution_time_ms + 1e-3) / (fastest[point.dataset] + 1e-3));
+                log_memory += std::log((point.peak_memory_bytes + 1.0) / (smallest[point.dataset] + 1.0));
+                summary.sp_score += point.sp_score;
+                summary.tc_score += point.tc_score;
+                ++summary.datasets;
+            }
+            if (summary.datasets == 0) {
+                continue;
+            }
+            summary.time_ratio = std::exp(log_time / summary.datasets);
+            summary.memory_ratio = std::exp(log_memory / summary.datasets);
+            summary.sp_score /= summary.datasets;
+            summary.tc_score /= summary.datasets;
+            study.classes.push_back(summary);
+        }
         
-        synthetic_sequences.push_back(seq);
+        std::vector<std::vector<double>> costs;
+        double best_sp = 0.0;
+        for (size_t s = first; s < study.classes.size(); ++s) {
+            costs.push_back({study.classes[s].time_ratio, -study.classes[s].sp_score});
+            best_sp = std::max(best_sp, study.classes[s].sp_score);
+        }
+        std::vector<bool> front = nonDominated(costs);
+        ParetoClassSummary* recommended = nullptr;
+        for (size_t s = first; s < study.classes.size(); ++s) {
+            ParetoClassSummary& summary = study.classes[s];
+            summary.pareto = front[s - first];
+            if (summary.pareto && summary.sp_score >= best_sp - options.sp_tolerance &&
+                (!recommended || summary.time_ratio < recommended->time_ratio)) {
+                recommended = &summary;
+            }
+        }
+        if (recommended) {
+            recommended->recommended = true;
+        }
     }
     
-    // Guardar dataset
-    FastaIO::writeFasta(synthetic_sequences, output_path);
+    return study;
+}
+
+void Benchmark::printParetoStudy(const ParetoStudy& study) {
+    std::ostringstream table;
+    table << "\nBENCHMARK DE PRESETS (* = frontera tiempo/memoria/SP, + = frontera tiempo/SP)\n";
+    std::string dataset;
+    for (const auto& point : study.points) {
+        if (point.dataset != dataset) {
+            dataset = point.dataset;
+            table << "\n" << dataset << " (" << point.size_class << ", " << point.num_sequences << " x "
+                  << point.avg_length << ")\n";
+            table << "  " << std::left << std::setw(42) << "Preset" << std::right << std::setw(12) << "Tiempo ms"
+                  << std::setw(14) << "Pico KB" << std::setw(8) << "SP" << std::setw(8) << "TC" << "\n";
+        }
+        table << (point.pareto ? "* " : "  ") << std::left << std::setw(41) << point.preset
+              << (point.pareto_speed ? "+" : " ") << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << point.execution_time_ms << std::setw(14) << point.peak_memory_bytes / 1024
+              << std::setprecision(3) << std::setw(8) << point.sp_score << std::setw(8) << point.tc_score << "\n";
+    }
     
-    std::cout << "Dataset sintético creado: " << output_path << std::endl;
-    std::cout << "  Secuencias: " << num_sequences << std::endl;
-    std::cout << "  Longitud base: " << base_length << std::endl;
-    std::cout << "  Tasa de mutación: " << mutation_rate << std::endl;
+    table << "\nPOR CLASE DE TAMANO (tiempo y memoria relativos al mejor preset de cada dataset; <- recomendado)\n";
+    std::string size_class;
+    for (const auto& summary : study.classes) {
+        if (summary.size_class != size_class) {
+            size_class = summary.size_class;
+            table << "\n" << size_class << " (" << summary.datasets << " datasets)\n";
+            table << "  " << std::left << std::setw(42) << "Preset" << std::right << std::setw(10) << "Tiempo x"
+                  << std::setw(10) << "Memoria x" << std::setw(8) << "SP" << std::setw(8) << "TC" << "\n";
+        }
+        table << (summary.pareto ? "* " : "  ") << std::left << std::setw(42) << summary.preset << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10) << summary.time_ratio << std::setw(10)
+              << summary.memory_ratio << std::setprecision(3) << std::setw(8) << summary.sp_score << std::setw(8)
+              << summary.tc_score << (summary.recommended ? "  <-" : "") << "\n";
+    }
+    std::string text = table.str();
+    text.pop_back();
+    LOG_INFO("benchmark.report") << text;
+    
+    for (const auto& summary : study.classes) {
+        if (summary.recommended) {
+            LOG_INFO("benchmark").field("size_class", summary.size_class).field("preset", summary.preset)
+                << "Preset recomendado para " << summary.size_class << ": " << summary.preset;
+        }
+    }
+}
+
+void Benchmark::exportParetoStudy(const ParetoStudy& study, const std::string& points_csv,
+                                  const std::string& classes_csv) {
+    std::ofstream points(points_csv);
+    if (!points.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo CSV " << points_csv;
+        return;
+    }
+    points << "Dataset,SizeClass,Preset,Distance,Tree,Pairwise,Merge,Refinement,NumSequences,AvgLength,Repetitions,"
+           << "ExecutionTime_ms,PeakMemoryBytes,SPScore,TCScore,Pareto,ParetoSpeed\n";
+    for (const auto& point : study.points) {
+        // El nombre del preset ya separa las etapas con '/'
+        std::string stages = point.preset;
+        std::replace(stages.begin(), stages.end(), '/', ',');
+        points << point.dataset << "," << point.size_class << "," << point.preset << "," << stages << ","
+               << point.num_sequences << "," << point.avg_length << "," << point.repetitions << ","
+               << point.execution_time_ms << "," << point.peak_memory_bytes << "," << point.sp_score << ","
+               << point.tc_score << "," << (point.pareto ? "true" : "false") << ","
+               << (point.pareto_speed ? "true" : "false") << "\n";
+    }
+    points.close();
+    LOG_INFO("benchmark") << "Resultados exportados a CSV: " << points_csv;
+    
+    std::ofstream classes(classes_csv);
+    if (!classes.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo CSV " << classes_csv;
+        return;
+    }
+    classes << "SizeClass,Preset,Datasets,TimeRatio,MemoryRatio,SPScore,TCScore,Pareto,Recommended\n";
+    for (const auto& summary : study.classes) {
+        classes << summary.size_class << "," << summary.preset << "," << summary.datasets << ","
+                << summary.time_ratio << "," << summary.memory_ratio << "," << summary.sp_score << ","
+                << summary.tc_score << "," << (summary.pareto ? "true" : "false") << ","
+                << (summary.recommended ? "true" : "false") << "\n";
+    }
+    classes.close();
+    LOG_INFO("benchmark") << "Resumen por clase exportado a CSV: " << classes_csv;
 }
 
 void Benchmark::exportToCSV(const std::vector<BenchmarkResult>& results,
@@ -252,14 +1150,31 @@ void Benchmark::exportToCSV(const std::vector<BenchmarkResult>& results,
     std::ofstream file(csv_file);
     
     if (!file.is_open()) {
-        std::cerr << "Error: No se pudo crear el archivo CSV " << csv_file << std::endl;
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo CSV " << csv_file;
         return;
     }
     
     // Header CSV
     file << "Dataset,Timestamp,NumSequences,OriginalAvgLength,FinalLength,";
     file << "ExecutionTime_ms,MemoryUsage_MB,TotalGaps,GapPercentage,";
-    file << "AccuracyScore,HasReference\\n";
+    file << "AccuracyScore,TCScore,AccuracyTime_ms,HasReference,";
+    file << "Allocations,HeapAllocations,AllocatedBytes,AllocationTime_ms,";
+    file << "DistancesTime_ms,TreeTime_ms,ProgressiveTime_ms,RowsTime_ms,AlignTime_ms,";
+    file << "DPFillTime_ms,TracebackTime_ms,ConsensusTime_ms,ProfileMergeTime_ms,";
+    file << "DistancePairs,DPAlignments,DPCells,GCUPS";
+    for (int p = 0; p < MemoryAccounting::PHASE_COUNT; ++p) {
+        std::string phase = phaseColumn(p);
+        file << "," << phase << "AllocBytes," << phase << "Allocs," << phase << "PeakLiveBytes";
+    }
+    // Contadores de hardware: celdas vacías si no están disponibles
+    for (int p = 0; p < MemoryAccounting::PHASE_COUNT; ++p) {
+        std::string phase = phaseColumn(p);
+        file << "," << phase << "Cycles," << phase << "Instructions," << phase << "IPC,"
+             << phase << "CacheMisses," << phase << "CacheMissRate,"
+             << phase << "BranchMisses," << phase << "BranchMissRate";
+    }
+    file << ",InstructionsPerCell";
+    file << "\n";
     
     // Datos
     for (const auto& result : results) {
@@ -273,11 +1188,132 @@ void Benchmark::exportToCSV(const std::vector<BenchmarkResult>& results,
         file << result.total_gaps << ",";
         file << result.gap_percentage << ",";
         file << result.accuracy_score << ",";
-        file << (result.has_reference ? "true" : "false") << "\\n";
+        file << result.tc_score << ",";
+        file << result.accuracy_ms << ",";
+        file << (result.has_reference ? "true" : "false") << ",";
+        file << result.allocations << ",";
+        file << result.heap_allocations << ",";
+        file << result.allocated_bytes << ",";
+        file << result.allocation_ms << ",";
+        file << result.timings.distances_ms << ",";
+        file << result.timings.tree_ms << ",";
+        file << result.timings.progressive_ms << ",";
+        file << result.timings.rows_ms << ",";
+        file << result.timings.total_ms << ",";
+        file << result.timings.dp_fill_ms << ",";
+        file << result.timings.traceback_ms << ",";
+        file << result.timings.consensus_ms << ",";
+        file << result.timings.profile_merge_ms << ",";
+        file << result.timings.distance_pairs << ",";
+        file << result.timings.dp_alignments << ",";
+        file << result.timings.dp_cells << ",";
+        file << result.timings.gcups();
+        for (const auto& phase : result.phase_memory) {
+            file << "," << phase.bytes_allocated << "," << phase.allocations << "," << phase.peak_live_bytes;
+        }
+        for (const auto& counters : result.phase_counters) {
+            file << "," << counterValue(counters, PerfEvent::CYCLES, "");
+            file << "," << counterValue(counters, PerfEvent::INSTRUCTIONS, "");
+            file << "," << ratioValue(counters.ipc(), "");
+            file << "," << counterValue(counters, PerfEvent::CACHE_MISSES, "");
+            file << "," << ratioValue(counters.cacheMissRate(), "");
+            file << "," << counterValue(counters, PerfEvent::BRANCH_MISSES, "");
+            file << "," << ratioValue(counters.branchMissRate(), "");
+        }
+        file << "," << ratioValue(result.instructions_per_cell, "");
+        file << "\n";
     }
     
     file.close();
-    std::cout << "Resultados exportados a CSV: " << csv_file << std::endl;
+    LOG_INFO("benchmark") << "Resultados exportados a CSV: " << csv_file;
+}
+
+void Benchmark::exportToJSON(const std::vector<BenchmarkResult>& results,
+                             const std::string& json_file) {
+    std::ofstream file(json_file);
+    
+    if (!file.is_open()) {
+        LOG_ERROR("benchmark.error") << "Error: No se pudo crear el archivo JSON " << json_file;
+        return;
+    }
+    
+    file << "[";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const BenchmarkResult& result = results[r];
+        const AlignmentTimings& timings = result.timings;
+        file << (r > 0 ? ",\n" : "\n");
+        file << "  {\n";
+        file << "    \"dataset\": " << jsonString(result.dataset_name) << ",\n";
+        file << "    \"timestamp\": " << jsonString(result.timestamp) << ",\n";
+        file << "    \"num_sequences\": " << result.num_sequences << ",\n";
+        file << "    \"original_avg_length\": " << result.original_avg_length << ",\n";
+        file << "    \"final_length\": " << result.final_length << ",\n";
+        file << "    \"execution_time_ms\": " << result.execution_time_ms << ",\n";
+        file << "    \"memory_usage_mb\": " << result.memory_usage_mb << ",\n";
+        file << "    \"total_gaps\": " << result.total_gaps << ",\n";
+        file << "    \"gap_percentage\": " << result.gap_percentage << ",\n";
+        file << "    \"accuracy_score\": " << result.accuracy_score << ",\n";
+        file << "    \"tc_score\": " << result.tc_score << ",\n";
+        file << "    \"accuracy_ms\": " << result.accuracy_ms << ",\n";
+        file << "    \"has_reference\": " << (result.has_reference ? "true" : "false") << ",\n";
+        file << "    \"allocations\": " << result.allocations << ",\n";
+        file << "    \"heap_allocations\": " << result.heap_allocations << ",\n";
+        file << "    \"allocated_bytes\": " << result.allocated_bytes << ",\n";
+        file << "    \"allocation_ms\": " << result.allocation_ms << ",\n";
+        file << "    \"timings\": {";
+        file << "\"distances_ms\": " << timings.distances_ms;
+        file << ", \"tree_ms\": " << timings.tree_ms;
+        file << ", \"progressive_ms\": " << timings.progressive_ms;
+        file << ", \"rows_ms\": " << timings.rows_ms;
+        file << ", \"total_ms\": " << timings.total_ms;
+        file << ", \"dp_fill_ms\": " << timings.dp_fill_ms;
+        file << ", \"traceback_ms\": " << timings.traceback_ms;
+        file << ", \"consensus_ms\": " << timings.consensus_ms;
+        file << ", \"profile_merge_ms\": " << timings.profile_merge_ms;
+        file << ", \"distance_pairs\": " << timings.distance_pairs;
+        file << ", \"dp_alignments\": " << timings.dp_alignments;
+        file << ", \"dp_cells\": " << timings.dp_cells;
+        file << ", \"gcups\": " << timings.gcups() << "},\n";
+        file << "    \"phase_memory\": {";
+        for (int p = 0; p < MemoryAccounting::PHASE_COUNT; ++p) {
+            const PhaseMemory& phase = result.phase_memory[p];
+            file << (p > 0 ? ", " : "") << jsonString(memoryPhaseName(static_cast<MemoryPhase>(p)))
+                 << ": {\"bytes\": " << phase.bytes_allocated << ", \"allocations\": " << phase.allocations
+                 << ", \"peak_live_bytes\": " << phase.peak_live_bytes << "}";
+        }
+        file << "},\n";
+        file << "    \"perf_available\": " << (result.perf_available ? "true" : "false") << ",\n";
+        file << "    \"instructions_per_cell\": " << ratioValue(result.instructions_per_cell, "null") << ",\n";
+        file << "    \"phase_counters\": {";
+        for (int p = 0; p < MemoryAccounting::PHASE_COUNT; ++p) {
+            const PerfSample& counters = result.phase_counters[p];
+            file << (p > 0 ? ", " : "") << jsonString(memoryPhaseName(static_cast<MemoryPhase>(p))) << ": {";
+            for (int e = 0; e < PerfSample::EVENT_COUNT; ++e) {
+                PerfEvent event = static_cast<PerfEvent>(e);
+                file << "\"" << perfEventName(event) << "\": " << counterValue(counters, event, "null") << ", ";
+            }
+            file << "\"ipc\": " << ratioValue(counters.ipc(), "null") << "}";
+        }
+        file << "}\n";
+        file << "  }";
+    }
+    file << "\n]\n";
+    
+    file.close();
+    LOG_INFO("benchmark") << "Resultados exportados a JSON: " << json_file;
+}
+
+void Benchmark::setArenaEnabled(bool enabled) {
+    aligner.setArenaEnabled(enabled);
+}
+
+bool Benchmark::setPreset(const AlignerPreset& preset) {
+    return aligner.setPreset(preset);
+}
+
+void Benchmark::setThreadPool(ThreadPool* pool) {
+    this->pool = pool;
+    aligner.setThreadPool(pool);
 }
 
 // Métodos privados
@@ -336,55 +1372,6 @@ std::map<std::string, double> Benchmark::calculateSequenceStats(const std::vecto
     return stats;
 }
 
-std::string Benchmark::mutateSequence(const std::string& base_sequence, double mutation_rate) {
-    std::string mutated = base_sequence;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> mutation_prob(0.0, 1.0);
-    std::uniform_int_distribution<> base_dis(0, 3);
-    
-    std::string bases = "ATCG";
-    
-    for (size_t i = 0; i < mutated.length(); ++i) {
-        if (mutation_prob(gen) < mutation_rate) {
-            char new_base;
-            do {
-                new_base = bases[base_dis(gen)];
-            } while (new_base == mutated[i]); // Asegurar que sea una mutación real
-            
-            mutated[i] = new_base;
-        }
-    }
-    
-    return mutated;
-}
-
-double Benchmark::calculateAlignmentAccuracy(const std::vector<Sequence>& alignment1,
-                                            const std::vector<Sequence>& alignment2) {
-    if (alignment1.size() != alignment2.size()) {
-        return 0.0;
-    }
-    
-    int total_positions = 0;
-    int matching_positions = 0;
-    
-    for (size_t i = 0; i < alignment1.size(); ++i) {
-        const std::string& seq1 = alignment1[i].sequence;
-        const std::string& seq2 = alignment2[i].sequence;
-        
-        int min_length = std::min(seq1.length(), seq2.length());
-        total_positions += min_length;
-        
-        for (int j = 0; j < min_length; ++j) {
-            if (seq1[j] == seq2[j]) {
-                matching_positions++;
-            }
-        }
-    }
-    
-    return total_positions > 0 ? static_cast<double>(matching_positions) / total_positions : 0.0;
-}
-
 std::string Benchmark::getCurrentTimestamp() {
     auto now = std::chrono::system_clock::now();
     std::time_t time = std::chrono::system_clock::to_time_t(now);
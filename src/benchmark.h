@@ -1,8 +1,13 @@
 #ifndef BENCHMARK_H
 #define BENCHMARK_H
 
+#include "accuracy.h"
 #include "alignment.h"
 #include "io.h"
+#include "memory_accounting.h"
+#include "perf_counters.h"
+#include "synthetic.h"
+#include "thread_pool.h"
 #include <string>
 #include <vector>
 #include <chrono>
@@ -16,6 +21,24 @@ struct BenchmarkResult {
     double execution_time_ms;      // Tiempo de ejecución en milisegundos
     size_t memory_usage_mb;        // Uso de memoria en MB
     
+    // Reservas de memoria temporal del alineamiento (arena)
+    unsigned long allocations;     // Reservas de perfiles, nodos y temporales
+    unsigned long heap_allocations; // Reservas que llegaron al montículo
+    size_t allocated_bytes;        // Bytes reservados en total
+    double allocation_ms;          // Tiempo dentro de reservas y liberaciones
+    
+    // Tiempos por etapa y subetapa, celdas DP y GCUPS del alineamiento
+    AlignmentTimings timings;
+    
+    // Reservas por fase (índice MemoryPhase); solo con el hook de operator new enlazado
+    bool memory_accounting;        // Si phase_memory tiene datos
+    std::vector<PhaseMemory> phase_memory;
+    
+    // Contadores de hardware por fase (índice MemoryPhase); solo si perf_event_open está disponible
+    bool perf_available;           // Si phase_counters tiene datos
+    std::vector<PerfSample> phase_counters;
+    double instructions_per_cell;  // Instrucciones de la fase progresiva por celda DP (-1 sin datos)
+    
     // Métricas del alineamiento
     int num_sequences;             // Número de secuencias procesadas
     int original_avg_length;       // Longitud promedio original
@@ -24,7 +47,9 @@ struct BenchmarkResult {
     double gap_percentage;         // Porcentaje de gaps
     
     // Métricas de calidad (si se proporciona referencia)
-    double accuracy_score;         // Puntuación de precisión vs referencia
+    double accuracy_score;         // SP: pares alineados de la referencia que se reproducen
+    double tc_score;               // TC: columnas de la referencia reproducidas completas
+    double accuracy_ms;            // Tiempo de la comparación (fuera de execution_time_ms)
     bool has_reference;            // Si se comparó con referencia
     
     // Metadatos
@@ -32,9 +57,168 @@ struct BenchmarkResult {
     std::string timestamp;         // Momento de ejecución
     
     BenchmarkResult() : execution_time_ms(0.0), memory_usage_mb(0), 
+                       allocations(0), heap_allocations(0), allocated_bytes(0), allocation_ms(0.0),
+                       memory_accounting(false), phase_memory(MemoryAccounting::PHASE_COUNT),
+                       perf_available(false), phase_counters(MemoryAccounting::PHASE_COUNT),
+                       instructions_per_cell(-1.0),
                        num_sequences(0), original_avg_length(0), 
                        final_length(0), total_gaps(0), gap_percentage(0.0),
-                       accuracy_score(0.0), has_reference(false) {}
+                       accuracy_score(0.0), tc_score(0.0), accuracy_ms(0.0), has_reference(false) {}
+};
+
+/**
+ * Parámetros del estudio de escalabilidad: se varía el número de secuencias
+ * (con su longitud completa) y, por separado, la longitud (con N fijo)
+ */
+struct ScalabilityOptions {
+    int max_sequences;             // N máximo del barrido en N
+    int step;                      // Incremento de N
+    std::vector<int> lengths;      // Longitudes del barrido en L (vacío = 1/8, 1/4, 1/2 y la completa)
+    int fixed_sequences;           // N del barrido en L (0 = step)
+    int repetitions;               // Repeticiones de cada punto (se usa la mediana)
+    
+    ScalabilityOptions() : max_sequences(50), step(10), fixed_sequences(0), repetitions(3) {}
+};
+
+/**
+ * Punto de una curva de escalabilidad (medianas de las repeticiones)
+ */
+struct ScalabilityPoint {
+    char axis;                     // 'N' (número de secuencias) o 'L' (longitud)
+    int num_sequences;
+    double avg_length;             // Longitud promedio de las secuencias alineadas
+    int repetitions;
+    double execution_time_ms;
+    AlignmentTimings timings;      // Mediana de cada campo por separado
+    
+    ScalabilityPoint() : axis('N'), num_sequences(0), avg_length(0.0), repetitions(0), execution_time_ms(0.0) {}
+};
+
+/**
+ * Ajuste tiempo ~ coeficiente * x^exponente de una etapa (mínimos cuadrados en log-log)
+ */
+struct ScalingFit {
+    char axis;                     // 'N' o 'L'
+    std::string stage;             // "distances", "tree", ..., "total"
+    double exponent;
+    double coefficient;            // Milisegundos para x = 1
+    double r_squared;              // Bondad del ajuste en escala logarítmica
+    size_t points;                 // Puntos usados (los de tiempo 0 se descartan)
+    
+    ScalingFit() : axis('N'), exponent(0.0), coefficient(0.0), r_squared(0.0), points(0) {}
+    
+    /**
+     * Tiempo estimado (ms) para un tamaño dado
+     */
+    double predict(double x) const;
+};
+
+/**
+ * Parámetros del benchmark de escalabilidad en hilos
+ */
+struct ThreadScalingOptions {
+    std::vector<int> threads;      // Hilos a probar (vacío = 1, 2, 4, ... hasta los núcleos disponibles)
+    int repetitions;               // Repeticiones de cada punto (se usa la mediana)
+    int weak_base_sequences;       // N por hilo en el escalado débil (0 = N del dataset / máximo de hilos)
+    bool strong;                   // Mismo dataset con más hilos
+    bool weak;                     // N proporcional al número de hilos
+    
+    ThreadScalingOptions() : repetitions(3), weak_base_sequences(0), strong(true), weak(true) {}
+};
+
+/**
+ * Punto del benchmark de escalabilidad en hilos (medianas de las repeticiones)
+ */
+struct ThreadScalingPoint {
+    std::string mode;              // "strong" o "weak"
+    int threads;
+    int num_sequences;
+    int repetitions;
+    double execution_time_ms;
+    AlignmentTimings timings;      // Mediana de cada campo por separado
+    double speedup;                // Fuerte: T1 / Tp; débil: speedup escalado p·T1 / Tp
+    double efficiency;             // Fuerte: speedup / p; débil: T1 / Tp (1 = escalado perfecto)
+    ThreadPoolStats pool;          // Ocupación del pool (sin pool con un hilo)
+    
+    ThreadScalingPoint() : threads(1), num_sequences(0), repetitions(0), execution_time_ms(0.0),
+                           speedup(0.0), efficiency(0.0) {}
+};
+
+/**
+ * Resultado del estudio de escalabilidad
+ */
+struct ScalabilityStudy {
+    std::vector<BenchmarkResult> runs;      // Cada ejecución individual
+    std::vector<ScalabilityPoint> points;   // Medianas por punto
+    std::vector<ScalingFit> fits;           // Exponentes por eje y etapa
+};
+
+/**
+ * Parámetros del benchmark de presets (velocidad, memoria y precisión)
+ */
+struct ParetoOptions {
+    std::vector<AlignerPreset> presets;   // Vacío = todas las combinaciones (AlignerPreset::all())
+    int repetitions;                      // Ejecuciones por preset y dataset (tiempo = mediana)
+    double sp_tolerance;                  // Pérdida de SP admitida al recomendar el preset más rápido
+    
+    ParetoOptions() : repetitions(3), sp_tolerance(0.01) {}
+};
+
+/**
+ * Dataset del benchmark de presets con su alineamiento de referencia
+ */
+struct ParetoDataset {
+    std::string name;
+    std::string size_class;        // Vacío = según N ("small" < 100, "medium" < 1000, "large")
+    std::vector<Sequence> sequences;
+    std::vector<Sequence> reference;
+};
+
+/**
+ * Resultado de un preset sobre un dataset
+ */
+struct ParetoPoint {
+    std::string dataset;
+    std::string size_class;
+    std::string preset;
+    int num_sequences;
+    int avg_length;
+    int repetitions;
+    double execution_time_ms;      // Mediana de las repeticiones
+    size_t peak_memory_bytes;      // Pico de bytes vivos por fase (hook de memoria) o crecimiento del RSS
+    double sp_score;
+    double tc_score;
+    bool pareto;                   // No dominado en (tiempo, memoria, SP) dentro del dataset
+    bool pareto_speed;             // No dominado en (tiempo, SP) dentro del dataset
+    
+    ParetoPoint() : num_sequences(0), avg_length(0), repetitions(0), execution_time_ms(0.0),
+                    peak_memory_bytes(0), sp_score(0.0), tc_score(0.0), pareto(false), pareto_speed(false) {}
+};
+
+/**
+ * Resumen de un preset sobre los datasets de una clase de tamaño
+ */
+struct ParetoClassSummary {
+    std::string size_class;
+    std::string preset;
+    int datasets;
+    double time_ratio;             // Media geométrica del tiempo relativo al preset más rápido de cada dataset
+    double memory_ratio;           // Ídem para el pico de memoria
+    double sp_score;               // Medias sobre los datasets
+    double tc_score;
+    bool pareto;                   // No dominado en (tiempo relativo, SP medio)
+    bool recommended;              // El más rápido de la frontera con SP a menos de sp_tolerance del mejor
+    
+    ParetoClassSummary() : datasets(0), time_ratio(0.0), memory_ratio(0.0), sp_score(0.0), tc_score(0.0),
+                           pareto(false), recommended(false) {}
+};
+
+/**
+ * Resultado del benchmark de presets
+ */
+struct ParetoStudy {
+    std::vector<ParetoPoint> points;           // Un punto por dataset y preset
+    std::vector<ParetoClassSummary> classes;   // Un resumen por clase de tamaño y preset
 };
 
 /**
@@ -56,26 +240,41 @@ public:
      * Ejecuta un benchmark sobre un dataset específico
      * @param dataset_path Ruta al archivo FASTA del dataset
      * @param output_path Ruta donde guardar el resultado (opcional)
+     * @param reference_path Alineamiento de referencia para SP y TC (opcional)
      * @return Resultado del benchmark
      */
     BenchmarkResult runSingleBenchmark(const std::string& dataset_path,
-                                      const std::string& output_path = "");
+                                      const std::string& output_path = "",
+                                      const std::string& reference_path = "");
+    
+    /**
+     * Ejecuta un benchmark sobre secuencias ya cargadas (sin lectura ni escritura de archivos)
+     * @param sequences Secuencias a alinear
+     * @param dataset_name Nombre con el que se reporta
+     * @param reference Alineamiento de referencia para SP y TC (nullptr = sin referencia)
+     * @return Resultado del benchmark
+     */
+    BenchmarkResult runSequenceBenchmark(const std::vector<Sequence>& sequences,
+                                        const std::string& dataset_name,
+                                        const std::vector<Sequence>* reference = nullptr);
     
     /**
      * Ejecuta benchmarks sobre múltiples datasets
      * @param dataset_paths Vector de rutas a los datasets
+     * @param reference_paths Referencia de cada dataset, en el mismo orden (vacío = sin referencias)
      * @return Vector de resultados de benchmarks
      */
-    std::vector<BenchmarkResult> runMultipleBenchmarks(const std::vector<std::string>& dataset_paths);
+    std::vector<BenchmarkResult> runMultipleBenchmarks(const std::vector<std::string>& dataset_paths,
+                                                       const std::vector<std::string>& reference_paths = {});
     
     /**
      * Compara un alineamiento con una referencia conocida
      * @param alignment_path Ruta al alineamiento generado
      * @param reference_path Ruta al alineamiento de referencia
-     * @return Puntuación de precisión (0.0 = mala, 1.0 = perfecta)
+     * @return Puntuaciones SP y TC (valid == false si no se pudieron comparar)
      */
-    double compareWithReference(const std::string& alignment_path,
-                               const std::string& reference_path);
+    AccuracyScore compareWithReference(const std::string& alignment_path,
+                                       const std::string& reference_path);
     
     /**
      * Genera un reporte detallado de los benchmarks
@@ -97,14 +296,42 @@ public:
                                                         int step = 10);
     
     /**
-     * Crea datasets sintéticos para pruebas
-     * @param num_sequences Número de secuencias
-     * @param base_length Longitud base de las secuencias
-     * @param mutation_rate Tasa de mutación (0.0 - 1.0)
+     * Estudio de escalabilidad en memoria: barre N y L por separado, repite
+     * cada punto y ajusta un exponente empírico por etapa y eje
+     * @param base_sequences Secuencias base (los subconjuntos toman las primeras)
+     * @param options Barridos y repeticiones
+     * @return Ejecuciones, puntos (medianas) y ajustes
+     */
+    ScalabilityStudy runScalabilityStudy(const std::vector<Sequence>& base_sequences,
+                                         const ScalabilityOptions& options);
+    
+    /**
+     * Ajusta exponentes de escalabilidad por eje y etapa
+     * @param points Puntos de las curvas
+     * @return Un ajuste por eje y etapa con al menos dos tamaños distintos
+     */
+    static std::vector<ScalingFit> fitScaling(const std::vector<ScalabilityPoint>& points);
+    
+    /**
+     * Exporta puntos y ajustes del estudio a CSV (dos archivos) y JSON
+     * @param study Estudio de escalabilidad
+     * @param points_csv Archivo CSV de puntos
+     * @param fits_csv Archivo CSV de ajustes
+     * @param json_file Archivo JSON con puntos y ajustes
+     */
+    void exportScalabilityStudy(const ScalabilityStudy& study, const std::string& points_csv,
+                                const std::string& fits_csv, const std::string& json_file);
+    
+    /**
+     * Crea datasets sintéticos para pruebas (evolución sobre un árbol aleatorio, reproducible por semilla)
+     * @param options Parámetros de la simulación
      * @param output_path Archivo donde guardar el dataset
+     * @param alignment_path Archivo para el alineamiento verdadero ("" = no escribirlo)
+     * @param pool Pool de hilos (nullptr = un solo hilo)
+     * @return false si no se pudo generar
      */
-    void createSyntheticDataset(int num_sequences, int base_length,
-                               double mutation_rate, const std::string& output_path);
+    bool createSyntheticDataset(const SyntheticOptions& options, const std::string& output_path,
+                                const std::string& alignment_path = "", ThreadPool* pool = nullptr);
     
     /**
      * Exporta resultados a formato CSV
@@ -113,9 +340,103 @@ public:
      */
     void exportToCSV(const std::vector<BenchmarkResult>& results,
                      const std::string& csv_file);
+    
+    /**
+     * Exporta resultados a formato JSON (un objeto por benchmark, mismas métricas que el CSV)
+     * @param results Vector de resultados
+     * @param json_file Archivo JSON de salida
+     */
+    void exportToJSON(const std::vector<BenchmarkResult>& results,
+                      const std::string& json_file);
+    
+    /**
+     * Benchmark de escalabilidad en hilos: escalado fuerte (mismo dataset con
+     * 1, 2, 4, ... hilos) y débil (N proporcional a los hilos)
+     * @param sequences Secuencias del dataset
+     * @param options Hilos, repeticiones y modos
+     * @return Un punto por modo y número de hilos
+     */
+    std::vector<ThreadScalingPoint> runThreadScaling(const std::vector<Sequence>& sequences,
+                                                     const ThreadScalingOptions& options);
+    
+    /**
+     * Exporta el benchmark de escalabilidad en hilos a CSV y JSON
+     * @param points Puntos medidos
+     * @param csv_file Archivo CSV de salida
+     * @param json_file Archivo JSON de salida
+     */
+    void exportThreadScaling(const std::vector<ThreadScalingPoint>& points, const std::string& csv_file,
+                             const std::string& json_file);
+    
+    /**
+     * Benchmark de presets: alinea cada dataset con cada combinación de
+     * distancias, árbol guía, kernel DP y refinamiento, mide tiempo, pico de
+     * memoria y SP/TC frente a la referencia, y marca la frontera de Pareto por
+     * dataset y por clase de tamaño
+     * @param datasets Datasets con referencia
+     * @param options Presets, repeticiones y tolerancia de la recomendación
+     * @return Puntos por dataset y resúmenes por clase
+     */
+    ParetoStudy runParetoStudy(const std::vector<ParetoDataset>& datasets, const ParetoOptions& options);
+    
+    /**
+     * Muestra el benchmark de presets como tablas (por dataset y por clase)
+     */
+    void printParetoStudy(const ParetoStudy& study);
+    
+    /**
+     * Exporta el benchmark de presets a CSV
+     * @param study Puntos y resúmenes
+     * @param points_csv Archivo con un punto por dataset y preset
+     * @param classes_csv Archivo con un resumen por clase y preset
+     */
+    void exportParetoStudy(const ParetoStudy& study, const std::string& points_csv, const std::string& classes_csv);
+    
+    /**
+     * Dataset sintético de un nivel predefinido, con su alineamiento verdadero como referencia
+     * ("small": 16 x 150, "medium": 48 x 300, "large": 128 x 400; divergencia 0.2)
+     * @param tier Nombre del nivel
+     * @param dataset Dataset generado (salida)
+     * @param pool Pool de hilos (nullptr = un solo hilo)
+     * @return false si el nivel no existe
+     */
+    static bool syntheticTier(const std::string& tier, ParetoDataset& dataset, ThreadPool* pool = nullptr);
+    
+    /**
+     * Activa o desactiva la arena por alineamiento del alineador
+     * @param enabled false para medir con new/delete directo
+     */
+    void setArenaEnabled(bool enabled);
+    
+    /**
+     * Engines con los que alinea el benchmark (el de presets los recorre todos
+     * y al terminar vuelve a este)
+     * @param preset Engines por etapa
+     * @return false si algún engine no está registrado
+     */
+    bool setPreset(const AlignerPreset& preset);
+    
+    /**
+     * Pool de hilos con el que alinea el benchmark
+     * @param pool Pool (nullptr = alinear en el hilo del benchmark)
+     */
+    void setThreadPool(ThreadPool* pool);
 
 private:
     MSAAligner aligner;
+    ThreadPool* pool;              // También reparte la comparación con la referencia
+    
+    // Contadores de hardware del hilo del benchmark; se abren en el primer benchmark
+    PerfCounterGroup perf_counters;
+    bool perf_checked;
+    
+    /**
+     * Benchmark de un dataset leído de disco (in_memory == nullptr) o ya cargado
+     */
+    BenchmarkResult runBenchmark(const std::string& dataset_path,
+                                 const std::vector<Sequence>* in_memory,
+                                 const std::string& output_path,
+                                 const std::vector<Sequence>* reference = nullptr);
     
     /**
      * Obtiene el uso actual de memoria del proceso
@@ -130,23 +451,6 @@ private:
      */
     std::map<std::string, double> calculateSequenceStats(const std::vector<Sequence>& sequences);
     
-    /**
-     * Genera una secuencia mutada a partir de una base
-     * @param base_sequence Secuencia base
-     * @param mutation_rate Tasa de mutación
-     * @return Secuencia mutada
-     */
-    std::string mutateSequence(const std::string& base_sequence, double mutation_rate);
-    
-    /**
-     * Calcula la precisión comparando dos alineamientos
-     * @param alignment1 Primer alineamiento
-     * @param alignment2 Segundo alineamiento
-     * @return Puntuación de precisión
-     */
-    double calculateAlignmentAccuracy(const std::vector<Sequence>& alignment1,
-                                     const std::vector<Sequence>& alignment2);
-    
     /**
      * Obtiene timestamp actual como string
      * @return Timestamp formateado
@@ -1,120 +1,642 @@
 #include "benchmark.h"
+#include "differential.h"
+#include "kernel_benchmark.h"
+#include "logger.h"
+#include "regression.h"
+#include "trace.h"
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <vector>
 #include <string>
 
+namespace {
+
+/**
+ * Separa una lista separada por comas
+ */
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::istringstream input(text);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+} // namespace
+
 /**
  * Programa principal para ejecutar benchmarks del MSA Aligner
  */
 int main(int argc, char* argv[]) {
-    std::cout << "============================================================" << std::endl;
-    std::cout << "MSA ALIGNER - SISTEMA DE BENCHMARKS v1.0" << std::endl;
-    std::cout << "============================================================" << std::endl;
+    std::vector<char*> args;
+    if (!applyLogOptions(argc, argv, args)) {
+        return 1;
+    }
+    
+    // --no-arena: perfiles y nodos con new/delete directo, para comparar
+    bool use_arena = true;
+    args.erase(std::remove_if(args.begin() + 1, args.end(), [&use_arena](char* arg) {
+        if (std::string(arg) == "--no-arena") {
+            use_arena = false;
+            return true;
+        }
+        return false;
+    }), args.end());
+    
+    // --trace <archivo.json>: traza Chrome/Perfetto de todo el comando
+    std::string trace_file;
+    for (size_t i = 1; i + 1 < args.size(); ++i) {
+        if (std::string(args[i]) == "--trace") {
+            trace_file = args[i + 1];
+            args.erase(args.begin() + i, args.begin() + i + 2);
+            break;
+        }
+    }
+    
+    // --engine <etapa>=<nombre> (repetible): engines con los que alinean los comandos
+    std::vector<std::string> engine_specs;
+    for (size_t i = 1; i + 1 < args.size();) {
+        if (std::string(args[i]) == "--engine") {
+            engine_specs.push_back(args[i + 1]);
+            args.erase(args.begin() + i, args.begin() + i + 2);
+        } else {
+            ++i;
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+    TraceSession trace_session(trace_file);
+    
+    LOG_INFO("benchmark") << "============================================================";
+    LOG_INFO("benchmark") << "MSA ALIGNER - SISTEMA DE BENCHMARKS v1.0";
+    LOG_INFO("benchmark") << "============================================================";
     
     if (argc < 2) {
-        std::cout << std::endl;
-        std::cout << "Uso: " << argv[0] << " <comando> [opciones]" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Comandos disponibles:" << std::endl;
-        std::cout << "  single <dataset.fasta> [output.fasta]  - Ejecutar benchmark individual" << std::endl;
-        std::cout << "  multiple <dataset1> <dataset2> ...     - Ejecutar múltiples benchmarks" << std::endl;
-        std::cout << "  scalability <dataset.fasta> [max] [step] - Test de escalabilidad" << std::endl;
-        std::cout << "  synthetic <num_seq> <length> <mut_rate> <output.fasta> - Crear dataset sintético" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Ejemplos:" << std::endl;
-        std::cout << "  " << argv[0] << " single benchmarks/datasets/small/dna_sample.fasta" << std::endl;
-        std::cout << "  " << argv[0] << " scalability entrada.fasta 50 10" << std::endl;
-        std::cout << "  " << argv[0] << " synthetic 20 100 0.1 synthetic_test.fasta" << std::endl;
-        std::cout << std::endl;
+        LOG_INFO("benchmark");
+        LOG_INFO("benchmark") << "Uso: " << argv[0] << " <comando> [opciones]";
+        LOG_INFO("benchmark");
+        LOG_INFO("benchmark") << "Comandos disponibles:";
+        LOG_INFO("benchmark") << "  single <dataset.fasta> [output.fasta] [--reference ref.fasta] [--threads n]";
+        LOG_INFO("benchmark") << "          - Ejecutar benchmark individual (con referencia: precision SP y TC)";
+        LOG_INFO("benchmark") << "  multiple <dataset1> <dataset2> ... [--reference ref1,ref2,...] [--threads n]";
+        LOG_INFO("benchmark") << "          - Ejecutar múltiples benchmarks (una referencia por dataset, en orden)";
+        LOG_INFO("benchmark") << "  scalability <dataset.fasta> [max] [step] [--lengths a,b] [--fixed-n n] [--repetitions r]";
+        LOG_INFO("benchmark") << "          - Escalabilidad en N y L con exponentes ajustados por etapa";
+        LOG_INFO("benchmark") << "  synthetic <num_seq> <length> <divergence> <output.fasta> [--seed n] [--protein]";
+        LOG_INFO("benchmark") << "          [--indel-rate r] [--indel-length m] [--alignment verdadero.fasta] [--threads n]";
+        LOG_INFO("benchmark") << "          - Crear dataset sintético por evolución sobre un árbol aleatorio";
+        LOG_INFO("benchmark") << "  scaling-threads <dataset.fasta> [--threads 1,2,4] [--repetitions r] [--weak-base n]";
+        LOG_INFO("benchmark") << "          [--strong-only|--weak-only] - Escalado fuerte y debil en hilos";
+        LOG_INFO("benchmark") << "  kernels [--lengths a,b] [--alphabets dna,protein] [--divergence x,y]";
+        LOG_INFO("benchmark") << "          [--kernels k1,k2] [--min-time s] [--repetitions n] [--csv archivo] - Microbenchmarks de kernels";
+        LOG_INFO("benchmark") << "  compare <dataset1> [dataset2 ...] [--baseline archivo.json] [--save] [--repetitions k]";
+        LOG_INFO("benchmark") << "          [--warmup w] [--confidence c] [--min-change pct] [--threads n]";
+        LOG_INFO("benchmark") << "          - Puerta de regresion contra una linea base (sale con 2 si hay regresiones)";
+        LOG_INFO("benchmark") << "  pareto [dataset1 ...] [--reference ref1,...] [--tiers small,medium,large] [--repetitions r]";
+        LOG_INFO("benchmark") << "          [--distances identity,kmer] [--trees upgma,nj] [--kernels full,banded,packed,linear]";
+        LOG_INFO("benchmark") << "          [--merges consensus] [--refinement on,off] [--sp-tolerance x] [--threads n]";
+        LOG_INFO("benchmark") << "          - Tiempo, memoria y SP/TC de cada preset con la frontera de Pareto";
+        LOG_INFO("benchmark") << "  differential [--pairs n] [--profiles n] [--max-length L] [--alphabets dna,protein]";
+        LOG_INFO("benchmark") << "          [--engines full,linear] [--seed s] [--csv archivo]";
+        LOG_INFO("benchmark") << "          - Contrasta los engines de DP con la DP de referencia (sale con 2 si discrepan)";
+        LOG_INFO("benchmark") << "  engines - Listar los engines registrados por etapa";
+        LOG_INFO("benchmark");
+        LOG_INFO("benchmark") << "Opciones:";
+        LOG_INFO("benchmark") << "  --no-arena  Reservar perfiles y nodos con new/delete (sin arena por alineamiento)";
+        LOG_INFO("benchmark") << "  --trace <archivo.json>  Traza Chrome/Perfetto (etapas, uniones, E/S, ocio de los hilos)";
+        LOG_INFO("benchmark") << "  --engine <etapa>=<nombre>  Engine de una etapa (distance, tree, pairwise, merge); repetible";
+        LOG_INFO("benchmark");
+        LOG_INFO("benchmark") << "Ejemplos:";
+        LOG_INFO("benchmark") << "  " << argv[0] << " single benchmarks/datasets/small/dna_sample.fasta";
+        LOG_INFO("benchmark") << "  " << argv[0] << " scalability entrada.fasta 50 10";
+        LOG_INFO("benchmark") << "  " << argv[0] << " synthetic 20 100 0.1 synthetic_test.fasta";
+        LOG_INFO("benchmark") << "  " << argv[0] << " kernels --lengths 1000 --alphabets dna --kernels dp_fill";
+        LOG_INFO("benchmark") << "  " << argv[0] << " compare benchmarks/datasets/small/dna_sample.fasta --save";
+        LOG_INFO("benchmark") << "  " << argv[0] << " pareto --tiers small,medium --repetitions 3";
+        LOG_INFO("benchmark") << "  " << argv[0] << " differential --pairs 5000 --max-length 500";
+        LOG_INFO("benchmark") << "  " << argv[0] << " single entrada.fasta --engine pairwise=linear --engine tree=nj";
+        LOG_INFO("benchmark");
         return 1;
     }
     
     std::string command = argv[1];
     Benchmark benchmark;
+    benchmark.setArenaEnabled(use_arena);
+    AlignerPreset engines;
+    for (const auto& spec : engine_specs) {
+        if (!engines.select(spec)) {
+            return 1;
+        }
+    }
+    if (!benchmark.setPreset(engines)) {
+        return 1;
+    }
+    if (!engine_specs.empty()) {
+        LOG_INFO("benchmark").field("preset", engines.name()) << "Engines: " << engines.name();
+    }
     
     try {
-        if (command == "single") {
-            if (argc < 3) {
-                std::cerr << "Error: Falta especificar el dataset" << std::endl;
+        if (command == "single" || command == "multiple") {
+            std::vector<std::string> positional;
+            std::vector<std::string> references;
+            int threads = 1;
+            for (int i = 2; i < argc; ++i) {
+                std::string option = argv[i];
+                if (option.compare(0, 2, "--") != 0) {
+                    positional.push_back(option);
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--reference") {
+                    references = splitList(value);
+                } else if (option == "--threads") {
+                    threads = std::max(1, std::stoi(value));
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            if (positional.empty()) {
+                LOG_ERROR("benchmark.error") << (command == "single" ? "Error: Falta especificar el dataset"
+                                                                      : "Error: Faltan especificar los datasets");
                 return 1;
             }
-            
-            std::string dataset = argv[2];
-            std::string output = (argc > 3) ? argv[3] : "";
-            
-            std::cout << "Ejecutando benchmark individual..." << std::endl;
-            BenchmarkResult result = benchmark.runSingleBenchmark(dataset, output);
-            
-            std::vector<BenchmarkResult> results = {result};
-            benchmark.generateReport(results);
-            
-        } else if (command == "multiple") {
-            if (argc < 3) {
-                std::cerr << "Error: Faltan especificar los datasets" << std::endl;
+            size_t expected_references = command == "single" ? 1 : positional.size();
+            if (!references.empty() && references.size() != expected_references) {
+                LOG_ERROR("benchmark.error") << "Error: --reference necesita " << expected_references
+                                             << " referencias y se dieron " << references.size();
                 return 1;
             }
             
-            std::vector<std::string> datasets;
-            for (int i = 2; i < argc; ++i) {
-                datasets.push_back(argv[i]);
+            // El pool alinea y también reparte por columnas la comparación con la referencia
+            std::unique_ptr<ThreadPool> pool;
+            if (threads > 1) {
+                pool = std::make_unique<ThreadPool>(threads);
+                benchmark.setThreadPool(pool.get());
             }
             
-            std::cout << "Ejecutando benchmarks múltiples..." << std::endl;
-            std::vector<BenchmarkResult> results = benchmark.runMultipleBenchmarks(datasets);
-            
-            benchmark.generateReport(results, "benchmarks/results/multiple_benchmark_report.txt");
-            benchmark.exportToCSV(results, "benchmarks/results/multiple_benchmark_results.csv");
+            if (command == "single") {
+                std::string output = positional.size() > 1 ? positional[1] : "";
+                std::string reference = references.empty() ? "" : references[0];
+                
+                LOG_INFO("benchmark") << "Ejecutando benchmark individual...";
+                BenchmarkResult result = benchmark.runSingleBenchmark(positional[0], output, reference);
+                benchmark.setThreadPool(nullptr);
+                
+                std::vector<BenchmarkResult> results = {result};
+                benchmark.generateReport(results);
+            } else {
+                LOG_INFO("benchmark") << "Ejecutando benchmarks múltiples...";
+                std::vector<BenchmarkResult> results = benchmark.runMultipleBenchmarks(positional, references);
+                benchmark.setThreadPool(nullptr);
+                
+                benchmark.generateReport(results, "benchmarks/results/multiple_benchmark_report.txt");
+                benchmark.exportToCSV(results, "benchmarks/results/multiple_benchmark_results.csv");
+                benchmark.exportToJSON(results, "benchmarks/results/multiple_benchmark_results.json");
+            }
             
         } else if (command == "scalability") {
             if (argc < 3) {
-                std::cerr << "Error: Falta especificar el dataset base" << std::endl;
+                LOG_ERROR("benchmark.error") << "Error: Falta especificar el dataset base";
                 return 1;
             }
             
             std::string dataset = argv[2];
-            int max_sequences = (argc > 3) ? std::stoi(argv[3]) : 50;
-            int step = (argc > 4) ? std::stoi(argv[4]) : 10;
+            ScalabilityOptions options;
+            std::vector<std::string> positional;
+            for (int i = 3; i < argc; ++i) {
+                std::string option = argv[i];
+                if (option.compare(0, 2, "--") != 0) {
+                    positional.push_back(option);
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--lengths") {
+                    for (const auto& item : splitList(value)) {
+                        options.lengths.push_back(std::stoi(item));
+                    }
+                } else if (option == "--fixed-n") {
+                    options.fixed_sequences = std::stoi(value);
+                } else if (option == "--repetitions") {
+                    options.repetitions = std::stoi(value);
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            options.max_sequences = positional.size() > 0 ? std::stoi(positional[0]) : 50;
+            options.step = positional.size() > 1 ? std::stoi(positional[1]) : 10;
             
             // Leer secuencias base
             std::vector<Sequence> base_sequences = FastaIO::readFasta(dataset);
             
             if (base_sequences.empty()) {
-                std::cerr << "Error: No se pudieron leer las secuencias del dataset base" << std::endl;
+                LOG_ERROR("benchmark.error") << "Error: No se pudieron leer las secuencias del dataset base";
                 return 1;
             }
             
-            std::cout << "Ejecutando test de escalabilidad..." << std::endl;
-            std::vector<BenchmarkResult> results = benchmark.runScalabilityBenchmark(base_sequences, max_sequences, step);
+            LOG_INFO("benchmark") << "Ejecutando test de escalabilidad...";
+            ScalabilityStudy study = benchmark.runScalabilityStudy(base_sequences, options);
             
-            benchmark.generateReport(results, "benchmarks/results/scalability_report.txt");
-            benchmark.exportToCSV(results, "benchmarks/results/scalability_results.csv");
+            benchmark.generateReport(study.runs, "benchmarks/results/scalability_report.txt");
+            benchmark.exportToCSV(study.runs, "benchmarks/results/scalability_results.csv");
+            benchmark.exportToJSON(study.runs, "benchmarks/results/scalability_results.json");
+            benchmark.exportScalabilityStudy(study, "benchmarks/results/scalability_points.csv",
+                                             "benchmarks/results/scalability_fits.csv",
+                                             "benchmarks/results/scalability_fits.json");
             
         } else if (command == "synthetic") {
             if (argc < 6) {
-                std::cerr << "Error: Parámetros insuficientes para dataset sintético" << std::endl;
-                std::cerr << "Uso: " << argv[0] << " synthetic <num_seq> <length> <mut_rate> <output.fasta>" << std::endl;
+                LOG_ERROR("benchmark.error") << "Error: Parámetros insuficientes para dataset sintético";
+                LOG_ERROR("benchmark.error") << "Uso: " << argv[0] << " synthetic <num_seq> <length> <divergence> <output.fasta> [opciones]";
                 return 1;
             }
             
-            int num_sequences = std::stoi(argv[2]);
-            int base_length = std::stoi(argv[3]);
-            double mutation_rate = std::stod(argv[4]);
+            SyntheticOptions options;
+            options.num_sequences = std::stoul(argv[2]);
+            options.length = std::stoul(argv[3]);
+            options.divergence = std::stod(argv[4]);
             std::string output_path = argv[5];
+            std::string alignment_path;
+            size_t threads = 0;
+            for (int i = 6; i < argc; ++i) {
+                std::string option = argv[i];
+                if (option == "--protein") {
+                    options.protein = true;
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--seed") {
+                    options.seed = std::stoull(value);
+                } else if (option == "--indel-rate") {
+                    options.indel_rate = std::stod(value);
+                } else if (option == "--indel-length") {
+                    options.mean_indel_length = std::stod(value);
+                } else if (option == "--alignment") {
+                    alignment_path = value;
+                } else if (option == "--threads") {
+                    threads = std::stoul(value);
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            
+            LOG_INFO("benchmark") << "Creando dataset sintético...";
+            std::unique_ptr<ThreadPool> pool;
+            if (threads != 1) {
+                pool = std::make_unique<ThreadPool>(threads);
+            }
+            if (!benchmark.createSyntheticDataset(options, output_path, alignment_path, pool.get())) {
+                return 1;
+            }
+            
+        } else if (command == "scaling-threads") {
+            if (argc < 3) {
+                LOG_ERROR("benchmark.error") << "Error: Falta especificar el dataset";
+                return 1;
+            }
+            
+            std::string dataset = argv[2];
+            ThreadScalingOptions options;
+            for (int i = 3; i < argc; ++i) {
+                std::string option = argv[i];
+                if (option == "--strong-only") {
+                    options.weak = false;
+                    continue;
+                }
+                if (option == "--weak-only") {
+                    options.strong = false;
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--threads") {
+                    for (const auto& item : splitList(value)) {
+                        options.threads.push_back(std::stoi(item));
+                    }
+                } else if (option == "--repetitions") {
+                    options.repetitions = std::stoi(value);
+                } else if (option == "--weak-base") {
+                    options.weak_base_sequences = std::stoi(value);
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            
+            std::vector<Sequence> sequences = FastaIO::readFasta(dataset);
+            if (sequences.empty()) {
+                LOG_ERROR("benchmark.error") << "Error: No se pudieron leer las secuencias de " << dataset;
+                return 1;
+            }
+            
+            LOG_INFO("benchmark") << "Ejecutando escalabilidad en hilos...";
+            std::vector<ThreadScalingPoint> points = benchmark.runThreadScaling(sequences, options);
+            benchmark.exportThreadScaling(points, "benchmarks/results/thread_scaling.csv",
+                                          "benchmarks/results/thread_scaling.json");
+            
+        } else if (command == "kernels") {
+            KernelBenchmarkOptions options;
+            std::string csv_file = "benchmarks/results/kernel_results.csv";
+            for (int i = 2; i < argc; ++i) {
+                std::string option = argv[i];
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--lengths") {
+                    options.lengths.clear();
+                    for (const auto& item : splitList(value)) {
+                        options.lengths.push_back(std::stoul(item));
+                    }
+                } else if (option == "--alphabets") {
+                    options.alphabets = splitList(value);
+                } else if (option == "--divergence") {
+                    options.divergences.clear();
+                    for (const auto& item : splitList(value)) {
+                        options.divergences.push_back(std::stod(item));
+                    }
+                } else if (option == "--kernels") {
+                    options.kernels = splitList(value);
+                } else if (option == "--min-time") {
+                    options.min_time_seconds = std::stod(value);
+                } else if (option == "--repetitions") {
+                    options.repetitions = std::max(1, std::stoi(value));
+                } else if (option == "--csv") {
+                    csv_file = value;
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            
+            LOG_INFO("benchmark") << "Ejecutando microbenchmarks de kernels...";
+            KernelBenchmark kernels(options);
+            std::vector<KernelResult> results = kernels.run();
+            kernels.printResults(results);
+            kernels.exportToCSV(results, csv_file);
+            
+        } else if (command == "compare") {
+            RegressionOptions options;
+            options.arena = use_arena;
+            std::string baseline_file = "benchmarks/results/baseline.json";
+            bool save = false;
+            std::vector<std::string> datasets;
+            for (int i = 2; i < argc; ++i) {
+                std::string option = argv[i];
+                if (option == "--save") {
+                    save = true;
+                    continue;
+                }
+                if (option.compare(0, 2, "--") != 0) {
+                    datasets.push_back(option);
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--baseline") {
+                    baseline_file = value;
+                } else if (option == "--repetitions") {
+                    options.repetitions = std::max(1, std::stoi(value));
+                } else if (option == "--warmup") {
+                    options.warmup = std::max(0, std::stoi(value));
+                } else if (option == "--confidence") {
+                    options.confidence = std::stod(value);
+                } else if (option == "--min-change") {
+                    options.min_change = std::stod(value) / 100.0;
+                } else if (option == "--threads") {
+                    options.threads = std::max(1, std::stoi(value));
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            if (datasets.empty()) {
+                LOG_ERROR("benchmark.error") << "Error: Faltan especificar los datasets";
+                return 1;
+            }
+            if (options.confidence <= 0.0 || options.confidence >= 1.0) {
+                LOG_ERROR("benchmark.error") << "Error: --confidence debe estar entre 0 y 1";
+                return 1;
+            }
+            
+            // Sin línea base previa, la primera medición se convierte en la línea base
+            RegressionBaseline baseline;
+            if (!save && !RegressionGate::loadBaseline(baseline_file, baseline)) {
+                LOG_INFO("benchmark") << "No hay linea base valida en " << baseline_file << "; se creara una nueva";
+                save = true;
+            }
+            
+            std::unique_ptr<ThreadPool> pool;
+            if (options.threads > 1) {
+                pool = std::make_unique<ThreadPool>(options.threads);
+                benchmark.setThreadPool(pool.get());
+            }
+            
+            LOG_INFO("benchmark") << "Midiendo " << datasets.size() << " datasets (" << options.warmup
+                                  << " de calentamiento, " << options.repetitions << " repeticiones)...";
+            RegressionGate gate(options);
+            RegressionBaseline current = gate.measure(benchmark, datasets);
+            benchmark.setThreadPool(nullptr);
+            if (current.datasets.empty()) {
+                return 1;
+            }
+            
+            if (save) {
+                if (!RegressionGate::saveBaseline(current, baseline_file)) {
+                    return 1;
+                }
+            } else {
+                RegressionGate::saveBaseline(current, "benchmarks/results/compare_current.json");
+                std::vector<MetricComparison> comparisons = gate.compare(baseline, current);
+                int regressions = gate.printComparison(comparisons);
+                gate.exportComparison(comparisons, "benchmarks/results/compare_report.csv");
+                if (regressions > 0) {
+                    LOG_ERROR("benchmark.error") << "Error: " << regressions
+                                                 << " regresiones significativas respecto a " << baseline_file;
+                    return 2;
+                }
+            }
+            
+        } else if (command == "pareto") {
+            ParetoOptions options;
+            std::vector<std::string> datasets, references, tiers;
+            // Filtros por etapa (vacío = todos los engines registrados)
+            std::vector<std::string> distances, trees, kernels, merges;
+            std::vector<std::string> refinement = {"on", "off"};
+            int threads = 1;
+            for (int i = 2; i < argc; ++i) {
+                std::string option = argv[i];
+                if (option.compare(0, 2, "--") != 0) {
+                    datasets.push_back(option);
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--reference") {
+                    references = splitList(value);
+                } else if (option == "--tiers") {
+                    tiers = splitList(value);
+                } else if (option == "--distances") {
+                    distances = splitList(value);
+                } else if (option == "--trees") {
+                    trees = splitList(value);
+                } else if (option == "--kernels") {
+                    kernels = splitList(value);
+                } else if (option == "--merges") {
+                    merges = splitList(value);
+                } else if (option == "--refinement") {
+                    refinement = splitList(value);
+                } else if (option == "--repetitions") {
+                    options.repetitions = std::max(1, std::stoi(value));
+                } else if (option == "--sp-tolerance") {
+                    options.sp_tolerance = std::stod(value);
+                } else if (option == "--threads") {
+                    threads = std::max(1, std::stoi(value));
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            if (references.size() != datasets.size()) {
+                LOG_ERROR("benchmark.error") << "Error: Cada dataset necesita su referencia (--reference ref1,ref2,...)";
+                return 1;
+            }
+            if (datasets.empty() && tiers.empty()) {
+                tiers = {"small", "medium"};
+            }
+            
+            // Presets: producto de los engines pedidos en cada etapa
+            auto selected = [](const std::vector<std::string>& names, const std::string& name) {
+                return names.empty() || std::find(names.begin(), names.end(), name) != names.end();
+            };
+            for (const auto& preset : AlignerPreset::all()) {
+                if (selected(distances, preset.distance) && selected(trees, preset.tree) &&
+                    selected(kernels, preset.pairwise) && selected(merges, preset.merge) &&
+                    selected(refinement, preset.refinement ? "on" : "off")) {
+                    options.presets.push_back(preset);
+                }
+            }
+            if (options.presets.empty()) {
+                LOG_ERROR("benchmark.error") << "Error: Ningun preset coincide con las variantes pedidas";
+                return 1;
+            }
+            
+            std::unique_ptr<ThreadPool> pool;
+            if (threads > 1) {
+                pool = std::make_unique<ThreadPool>(threads);
+                benchmark.setThreadPool(pool.get());
+            }
+            std::vector<ParetoDataset> inputs;
+            for (const auto& tier : tiers) {
+                ParetoDataset dataset;
+                if (!Benchmark::syntheticTier(tier, dataset, pool.get())) {
+                    return 1;
+                }
+                inputs.push_back(std::move(dataset));
+            }
+            for (size_t d = 0; d < datasets.size(); ++d) {
+                ParetoDataset dataset;
+                dataset.name = datasets[d];
+                dataset.sequences = FastaIO::readFasta(datasets[d]);
+                dataset.reference = FastaIO::readFasta(references[d]);
+                inputs.push_back(std::move(dataset));
+            }
+            
+            LOG_INFO("benchmark") << "Ejecutando " << options.presets.size() << " presets sobre " << inputs.size()
+                                  << " datasets (" << options.repetitions << " repeticiones)...";
+            ParetoStudy study = benchmark.runParetoStudy(inputs, options);
+            benchmark.setThreadPool(nullptr);
+            benchmark.printParetoStudy(study);
+            benchmark.exportParetoStudy(study, "benchmarks/results/pareto_results.csv",
+                                        "benchmarks/results/pareto_classes.csv");
+            
+        } else if (command == "differential") {
+            DifferentialOptions options;
+            std::string csv_file = "benchmarks/results/differential_results.csv";
+            for (int i = 2; i < argc; ++i) {
+                std::string option = argv[i];
+                if (i + 1 >= argc) {
+                    LOG_ERROR("benchmark.error") << "Error: Falta el valor de " << option;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (option == "--pairs") {
+                    options.pairs = std::max(0, std::stoi(value));
+                } else if (option == "--profiles") {
+                    options.profiles = std::max(0, std::stoi(value));
+                } else if (option == "--max-length") {
+                    options.max_length = std::max<size_t>(1, std::stoul(value));
+                } else if (option == "--alphabets") {
+                    options.alphabets = splitList(value);
+                } else if (option == "--engines") {
+                    options.engines = splitList(value);
+                } else if (option == "--seed") {
+                    options.seed = static_cast<unsigned>(std::stoul(value));
+                } else if (option == "--csv") {
+                    csv_file = value;
+                } else {
+                    LOG_ERROR("benchmark.error") << "Error: Opción desconocida '" << option << "'";
+                    return 1;
+                }
+            }
+            
+            LOG_INFO("benchmark") << "Ejecutando comparador diferencial de engines...";
+            DifferentialTester tester(options);
+            DifferentialReport report = tester.run();
+            tester.printReport(report);
+            bool exported = tester.exportToCSV(report, csv_file);
+            if (!report.passed()) {
+                return 2;
+            }
+            if (!exported) {
+                return 1;
+            }
             
-            std::cout << "Creando dataset sintético..." << std::endl;
-            benchmark.createSyntheticDataset(num_sequences, base_length, mutation_rate, output_path);
+        } else if (command == "engines") {
+            EngineRegistry::instance().print();
+            return 0;
             
         } else {
-            std::cerr << "Error: Comando desconocido '" << command << "'" << std::endl;
-            std::cerr << "Comandos válidos: single, multiple, scalability, synthetic" << std::endl;
+            LOG_ERROR("benchmark.error") << "Error: Comando desconocido '" << command << "'";
+            LOG_ERROR("benchmark.error") << "Comandos válidos: single, multiple, scalability, scaling-threads, synthetic, kernels, compare, pareto, differential, engines";
             return 1;
         }
         
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        LOG_ERROR("benchmark.error") << "Error: " << e.what();
         return 1;
     }
     
-    std::cout << std::endl << "Benchmark completado exitosamente!" << std::endl;
+    LOG_INFO("benchmark") << "\nBenchmark completado exitosamente!";
     return 0;
 }
\ No newline at end of file
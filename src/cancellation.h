@@ -0,0 +1,39 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+
+/**
+ * Señal de cancelación compartida entre quien lanza un alineamiento y el
+ * alineador, que la consulta de forma cooperativa en sus bucles principales
+ */
+class CancellationToken {
+public:
+    CancellationToken() : flag(false) {}
+    
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+    
+    /**
+     * Solicita la cancelación (seguro desde cualquier hilo)
+     */
+    void cancel() {
+        flag.store(true, std::memory_order_relaxed);
+    }
+    
+    /**
+     * Rearma el token para reutilizarlo en otro trabajo
+     */
+    void reset() {
+        flag.store(false, std::memory_order_relaxed);
+    }
+    
+    bool cancelled() const {
+        return flag.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> flag;
+};
+
+#endif // CANCELLATION_H
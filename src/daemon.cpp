@@ -0,0 +1,456 @@
+#include "daemon.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const size_t LATENCY_WINDOW = 4096;
+
+    std::atomic<bool> stop_requested(false);
+
+    void handleStopSignal(int) {
+        stop_requested = true;
+    }
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+AlignmentDaemon::AlignmentDaemon(const DaemonOptions& options)
+    : options(options), pool(options.pool_threads), stopping(false),
+      latency_next(0), requests_ok(0), requests_error(0), rejected_busy(0), connections(0), idle_timeouts(0),
+      active_jobs(0), started_at(std::chrono::steady_clock::now()) {
+    latency_samples.reserve(LATENCY_WINDOW);
+
+    if (options.cache_bytes > 0) {
+        ResultCacheOptions cache_options;
+        cache_options.max_bytes = options.cache_bytes;
+        cache_options.directory = options.cache_dir;
+        cache = std::make_unique<ResultCache>(cache_options);
+    }
+}
+
+#ifdef _WIN32
+
+int AlignmentDaemon::run() {
+    LOG_ERROR("daemon.error") << "Error: El modo demonio requiere sockets de dominio Unix (Linux/macOS).";
+    return 1;
+}
+
+bool AlignmentDaemon::readFrame(int, std::string&, size_t) {
+    return false;
+}
+
+bool AlignmentDaemon::writeFrame(int, const std::string&) {
+    return false;
+}
+
+void AlignmentDaemon::workerLoop() {
+}
+
+void AlignmentDaemon::serveConnection(const PendingConnection&, MSAAligner&) {
+}
+
+#else
+
+int AlignmentDaemon::run() {
+    if (options.socket_path.length() >= sizeof(sockaddr_un::sun_path)) {
+        LOG_ERROR("daemon.error") << "Error: Ruta de socket demasiado larga: " << options.socket_path;
+        return 1;
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        LOG_ERROR("daemon.error") << "Error: No se pudo crear el socket: " << std::strerror(errno);
+        return 1;
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, options.socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    // Las señales se instalan antes de crear el socket para poder retirarlo siempre al salir
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Solo se reemplaza un socket anterior: cualquier otro archivo en la ruta se conserva
+    struct stat existing;
+    if (lstat(options.socket_path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            LOG_ERROR("daemon.error") << "Error: " << options.socket_path
+                                      << " ya existe y no es un socket; no se reemplaza";
+            close(listen_fd);
+            return 1;
+        }
+        unlink(options.socket_path.c_str());
+    }
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        LOG_ERROR("daemon.error") << "Error: No se pudo escuchar en " << options.socket_path << ": "
+                                  << std::strerror(errno);
+        close(listen_fd);
+        return 1;
+    }
+    if (listen(listen_fd, static_cast<int>(std::max<size_t>(options.queue_capacity, 16))) < 0) {
+        LOG_ERROR("daemon.error") << "Error: No se pudo escuchar en " << options.socket_path << ": "
+                                  << std::strerror(errno);
+        close(listen_fd);
+        unlink(options.socket_path.c_str());
+        return 1;
+    }
+
+    FastaIO::setVerbose(false);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::max<size_t>(options.workers, 1); ++i) {
+        workers.emplace_back(&AlignmentDaemon::workerLoop, this);
+    }
+
+    LOG_INFO("daemon") << "Demonio escuchando en " << options.socket_path
+                       << " (trabajos: " << workers.size() << ", cola: " << options.queue_capacity
+                       << ", hilos del pool: " << pool.size() << ")";
+
+    while (!stop_requested) {
+        pollfd poll_fd = {listen_fd, POLLIN, 0};
+        int ready = poll(&poll_fd, 1, 200);
+        if (ready <= 0) {
+            continue;
+        }
+
+        int client_fd = accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+
+        bool accepted = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (queue.size() < options.queue_capacity) {
+                queue.push_back({client_fd, std::chrono::steady_clock::now()});
+                accepted = true;
+            }
+        }
+
+        if (accepted) {
+            queue_condition.notify_one();
+        } else {
+            // Cola llena: se rechaza de inmediato en lugar de acumular latencia
+            writeFrame(client_fd, "BUSY");
+            close(client_fd);
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            rejected_busy++;
+        }
+    }
+
+    // El socket se retira antes de esperar a los trabajadores para no dejarlo huérfano
+    close(listen_fd);
+    unlink(options.socket_path.c_str());
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    LOG_INFO("daemon") << "Demonio detenido.";
+    LOG_INFO("daemon") << statsReport();
+    return 0;
+}
+
+bool AlignmentDaemon::readFrame(int fd, std::string& payload, size_t max_bytes) {
+    auto readExact = [fd](char* buffer, size_t length) {
+        size_t received = 0;
+        while (received < length) {
+            ssize_t n = recv(fd, buffer + received, length - received, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            received += static_cast<size_t>(n);
+        }
+        return true;
+    };
+
+    unsigned char header[4];
+    if (!readExact(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+
+    size_t length = (static_cast<size_t>(header[0]) << 24) | (static_cast<size_t>(header[1]) << 16) |
+                    (static_cast<size_t>(header[2]) << 8) | static_cast<size_t>(header[3]);
+    if (length > max_bytes) {
+        return false;
+    }
+
+    payload.resize(length);
+    return length == 0 || readExact(&payload[0], length);
+}
+
+bool AlignmentDaemon::writeFrame(int fd, const std::string& payload) {
+    unsigned char header[4] = {
+        static_cast<unsigned char>((payload.size() >> 24) & 0xFF),
+        static_cast<unsigned char>((payload.size() >> 16) & 0xFF),
+        static_cast<unsigned char>((payload.size() >> 8) & 0xFF),
+        static_cast<unsigned char>(payload.size() & 0xFF)
+    };
+
+    auto writeAll = [fd](const char* buffer, size_t length) {
+        size_t sent = 0;
+        while (sent < length) {
+            ssize_t n = send(fd, buffer + sent, length - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    };
+
+    return writeAll(reinterpret_cast<const char*>(header), sizeof(header)) &&
+           writeAll(payload.data(), payload.size());
+}
+
+void AlignmentDaemon::workerLoop() {
+    // Alineador propio del trabajador: su configuración y workspace DP se conservan
+    MSAAligner aligner;
+    aligner.setVerbose(false);
+    aligner.setThreadPool(&pool);
+
+    while (true) {
+        PendingConnection connection;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_condition.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            if (queue.empty()) {
+                return;
+            }
+
+            connection = queue.front();
+            queue.pop_front();
+        }
+
+        serveConnection(connection, aligner);
+        close(connection.fd);
+    }
+}
+
+void AlignmentDaemon::serveConnection(const PendingConnection& connection, MSAAligner& aligner) {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        connections++;
+    }
+
+    // Sin datos durante idle_timeout_s, recv y send fallan con EAGAIN y la conexión se cierra
+    if (options.idle_timeout_s > 0.0) {
+        timeval timeout;
+        timeout.tv_sec = static_cast<time_t>(options.idle_timeout_s);
+        timeout.tv_usec = static_cast<suseconds_t>((options.idle_timeout_s - timeout.tv_sec) * 1e6);
+        setsockopt(connection.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+
+    double queue_ms = millisecondsSince(connection.accepted_at);
+    std::string request;
+
+    while (true) {
+        errno = 0;
+        if (!readFrame(connection.fd, request, options.max_frame_bytes)) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                LOG_DEBUG("daemon.idle") << "Conexion inactiva cerrada";
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                idle_timeouts++;
+            }
+            break;
+        }
+        std::string response = handleRequest(request, aligner, queue_ms);
+        if (!writeFrame(connection.fd, response)) {
+            break;
+        }
+        // Solo la primera petición de la conexión esperó en la cola
+        queue_ms = 0.0;
+    }
+}
+
+#endif
+
+std::string AlignmentDaemon::handleRequest(const std::string& request, MSAAligner& aligner, double queue_ms) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    size_t line_end = request.find('\n');
+    std::string command_line = request.substr(0, line_end);
+    std::istringstream command_stream(command_line);
+    std::string command, format, token;
+    command_stream >> command >> format;
+
+    // Opción ALIGN <formato> budget_ms=<n>: presupuesto de tiempo por petición
+    double budget_ms = 0.0;
+    while (command_stream >> token) {
+        if (token.compare(0, 10, "budget_ms=") == 0) {
+            try {
+                budget_ms = std::stod(token.substr(10));
+            } catch (const std::exception&) {
+                recordRequest(millisecondsSince(start_time) + queue_ms, false);
+                return "ERROR Presupuesto invalido: " + token;
+            }
+        }
+    }
+
+    if (command == "PING") {
+        return "OK pong";
+    }
+
+    if (command == "STATS") {
+        return "OK\n" + statsReport();
+    }
+
+    if (command != "ALIGN") {
+        recordRequest(millisecondsSince(start_time) + queue_ms, false);
+        return "ERROR Comando desconocido: " + command;
+    }
+
+    if (format.empty()) {
+        format = "fasta";
+    }
+    if (format != "fasta" && format != "a3m" && format != "rle") {
+        recordRequest(millisecondsSince(start_time) + queue_ms, false);
+        return "ERROR Formato de salida desconocido: " + format;
+    }
+
+    active_jobs++;
+    std::string response;
+    bool ok = false;
+
+    try {
+        std::istringstream body(line_end == std::string::npos ? "" : request.substr(line_end + 1));
+        auto sequences = FastaIO::parseFasta(body, "peticion");
+
+        if (sequences.size() < 2) {
+            response = "ERROR Se necesitan al menos 2 secuencias validas";
+        } else {
+            aligner.setTimeBudget(budget_ms / 1000.0);
+            bool cache_hit = false;
+            auto rows = cache ? cache->align(aligner, sequences, &cache_hit)
+                              : aligner.alignSequencesToRows(sequences);
+            double align_ms = millisecondsSince(start_time);
+
+            if (rows.empty()) {
+                response = "ERROR Fallo en el alineamiento";
+            } else {
+                std::ostringstream output;
+                output << std::fixed << std::setprecision(3)
+                       << "OK queue_ms=" << queue_ms << " align_ms=" << align_ms;
+                if (cache_hit) {
+                    output << " cache=hit";
+                } else if (aligner.getDegradations() != DEGRADE_NONE) {
+                    output << " degraded=" << describeDegradations(aligner.getDegradations());
+                }
+                output << '\n';
+                FastaIO::formatRows(rows, output, format);
+                response = output.str();
+                ok = true;
+            }
+        }
+    } catch (const std::exception& e) {
+        response = std::string("ERROR ") + e.what();
+    }
+
+    active_jobs--;
+    double latency_ms = millisecondsSince(start_time) + queue_ms;
+    recordRequest(latency_ms, ok);
+    LOG_DEBUG("daemon.request").field("format", format).field("ok", ok ? "true" : "false")
+                               .field("queue_ms", queue_ms).field("latency_ms", latency_ms);
+    return response;
+}
+
+void AlignmentDaemon::recordRequest(double latency_ms, bool ok) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+
+    if (ok) {
+        requests_ok++;
+    } else {
+        requests_error++;
+    }
+
+    if (latency_samples.size() < LATENCY_WINDOW) {
+        latency_samples.push_back(latency_ms);
+    } else {
+        latency_samples[latency_next] = latency_ms;
+    }
+    latency_next = (latency_next + 1) % LATENCY_WINDOW;
+}
+
+std::string AlignmentDaemon::statsReport() {
+    std::vector<double> samples;
+    std::ostringstream report;
+    size_t queue_depth = 0;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue_depth = queue.size();
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    samples = latency_samples;
+    std::sort(samples.begin(), samples.end());
+
+    auto percentile = [&samples](double p) {
+        if (samples.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[index];
+    };
+
+    double mean = 0.0;
+    for (double sample : samples) {
+        mean += sample;
+    }
+    if (!samples.empty()) {
+        mean /= samples.size();
+    }
+
+    report << std::fixed << std::setprecision(3);
+    report << "uptime_s=" << millisecondsSince(started_at) / 1000.0 << '\n';
+    report << "workers=" << options.workers << '\n';
+    report << "pool_threads=" << pool.size() << '\n';
+    report << "queue_capacity=" << options.queue_capacity << '\n';
+    report << "queue_depth=" << queue_depth << '\n';
+    report << "active_jobs=" << active_jobs.load() << '\n';
+    report << "connections=" << connections << '\n';
+    report << "idle_timeouts=" << idle_timeouts << '\n';
+    report << "requests_ok=" << requests_ok << '\n';
+    report << "requests_error=" << requests_error << '\n';
+    report << "rejected_busy=" << rejected_busy << '\n';
+    report << "latency_samples=" << samples.size() << '\n';
+    report << "latency_mean_ms=" << mean << '\n';
+    report << "latency_p50_ms=" << percentile(0.50) << '\n';
+    report << "latency_p95_ms=" << percentile(0.95) << '\n';
+    report << "latency_p99_ms=" << percentile(0.99) << '\n';
+    report << "latency_max_ms=" << (samples.empty() ? 0.0 : samples.back()) << '\n';
+    if (cache) {
+        report << cache->statsReport();
+    }
+    return report.str();
+}
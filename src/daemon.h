@@ -0,0 +1,123 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "alignment.h"
+#include "io.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+
+/**
+ * Opciones del demonio de alineamiento
+ */
+struct DaemonOptions {
+    std::string socket_path;        // Ruta del socket de dominio Unix
+    size_t workers;                 // Trabajos atendidos en paralelo
+    size_t queue_capacity;          // Conexiones en espera antes de responder BUSY
+    size_t pool_threads;            // Hilos del pool compartido (0 = núcleos disponibles)
+    size_t max_frame_bytes;         // Tamaño máximo aceptado por mensaje
+    double idle_timeout_s;          // Espera máxima por un mensaje antes de cerrar la conexión (0 = sin límite)
+    size_t cache_bytes;             // Caché de resultados en memoria (0 = desactivada)
+    std::string cache_dir;          // Directorio persistente de la caché (opcional)
+    
+    DaemonOptions() : workers(2), queue_capacity(64), pool_threads(0),
+                      max_frame_bytes(256u * 1024u * 1024u), idle_timeout_s(30.0), cache_bytes(0) {}
+};
+
+/**
+ * Demonio local que atiende trabajos de alineamiento sobre un socket Unix,
+ * manteniendo alineadores, workspaces DP y el pool de hilos calientes entre peticiones.
+ *
+ * Protocolo: cada mensaje es una longitud de 4 bytes (big-endian) seguida de la carga.
+ * Peticiones (primera línea = comando):
+ *   "ALIGN [fasta|a3m|rle]\n<FASTA>"  -> "OK queue_ms=.. align_ms=.. [cache=hit]\n<alineamiento>"
+ *   "STATS"                            -> "OK\n<clave=valor por línea>"
+ *   "PING"                             -> "OK pong"
+ * Los errores se responden como "ERROR <mensaje>" y la cola llena como "BUSY".
+ * Una conexión que no envía datos durante idle_timeout_s se cierra, para que
+ * un cliente inactivo no retenga a un trabajador.
+ */
+class AlignmentDaemon {
+public:
+    /**
+     * Constructor
+     * @param options Opciones del demonio
+     */
+    explicit AlignmentDaemon(const DaemonOptions& options);
+    
+    /**
+     * Destructor
+     */
+    ~AlignmentDaemon() = default;
+    
+    /**
+     * Escucha en el socket hasta recibir SIGINT/SIGTERM
+     * @return Código de salida del proceso
+     */
+    int run();
+    
+    /**
+     * Genera el reporte de estadísticas de latencia y carga
+     * @return Líneas clave=valor
+     */
+    std::string statsReport();
+    
+    /**
+     * Lee un mensaje enmarcado completo
+     * @param fd Descriptor del socket
+     * @param payload Carga leída
+     * @param max_bytes Tamaño máximo aceptado
+     * @return false si la conexión se cerró o el mensaje es inválido
+     */
+    static bool readFrame(int fd, std::string& payload, size_t max_bytes);
+    
+    /**
+     * Escribe un mensaje enmarcado completo
+     * @param fd Descriptor del socket
+     * @param payload Carga a enviar
+     * @return false si la conexión se cerró
+     */
+    static bool writeFrame(int fd, const std::string& payload);
+
+private:
+    struct PendingConnection {
+        int fd;
+        std::chrono::steady_clock::time_point accepted_at;
+    };
+    
+    DaemonOptions options;
+    ThreadPool pool;
+    std::unique_ptr<ResultCache> cache;
+    
+    std::deque<PendingConnection> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_condition;
+    bool stopping;
+    
+    // Estadísticas
+    std::mutex stats_mutex;
+    std::vector<double> latency_samples;     // Ventana circular de latencias (ms)
+    size_t latency_next;
+    unsigned long requests_ok;
+    unsigned long requests_error;
+    unsigned long rejected_busy;
+    unsigned long connections;
+    unsigned long idle_timeouts;
+    std::atomic<int> active_jobs;
+    std::chrono::steady_clock::time_point started_at;
+    
+    void workerLoop();
+    void serveConnection(const PendingConnection& connection, MSAAligner& aligner);
+    std::string handleRequest(const std::string& request, MSAAligner& aligner, double queue_ms);
+    void recordRequest(double latency_ms, bool ok);
+};
+
+#endif // DAEMON_H
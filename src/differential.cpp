@@ -0,0 +1,582 @@
+#include "differential.h"
+#include "kernel_benchmark.h"
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// Subproblemas base de Hirschberg durante el barrido: con el valor de producción
+// la recursión solo aparecería en pares de más de mil residuos por lado
+const size_t TEST_HIRSCHBERG_BASE_CELLS = 16;
+
+const size_t REPORTED_RESIDUES = 60;   // Residuos que se muestran de cada entrada de una discrepancia
+
+std::string removeGaps(const std::string& aligned) {
+    std::string residues;
+    residues.reserve(aligned.size());
+    for (char c : aligned) {
+        if (c != '-') {
+            residues.push_back(c);
+        }
+    }
+    return residues;
+}
+
+std::string shorten(const std::string& sequence) {
+    if (sequence.size() <= REPORTED_RESIDUES) {
+        return sequence.empty() ? "(vacia)" : sequence;
+    }
+    return sequence.substr(0, REPORTED_RESIDUES) + "... (" + std::to_string(sequence.size()) + ")";
+}
+
+/**
+ * Longitud aleatoria sesgada hacia pares cortos, donde están los casos borde
+ */
+size_t randomLength(std::mt19937& gen, size_t max_length) {
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    double kind = chance(gen);
+    size_t limit = kind < 0.5 ? std::min<size_t>(max_length, 16)
+                 : kind < 0.85 ? std::min<size_t>(max_length, 64) : max_length;
+    return std::uniform_int_distribution<size_t>(0, limit)(gen);
+}
+
+std::string randomSequence(std::mt19937& gen, const std::string& residues, size_t length) {
+    std::uniform_int_distribution<size_t> residue(0, residues.size() - 1);
+    std::string sequence(length, ' ');
+    for (char& c : sequence) {
+        c = residues[residue(gen)];
+    }
+    return sequence;
+}
+
+/**
+ * Minúsculas y residuos desconocidos ('N' en ADN, 'X' en proteínas) en algunas posiciones
+ */
+void perturb(std::mt19937& gen, std::string& sequence, bool protein) {
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    for (char& c : sequence) {
+        double roll = chance(gen);
+        if (roll < 0.05) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        } else if (roll < 0.08) {
+            c = protein ? 'X' : 'N';
+        }
+    }
+}
+
+/**
+ * Alineamiento aleatorio: filas derivadas de un ancestro con gaps, y a veces
+ * filas o columnas de solo gaps
+ */
+std::vector<Sequence> randomAlignment(std::mt19937& gen, const std::string& residues, size_t width,
+                                      size_t rows, const std::string& prefix) {
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<size_t> residue(0, residues.size() - 1);
+    std::string ancestor = randomSequence(gen, residues, width);
+    double gap_rate = chance(gen) * 0.6;
+
+    std::vector<bool> gap_column(width, false);
+    if (width > 0 && chance(gen) < 0.2) {
+        gap_column[std::uniform_int_distribution<size_t>(0, width - 1)(gen)] = true;
+    }
+
+    std::vector<Sequence> alignment;
+    for (size_t r = 0; r < rows; ++r) {
+        bool all_gaps = chance(gen) < 0.1;
+        std::string row(width, '-');
+        for (size_t c = 0; c < width; ++c) {
+            if (all_gaps || gap_column[c] || chance(gen) < gap_rate) {
+                continue;
+            }
+            row[c] = chance(gen) < 0.2 ? residues[residue(gen)] : ancestor[c];
+        }
+        alignment.emplace_back(prefix + std::to_string(r), row);
+    }
+    return alignment;
+}
+
+} // namespace
+
+/**
+ * Engine bajo prueba: su alineador (con el engine en el preset) o la función
+ * externa, que se llama directamente para validar su resultado sin respaldo
+ */
+struct DifferentialTester::EngineUnderTest {
+    EngineCheck check;
+    std::unique_ptr<MSAAligner> aligner;
+    PairwiseEngineFn pairwise;
+    MergeEngineFn merge;
+};
+
+DifferentialTester::DifferentialTester(const DifferentialOptions& options) : options(options) {
+    reference.setVerbose(false);
+    FastaIO::setVerbose(false);
+
+    EngineRegistry& registry = EngineRegistry::instance();
+    auto addEngine = [&](EngineStage stage, const EngineInfo& info) {
+        auto engine = std::make_unique<EngineUnderTest>();
+        engine->check.stage = engineStageName(stage);
+        engine->check.engine = info.name;
+        engine->aligner = std::make_unique<MSAAligner>();
+        engine->aligner->setVerbose(false);
+        engine->aligner->hirschberg_base_cells = TEST_HIRSCHBERG_BASE_CELLS;
+
+        AlignerPreset preset;
+        if (stage == EngineStage::PAIRWISE) {
+            preset.pairwise = info.name;
+            engine->pairwise = registry.pairwise(info.name);
+            engine->check.contract = info.name == "full" || info.name == "packed" ? EngineContract::IDENTICAL
+                                   : info.name == "banded" ? EngineContract::BOUNDED : EngineContract::OPTIMAL;
+        } else {
+            preset.merge = info.name;
+            engine->merge = registry.merge(info.name);
+            engine->check.contract = EngineContract::VALID;
+        }
+        engine->aligner->setPreset(preset);
+        engines.push_back(std::move(engine));
+    };
+
+    for (const auto& info : registry.list(EngineStage::PAIRWISE)) {
+        if (selected(info.name)) {
+            addEngine(EngineStage::PAIRWISE, info);
+        }
+    }
+    // La unión integrada ya se recorre con cada engine pairwise
+    for (const auto& info : registry.list(EngineStage::MERGE)) {
+        if (!info.builtin && selected(info.name)) {
+            addEngine(EngineStage::MERGE, info);
+        }
+    }
+    for (const auto& name : options.engines) {
+        if (!registry.contains(EngineStage::PAIRWISE, name) && !registry.contains(EngineStage::MERGE, name)) {
+            LOG_WARN("differential") << "Advertencia: No hay engine pairwise ni merge llamado " << name;
+        }
+    }
+}
+
+DifferentialTester::~DifferentialTester() = default;
+
+const std::string& DifferentialTester::residuesOf(const std::string& alphabet) {
+    return alphabet == "protein" ? MSAAligner::PROTEIN_ALPHABET : MSAAligner::DNA_ALPHABET;
+}
+
+bool DifferentialTester::selected(const std::string& engine) const {
+    return options.engines.empty() ||
+           std::find(options.engines.begin(), options.engines.end(), engine) != options.engines.end();
+}
+
+const char* DifferentialTester::contractName(EngineContract contract) {
+    switch (contract) {
+        case EngineContract::IDENTICAL: return "identical";
+        case EngineContract::OPTIMAL: return "optimal";
+        case EngineContract::BOUNDED: return "bounded";
+        case EngineContract::VALID: return "valid";
+    }
+    return "";
+}
+
+bool DifferentialTester::scoreAlignment(const std::pair<std::string, std::string>& aligned,
+                                        const std::string& seq1, const std::string& seq2,
+                                        int& score, std::string& reason) {
+    if (aligned.first.size() != aligned.second.size()) {
+        reason = "filas de distinta longitud (" + std::to_string(aligned.first.size()) + " y " +
+                 std::to_string(aligned.second.size()) + ")";
+        return false;
+    }
+    if (removeGaps(aligned.first) != seq1 || removeGaps(aligned.second) != seq2) {
+        reason = "sin gaps no reproduce las secuencias de entrada";
+        return false;
+    }
+    score = 0;
+    for (size_t c = 0; c < aligned.first.size(); ++c) {
+        char a = aligned.first[c];
+        char b = aligned.second[c];
+        if (a == '-' && b == '-') {
+            reason = "columna " + std::to_string(c) + " de solo gaps";
+            return false;
+        }
+        score += (a == '-' || b == '-') ? reference.gap_penalty : reference.calculateMatchScore(a, b);
+    }
+    return true;
+}
+
+void DifferentialTester::fail(EngineCheck& check, const std::string& test, const std::string& reason,
+                              const std::string& seq1, const std::string& seq2, DifferentialReport& report) {
+    ++check.failures;
+    ++report.total_failures;
+    if (report.failures.size() < options.max_reported) {
+        report.failures.push_back({check.engine, test, reason, seq1, seq2});
+    }
+}
+
+void DifferentialTester::checkPair(const std::string& seq1, const std::string& seq2, DifferentialReport& report) {
+    const size_t m = seq1.size();
+    const size_t n = seq2.size();
+    ++report.pair_cases;
+
+    // La referencia se resuelve antes que los engines: el workspace DP es del hilo
+    // y lo reutilizan todos los alineadores
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<int>>& dp = reference.initializeDPMatrix(m, n);
+    reference.fillDPMatrix(dp, seq1, seq2, m, n);
+    const int optimal = dp[m][n];
+    const auto expected = reference.reconstructAlignment(dp, seq1, seq2, m, n);
+    report.reference.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.reference.cells += m * n;
+    ++report.reference.pair_cases;
+
+    int score = 0;
+    std::string reason;
+    if (!scoreAlignment(expected, seq1, seq2, score, reason) || score != optimal) {
+        fail(report.reference, "pair", reason.empty() ? "la traza no alcanza dp[m][n]" : reason,
+             seq1, seq2, report);
+        return;
+    }
+
+    for (auto& engine : engines) {
+        if (engine->check.stage != engineStageName(EngineStage::PAIRWISE)) {
+            continue;
+        }
+        EngineCheck& check = engine->check;
+        ++check.pair_cases;
+
+        start = std::chrono::steady_clock::now();
+        std::pair<std::string, std::string> aligned;
+        if (engine->pairwise) {
+            auto path = engine->pairwise(seq1, seq2, engine->aligner->scoringScheme());
+            size_t consumed1 = 0, consumed2 = 0;
+            for (AlignmentStep step : path) {
+                consumed1 += step != AlignmentStep::INSERT;
+                consumed2 += step != AlignmentStep::DELETE;
+            }
+            if (consumed1 != m || consumed2 != n) {
+                check.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                fail(check, "pair", "el camino no consume exactamente ambas secuencias", seq1, seq2, report);
+                continue;
+            }
+            aligned = engine->aligner->pathToAlignment(path, seq1, seq2);
+        } else {
+            aligned = engine->aligner->pairwiseAlignment(seq1, seq2);
+        }
+        check.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        check.cells += m * n;
+
+        reason.clear();
+        if (!scoreAlignment(aligned, seq1, seq2, score, reason)) {
+            fail(check, "pair", reason, seq1, seq2, report);
+        } else if (score > optimal) {
+            fail(check, "pair", "puntaje " + std::to_string(score) + " mayor que el optimo " +
+                 std::to_string(optimal), seq1, seq2, report);
+        } else if (score < optimal) {
+            ++check.suboptimal;
+            if (check.contract != EngineContract::BOUNDED) {
+                fail(check, "pair", "puntaje " + std::to_string(score) + " menor que el optimo " +
+                     std::to_string(optimal), seq1, seq2, report);
+            }
+        } else if (check.contract == EngineContract::IDENTICAL && aligned != expected) {
+            fail(check, "pair", "alineamiento optimo distinto del de la referencia", seq1, seq2, report);
+        }
+    }
+}
+
+void DifferentialTester::checkProfiles(const std::vector<Sequence>& rows1, const std::vector<Sequence>& rows2,
+                                       DifferentialReport& report) {
+    ++report.profile_cases;
+    const Profile profile1 = reference.buildProfileFromAlignment(rows1);
+    const Profile profile2 = reference.buildProfileFromAlignment(rows2);
+    const std::string consensus1 = reference.generateConsensusFromProfile(profile1);
+    const std::string consensus2 = reference.generateConsensusFromProfile(profile2);
+
+    // Óptimo y alineamiento de referencia de los consensos (antes que los engines)
+    const size_t m = consensus1.size();
+    const size_t n = consensus2.size();
+    std::vector<std::vector<int>>& dp = reference.initializeDPMatrix(m, n);
+    reference.fillDPMatrix(dp, consensus1, consensus2, m, n);
+    const int optimal = dp[m][n];
+    const auto expected = reference.reconstructAlignment(dp, consensus1, consensus2, m, n);
+
+    // Masa de cada residuo y de los gaps en ambos perfiles, para la combinación
+    std::vector<double> mass(MSAAligner::ALPHABET_SIZE + 1, 0.0);
+    for (const Profile* profile : {&profile1, &profile2}) {
+        for (int pos = 0; pos < profile->length; ++pos) {
+            for (int base = 0; base < MSAAligner::ALPHABET_SIZE; ++base) {
+                mass[base] += profile->frequencies[pos][base] * profile->num_sequences;
+            }
+            mass[MSAAligner::ALPHABET_SIZE] += profile->gap_frequencies[pos] * profile->num_sequences;
+        }
+    }
+
+    for (auto& engine : engines) {
+        EngineCheck& check = engine->check;
+        MSAAligner& aligner = *engine->aligner;
+        ++check.profile_cases;
+
+        std::pair<std::string, std::string> aligned = engine->merge
+            ? engine->merge(profile1, profile2, aligner.scoringScheme())
+            : aligner.alignProfileConsensus(profile1, profile2);
+
+        // Cada lado conserva sus columnas en orden y ninguna columna queda vacía
+        std::string reason;
+        if (aligned.first.size() != aligned.second.size()) {
+            reason = "consensos alineados de distinta longitud";
+        } else if (static_cast<int>(removeGaps(aligned.first).size()) != profile1.length ||
+                   static_cast<int>(removeGaps(aligned.second).size()) != profile2.length) {
+            reason = "los consensos alineados no conservan las columnas de los perfiles";
+        } else {
+            for (size_t c = 0; c < aligned.first.size() && reason.empty(); ++c) {
+                if (aligned.first[c] == '-' && aligned.second[c] == '-') {
+                    reason = "columna " + std::to_string(c) + " de solo gaps";
+                }
+            }
+        }
+        if (!reason.empty()) {
+            fail(check, "profile", reason, consensus1, consensus2, report);
+            continue;
+        }
+
+        if (!engine->merge) {
+            int score = 0;
+            if (!scoreAlignment(aligned, consensus1, consensus2, score, reason)) {
+                fail(check, "profile", reason, consensus1, consensus2, report);
+                continue;
+            }
+            if (score > optimal || (score < optimal && check.contract != EngineContract::BOUNDED)) {
+                fail(check, "profile", "puntaje de consensos " + std::to_string(score) + " frente al optimo " +
+                     std::to_string(optimal), consensus1, consensus2, report);
+                continue;
+            }
+            if (check.contract == EngineContract::IDENTICAL && aligned != expected) {
+                fail(check, "profile", "consensos alineados distintos de la referencia", consensus1, consensus2,
+                     report);
+                continue;
+            }
+        }
+
+        // Propagación a las filas: mismas filas, mismos residuos, columnas comunes
+        std::vector<Sequence> merged = aligner.propagateGaps(rows1, rows2, aligned);
+        if (merged.size() != rows1.size() + rows2.size()) {
+            fail(check, "profile", "la union no conserva el numero de filas", consensus1, consensus2, report);
+            continue;
+        }
+        for (size_t r = 0; r < merged.size() && reason.empty(); ++r) {
+            const Sequence& source = r < rows1.size() ? rows1[r] : rows2[r - rows1.size()];
+            if (merged[r].sequence.size() != aligned.first.size()) {
+                reason = "la fila " + source.header + " no tiene el ancho de la union";
+            } else if (merged[r].header != source.header ||
+                       removeGaps(merged[r].sequence) != removeGaps(source.sequence)) {
+                reason = "la fila " + source.header + " no conserva sus residuos";
+            }
+        }
+        if (!reason.empty()) {
+            fail(check, "profile", reason, consensus1, consensus2, report);
+            continue;
+        }
+
+        // Combinación de frecuencias: ancho, filas y masa de cada residuo
+        Profile combined = aligner.combineProfiles(profile1, profile2, aligned);
+        if (combined.length != static_cast<int>(aligned.first.size()) ||
+            combined.num_sequences != profile1.num_sequences + profile2.num_sequences) {
+            fail(check, "profile", "el perfil combinado no tiene el ancho o las filas de la union",
+                 consensus1, consensus2, report);
+            continue;
+        }
+        std::vector<double> combined_mass(MSAAligner::ALPHABET_SIZE + 1, 0.0);
+        for (int pos = 0; pos < combined.length; ++pos) {
+            for (int base = 0; base < MSAAligner::ALPHABET_SIZE; ++base) {
+                combined_mass[base] += combined.frequencies[pos][base] * combined.num_sequences;
+            }
+            combined_mass[MSAAligner::ALPHABET_SIZE] += combined.gap_frequencies[pos] * combined.num_sequences;
+        }
+        for (size_t k = 0; k < mass.size(); ++k) {
+            if (std::fabs(combined_mass[k] - mass[k]) > 1e-6 * (1.0 + mass[k])) {
+                fail(check, "profile", "el perfil combinado no conserva las frecuencias de los perfiles",
+                     consensus1, consensus2, report);
+                break;
+            }
+        }
+    }
+}
+
+DifferentialReport DifferentialTester::run() {
+    DifferentialReport report;
+    report.reference.stage = engineStageName(EngineStage::PAIRWISE);
+    report.reference.engine = "reference";
+    report.reference.contract = EngineContract::IDENTICAL;
+
+    std::vector<std::string> alphabets;
+    for (const auto& alphabet : options.alphabets) {
+        if (alphabet == "dna" || alphabet == "protein") {
+            alphabets.push_back(alphabet);
+        } else {
+            LOG_WARN("differential") << "Advertencia: Alfabeto desconocido " << alphabet << ", se omite";
+        }
+    }
+    if (alphabets.empty()) {
+        alphabets.push_back("dna");
+    }
+    const size_t max_length = std::max<size_t>(options.max_length, 1);
+
+    LOG_INFO("differential") << "Comparador diferencial: " << engines.size() << " engines, "
+                             << options.pairs << " pares y " << options.profiles << " uniones de perfiles";
+
+    // Casos límite: vacías, longitud 1, repeticiones, periodos y extremos de longitud
+    std::mt19937 edge_gen(options.seed);
+    const std::string longest = randomSequence(edge_gen, MSAAligner::DNA_ALPHABET, max_length);
+    const std::vector<std::pair<std::string, std::string>> edge_pairs = {
+        {"", ""}, {"", "A"}, {"A", ""}, {"", "ACGTACGT"}, {"ACGTACGT", ""},
+        {"A", "A"}, {"A", "C"}, {"A", "ACGTACGT"}, {"ACGTACGT", "T"},
+        {"AAAAAAAA", "AAA"}, {"AAA", "AAAAAAAA"}, {"ACACACACAC", "CACACA"},
+        {"acgt", "ACGT"}, {"NNNN", "ACGT"}, {"XXXX", "MKVL"},
+        {"ACGTTGCA", "TGCAACGT"}, {longest, ""}, {"", longest}, {longest, "G"}, {"G", longest},
+        {longest, longest}, {longest, longest.substr(longest.size() / 2)}
+    };
+    for (const auto& pair : edge_pairs) {
+        checkPair(pair.first, pair.second, report);
+    }
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    for (int k = 0; k < options.pairs; ++k) {
+        std::mt19937 gen(options.seed + static_cast<unsigned>(k));
+        const std::string& alphabet = alphabets[k % alphabets.size()];
+        const std::string& residues = residuesOf(alphabet);
+
+        std::pair<std::string, std::string> pair;
+        if (chance(gen) < 0.6) {
+            // Par emparentado con divergencia variable
+            pair = KernelBenchmark::makePair(residues, randomLength(gen, max_length), chance(gen) * 0.5, gen());
+        } else {
+            pair.first = randomSequence(gen, residues, randomLength(gen, max_length));
+            pair.second = randomSequence(gen, residues, randomLength(gen, max_length));
+        }
+        if (chance(gen) < 0.2) {
+            perturb(gen, pair.first, alphabet == "protein");
+            perturb(gen, pair.second, alphabet == "protein");
+        }
+        checkPair(pair.first, pair.second, report);
+    }
+
+    // Uniones límite: perfiles vacíos, filas de solo gaps, una sola columna
+    const std::vector<std::pair<std::vector<Sequence>, std::vector<Sequence>>> edge_profiles = {
+        {{Sequence("a0", "")}, {Sequence("b0", "")}},
+        {{Sequence("a0", "")}, {Sequence("b0", "ACGT"), Sequence("b1", "AC-T")}},
+        {{Sequence("a0", "----")}, {Sequence("b0", "ACGT")}},
+        {{Sequence("a0", "----"), Sequence("a1", "----")}, {Sequence("b0", "--")}},
+        {{Sequence("a0", "A")}, {Sequence("b0", "C")}},
+        {{Sequence("a0", "A-"), Sequence("a1", "-A")}, {Sequence("b0", "A")}}
+    };
+    for (const auto& profiles : edge_profiles) {
+        checkProfiles(profiles.first, profiles.second, report);
+    }
+
+    const size_t max_width = std::max<size_t>(max_length / 2, 1);
+    for (int k = 0; k < options.profiles; ++k) {
+        std::mt19937 gen(options.seed + static_cast<unsigned>(options.pairs + k));
+        const std::string& residues = residuesOf(alphabets[k % alphabets.size()]);
+        std::uniform_int_distribution<size_t> rows(1, 6);
+        size_t width1 = chance(gen) < 0.05 ? 0 : randomLength(gen, max_width);
+        size_t width2 = chance(gen) < 0.05 ? 0 : randomLength(gen, max_width);
+        std::vector<Sequence> rows1 = randomAlignment(gen, residues, width1, rows(gen), "a");
+        std::vector<Sequence> rows2 = randomAlignment(gen, residues, width2, rows(gen), "b");
+        checkProfiles(rows1, rows2, report);
+    }
+
+    report.engines.reserve(engines.size());
+    for (const auto& engine : engines) {
+        report.engines.push_back(engine->check);
+    }
+    return report;
+}
+
+void DifferentialTester::printReport(const DifferentialReport& report) const {
+    std::ostringstream header;
+    header << std::left << std::setw(12) << "Engine" << std::setw(10) << "Etapa" << std::setw(11) << "Contrato"
+           << std::right << std::setw(8) << "Pares" << std::setw(10) << "Perfiles" << std::setw(8) << "Fallos"
+           << std::setw(9) << "Subopt." << std::setw(9) << "GCUPS" << std::setw(11) << "Pares/s";
+    LOG_INFO("differential") << header.str();
+    LOG_INFO("differential") << std::string(header.str().size(), '-');
+
+    std::vector<const EngineCheck*> rows = {&report.reference};
+    for (const auto& check : report.engines) {
+        rows.push_back(&check);
+    }
+    for (const EngineCheck* check : rows) {
+        std::ostringstream line;
+        line << std::left << std::setw(12) << check->engine << std::setw(10) << check->stage
+             << std::setw(11) << (check == &report.reference ? "-" : contractName(check->contract))
+             << std::right << std::setw(8) << check->pair_cases << std::setw(10) << check->profile_cases
+             << std::setw(8) << check->failures << std::setw(9) << check->suboptimal;
+        if (check->seconds > 0.0) {
+            line << std::setw(9) << std::fixed << std::setprecision(3) << check->gcups()
+                 << std::setw(11) << std::setprecision(0) << check->pair_cases / check->seconds;
+        } else {
+            line << std::setw(9) << "-" << std::setw(11) << "-";
+        }
+        LOG_INFO("differential") << line.str();
+    }
+
+    for (const auto& failure : report.failures) {
+        LOG_ERROR("differential.error").field("engine", failure.engine)
+            << "Error: " << failure.engine << " (" << failure.test << "): " << failure.reason
+            << "\n  seq1: " << shorten(failure.seq1) << "\n  seq2: " << shorten(failure.seq2);
+    }
+    if (report.total_failures > report.failures.size()) {
+        LOG_ERROR("differential.error") << "... y " << report.total_failures - report.failures.size()
+                                        << " discrepancias mas";
+    }
+
+    if (report.passed()) {
+        LOG_INFO("differential") << "Todos los engines coinciden con la referencia en " << report.pair_cases
+                                 << " pares y " << report.profile_cases << " uniones de perfiles";
+    } else {
+        LOG_ERROR("differential.error") << "Error: " << report.total_failures
+                                        << " discrepancias con la DP de referencia";
+    }
+}
+
+bool DifferentialTester::exportToCSV(const DifferentialReport& report, const std::string& csv_file) const {
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(csv_file).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::ofstream file(csv_file);
+
+    if (!file.is_open()) {
+        LOG_ERROR("differential.error") << "Error: No se pudo crear el archivo CSV " << csv_file;
+        return false;
+    }
+
+    file << "Engine,Stage,Contract,PairCases,ProfileCases,Failures,Suboptimal,Cells,Seconds,GCUPS,PairsPerSecond\n";
+    std::vector<const EngineCheck*> rows = {&report.reference};
+    for (const auto& check : report.engines) {
+        rows.push_back(&check);
+    }
+    for (const EngineCheck* check : rows) {
+        file << check->engine << "," << check->stage << ","
+             << (check == &report.reference ? "reference" : contractName(check->contract)) << ","
+             << check->pair_cases << "," << check->profile_cases << "," << check->failures << ","
+             << check->suboptimal << "," << check->cells << "," << check->seconds << ",";
+        if (check->seconds > 0.0) {
+            file << check->gcups() << "," << check->pair_cases / check->seconds;
+        } else {
+            file << ",";
+        }
+        file << "\n";
+    }
+
+    file.close();
+    if (!file) {
+        LOG_ERROR("differential.error") << "Error: Fallo la escritura del archivo CSV " << csv_file;
+        return false;
+    }
+    LOG_INFO("differential") << "Resultados exportados a CSV: " << csv_file;
+    return true;
+}
@@ -0,0 +1,164 @@
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+#include "alignment.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Parámetros del comparador diferencial de engines
+ */
+struct DifferentialOptions {
+    int pairs;                             // Pares aleatorios (además de los casos límite)
+    int profiles;                          // Pares de alineamientos aleatorios para la unión de perfiles
+    size_t max_length;                     // Longitud máxima de secuencias y alineamientos aleatorios
+    std::vector<std::string> alphabets;    // "dna" y/o "protein"
+    std::vector<std::string> engines;      // Engines pairwise y merge a contrastar (vacío = todos)
+    unsigned seed;                         // Semilla (el caso k usa seed + k)
+    size_t max_reported;                   // Discrepancias que se detallan
+
+    DifferentialOptions() : pairs(2000), profiles(300), max_length(300), alphabets{"dna", "protein"},
+                            seed(42), max_reported(20) {}
+};
+
+/**
+ * Garantía que se exige a un engine frente a la DP de referencia
+ */
+enum class EngineContract {
+    IDENTICAL,                  // Mismo alineamiento que reconstructAlignment (full, packed)
+    OPTIMAL,                    // Mismo puntaje óptimo con cualquier camino (linear, pairwise externos)
+    BOUNDED,                    // Alineamiento válido con puntaje <= óptimo (banded)
+    VALID                       // Solo alineamiento válido (merge externos: su objetivo es propio)
+};
+
+/**
+ * Resultado de un engine en el barrido
+ */
+struct EngineCheck {
+    std::string stage;                 // "pairwise" o "merge"
+    std::string engine;
+    EngineContract contract;
+    uint64_t pair_cases;
+    uint64_t profile_cases;
+    uint64_t failures;                 // Alineamientos inválidos o que incumplen el contrato
+    uint64_t suboptimal;               // Pares con puntaje menor que el óptimo (admitido en BOUNDED)
+    uint64_t cells;                    // Celdas m x n de los pares
+    double seconds;                    // Tiempo dentro del engine en los pares
+
+    EngineCheck() : contract(EngineContract::OPTIMAL), pair_cases(0), profile_cases(0), failures(0),
+                    suboptimal(0), cells(0), seconds(0.0) {}
+
+    /**
+     * Miles de millones de celdas por segundo en los pares (0 si no aplica)
+     */
+    double gcups() const {
+        return seconds > 0.0 ? cells / seconds / 1e9 : 0.0;
+    }
+};
+
+/**
+ * Discrepancia encontrada (con las entradas para reproducirla)
+ */
+struct DifferentialFailure {
+    std::string engine;
+    std::string test;                  // "pair" o "profile"
+    std::string reason;
+    std::string seq1;                  // Secuencias del par, o consensos de los perfiles
+    std::string seq2;
+};
+
+/**
+ * Resultado del comparador diferencial
+ */
+struct DifferentialReport {
+    EngineCheck reference;                       // DP de referencia (fillDPMatrix + reconstructAlignment)
+    std::vector<EngineCheck> engines;
+    std::vector<DifferentialFailure> failures;   // Solo las primeras max_reported
+    uint64_t pair_cases;
+    uint64_t profile_cases;
+    uint64_t total_failures;
+
+    DifferentialReport() : pair_cases(0), profile_cases(0), total_failures(0) {}
+
+    bool passed() const {
+        return total_failures == 0;
+    }
+};
+
+/**
+ * Comparador diferencial de los engines de DP contra la DP escalar de
+ * referencia (fillDPMatrix + reconstructAlignment).
+ *
+ * Cada par aleatorio (longitudes, alfabetos, divergencias, minúsculas y
+ * residuos desconocidos) y cada caso límite (vacías, longitud 1, repeticiones)
+ * se alinea con la referencia y con cada engine pairwise por el camino de
+ * producción (pairwiseAlignment con el engine elegido; los externos se llaman
+ * directamente para ver su camino sin validar). Se comprueba que cada
+ * alineamiento conserve ambas secuencias sin columnas de solo gaps y que su
+ * puntaje cumpla el contrato del engine. En Hirschberg se baja el tamaño de
+ * los subproblemas base para que la recursión se ejercite también en pares
+ * cortos. Los pares de alineamientos (con filas y columnas de solo gaps y
+ * perfiles vacíos) recorren la unión de perfiles: consensos alineados,
+ * propagación de gaps a las filas y combinación de frecuencias.
+ */
+class DifferentialTester {
+public:
+    explicit DifferentialTester(const DifferentialOptions& options = DifferentialOptions());
+    ~DifferentialTester();
+
+    /**
+     * Ejecuta el barrido completo
+     * @return Resultado por engine y discrepancias
+     */
+    DifferentialReport run();
+
+    /**
+     * Muestra el resultado por engine y las discrepancias
+     */
+    void printReport(const DifferentialReport& report) const;
+
+    /**
+     * Exporta el resultado por engine a CSV (crea el directorio si falta)
+     * @param csv_file Archivo de salida
+     * @return false si no se pudo escribir
+     */
+    bool exportToCSV(const DifferentialReport& report, const std::string& csv_file) const;
+
+    /**
+     * Nombre del contrato ("identical", "optimal", "bounded", "valid")
+     */
+    static const char* contractName(EngineContract contract);
+
+private:
+    struct EngineUnderTest;
+
+    DifferentialOptions options;
+    MSAAligner reference;
+    std::vector<std::unique_ptr<EngineUnderTest>> engines;
+
+    bool selected(const std::string& engine) const;
+
+    /**
+     * Residuos del alfabeto del alineador ("dna" o "protein")
+     */
+    static const std::string& residuesOf(const std::string& alphabet);
+
+    void checkPair(const std::string& seq1, const std::string& seq2, DifferentialReport& report);
+
+    void checkProfiles(const std::vector<Sequence>& rows1, const std::vector<Sequence>& rows2,
+                       DifferentialReport& report);
+
+    /**
+     * Puntaje de un alineamiento de seq1 contra seq2 con las puntuaciones del alineador
+     * @return false (con el motivo) si no conserva ambas secuencias o tiene columnas de solo gaps
+     */
+    bool scoreAlignment(const std::pair<std::string, std::string>& aligned, const std::string& seq1,
+                        const std::string& seq2, int& score, std::string& reason);
+
+    void fail(EngineCheck& check, const std::string& test, const std::string& reason,
+              const std::string& seq1, const std::string& seq2, DifferentialReport& report);
+};
+
+#endif // DIFFERENTIAL_H
@@ -0,0 +1,91 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Matriz de distancias simétrica con diagonal nula.
+ *
+ * Densa: n x n valores contiguos. Empaquetada: solo el triángulo superior
+ * (i < j) numerado por filas, igual que los pares de DistanceShards, con la
+ * mitad de memoria.
+ */
+class DistanceMatrix {
+public:
+    DistanceMatrix() : n(0), is_packed(false) {}
+
+    /**
+     * Dimensiona la matriz y pone todas las distancias a cero
+     * @param size Número de secuencias
+     * @param packed true para guardar solo el triángulo superior
+     */
+    void reset(size_t size, bool packed) {
+        n = size;
+        is_packed = packed;
+        values.assign(bytesFor(size, packed) / sizeof(double), 0.0);
+    }
+
+    /**
+     * Adopta los valores de un almacén de distancias ya empaquetado
+     * @param size Número de secuencias
+     * @param upper Triángulo superior por filas (n * (n - 1) / 2 valores)
+     */
+    void assignPacked(size_t size, std::vector<double> upper) {
+        n = size;
+        is_packed = true;
+        values = std::move(upper);
+    }
+
+    double get(size_t i, size_t j) const {
+        if (!is_packed) {
+            return values[i * n + j];
+        }
+        if (i == j) {
+            return 0.0;
+        }
+        return values[packedIndex(std::min(i, j), std::max(i, j))];
+    }
+
+    void set(size_t i, size_t j, double value) {
+        if (!is_packed) {
+            values[i * n + j] = value;
+            values[j * n + i] = value;
+        } else if (i != j) {
+            values[packedIndex(std::min(i, j), std::max(i, j))] = value;
+        }
+    }
+
+    size_t size() const { return n; }
+    bool packed() const { return is_packed; }
+    bool empty() const { return n == 0; }
+
+    /**
+     * Libera los valores
+     */
+    void clear() {
+        n = 0;
+        std::vector<double>().swap(values);
+    }
+
+    /**
+     * Memoria de los valores para n secuencias
+     */
+    static size_t bytesFor(size_t size, bool packed) {
+        size_t count = packed ? (size < 2 ? 0 : size * (size - 1) / 2) : size * size;
+        return count * sizeof(double);
+    }
+
+private:
+    size_t n;
+    bool is_packed;
+    std::vector<double> values;
+
+    size_t packedIndex(size_t i, size_t j) const {
+        return i * (2 * n - i - 1) / 2 + (j - i - 1);
+    }
+};
+
+#endif // DISTANCE_MATRIX_H
@@ -0,0 +1,252 @@
+#include "distance_shards.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char SHARD_MAGIC[8] = {'M', 'S', 'A', 'D', 'I', 'S', 'T', '1'};
+const uint32_t SHARD_VERSION = 2;
+const size_t SHARD_HEADER_BYTES = 8 + 4 * 4 + 8 * 4 + 4;    // Sin el nombre del engine
+const uint32_t MAX_ENGINE_NAME = 256;
+
+template <typename T>
+void writePod(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readPod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+bool DistanceShards::parseShardSpec(const std::string& spec, uint32_t& index, uint32_t& count) {
+    size_t slash = spec.find('/');
+    if (slash == std::string::npos || slash == 0 || slash + 1 == spec.size()) {
+        return false;
+    }
+
+    try {
+        size_t used = 0;
+        unsigned long i = std::stoul(spec.substr(0, slash), &used);
+        if (used != slash) {
+            return false;
+        }
+        unsigned long k = std::stoul(spec.substr(slash + 1), &used);
+        if (used != spec.size() - slash - 1 || k == 0 || i >= k || k > UINT32_MAX) {
+            return false;
+        }
+        index = static_cast<uint32_t>(i);
+        count = static_cast<uint32_t>(k);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void DistanceShards::shardPairRange(uint64_t n, uint32_t index, uint32_t count,
+                                    uint64_t& pair_begin, uint64_t& pair_end) {
+    uint64_t total = totalPairs(n);
+    uint64_t base = total / count;
+    uint64_t extra = total % count;
+    pair_begin = index * base + std::min<uint64_t>(index, extra);
+    pair_end = pair_begin + base + (index < extra ? 1 : 0);
+}
+
+uint64_t DistanceShards::fingerprint(const std::vector<Sequence>& sequences) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const std::string& text) {
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= '\n';
+        hash *= 1099511628211ULL;
+    };
+
+    for (const auto& seq : sequences) {
+        mix(seq.header);
+        mix(seq.sequence);
+    }
+    return hash;
+}
+
+bool DistanceShards::writeShard(const DistanceShard& shard, const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        LOG_ERROR("distances.error").field("file", path)
+            << "Error: No se puede escribir el archivo de distancias: " << path;
+        return false;
+    }
+
+    out.write(SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    writePod(out, SHARD_VERSION);
+    writePod(out, shard.shard_index);
+    writePod(out, shard.shard_count);
+    writePod(out, uint32_t(0));
+    writePod(out, shard.num_sequences);
+    writePod(out, shard.fingerprint);
+    writePod(out, shard.pair_begin);
+    writePod(out, shard.pair_end);
+    writePod(out, static_cast<uint32_t>(shard.distance_engine.size()));
+    out.write(shard.distance_engine.data(), static_cast<std::streamsize>(shard.distance_engine.size()));
+    out.write(reinterpret_cast<const char*>(shard.values.data()),
+              static_cast<std::streamsize>(shard.values.size() * sizeof(double)));
+
+    if (!out) {
+        LOG_ERROR("distances.error").field("file", path)
+            << "Error: Escritura incompleta del archivo de distancias: " << path;
+        return false;
+    }
+    return true;
+}
+
+bool DistanceShards::readShard(const std::string& path, DistanceShard& shard) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        LOG_ERROR("distances.error").field("file", path)
+            << "Error: No se puede abrir el archivo de distancias: " << path;
+        return false;
+    }
+    uint64_t file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    char magic[sizeof(SHARD_MAGIC)];
+    uint32_t version = 0, reserved = 0, name_length = 0;
+    bool ok = file_size >= SHARD_HEADER_BYTES &&
+              in.read(magic, sizeof(magic)) &&
+              std::memcmp(magic, SHARD_MAGIC, sizeof(magic)) == 0 &&
+              readPod(in, version);
+    if (ok && version != SHARD_VERSION) {
+        LOG_ERROR("distances.error").field("file", path).field("version", version)
+            << "Error: " << path << " tiene el formato de distancias v" << version
+            << " (se espera v" << SHARD_VERSION << "); vuelva a calcular los fragmentos.";
+        return false;
+    }
+    ok = ok && readPod(in, shard.shard_index) && readPod(in, shard.shard_count) &&
+         readPod(in, reserved) &&
+         readPod(in, shard.num_sequences) && readPod(in, shard.fingerprint) &&
+         readPod(in, shard.pair_begin) && readPod(in, shard.pair_end) &&
+         readPod(in, name_length) && name_length <= MAX_ENGINE_NAME &&
+         file_size >= SHARD_HEADER_BYTES + name_length;
+    if (ok) {
+        shard.distance_engine.resize(name_length);
+        ok = name_length == 0 || in.read(&shard.distance_engine[0], name_length);
+    }
+
+    uint64_t expected_end = 0, expected_begin = 0;
+    if (ok) {
+        ok = shard.shard_count > 0 && shard.shard_index < shard.shard_count;
+    }
+    if (ok) {
+        shardPairRange(shard.num_sequences, shard.shard_index, shard.shard_count,
+                       expected_begin, expected_end);
+        ok = shard.pair_begin == expected_begin && shard.pair_end == expected_end &&
+             file_size == SHARD_HEADER_BYTES + name_length +
+                          (shard.pair_end - shard.pair_begin) * sizeof(double);
+    }
+    if (!ok) {
+        LOG_ERROR("distances.error").field("file", path)
+            << "Error: Archivo de distancias invalido o truncado: " << path;
+        return false;
+    }
+
+    shard.values.resize(static_cast<size_t>(shard.pair_end - shard.pair_begin));
+    in.read(reinterpret_cast<char*>(shard.values.data()),
+            static_cast<std::streamsize>(shard.values.size() * sizeof(double)));
+    return static_cast<bool>(in);
+}
+
+bool DistanceShards::mergeShards(const std::vector<std::string>& paths, DistanceShard& store) {
+    std::vector<DistanceShard> shards(paths.size());
+    for (size_t s = 0; s < paths.size(); ++s) {
+        if (!readShard(paths[s], shards[s])) {
+            return false;
+        }
+    }
+    if (shards.empty()) {
+        LOG_ERROR("distances.error") << "Error: No se indicaron fragmentos para unir.";
+        return false;
+    }
+
+    std::sort(shards.begin(), shards.end(), [](const DistanceShard& a, const DistanceShard& b) {
+        return a.shard_index < b.shard_index;
+    });
+
+    const DistanceShard& first = shards.front();
+    if (shards.size() != first.shard_count) {
+        LOG_ERROR("distances.error") << "Error: Se esperaban " << first.shard_count
+                                     << " fragmentos y se recibieron " << shards.size();
+        return false;
+    }
+    for (size_t s = 0; s < shards.size(); ++s) {
+        if (shards[s].num_sequences != first.num_sequences || shards[s].fingerprint != first.fingerprint ||
+            shards[s].shard_count != first.shard_count) {
+            LOG_ERROR("distances.error") << "Error: Los fragmentos provienen de entradas distintas.";
+            return false;
+        }
+        if (shards[s].distance_engine != first.distance_engine) {
+            LOG_ERROR("distances.error") << "Error: Los fragmentos se calcularon con engines de distancia "
+                                         << "distintos (" << first.distance_engine << " y " << shards[s].distance_engine << ").";
+            return false;
+        }
+        if (shards[s].shard_index != s) {
+            LOG_ERROR("distances.error") << "Error: Falta el fragmento " << s << "/" << first.shard_count;
+            return false;
+        }
+    }
+
+    store = DistanceShard();
+    store.num_sequences = first.num_sequences;
+    store.fingerprint = first.fingerprint;
+    store.distance_engine = first.distance_engine;
+    store.pair_end = totalPairs(first.num_sequences);
+    store.values.reserve(static_cast<size_t>(store.pair_end));
+    for (const auto& shard : shards) {
+        store.values.insert(store.values.end(), shard.values.begin(), shard.values.end());
+    }
+    return true;
+}
+
+bool DistanceShards::loadMatrix(const std::string& path, const std::vector<Sequence>& sequences,
+                                const std::string& distance_engine, DistanceMatrix& matrix, bool packed) {
+    DistanceShard store;
+    if (!readShard(path, store)) {
+        return false;
+    }
+    if (store.shard_count != 1) {
+        LOG_ERROR("distances.error").field("file", path)
+            << "Error: " << path << " es un fragmento; unalo antes con 'distances --merge'.";
+        return false;
+    }
+    if (store.num_sequences != sequences.size() || store.fingerprint != fingerprint(sequences)) {
+        LOG_ERROR("distances.error").field("file", path)
+            << "Error: El almacen de distancias no corresponde al archivo de entrada.";
+        return false;
+    }
+    if (store.distance_engine != distance_engine) {
+        LOG_ERROR("distances.error").field("file", path).field("engine", store.distance_engine)
+            << "Error: El almacen de distancias se calculo con el engine '" << store.distance_engine
+            << "' y el alineamiento usa '" << distance_engine << "'.";
+        return false;
+    }
+
+    size_t n = sequences.size();
+    if (packed) {
+        // Los pares del almacén ya están en el orden de la matriz empaquetada
+        matrix.assignPacked(n, std::move(store.values));
+        return true;
+    }
+    
+    matrix.reset(n, false);
+    size_t pair = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            matrix.set(i, j, store.values[pair++]);
+        }
+    }
+    return true;
+}
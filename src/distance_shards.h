@@ -0,0 +1,126 @@
+#ifndef DISTANCE_SHARDS_H
+#define DISTANCE_SHARDS_H
+
+#include "io.h"
+#include "distance_matrix.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Bloque contiguo del triángulo superior de la matriz de distancias.
+ * Los pares (i, j) con i < j se numeran por filas: (0,1), (0,2), ..., (1,2), ...
+ * Un almacén de distancias completo es un fragmento 0/1 que cubre todos los pares.
+ */
+struct DistanceShard {
+    uint32_t shard_index;           // Fragmento i de k
+    uint32_t shard_count;           // Número total de fragmentos k
+    uint64_t num_sequences;         // Secuencias de la entrada
+    uint64_t fingerprint;           // Huella de la entrada (detecta entradas distintas)
+    uint64_t pair_begin;            // Primer par del bloque
+    uint64_t pair_end;              // Par siguiente al último
+    std::string distance_engine;    // Engine de distancias que calculó los valores ("identity", "kmer", ...)
+    std::vector<double> values;     // Distancias de los pares [pair_begin, pair_end)
+
+    DistanceShard() : shard_index(0), shard_count(1), num_sequences(0), fingerprint(0),
+                      pair_begin(0), pair_end(0) {}
+};
+
+/**
+ * Reparto determinista de la etapa de distancias entre procesos o máquinas que
+ * comparten un sistema de archivos, y unión de los fragmentos en un almacén.
+ *
+ * Formato binario (orden de bytes nativo, little-endian en la práctica):
+ * "MSADIST1", version u32, shard_index u32, shard_count u32, reservado u32,
+ * num_sequences u64, fingerprint u64, pair_begin u64, pair_end u64, longitud
+ * u32 y bytes del nombre del engine de distancias, y los valores como double.
+ * Los fragmentos y almacenes de engines distintos no se mezclan.
+ */
+class DistanceShards {
+public:
+    /**
+     * Interpreta una especificación "i/k" con 0 <= i < k
+     * @return true si es válida
+     */
+    static bool parseShardSpec(const std::string& spec, uint32_t& index, uint32_t& count);
+
+    /**
+     * Número de pares del triángulo superior para n secuencias
+     */
+    static uint64_t totalPairs(uint64_t n) {
+        return n < 2 ? 0 : n * (n - 1) / 2;
+    }
+
+    /**
+     * Índice lineal del par (row, row + 1)
+     */
+    static uint64_t rowOffset(uint64_t n, uint64_t row) {
+        return row * (2 * n - row - 1) / 2;
+    }
+
+    /**
+     * Fila que contiene el par de índice lineal pair
+     */
+    static uint64_t rowOfPair(uint64_t n, uint64_t pair) {
+        // Última fila cuyo desplazamiento no supera el par (búsqueda binaria)
+        uint64_t low = 0, high = n < 2 ? 1 : n - 1;
+        while (low + 1 < high) {
+            uint64_t mid = low + (high - low) / 2;
+            if (rowOffset(n, mid) <= pair) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    /**
+     * Rango de pares del fragmento index/count; los fragmentos tienen el mismo
+     * número de pares (±1), así que el trabajo queda equilibrado
+     */
+    static void shardPairRange(uint64_t n, uint32_t index, uint32_t count,
+                               uint64_t& pair_begin, uint64_t& pair_end);
+
+    /**
+     * Huella FNV-1a de encabezados y secuencias, en orden
+     */
+    static uint64_t fingerprint(const std::vector<Sequence>& sequences);
+
+    /**
+     * Escribe un fragmento o almacén
+     * @return true si se escribió completo
+     */
+    static bool writeShard(const DistanceShard& shard, const std::string& path);
+
+    /**
+     * Lee y valida un fragmento o almacén
+     * @return true si el archivo es válido
+     */
+    static bool readShard(const std::string& path, DistanceShard& shard);
+
+    /**
+     * Une fragmentos de la misma entrada en un almacén completo. Comprueba que
+     * coincidan entrada, engine de distancias y número de fragmentos y que
+     * cubran todos los pares sin huecos
+     * @param paths Archivos de fragmento (en cualquier orden)
+     * @param store Almacén resultante (fragmento 0/1)
+     * @return true si la unión es válida
+     */
+    static bool mergeShards(const std::vector<std::string>& paths, DistanceShard& store);
+
+    /**
+     * Carga un almacén como matriz de distancias para la construcción del árbol
+     * @param path Archivo del almacén
+     * @param sequences Secuencias de entrada (deben coincidir con la huella)
+     * @param distance_engine Engine de distancias del alineador (debe coincidir con el del almacén)
+     * @param matrix Matriz resultante
+     * @param packed true para conservar el triángulo superior tal como está en el
+     *               archivo; false para expandirlo a la matriz densa n x n
+     * @return true si el almacén corresponde a la entrada
+     */
+    static bool loadMatrix(const std::string& path, const std::vector<Sequence>& sequences,
+                           const std::string& distance_engine, DistanceMatrix& matrix, bool packed = false);
+};
+
+#endif // DISTANCE_SHARDS_H
@@ -0,0 +1,186 @@
+#include "engines.h"
+#include "logger.h"
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+const char* const STAGE_NAMES[] = {"distance", "tree", "pairwise", "merge", "output"};
+
+} // namespace
+
+const char* engineStageName(EngineStage stage) {
+    return STAGE_NAMES[static_cast<int>(stage)];
+}
+
+bool parseEngineStage(const std::string& name, EngineStage& stage) {
+    for (int s = 0; s <= static_cast<int>(EngineStage::OUTPUT); ++s) {
+        if (name == STAGE_NAMES[s]) {
+            stage = static_cast<EngineStage>(s);
+            return true;
+        }
+    }
+    return false;
+}
+
+EngineRegistry& EngineRegistry::instance() {
+    static EngineRegistry registry;
+    return registry;
+}
+
+EngineRegistry::EngineRegistry() {
+    addBuiltin(EngineStage::DISTANCE, "identity", "Identidad posicion a posicion (sin alinear el par)");
+    addBuiltin(EngineStage::DISTANCE, "kmer", "k-meros compartidos (costo independiente de la longitud)");
+
+    addBuiltin(EngineStage::TREE, "upgma", "UPGMA");
+    addBuiltin(EngineStage::TREE, "nj", "Neighbor joining, enraizado en la ultima union");
+
+    addBuiltin(EngineStage::PAIRWISE, "full", "Matriz DP completa (traza empaquetada o Hirschberg si no cabe)");
+    addBuiltin(EngineStage::PAIRWISE, "banded", "Banda alrededor de la diagonal (no garantiza el optimo)");
+    addBuiltin(EngineStage::PAIRWISE, "packed", "Dos filas de puntajes y traza de 2 bits por celda");
+    addBuiltin(EngineStage::PAIRWISE, "linear", "Hirschberg: memoria lineal, mas tiempo");
+
+    addBuiltin(EngineStage::MERGE, "consensus", "Alinea los consensos de ambos perfiles con el engine pairwise");
+
+    for (const char* format : {"fasta", "a3m", "rle"}) {
+        std::string name = format;
+        addBuiltin(EngineStage::OUTPUT, name,
+                   name == "fasta" ? "FASTA alineado" :
+                   name == "a3m" ? "A3M: inserciones en minusculas, sin gaps de relleno" :
+                                   "Corridas de gaps codificadas como -<n>",
+                   [name](const std::vector<AlignedRow>& rows, std::ostream& output) {
+                       FastaIO::formatRows(rows, output, name);
+                   });
+    }
+}
+
+void EngineRegistry::addBuiltin(EngineStage stage, const std::string& name, const std::string& description,
+                                OutputEngineFn output) {
+    Entry entry;
+    entry.info = {stage, name, description, true};
+    entry.output = std::move(output);
+    entries.push_back(std::move(entry));
+}
+
+bool EngineRegistry::add(Entry entry) {
+    if (entry.info.name.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (find(entry.info.stage, entry.info.name)) {
+        return false;
+    }
+    entries.push_back(std::move(entry));
+    return true;
+}
+
+bool EngineRegistry::addDistance(const std::string& name, const std::string& description, DistanceEngineFn fn) {
+    Entry entry;
+    entry.info = {EngineStage::DISTANCE, name, description, false};
+    entry.distance = std::move(fn);
+    return entry.distance && add(std::move(entry));
+}
+
+bool EngineRegistry::addTree(const std::string& name, const std::string& description, TreeEngineFn fn) {
+    Entry entry;
+    entry.info = {EngineStage::TREE, name, description, false};
+    entry.tree = std::move(fn);
+    return entry.tree && add(std::move(entry));
+}
+
+bool EngineRegistry::addPairwise(const std::string& name, const std::string& description, PairwiseEngineFn fn) {
+    Entry entry;
+    entry.info = {EngineStage::PAIRWISE, name, description, false};
+    entry.pairwise = std::move(fn);
+    return entry.pairwise && add(std::move(entry));
+}
+
+bool EngineRegistry::addMerge(const std::string& name, const std::string& description, MergeEngineFn fn) {
+    Entry entry;
+    entry.info = {EngineStage::MERGE, name, description, false};
+    entry.merge = std::move(fn);
+    return entry.merge && add(std::move(entry));
+}
+
+bool EngineRegistry::addOutput(const std::string& name, const std::string& description, OutputEngineFn fn) {
+    Entry entry;
+    entry.info = {EngineStage::OUTPUT, name, description, false};
+    entry.output = std::move(fn);
+    return entry.output && add(std::move(entry));
+}
+
+const EngineRegistry::Entry* EngineRegistry::find(EngineStage stage, const std::string& name) const {
+    for (const auto& entry : entries) {
+        if (entry.info.stage == stage && entry.info.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool EngineRegistry::contains(EngineStage stage, const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return find(stage, name) != nullptr;
+}
+
+bool EngineRegistry::isBuiltin(EngineStage stage, const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = find(stage, name);
+    return entry && entry->info.builtin;
+}
+
+std::vector<EngineInfo> EngineRegistry::list(EngineStage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<EngineInfo> infos;
+    for (const auto& entry : entries) {
+        if (entry.info.stage == stage) {
+            infos.push_back(entry.info);
+        }
+    }
+    return infos;
+}
+
+void EngineRegistry::print() const {
+    std::ostringstream text;
+    text << "Engines disponibles (* = integrado):";
+    for (int s = 0; s <= static_cast<int>(EngineStage::OUTPUT); ++s) {
+        EngineStage stage = static_cast<EngineStage>(s);
+        text << "\n  " << engineStageName(stage) << ":";
+        for (const auto& info : list(stage)) {
+            text << "\n    " << (info.builtin ? "* " : "  ") << std::left << std::setw(12) << info.name
+                 << info.description;
+        }
+    }
+    LOG_INFO("engines") << text.str();
+}
+
+DistanceEngineFn EngineRegistry::distance(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = find(EngineStage::DISTANCE, name);
+    return entry ? entry->distance : nullptr;
+}
+
+TreeEngineFn EngineRegistry::tree(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = find(EngineStage::TREE, name);
+    return entry ? entry->tree : nullptr;
+}
+
+PairwiseEngineFn EngineRegistry::pairwise(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = find(EngineStage::PAIRWISE, name);
+    return entry ? entry->pairwise : nullptr;
+}
+
+MergeEngineFn EngineRegistry::merge(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = find(EngineStage::MERGE, name);
+    return entry ? entry->merge : nullptr;
+}
+
+OutputEngineFn EngineRegistry::output(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = find(EngineStage::OUTPUT, name);
+    return entry ? entry->output : nullptr;
+}
@@ -0,0 +1,165 @@
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include "io.h"
+#include "distance_matrix.h"
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Profile;
+enum class AlignmentStep : unsigned char;
+
+/**
+ * Etapas del alineador con implementaciones intercambiables
+ */
+enum class EngineStage {
+    DISTANCE,                       // Distancia entre cada par de secuencias
+    TREE,                           // Árbol guía a partir de la matriz de distancias
+    PAIRWISE,                       // DP par a par (uniones, realineamiento de filas)
+    MERGE,                          // Unión de dos perfiles del alineamiento progresivo
+    OUTPUT                          // Formato del alineamiento escrito
+};
+
+/**
+ * Nombre de la etapa ("distance", "tree", "pairwise", "merge", "output")
+ */
+const char* engineStageName(EngineStage stage);
+
+/**
+ * Etapa a partir de su nombre
+ * @return false si el nombre no corresponde a ninguna etapa
+ */
+bool parseEngineStage(const std::string& name, EngineStage& stage);
+
+/**
+ * Puntuaciones con las que alinea MSAAligner, para los engines de DP
+ */
+struct ScoringScheme {
+    int match;
+    int mismatch;
+    int gap;
+};
+
+/**
+ * Unión del árbol guía: los clusters 0..n-1 son las secuencias y la unión k
+ * crea el cluster n + k
+ */
+struct TreeMerge {
+    size_t left;
+    size_t right;
+    double height;
+};
+
+// Firmas de los engines externos de cada etapa
+using DistanceEngineFn = std::function<double(const std::string& seq1, const std::string& seq2)>;
+using TreeEngineFn = std::function<std::vector<TreeMerge>(const DistanceMatrix& distances)>;
+using PairwiseEngineFn = std::function<std::vector<AlignmentStep>(const std::string& seq1, const std::string& seq2,
+                                                                  const ScoringScheme& scoring)>;
+using MergeEngineFn = std::function<std::pair<std::string, std::string>(const Profile& profile1,
+                                                                        const Profile& profile2,
+                                                                        const ScoringScheme& scoring)>;
+using OutputEngineFn = std::function<void(const std::vector<AlignedRow>& rows, std::ostream& output)>;
+
+/**
+ * Descripción de un engine registrado
+ */
+struct EngineInfo {
+    EngineStage stage;
+    std::string name;
+    std::string description;
+    bool builtin;                   // Implementado dentro de MSAAligner/FastaIO
+};
+
+/**
+ * Registro de engines por etapa, elegibles por nombre en tiempo de ejecución.
+ *
+ * Los engines integrados son las variantes que ya implementa MSAAligner
+ * (distancias, árbol, estrategias de DP) y los formatos de FastaIO; el
+ * alineador los reconoce por nombre y los ejecuta por su camino habitual. Un
+ * engine nuevo se registra con su función antes de crear el alineador y se
+ * elige con --engine etapa=nombre en MSAligner y en el benchmark, de modo que
+ * puede compararse con los demás sin tocar el resto del pipeline. Los
+ * resultados de los engines externos se validan antes de usarse.
+ *
+ * Las funciones de distancia y pairwise se llaman a la vez desde los hilos del
+ * pool (matriz de distancias, realineamiento de filas), así que deben ser
+ * seguras para hilos: sin estado mutable compartido o protegido por la propia
+ * función. Un nombre registrado no puede reasignarse a otra función, porque la
+ * caché de resultados identifica el engine solo por su nombre.
+ */
+class EngineRegistry {
+public:
+    /**
+     * Registro global (con los engines integrados ya registrados)
+     */
+    static EngineRegistry& instance();
+
+    /**
+     * Registra un engine externo
+     * @return false si el nombre está vacío o ya está registrado en la etapa
+     */
+    bool addDistance(const std::string& name, const std::string& description, DistanceEngineFn fn);
+    bool addTree(const std::string& name, const std::string& description, TreeEngineFn fn);
+    bool addPairwise(const std::string& name, const std::string& description, PairwiseEngineFn fn);
+    bool addMerge(const std::string& name, const std::string& description, MergeEngineFn fn);
+    bool addOutput(const std::string& name, const std::string& description, OutputEngineFn fn);
+
+    /**
+     * Indica si hay un engine con ese nombre en la etapa
+     */
+    bool contains(EngineStage stage, const std::string& name) const;
+
+    /**
+     * Indica si el engine es integrado (falso también si no existe)
+     */
+    bool isBuiltin(EngineStage stage, const std::string& name) const;
+
+    /**
+     * Engines de una etapa en orden de registro (los integrados primero)
+     */
+    std::vector<EngineInfo> list(EngineStage stage) const;
+
+    /**
+     * Muestra los engines de cada etapa (los integrados marcados con '*')
+     */
+    void print() const;
+
+    /**
+     * Función de un engine externo (vacía para los integrados y los que no existen)
+     */
+    DistanceEngineFn distance(const std::string& name) const;
+    TreeEngineFn tree(const std::string& name) const;
+    PairwiseEngineFn pairwise(const std::string& name) const;
+    MergeEngineFn merge(const std::string& name) const;
+
+    /**
+     * Función de salida (también para los formatos integrados)
+     */
+    OutputEngineFn output(const std::string& name) const;
+
+private:
+    struct Entry {
+        EngineInfo info;
+        DistanceEngineFn distance;
+        TreeEngineFn tree;
+        PairwiseEngineFn pairwise;
+        MergeEngineFn merge;
+        OutputEngineFn output;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+
+    EngineRegistry();
+
+    void addBuiltin(EngineStage stage, const std::string& name, const std::string& description,
+                    OutputEngineFn output = nullptr);
+    bool add(Entry entry);
+    const Entry* find(EngineStage stage, const std::string& name) const;
+};
+
+#endif // ENGINES_H
@@ -1,27 +1,60 @@
 ﻿
 #include "io.h"
+#include "logger.h"
+#include "trace.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <limits>
 #include <iomanip>
 
+bool FastaIO::verbose = true;
+
+namespace {
+    // Registros por evento de lectura o escritura en la traza
+    const size_t TRACE_CHUNK_RECORDS = 1024;
+}
+
+void FastaIO::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
 std::vector<Sequence> FastaIO::readFasta(const std::string& filename) {
-    std::vector<Sequence> sequences;
+    TraceSpan span("read_fasta", "io");
     std::ifstream file(filename);
 
     if (!file.is_open()) {
-        std::cerr << "Error: No se pudo abrir el archivo " << filename << std::endl;
-        return sequences;
+        LOG_ERROR("io.error") << "Error: No se pudo abrir el archivo " << filename;
+        return {};
+    }
+
+    auto sequences = parseFasta(file, filename);
+    span.arg("records", static_cast<double>(sequences.size()));
+    if (!sequences.empty() && verbose) {
+        LOG_INFO("io.read").field("file", filename).field("sequences", sequences.size()) << "Leidas " << sequences.size() << " secuencias de " << filename;
     }
 
+    return sequences;
+}
+
+std::vector<Sequence> FastaIO::parseFasta(std::istream& input, const std::string& source_name) {
+    std::vector<Sequence> sequences;
+
     std::string line;
     std::string current_header;
     std::string current_sequence;
     bool in_sequence = false;
-
-    while (std::getline(file, line)) {
+    
+    // Un evento por bloque de registros leídos
+    TraceSpan chunk("parse_chunk", "io");
+    size_t chunk_first = 0;
+    size_t chunk_bytes = 0;
+
+    while (std::getline(input, line)) {
+        chunk_bytes += line.size() + 1;
         line = cleanLine(line);
 
         if (line.empty()) {
@@ -33,11 +66,19 @@ std::vector<Sequence> FastaIO::readFasta(const std::string& filename) {
                 if (validateSequence(current_sequence)) {
                     sequences.emplace_back(current_header, current_sequence);
                 } else {
-                    std::cerr << "Advertencia: Secuencia invalida ignorada: "
-                              << current_header << std::endl;
+                    LOG_WARN("io.invalid_sequence") << "Advertencia: Secuencia invalida ignorada: "
+                                                    << current_header;
                 }
             }
 
+            if (sequences.size() - chunk_first >= TRACE_CHUNK_RECORDS) {
+                chunk.arg("records", static_cast<double>(sequences.size() - chunk_first))
+                     .arg("bytes", static_cast<double>(chunk_bytes));
+                chunk.next("parse_chunk");
+                chunk_first = sequences.size();
+                chunk_bytes = 0;
+            }
+
             current_header = line.substr(1);
             current_sequence.clear();
             in_sequence = true;
@@ -51,45 +92,81 @@ std::vector<Sequence> FastaIO::readFasta(const std::string& filename) {
         if (validateSequence(current_sequence)) {
             sequences.emplace_back(current_header, current_sequence);
         } else {
-            std::cerr << "Advertencia: Secuencia invalida ignorada: "
-                      << current_header << std::endl;
+            LOG_WARN("io.invalid_sequence") << "Advertencia: Secuencia invalida ignorada: "
+                                            << current_header;
         }
     }
-
-    file.close();
+    chunk.arg("records", static_cast<double>(sequences.size() - chunk_first))
+         .arg("bytes", static_cast<double>(chunk_bytes));
+    chunk.end();
 
     if (sequences.empty()) {
-        std::cerr << "Error: No se encontraron secuencias validas en " << filename << std::endl;
-    } else {
-        std::cout << "Leidas " << sequences.size() << " secuencias de " << filename << std::endl;
+        LOG_ERROR("io.error") << "Error: No se encontraron secuencias validas en " << source_name;
     }
 
     return sequences;
 }
 
+std::vector<Sequence> FastaIO::readAlignment(const std::string& filename) {
+    auto hasExtension = [&filename](const std::string& ext) {
+        return filename.length() >= ext.length() &&
+               filename.compare(filename.length() - ext.length(), ext.length(), ext) == 0;
+    };
+
+    if (hasExtension(".a3m")) {
+        return readA3M(filename);
+    }
+    if (hasExtension(".rle")) {
+        return readGapRLE(filename);
+    }
+    return readFasta(filename);
+}
+
 void FastaIO::writeFasta(const std::vector<Sequence>& sequences,
                          const std::string& filename,
                          bool aligned) {
+    TraceSpan span("write_fasta", "io");
+    span.arg("records", static_cast<double>(sequences.size()));
     std::ofstream file(filename);
 
     if (!file.is_open()) {
-        std::cerr << "Error: No se pudo crear el archivo " << filename << std::endl;
+        LOG_ERROR("io.error") << "Error: No se pudo crear el archivo " << filename;
         return;
     }
 
-    const int line_width = aligned ? 80 : 80;
+    formatFasta(sequences, file, aligned);
+
+    file.close();
+    if (verbose) {
+        LOG_INFO("io.write").field("file", filename).field("sequences", sequences.size()) << "Guardadas " << sequences.size() << " secuencias en " << filename;
+    }
+}
+
+void FastaIO::formatFasta(const std::vector<Sequence>& sequences, std::ostream& output, bool aligned) {
+    const size_t line_width = aligned ? 80 : 80;
+    
+    TraceSpan chunk("format_chunk", "io");
+    size_t chunk_records = 0;
+    size_t chunk_bytes = 0;
 
     for (const auto& seq : sequences) {
-        file << ">" << seq.header << std::endl;
+        if (chunk_records == TRACE_CHUNK_RECORDS) {
+            chunk.arg("records", static_cast<double>(chunk_records)).arg("bytes", static_cast<double>(chunk_bytes));
+            chunk.next("format_chunk");
+            chunk_records = 0;
+            chunk_bytes = 0;
+        }
+        ++chunk_records;
+        chunk_bytes += seq.header.size() + seq.sequence.size() + seq.sequence.size() / line_width + 3;
+        output << '>' << seq.header << '\n';
 
         for (size_t i = 0; i < seq.sequence.length(); i += line_width) {
             size_t end = std::min(i + line_width, seq.sequence.length());
-            file << seq.sequence.substr(i, end - i) << std::endl;
+            output.write(seq.sequence.data() + i, end - i);
+            output << '\n';
         }
     }
-
-    file.close();
-    std::cout << "Guardadas " << sequences.size() << " secuencias en " << filename << std::endl;
+    chunk.arg("records", static_cast<double>(chunk_records)).arg("bytes", static_cast<double>(chunk_bytes));
 }
 
 bool FastaIO::validateSequence(const std::string& sequence) {
@@ -115,12 +192,12 @@ bool FastaIO::validateSequence(const std::string& sequence) {
 void FastaIO::printSequenceStats(const std::vector<Sequence>& sequences,
                                  const std::string& title) {
     if (sequences.empty()) {
-        std::cout << "No hay secuencias para mostrar estadisticas." << std::endl;
+        LOG_INFO("io.stats") << "No hay secuencias para mostrar estadisticas.";
         return;
     }
 
-    std::cout << "\n=== " << title << " ===" << std::endl;
-    std::cout << "Numero de secuencias: " << sequences.size() << std::endl;
+    LOG_INFO("io.stats") << "\n=== " << title << " ===";
+    LOG_INFO("io.stats") << "Numero de secuencias: " << sequences.size();
 
     size_t min_length = sequences[0].sequence.length();
     size_t max_length = sequences[0].sequence.length();
@@ -135,20 +212,20 @@ void FastaIO::printSequenceStats(const std::vector<Sequence>& sequences,
 
     double avg_length = static_cast<double>(total_length) / sequences.size();
 
-    std::cout << "Longitud minima: " << min_length << std::endl;
-    std::cout << "Longitud maxima: " << max_length << std::endl;
-    std::cout << "Longitud promedio: " << std::fixed << std::setprecision(1) << avg_length << std::endl;
+    LOG_INFO("io.stats") << "Longitud minima: " << min_length;
+    LOG_INFO("io.stats") << "Longitud maxima: " << max_length;
+    LOG_INFO("io.stats") << "Longitud promedio: " << std::fixed << std::setprecision(1) << avg_length;
 
-    std::cout << "\nEjemplos de secuencias:" << std::endl;
+    LOG_INFO("io.stats") << "\nEjemplos de secuencias:";
     for (size_t i = 0; i < std::min(size_t(3), sequences.size()); ++i) {
         std::string preview = sequences[i].sequence.substr(0, 50);
         if (sequences[i].sequence.length() > 50) {
             preview += "...";
         }
-        std::cout << "  " << sequences[i].header << ": " << preview << std::endl;
+        LOG_INFO("io.stats") << "  " << sequences[i].header << ": " << preview;
     }
 
-    std::cout << std::endl;
+    LOG_INFO("io.stats");
 }
 
 std::string FastaIO::cleanLine(const std::string& line) {
@@ -169,3 +246,365 @@ std::string FastaIO::cleanLine(const std::string& line) {
     size_t end = cleaned.find_last_not_of(' ');
     return cleaned.substr(start, end - start + 1);
 }
+
+void AlignedRow::append(char op, int count) {
+    if (count <= 0) {
+        return;
+    }
+    if (!script.empty() && script.back().op == op) {
+        script.back().length += count;
+    } else {
+        script.emplace_back(op, count);
+    }
+}
+
+std::string AlignedRow::toAlignedString() const {
+    std::string aligned;
+    size_t residue_pos = 0;
+
+    for (const auto& edit : script) {
+        if (edit.op == 'D') {
+            aligned.append(edit.length, '-');
+        } else {
+            aligned.append(residues, residue_pos, edit.length);
+            residue_pos += edit.length;
+        }
+    }
+
+    return aligned;
+}
+
+AlignedRow AlignedRow::fromAlignedSequence(const Sequence& aligned) {
+    AlignedRow row;
+    row.header = aligned.header;
+    row.residues.reserve(aligned.sequence.length());
+
+    for (char c : aligned.sequence) {
+        if (c == '-') {
+            row.append('D');
+        } else {
+            row.residues += c;
+            row.append('M');
+        }
+    }
+
+    return row;
+}
+
+void FastaIO::writeA3M(const std::vector<AlignedRow>& rows, const std::string& filename) {
+    TraceSpan span("write_a3m", "io");
+    span.arg("records", static_cast<double>(rows.size()));
+    std::ofstream file(filename);
+
+    if (!file.is_open()) {
+        LOG_ERROR("io.error") << "Error: No se pudo crear el archivo " << filename;
+        return;
+    }
+
+    formatA3M(rows, file);
+
+    file.close();
+    if (verbose) {
+        LOG_INFO("io.write").field("file", filename).field("sequences", rows.size()) << "Guardadas " << rows.size() << " secuencias (A3M) en " << filename;
+    }
+}
+
+void FastaIO::formatA3M(const std::vector<AlignedRow>& rows, std::ostream& output) {
+    std::string line;
+    for (const auto& row : rows) {
+        line.clear();
+        size_t residue_pos = 0;
+
+        for (const auto& edit : row.script) {
+            for (int k = 0; k < edit.length; ++k) {
+                if (edit.op == 'D') {
+                    line += '-';
+                } else {
+                    char c = row.residues[residue_pos++];
+                    line += (edit.op == 'I')
+                        ? static_cast<char>(std::tolower(static_cast<unsigned char>(c)))
+                        : static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+            }
+        }
+
+        output << '>' << row.header << '\n' << line << '\n';
+    }
+}
+
+std::vector<Sequence> FastaIO::readA3M(const std::string& filename) {
+    std::vector<AlignedRow> rows;
+
+    for (const auto& record : readRecords(filename)) {
+        AlignedRow row;
+        row.header = record.header;
+
+        for (char c : record.sequence) {
+            if (c == '-') {
+                row.append('D');
+            } else if (c == '.') {
+                continue;
+            } else if (std::islower(static_cast<unsigned char>(c))) {
+                row.residues += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                row.append('I');
+            } else {
+                row.residues += c;
+                row.append('M');
+            }
+        }
+
+        rows.push_back(std::move(row));
+    }
+
+    auto sequences = expandRows(rows);
+    if (!sequences.empty() && verbose) {
+        LOG_INFO("io.read").field("file", filename).field("sequences", sequences.size()) << "Leidas " << sequences.size() << " secuencias (A3M) de " << filename;
+    }
+    return sequences;
+}
+
+void FastaIO::writeGapRLE(const std::vector<AlignedRow>& rows, const std::string& filename) {
+    TraceSpan span("write_rle", "io");
+    span.arg("records", static_cast<double>(rows.size()));
+    std::ofstream file(filename);
+
+    if (!file.is_open()) {
+        LOG_ERROR("io.error") << "Error: No se pudo crear el archivo " << filename;
+        return;
+    }
+
+    formatGapRLE(rows, file);
+
+    file.close();
+    if (verbose) {
+        LOG_INFO("io.write").field("file", filename).field("sequences", rows.size()) << "Guardadas " << rows.size() << " secuencias (gaps RLE) en " << filename;
+    }
+}
+
+void FastaIO::formatGapRLE(const std::vector<AlignedRow>& rows, std::ostream& output) {
+    std::string line;
+    for (const auto& row : rows) {
+        line.clear();
+        size_t residue_pos = 0;
+
+        for (const auto& edit : row.script) {
+            if (edit.op == 'D') {
+                line += '-';
+                if (edit.length > 1) {
+                    line += std::to_string(edit.length);
+                }
+            } else {
+                line.append(row.residues, residue_pos, edit.length);
+                residue_pos += edit.length;
+            }
+        }
+
+        output << '>' << row.header << '\n' << line << '\n';
+    }
+}
+
+std::vector<Sequence> FastaIO::readGapRLE(const std::string& filename) {
+    std::vector<Sequence> sequences;
+    auto records = readRecords(filename);
+
+    // Cada columna tiene al menos un residuo: el total de residuos acota el ancho de una fila
+    auto runEnd = [](const std::string& encoded, size_t dash) {
+        size_t end = dash + 1;
+        while (end < encoded.length() && std::isdigit(static_cast<unsigned char>(encoded[end]))) {
+            end++;
+        }
+        return end;
+    };
+    size_t max_width = 0;
+    for (const auto& record : records) {
+        const std::string& encoded = record.sequence;
+        for (size_t i = 0; i < encoded.length(); ++i) {
+            if (encoded[i] == '-') {
+                i = runEnd(encoded, i) - 1;
+            } else {
+                max_width++;
+            }
+        }
+    }
+
+    for (size_t r = 0; r < records.size(); ++r) {
+        const auto& record = records[r];
+        Sequence seq;
+        seq.header = record.header;
+        auto formatError = [&](const std::string& reason) {
+            return FormatError("Formato RLE invalido en " + filename + ", registro " +
+                               std::to_string(r + 1) + " (" + record.header + "): " + reason);
+        };
+
+        const std::string& encoded = record.sequence;
+        for (size_t i = 0; i < encoded.length(); ++i) {
+            if (encoded[i] != '-') {
+                seq.sequence += encoded[i];
+                continue;
+            }
+
+            size_t digits_end = runEnd(encoded, i);
+            size_t run = 1;
+            if (digits_end > i + 1) {
+                std::string digits = encoded.substr(i + 1, digits_end - i - 1);
+                // Más de 19 dígitos desborda; el límite real lo pone el ancho
+                run = digits.length() <= 19 ? static_cast<size_t>(std::strtoull(digits.c_str(), nullptr, 10))
+                                            : std::numeric_limits<size_t>::max();
+                if (run == 0) {
+                    throw formatError("corrida de gaps de longitud 0");
+                }
+                if (run > max_width - std::min(max_width, seq.sequence.length())) {
+                    throw formatError("la corrida de gaps -" + digits + " supera el ancho del alineamiento (" +
+                                      std::to_string(max_width) + " columnas)");
+                }
+            } else if (seq.sequence.length() >= max_width) {
+                throw formatError("la fila supera el ancho del alineamiento (" +
+                                  std::to_string(max_width) + " columnas)");
+            }
+            seq.sequence.append(run, '-');
+            i = digits_end - 1;
+        }
+
+        sequences.push_back(std::move(seq));
+    }
+
+    if (!sequences.empty() && verbose) {
+        LOG_INFO("io.read").field("file", filename).field("sequences", sequences.size()) << "Leidas " << sequences.size() << " secuencias (gaps RLE) de " << filename;
+    }
+    return sequences;
+}
+
+std::vector<Sequence> FastaIO::expandRows(const std::vector<AlignedRow>& rows) {
+    std::vector<Sequence> sequences;
+    if (rows.empty()) {
+        return sequences;
+    }
+
+    auto countColumns = [](const AlignedRow& row) {
+        size_t columns = 0;
+        for (const auto& edit : row.script) {
+            if (edit.op != 'I') columns += edit.length;
+        }
+        return columns;
+    };
+
+    // Ancho maximo de insercion antes de cada columna de referencia (y al final)
+    const size_t num_columns = countColumns(rows[0]);
+    std::vector<int> insert_width(num_columns + 1, 0);
+
+    for (const auto& row : rows) {
+        if (countColumns(row) != num_columns) {
+            LOG_ERROR("io.error") << "Error: Fila con numero de columnas inconsistente: " << row.header;
+            return sequences;
+        }
+
+        size_t column = 0;
+        for (const auto& edit : row.script) {
+            if (edit.op == 'I') {
+                insert_width[column] = std::max(insert_width[column], edit.length);
+            } else {
+                column += edit.length;
+            }
+        }
+    }
+
+    size_t total_length = num_columns;
+    for (int width : insert_width) {
+        total_length += width;
+    }
+
+    sequences.reserve(rows.size());
+    for (const auto& row : rows) {
+        std::string aligned;
+        aligned.reserve(total_length);
+
+        size_t column = 0;
+        size_t residue_pos = 0;
+        int pending_insert = 0;
+
+        for (const auto& edit : row.script) {
+            if (edit.op == 'I') {
+                aligned.append(row.residues, residue_pos, edit.length);
+                residue_pos += edit.length;
+                pending_insert += edit.length;
+                continue;
+            }
+
+            for (int k = 0; k < edit.length; ++k) {
+                aligned.append(insert_width[column] - pending_insert, '-');
+                pending_insert = 0;
+                if (edit.op == 'M') {
+                    aligned += row.residues[residue_pos++];
+                } else {
+                    aligned += '-';
+                }
+                column++;
+            }
+        }
+        aligned.append(insert_width[column] - pending_insert, '-');
+
+        sequences.emplace_back(row.header, aligned);
+    }
+
+    return sequences;
+}
+
+void FastaIO::writeRows(const std::vector<AlignedRow>& rows,
+                        const std::string& filename,
+                        const std::string& format) {
+    if (format == "a3m") {
+        writeA3M(rows, filename);
+    } else if (format == "rle") {
+        writeGapRLE(rows, filename);
+    } else {
+        std::vector<Sequence> sequences;
+        sequences.reserve(rows.size());
+        for (const auto& row : rows) {
+            sequences.emplace_back(row.header, row.toAlignedString());
+        }
+        writeFasta(sequences, filename, true);
+    }
+}
+
+void FastaIO::formatRows(const std::vector<AlignedRow>& rows, std::ostream& output,
+                         const std::string& format) {
+    if (format == "a3m") {
+        formatA3M(rows, output);
+    } else if (format == "rle") {
+        formatGapRLE(rows, output);
+    } else {
+        std::vector<Sequence> sequences;
+        sequences.reserve(rows.size());
+        for (const auto& row : rows) {
+            sequences.emplace_back(row.header, row.toAlignedString());
+        }
+        formatFasta(sequences, output, true);
+    }
+}
+
+std::vector<Sequence> FastaIO::readRecords(const std::string& filename) {
+    std::vector<Sequence> records;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        LOG_ERROR("io.error") << "Error: No se pudo abrir el archivo " << filename;
+        return records;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = cleanLine(line);
+
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line[0] == '>') {
+            records.emplace_back(line.substr(1), "");
+        } else if (!records.empty()) {
+            records.back().sequence += line;
+        }
+    }
+
+    return records;
+}
@@ -5,6 +5,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 /**
  * Estructura para representar una secuencia biolgica
@@ -17,6 +18,58 @@ struct Sequence {
     Sequence(const std::string& h, const std::string& s) : header(h), sequence(s) {}
 };
 
+/**
+ * Operacin de un guion de edicin (corrida de longitud variable)
+ *  'M' = residuo en una columna de referencia
+ *  'I' = residuo insertado entre columnas de referencia
+ *  'D' = gap en una columna de referencia
+ */
+struct EditOp {
+    char op;        // Tipo de operacin ('M', 'I' o 'D')
+    int length;     // Longitud de la corrida
+
+    EditOp(char o, int l) : op(o), length(l) {}
+};
+
+/**
+ * Fila alineada representada como residuos sin gaps mas su guion de edicin,
+ * sin materializar la cadena con todos los '-'
+ */
+struct AlignedRow {
+    std::string header;             // Encabezado de la secuencia (sin '>')
+    std::string residues;           // Residuos de la secuencia sin gaps
+    std::vector<EditOp> script;     // Guion de edicin respecto a las columnas de referencia
+
+    /**
+     * Agrega una operacin al guion, fusionndola con la ltima corrida si coincide
+     * @param op Tipo de operacin
+     * @param count Longitud de la operacin
+     */
+    void append(char op, int count = 1);
+
+    /**
+     * Materializa la fila como cadena alineada ('-' para cada gap)
+     * @return Secuencia alineada de esta fila
+     */
+    std::string toAlignedString() const;
+    
+    /**
+     * Construye una fila a partir de una secuencia ya alineada, tomando cada
+     * columna como columna de referencia ('M' o 'D')
+     * @param aligned Secuencia alineada
+     * @return Fila equivalente
+     */
+    static AlignedRow fromAlignedSequence(const Sequence& aligned);
+};
+
+/**
+ * Error de formato en un archivo de entrada; el mensaje nombra el archivo y el registro
+ */
+class FormatError : public std::runtime_error {
+public:
+    explicit FormatError(const std::string& message) : std::runtime_error(message) {}
+};
+
 /**
  * Clase para manejo de entrada/salida de archivos FASTA
  */
@@ -29,6 +82,22 @@ public:
      */
     static std::vector<Sequence> readFasta(const std::string& filename);
     
+    /**
+     * Lee secuencias FASTA desde un flujo (por ejemplo, una peticin en memoria)
+     * @param input Flujo de entrada
+     * @param source_name Nombre del origen para los mensajes de error
+     * @return Vector de secuencias ledas
+     */
+    static std::vector<Sequence> parseFasta(std::istream& input, const std::string& source_name);
+    
+    /**
+     * Lee un alineamiento existente eligiendo el lector segn la extensin
+     * (.a3m, .rle o FASTA alineado en cualquier otro caso)
+     * @param filename Nombre del archivo
+     * @return Secuencias alineadas
+     */
+    static std::vector<Sequence> readAlignment(const std::string& filename);
+    
     /**
      * Escribe secuencias a un archivo FASTA
      * @param sequences Vector de secuencias a escribir
@@ -39,6 +108,72 @@ public:
                           const std::string& filename, 
                           bool aligned = true);
     
+    /**
+     * Escribe secuencias en formato FASTA sobre un flujo
+     * @param sequences Vector de secuencias a escribir
+     * @param output Flujo de salida
+     * @param aligned Indica si las secuencias estn alineadas (para formato)
+     */
+    static void formatFasta(const std::vector<Sequence>& sequences, std::ostream& output,
+                            bool aligned = true);
+    
+    /**
+     * Escribe filas alineadas en formato A3M directamente desde su guion de edicin
+     * (maysculas y '-' en columnas de referencia, minsculas para inserciones)
+     * @param rows Filas alineadas
+     * @param filename Nombre del archivo de salida
+     */
+    static void writeA3M(const std::vector<AlignedRow>& rows, const std::string& filename);
+    
+    /**
+     * Lee un archivo A3M y expande las inserciones a un alineamiento con columnas comunes
+     * @param filename Nombre del archivo A3M
+     * @return Secuencias alineadas (todas con la misma longitud)
+     */
+    static std::vector<Sequence> readA3M(const std::string& filename);
+    
+    /**
+     * Escribe filas alineadas codificando cada corrida de gaps como "-<n>"
+     * @param rows Filas alineadas
+     * @param filename Nombre del archivo de salida
+     */
+    static void writeGapRLE(const std::vector<AlignedRow>& rows, const std::string& filename);
+    
+    /**
+     * Lee un archivo con gaps codificados por corridas ("-<n>")
+     * @param filename Nombre del archivo
+     * @return Secuencias alineadas con los gaps expandidos
+     * @throws FormatError si una corrida no es un entero positivo o desborda el ancho del alineamiento
+     */
+    static std::vector<Sequence> readGapRLE(const std::string& filename);
+    
+    /**
+     * Expande filas con guion de edicin a un alineamiento de longitud comn,
+     * rellenando con gaps las inserciones de las dems filas
+     * @param rows Filas alineadas contra el mismo conjunto de columnas de referencia
+     * @return Secuencias alineadas (vaco si las filas no son compatibles)
+     */
+    static std::vector<Sequence> expandRows(const std::vector<AlignedRow>& rows);
+    
+    /**
+     * Escribe filas alineadas en el formato indicado
+     * @param rows Filas alineadas
+     * @param filename Nombre del archivo de salida
+     * @param format "fasta", "a3m" o "rle"
+     */
+    static void writeRows(const std::vector<AlignedRow>& rows,
+                          const std::string& filename,
+                          const std::string& format);
+    
+    /**
+     * Escribe filas alineadas en el formato indicado sobre un flujo
+     * @param rows Filas alineadas
+     * @param output Flujo de salida
+     * @param format "fasta", "a3m" o "rle"
+     */
+    static void formatRows(const std::vector<AlignedRow>& rows, std::ostream& output,
+                           const std::string& format);
+    
     /**
      * Valida el formato de una secuencia
      * @param sequence Secuencia a validar
@@ -53,14 +188,32 @@ public:
      */
     static void printSequenceStats(const std::vector<Sequence>& sequences, 
                                   const std::string& title = "Secuencias");
+    
+    /**
+     * Activa o desactiva los mensajes informativos de lectura/escritura
+     * @param enabled true para imprimir los mensajes
+     */
+    static void setVerbose(bool enabled);
 
 private:
+    static bool verbose;
+    
+    static void formatA3M(const std::vector<AlignedRow>& rows, std::ostream& output);
+    static void formatGapRLE(const std::vector<AlignedRow>& rows, std::ostream& output);
+    
     /**
      * Limpia una lnea removiendo espacios en blanco y caracteres de control
      * @param line Lnea a limpiar
      * @return Lnea limpia
      */
     static std::string cleanLine(const std::string& line);
+    
+    /**
+     * Lee los registros de un archivo tipo FASTA sin validar su contenido
+     * @param filename Nombre del archivo
+     * @return Registros ledos (encabezado y lneas concatenadas)
+     */
+    static std::vector<Sequence> readRecords(const std::string& filename);
 };
 
 #endif // IO_H
\ No newline at end of file
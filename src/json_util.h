@@ -0,0 +1,41 @@
+#ifndef JSON_UTIL_H
+#define JSON_UTIL_H
+
+#include <cstdio>
+#include <string>
+
+/**
+ * Agrega value escapado como contenido de una cadena JSON (sin comillas):
+ * comillas, barra invertida y caracteres de control
+ */
+inline void appendJsonEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                    out += code;
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+/**
+ * Cadena JSON entre comillas
+ */
+inline std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    appendJsonEscaped(out, value);
+    out += '"';
+    return out;
+}
+
+#endif // JSON_UTIL_H
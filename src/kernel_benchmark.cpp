@@ -0,0 +1,271 @@
+#include "kernel_benchmark.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// Sumidero de los resultados de cada iteración para que el compilador no elimine el trabajo
+volatile uint64_t kernel_sink = 0;
+
+const size_t FASTA_BATCH = 32;   // Secuencias por iteración en los kernels FASTA
+
+double nanosecondsPerIteration(const std::function<uint64_t()>& body, uint64_t iterations) {
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        checksum += body();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    kernel_sink = kernel_sink + checksum;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           iterations;
+}
+
+} // namespace
+
+KernelBenchmark::KernelBenchmark(const KernelBenchmarkOptions& options) : options(options) {
+    aligner.setVerbose(false);
+    FastaIO::setVerbose(false);
+}
+
+const std::vector<std::string>& KernelBenchmark::kernelNames() {
+    static const std::vector<std::string> names = {
+        "dp_fill", "traceback", "distance", "profile_merge", "consensus", "fasta_parse", "fasta_write"
+    };
+    return names;
+}
+
+std::pair<std::string, std::string> KernelBenchmark::makePair(const std::string& alphabet, size_t length,
+                                                               double divergence, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> residue(0, alphabet.size() - 1);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    std::string original(length, ' ');
+    for (char& c : original) {
+        c = alphabet[residue(gen)];
+    }
+
+    // Mutaciones: 80% sustituciones, 10% inserciones, 10% eliminaciones
+    std::string derived;
+    derived.reserve(length + length / 10 + 1);
+    for (char c : original) {
+        if (chance(gen) >= divergence) {
+            derived.push_back(c);
+            continue;
+        }
+        double kind = chance(gen);
+        if (kind < 0.8) {
+            derived.push_back(alphabet[residue(gen)]);
+        } else if (kind < 0.9) {
+            derived.push_back(c);
+            derived.push_back(alphabet[residue(gen)]);
+        }
+    }
+    if (derived.empty()) {
+        derived.push_back(alphabet[residue(gen)]);
+    }
+    return {original, derived};
+}
+
+bool KernelBenchmark::selected(const std::string& kernel) const {
+    return options.kernels.empty() ||
+           std::find(options.kernels.begin(), options.kernels.end(), kernel) != options.kernels.end();
+}
+
+KernelResult KernelBenchmark::measure(const std::function<uint64_t()>& body) const {
+    // Calentamiento: cachés, workspace DP del hilo y predictores
+    kernel_sink = kernel_sink + body();
+
+    // Calibración: lotes crecientes hasta que uno dure al menos el tiempo mínimo
+    double min_ns = options.min_time_seconds * 1e9;
+    uint64_t iterations = 1;
+    double ns = nanosecondsPerIteration(body, iterations);
+    while (ns * iterations < min_ns && iterations < (1ULL << 40)) {
+        double target = ns > 0.0 ? min_ns * 1.2 / ns : iterations * 10.0;
+        iterations = std::max(iterations * 2, static_cast<uint64_t>(std::min(target, iterations * 100.0)));
+        ns = nanosecondsPerIteration(body, iterations);
+    }
+
+    std::vector<double> samples = {ns};
+    for (int r = 1; r < options.repetitions; ++r) {
+        samples.push_back(nanosecondsPerIteration(body, iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    KernelResult result;
+    result.iterations = iterations;
+    result.ns_per_iteration = samples[samples.size() / 2];
+    return result;
+}
+
+void KernelBenchmark::runCase(const std::string& alphabet_name, size_t length, double divergence,
+                              bool include_io, std::vector<KernelResult>& results) {
+    const std::string& alphabet = alphabet_name == "protein" ? MSAAligner::PROTEIN_ALPHABET
+                                                             : MSAAligner::DNA_ALPHABET;
+    auto pair = makePair(alphabet, length, divergence, options.seed + static_cast<unsigned>(length));
+    const std::string& seq1 = pair.first;
+    const std::string& seq2 = pair.second;
+    size_t m = seq1.size();
+    size_t n = seq2.size();
+
+    auto record = [&](const std::string& kernel, const std::function<uint64_t()>& body,
+                      uint64_t cells, uint64_t bytes) {
+        KernelResult result = measure(body);
+        result.kernel = kernel;
+        result.alphabet = alphabet_name;
+        result.length = length;
+        result.divergence = divergence;
+        result.cells_per_iteration = cells;
+        result.bytes_per_iteration = bytes;
+        results.push_back(result);
+        LOG_DEBUG("kernels.result").field("kernel", kernel).field("alphabet", alphabet_name)
+            .field("length", length).field("divergence", divergence)
+            .field("ns_per_iteration", result.ns_per_iteration);
+    };
+
+    if (selected("dp_fill")) {
+        // Solo el llenado: los bordes se inicializan una vez y el interior se reescribe en cada iteración
+        std::vector<std::vector<int>>& dp = aligner.initializeDPMatrix(m, n);
+        record("dp_fill", [&]() {
+            aligner.fillDPMatrix(dp, seq1, seq2, m, n);
+            return static_cast<uint64_t>(dp[m][n]);
+        }, static_cast<uint64_t>(m) * n, m + n);
+    }
+
+    if (selected("traceback")) {
+        const std::vector<std::vector<int>>& dp = aligner.computeDPMatrix(seq1, seq2);
+        record("traceback", [&]() {
+            return static_cast<uint64_t>(aligner.reconstructEditScript(dp, seq1, seq2, m, n).size());
+        }, 0, m + n);
+    }
+
+    if (selected("distance")) {
+        record("distance", [&]() {
+            return static_cast<uint64_t>(aligner.calculateSequenceDistance(seq1, seq2) * 1e6);
+        }, 0, m + n);
+    }
+
+    if (selected("profile_merge") || selected("consensus")) {
+        Profile profile1 = aligner.createProfile(seq1);
+        Profile profile2 = aligner.createProfile(seq2);
+        auto aligned_pair = aligner.alignProfileConsensus(profile1, profile2);
+        uint64_t column_bytes = (MSAAligner::ALPHABET_SIZE + 1) * sizeof(double);
+
+        if (selected("profile_merge")) {
+            record("profile_merge", [&]() {
+                return static_cast<uint64_t>(aligner.combineProfiles(profile1, profile2, aligned_pair).length);
+            }, 0, (profile1.length + profile2.length) * column_bytes);
+        }
+        if (selected("consensus")) {
+            record("consensus", [&]() {
+                return static_cast<uint64_t>(aligner.generateConsensusFromProfile(profile1).size());
+            }, 0, profile1.length * column_bytes);
+        }
+    }
+
+    if (!include_io || (!selected("fasta_parse") && !selected("fasta_write"))) {
+        return;
+    }
+
+    std::vector<Sequence> batch;
+    for (size_t s = 0; s < FASTA_BATCH; ++s) {
+        auto variant = makePair(alphabet, length, divergence, options.seed + static_cast<unsigned>(s));
+        batch.emplace_back("seq" + std::to_string(s) + " sintetica", variant.second);
+    }
+    std::ostringstream formatted;
+    FastaIO::formatFasta(batch, formatted);
+    const std::string text = formatted.str();
+
+    if (selected("fasta_parse")) {
+        record("fasta_parse", [&]() {
+            std::istringstream input(text);
+            return static_cast<uint64_t>(FastaIO::parseFasta(input, "kernels").size());
+        }, 0, text.size());
+    }
+    if (selected("fasta_write")) {
+        record("fasta_write", [&]() {
+            std::ostringstream output;
+            FastaIO::formatFasta(batch, output);
+            return static_cast<uint64_t>(output.tellp());
+        }, 0, text.size());
+    }
+}
+
+std::vector<KernelResult> KernelBenchmark::run() {
+    std::vector<KernelResult> results;
+    for (const auto& kernel : options.kernels) {
+        const auto& names = kernelNames();
+        if (std::find(names.begin(), names.end(), kernel) == names.end()) {
+            LOG_WARN("kernels.error").field("kernel", kernel)
+                << "Advertencia: Kernel desconocido '" << kernel << "' (se ignora)";
+        }
+    }
+
+    for (const auto& alphabet : options.alphabets) {
+        if (alphabet != "dna" && alphabet != "protein") {
+            LOG_WARN("kernels.error").field("alphabet", alphabet)
+                << "Advertencia: Alfabeto desconocido '" << alphabet << "' (se ignora)";
+            continue;
+        }
+        for (size_t length : options.lengths) {
+            for (size_t d = 0; d < options.divergences.size(); ++d) {
+                // La lectura y escritura FASTA no dependen de la divergencia: se miden una vez
+                runCase(alphabet, length, options.divergences[d], d == 0, results);
+            }
+        }
+    }
+    return results;
+}
+
+void KernelBenchmark::printResults(const std::vector<KernelResult>& results) const {
+    std::ostringstream header;
+    header << std::left << std::setw(15) << "Kernel" << std::setw(9) << "Alfabeto"
+           << std::right << std::setw(7) << "Long." << std::setw(7) << "Div."
+           << std::setw(14) << "ns/iter" << std::setw(10) << "GCUPS" << std::setw(11) << "MB/s";
+    LOG_INFO("kernels") << header.str();
+    LOG_INFO("kernels") << std::string(header.str().size(), '-');
+
+    for (const auto& result : results) {
+        std::ostringstream line;
+        line << std::left << std::setw(15) << result.kernel << std::setw(9) << result.alphabet
+             << std::right << std::setw(7) << result.length
+             << std::setw(7) << std::fixed << std::setprecision(2) << result.divergence
+             << std::setw(14) << std::setprecision(1) << result.ns_per_iteration;
+        if (result.cells_per_iteration > 0) {
+            line << std::setw(10) << std::setprecision(3) << result.gcups();
+        } else {
+            line << std::setw(10) << "-";
+        }
+        line << std::setw(11) << std::setprecision(1) << result.megabytesPerSecond();
+        LOG_INFO("kernels") << line.str();
+    }
+}
+
+void KernelBenchmark::exportToCSV(const std::vector<KernelResult>& results, const std::string& csv_file) const {
+    std::ofstream file(csv_file);
+
+    if (!file.is_open()) {
+        LOG_ERROR("kernels.error") << "Error: No se pudo crear el archivo CSV " << csv_file;
+        return;
+    }
+
+    file << "Kernel,Alphabet,Length,Divergence,Iterations,NsPerIteration,"
+         << "CellsPerIteration,BytesPerIteration,GCUPS,MBPerSecond\n";
+    for (const auto& result : results) {
+        file << result.kernel << "," << result.alphabet << "," << result.length << ","
+             << result.divergence << "," << result.iterations << "," << result.ns_per_iteration << ","
+             << result.cells_per_iteration << "," << result.bytes_per_iteration << ",";
+        if (result.cells_per_iteration > 0) {
+            file << result.gcups();
+        }
+        file << "," << result.megabytesPerSecond() << "\n";
+    }
+
+    LOG_INFO("kernels") << "Resultados exportados a CSV: " << csv_file;
+}
@@ -0,0 +1,120 @@
+#ifndef KERNEL_BENCHMARK_H
+#define KERNEL_BENCHMARK_H
+
+#include "alignment.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Parámetros del barrido de microbenchmarks de kernels
+ */
+struct KernelBenchmarkOptions {
+    std::vector<size_t> lengths;           // Longitudes de secuencia
+    std::vector<std::string> alphabets;    // "dna" y/o "protein"
+    std::vector<double> divergences;       // Fracción de posiciones mutadas entre las dos secuencias
+    std::vector<std::string> kernels;      // Kernels a medir (vacío = todos)
+    double min_time_seconds;               // Tiempo mínimo de cada repetición
+    int repetitions;                       // Repeticiones (se informa la mediana)
+    unsigned seed;                         // Semilla del generador de secuencias
+
+    KernelBenchmarkOptions() : lengths{100, 1000, 4000}, alphabets{"dna", "protein"},
+                               divergences{0.05, 0.2, 0.4}, min_time_seconds(0.2),
+                               repetitions(3), seed(42) {}
+};
+
+/**
+ * Medición de un kernel sobre un caso del barrido
+ */
+struct KernelResult {
+    std::string kernel;
+    std::string alphabet;
+    size_t length;
+    double divergence;
+
+    uint64_t iterations;             // Iteraciones de cada repetición
+    double ns_per_iteration;         // Mediana de las repeticiones
+    uint64_t cells_per_iteration;    // Celdas DP por iteración (0 si el kernel no llena DP)
+    uint64_t bytes_per_iteration;    // Bytes de entrada procesados por iteración
+
+    KernelResult() : length(0), divergence(0.0), iterations(0), ns_per_iteration(0.0),
+                     cells_per_iteration(0), bytes_per_iteration(0) {}
+
+    /**
+     * Miles de millones de celdas por segundo (0 si no aplica)
+     */
+    double gcups() const {
+        return ns_per_iteration > 0.0 ? cells_per_iteration / ns_per_iteration : 0.0;
+    }
+
+    /**
+     * Megabytes de entrada por segundo
+     */
+    double megabytesPerSecond() const {
+        return ns_per_iteration > 0.0 ? bytes_per_iteration * 1e3 / ns_per_iteration : 0.0;
+    }
+};
+
+/**
+ * Microbenchmarks de los kernels del alineador: llenado DP, reconstrucción,
+ * distancia entre secuencias, combinación de perfiles, consenso y lectura y
+ * escritura FASTA. Cada kernel se mide aislado sobre pares de secuencias
+ * sintéticas (misma semilla en cada ejecución), con calentamiento previo y
+ * lotes que duran al menos min_time_seconds.
+ */
+class KernelBenchmark {
+public:
+    explicit KernelBenchmark(const KernelBenchmarkOptions& options = KernelBenchmarkOptions());
+
+    /**
+     * Nombres de los kernels disponibles
+     */
+    static const std::vector<std::string>& kernelNames();
+
+    /**
+     * Ejecuta el barrido completo
+     * @return Una medición por kernel y caso
+     */
+    std::vector<KernelResult> run();
+
+    /**
+     * Muestra las mediciones como tabla
+     */
+    void printResults(const std::vector<KernelResult>& results) const;
+
+    /**
+     * Exporta las mediciones a CSV
+     * @param csv_file Archivo de salida
+     */
+    void exportToCSV(const std::vector<KernelResult>& results, const std::string& csv_file) const;
+
+    /**
+     * Genera un par de secuencias: la segunda deriva de la primera con
+     * sustituciones e indels en la fracción de posiciones indicada
+     * @param alphabet Residuos posibles
+     * @param length Longitud de la primera secuencia
+     * @param divergence Fracción de posiciones mutadas
+     * @param seed Semilla
+     * @return Par (original, derivada)
+     */
+    static std::pair<std::string, std::string> makePair(const std::string& alphabet, size_t length,
+                                                        double divergence, unsigned seed);
+
+private:
+    KernelBenchmarkOptions options;
+    MSAAligner aligner;
+
+    bool selected(const std::string& kernel) const;
+
+    /**
+     * Mide un kernel: calibra las iteraciones por lote y devuelve la mediana
+     * @param body Una iteración; devuelve un valor que se acumula para que no se elimine
+     */
+    KernelResult measure(const std::function<uint64_t()>& body) const;
+
+    void runCase(const std::string& alphabet_name, size_t length, double divergence,
+                 bool include_io, std::vector<KernelResult>& results);
+};
+
+#endif // KERNEL_BENCHMARK_H
@@ -0,0 +1,351 @@
+#include "logger.h"
+#include "json_util.h"
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+
+std::atomic<int> Logger::threshold(static_cast<int>(LogLevel::Off));
+std::atomic<int> Logger::format(static_cast<int>(LogFormat::Text));
+
+namespace {
+    const char* levelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::Error: return "error";
+            case LogLevel::Warn:  return "warn";
+            case LogLevel::Info:  return "info";
+            case LogLevel::Debug: return "debug";
+            case LogLevel::Trace: return "trace";
+            case LogLevel::Off:   return "off";
+        }
+        return "info";
+    }
+
+    unsigned currentThreadIndex() {
+        static std::atomic<unsigned> next_index(0);
+        thread_local unsigned index = next_index++;
+        return index;
+    }
+
+    void appendKeyValue(std::string& out, const std::string& key, const std::string& value, bool quoted) {
+        out += ' ';
+        out += key;
+        out += '=';
+        bool needs_quotes = quoted && (value.empty() || value.find_first_of(" \"=\n\t") != std::string::npos);
+        if (needs_quotes) {
+            out += '"';
+            appendJsonEscaped(out, value);
+            out += '"';
+        } else {
+            out += value;
+        }
+    }
+
+    void appendJsonPair(std::string& out, const std::string& key, const std::string& value, bool quoted) {
+        out += ",\"";
+        appendJsonEscaped(out, key);
+        out += "\":";
+        if (quoted) {
+            out += '"';
+            appendJsonEscaped(out, value);
+            out += '"';
+        } else {
+            out += value;
+        }
+    }
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : ring(new Slot[RING_CAPACITY]), enqueue_pos(0), dequeue_pos(0), written(0),
+      stopping(false), drainer_sleeping(false) {
+    for (size_t i = 0; i < RING_CAPACITY; ++i) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger() {
+    if (drainer.joinable()) {
+        stopping = true;
+        wake_condition.notify_one();
+        drainer.join();
+    }
+}
+
+void Logger::setLevel(LogLevel level) {
+    threshold.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void Logger::setFormat(LogFormat log_format) {
+    format.store(static_cast<int>(log_format), std::memory_order_relaxed);
+}
+
+void Logger::setSink(LogSink log_sink) {
+    // Lo ya encolado va al destino vigente cuando se registró
+    Logger& logger = instance();
+    logger.flush();
+    std::lock_guard<std::mutex> lock(logger.sink_mutex);
+    logger.sink = log_sink ? std::make_shared<const LogSink>(std::move(log_sink)) : nullptr;
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    if (name == "quiet") level = LogLevel::Warn;
+    else if (name == "info") level = LogLevel::Info;
+    else if (name == "debug") level = LogLevel::Debug;
+    else if (name == "trace") level = LogLevel::Trace;
+    else return false;
+    return true;
+}
+
+bool Logger::parseFormat(const std::string& name, LogFormat& log_format) {
+    if (name == "text") log_format = LogFormat::Text;
+    else if (name == "kv") log_format = LogFormat::KeyValue;
+    else if (name == "json") log_format = LogFormat::Json;
+    else return false;
+    return true;
+}
+
+void Logger::startDrainer() {
+    std::call_once(drainer_started, [this] {
+        drainer = std::thread(&Logger::drainLoop, this);
+    });
+}
+
+void Logger::submit(LogEntry&& entry) {
+    startDrainer();
+
+    // Cola acotada MPMC de Vyukov: cada ranura lleva un número de secuencia
+    size_t position = enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+        slot = &ring[position & (RING_CAPACITY - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (difference == 0) {
+            if (enqueue_pos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // Anillo lleno: se despierta al drenador y se cede la CPU
+            wake_condition.notify_one();
+            std::this_thread::yield();
+            position = enqueue_pos.load(std::memory_order_relaxed);
+        } else {
+            position = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->entry = std::move(entry);
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    if (drainer_sleeping.load(std::memory_order_relaxed)) {
+        wake_condition.notify_one();
+    }
+}
+
+bool Logger::tryDequeue(LogEntry& entry) {
+    // Un único consumidor: no hace falta CAS sobre dequeue_pos
+    size_t position = dequeue_pos.load(std::memory_order_relaxed);
+    Slot& slot = ring[position & (RING_CAPACITY - 1)];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (sequence != position + 1) {
+        return false;
+    }
+
+    entry = std::move(slot.entry);
+    slot.sequence.store(position + RING_CAPACITY, std::memory_order_release);
+    dequeue_pos.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void Logger::drainLoop() {
+    std::string out_buffer;
+    std::string err_buffer;
+    std::string line;
+    LogEntry entry;
+
+    while (true) {
+        std::shared_ptr<const LogSink> current_sink;
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            current_sink = sink;
+        }
+
+        size_t batch = 0;
+        while (tryDequeue(entry)) {
+            if (current_sink) {
+                line.clear();
+                formatEntry(entry, line);
+                (*current_sink)(entry.level, entry.event, line);
+            } else {
+                writeEntry(entry, out_buffer, err_buffer);
+            }
+            ++batch;
+        }
+
+        if (batch > 0) {
+            // El orden entre stdout y stderr se preserva vaciando stderr antes de seguir
+            if (!out_buffer.empty()) {
+                std::fwrite(out_buffer.data(), 1, out_buffer.size(), stdout);
+                std::fflush(stdout);
+                out_buffer.clear();
+            }
+            if (!err_buffer.empty()) {
+                std::fwrite(err_buffer.data(), 1, err_buffer.size(), stderr);
+                err_buffer.clear();
+            }
+            written.fetch_add(batch, std::memory_order_release);
+            continue;
+        }
+
+        if (stopping.load()) {
+            if (dequeue_pos.load(std::memory_order_relaxed) == enqueue_pos.load(std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        drainer_sleeping = true;
+        wake_condition.wait_for(lock, std::chrono::milliseconds(2));
+        drainer_sleeping = false;
+    }
+}
+
+void Logger::writeEntry(const LogEntry& entry, std::string& out_buffer, std::string& err_buffer) {
+    bool to_stderr = entry.level <= LogLevel::Warn;
+    std::string& out = to_stderr ? err_buffer : out_buffer;
+
+    if (to_stderr && !out_buffer.empty()) {
+        std::fwrite(out_buffer.data(), 1, out_buffer.size(), stdout);
+        std::fflush(stdout);
+        out_buffer.clear();
+    } else if (!to_stderr && !err_buffer.empty()) {
+        std::fwrite(err_buffer.data(), 1, err_buffer.size(), stderr);
+        err_buffer.clear();
+    }
+
+    formatEntry(entry, out);
+    out += '\n';
+}
+
+void Logger::formatEntry(const LogEntry& entry, std::string& out) {
+    LogFormat log_format = static_cast<LogFormat>(format.load(std::memory_order_relaxed));
+
+    if (log_format == LogFormat::Text) {
+        out += entry.message.empty() && !entry.fields.empty() ? std::string(entry.event) : entry.message;
+        if (entry.level >= LogLevel::Debug) {
+            for (size_t i = 0; i < entry.fields.size(); ++i) {
+                appendKeyValue(out, entry.fields[i].first, entry.fields[i].second, entry.quoted[i]);
+            }
+        }
+        return;
+    }
+
+    char timestamp[32];
+    std::snprintf(timestamp, sizeof(timestamp), "%.6f", entry.timestamp);
+
+    if (log_format == LogFormat::KeyValue) {
+        out += "ts=";
+        out += timestamp;
+        appendKeyValue(out, "level", levelName(entry.level), false);
+        appendKeyValue(out, "event", entry.event, false);
+        appendKeyValue(out, "thread", std::to_string(entry.thread_index), false);
+        if (!entry.message.empty()) {
+            out += " msg=\"";
+            appendJsonEscaped(out, entry.message);
+            out += '"';
+        }
+        for (size_t i = 0; i < entry.fields.size(); ++i) {
+            appendKeyValue(out, entry.fields[i].first, entry.fields[i].second, entry.quoted[i]);
+        }
+    } else {
+        out += "{\"ts\":";
+        out += timestamp;
+        appendJsonPair(out, "level", levelName(entry.level), true);
+        appendJsonPair(out, "event", entry.event, true);
+        appendJsonPair(out, "thread", std::to_string(entry.thread_index), false);
+        if (!entry.message.empty()) {
+            appendJsonPair(out, "msg", entry.message, true);
+        }
+        for (size_t i = 0; i < entry.fields.size(); ++i) {
+            appendJsonPair(out, entry.fields[i].first, entry.fields[i].second, entry.quoted[i]);
+        }
+        out += '}';
+    }
+}
+
+void Logger::flush() {
+    size_t target = enqueue_pos.load(std::memory_order_acquire);
+    while (written.load(std::memory_order_acquire) < target) {
+        wake_condition.notify_one();
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    std::fflush(stdout);
+    std::fflush(stderr);
+}
+
+LogRecord::LogRecord(LogLevel level, const char* event) {
+    entry.level = level;
+    entry.event = event;
+}
+
+LogRecord::~LogRecord() {
+    entry.message = stream.str();
+
+    entry.timestamp = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    entry.thread_index = currentThreadIndex();
+    Logger::instance().submit(std::move(entry));
+}
+
+LogRecord& LogRecord::field(const char* key, const std::string& value) {
+    entry.fields.emplace_back(key, value);
+    entry.quoted.push_back(true);
+    return *this;
+}
+
+LogRecord& LogRecord::field(const char* key, const char* value) {
+    return field(key, std::string(value));
+}
+
+LogRecord& LogRecord::field(const char* key, double value) {
+    std::ostringstream text;
+    text << value;
+    entry.fields.emplace_back(key, text.str());
+    entry.quoted.push_back(false);
+    return *this;
+}
+
+bool applyLogOptions(int argc, char* argv[], std::vector<char*>& remaining) {
+    Logger::setLevel(LogLevel::Info);
+    remaining.clear();
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quiet") {
+            Logger::setLevel(LogLevel::Warn);
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            LogLevel level;
+            if (!Logger::parseLevel(argv[++i], level)) {
+                LOG_ERROR("log.error") << "Error: Nivel de registro desconocido: " << argv[i];
+                return false;
+            }
+            Logger::setLevel(level);
+        } else if (arg == "--log-format" && i + 1 < argc) {
+            LogFormat log_format;
+            if (!Logger::parseFormat(argv[++i], log_format)) {
+                LOG_ERROR("log.error") << "Error: Formato de registro desconocido: " << argv[i];
+                return false;
+            }
+            Logger::setFormat(log_format);
+        } else {
+            remaining.push_back(argv[i]);
+        }
+    }
+    return true;
+}
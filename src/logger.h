@@ -0,0 +1,211 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Niveles de registro. "quiet" deja solo Error y Warn; Off no emite nada (valor
+ * por defecto hasta que un ejecutable o la aplicación elige un nivel).
+ * (Nombres en CamelCase para no chocar con macros como ERROR de <windows.h>)
+ */
+enum class LogLevel {
+    Off = -1,
+    Error = 0,
+    Warn = 1,
+    Info = 2,
+    Debug = 3,
+    Trace = 4
+};
+
+/**
+ * Formato de los registros
+ */
+enum class LogFormat {
+    Text,       // Solo el mensaje (salida de consola habitual)
+    KeyValue,   // ts=... level=... event=... msg="..." clave=valor
+    Json        // Un objeto JSON por línea
+};
+
+/**
+ * Registro listo para encolar
+ */
+struct LogEntry {
+    LogLevel level;
+    const char* event;
+    std::string message;
+    std::vector<std::pair<std::string, std::string>> fields;   // Valores ya serializados
+    std::vector<bool> quoted;                                   // true si el valor es texto
+    double timestamp;
+    unsigned thread_index;
+    
+    LogEntry() : level(LogLevel::Info), event(""), timestamp(0.0), thread_index(0) {}
+};
+
+/**
+ * Destino de los registros de una aplicación que embebe el alineador: recibe el
+ * nivel, el evento y la línea ya formateada (sin salto de línea). Se llama desde
+ * el hilo de fondo del registro, un registro a la vez.
+ */
+using LogSink = std::function<void(LogLevel level, const char* event, const std::string& line)>;
+
+/**
+ * Registro asíncrono: los productores encolan en un anillo acotado sin bloqueos
+ * y un hilo de fondo formatea y escribe en lotes (stdout para INFO y superiores,
+ * stderr para ERROR/WARN, o el LogSink instalado). Si el nivel no está activo,
+ * el registro cuesta una lectura atómica y no se arranca el hilo de fondo.
+ *
+ * Arranca en LogLevel::Off: la biblioteca no escribe nada salvo que la
+ * aplicación instale un destino y un nivel; los ejecutables activan la consola
+ * con applyLogOptions.
+ */
+class Logger {
+public:
+    static Logger& instance();
+    
+    /**
+     * Indica si un nivel está activo (comprobación del camino rápido)
+     */
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) <= threshold.load(std::memory_order_relaxed);
+    }
+    
+    static void setLevel(LogLevel level);
+    static void setFormat(LogFormat format);
+    
+    /**
+     * Envía los registros a una función en lugar de la consola; antes entrega
+     * al destino anterior lo que ya estaba encolado (no llamar desde el destino)
+     * @param sink Destino (nullptr = stdout/stderr)
+     */
+    static void setSink(LogSink sink);
+    
+    /**
+     * Interpreta un nivel por nombre (quiet, info, debug, trace)
+     * @return false si el nombre no es válido
+     */
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    
+    /**
+     * Interpreta un formato por nombre (text, kv, json)
+     * @return false si el nombre no es válido
+     */
+    static bool parseFormat(const std::string& name, LogFormat& format);
+    
+    /**
+     * Encola un registro; si el anillo está lleno espera a que el hilo de fondo libere espacio
+     */
+    void submit(LogEntry&& entry);
+    
+    /**
+     * Espera a que todos los registros encolados hasta ahora estén escritos
+     */
+    void flush();
+    
+    ~Logger();
+    
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogEntry entry;
+    };
+    
+    static const size_t RING_CAPACITY = 4096;   // Potencia de 2
+    
+    static std::atomic<int> threshold;
+    static std::atomic<int> format;
+    
+    std::unique_ptr<Slot[]> ring;
+    std::atomic<size_t> enqueue_pos;
+    std::atomic<size_t> dequeue_pos;
+    std::atomic<size_t> written;
+    
+    std::thread drainer;
+    std::once_flag drainer_started;
+    std::atomic<bool> stopping;
+    std::atomic<bool> drainer_sleeping;
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+    
+    std::mutex sink_mutex;
+    std::shared_ptr<const LogSink> sink;
+    
+    Logger();
+    
+    void startDrainer();
+    void drainLoop();
+    bool tryDequeue(LogEntry& entry);
+    void writeEntry(const LogEntry& entry, std::string& out_buffer, std::string& err_buffer);
+    static void formatEntry(const LogEntry& entry, std::string& out);
+};
+
+/**
+ * Constructor de registros por flujo. Se usa a través de las macros LOG_*,
+ * que solo lo instancian si el nivel está activo.
+ */
+class LogRecord {
+public:
+    LogRecord(LogLevel level, const char* event);
+    ~LogRecord();
+    
+    LogRecord& field(const char* key, const std::string& value);
+    LogRecord& field(const char* key, const char* value);
+    LogRecord& field(const char* key, double value);
+    
+    template <typename T>
+    LogRecord& field(const char* key, T value) {
+        entry.fields.emplace_back(key, std::to_string(value));
+        entry.quoted.push_back(false);
+        return *this;
+    }
+    
+    template <typename T>
+    LogRecord& operator<<(const T& value) {
+        stream << value;
+        return *this;
+    }
+    
+    LogRecord& operator<<(std::ios_base& (*manipulator)(std::ios_base&)) {
+        stream << manipulator;
+        return *this;
+    }
+
+private:
+    LogEntry entry;
+    std::ostringstream stream;
+};
+
+/**
+ * Activa la consola en nivel info y extrae y aplica las opciones de registro de
+ * la línea de comandos: --quiet, --log-level <quiet|info|debug|trace> y
+ * --log-format <text|kv|json>
+ * @param argc Número de argumentos
+ * @param argv Argumentos
+ * @param remaining Argumentos restantes (incluido el nombre del programa)
+ * @return false si alguna opción tiene un valor inválido
+ */
+bool applyLogOptions(int argc, char* argv[], std::vector<char*>& remaining);
+
+#define MSA_LOG(level, event) \
+    if (!Logger::enabled(level)) {} else LogRecord(level, event)
+
+#define LOG_ERROR(event) MSA_LOG(LogLevel::Error, event)
+#define LOG_WARN(event)  MSA_LOG(LogLevel::Warn, event)
+#define LOG_INFO(event)  MSA_LOG(LogLevel::Info, event)
+#define LOG_DEBUG(event) MSA_LOG(LogLevel::Debug, event)
+#define LOG_TRACE(event) MSA_LOG(LogLevel::Trace, event)
+
+#endif // LOGGER_H
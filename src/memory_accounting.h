@@ -0,0 +1,271 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/**
+ * Fases del alineamiento a las que se atribuyen las reservas de memoria
+ */
+enum class MemoryPhase : int {
+    OTHER = 0,
+    PARSE,          // Lectura de la entrada
+    DISTANCES,      // Matriz de distancias
+    TREE,           // Árbol guía
+    PROGRESSIVE,    // Uniones progresivas y realineamiento final de las filas
+    OUTPUT,         // Materialización y escritura del resultado
+    COUNT
+};
+
+/**
+ * Nombre de una fase ("parse", "distances", ...)
+ */
+inline const char* memoryPhaseName(MemoryPhase phase) {
+    static const char* const names[] = {"other", "parse", "distances", "tree", "progressive", "output"};
+    int index = static_cast<int>(phase);
+    return index >= 0 && index < static_cast<int>(MemoryPhase::COUNT) ? names[index] : "other";
+}
+
+/**
+ * Reservas atribuidas a una fase
+ */
+struct PhaseMemory {
+    uint64_t bytes_allocated;       // Bytes reservados (tamaño real de bloque)
+    uint64_t allocations;           // Llamadas a operator new
+    uint64_t peak_live_bytes;       // Pico de bytes vivos sobre el inicio de la medición
+
+    PhaseMemory() : bytes_allocated(0), allocations(0), peak_live_bytes(0) {}
+};
+
+/**
+ * Contabilidad de reservas por fase.
+ *
+ * La fase en curso es global (los hilos del pool trabajan para la fase que fijó
+ * el alineador). Cada hilo acumula bytes y reservas en contadores propios, sin
+ * contención, y vuelca su saldo de bytes vivos al total global cada
+ * LIVE_FLUSH_BYTES; el pico por fase es por tanto aproximado a esa granularidad
+ * por hilo.
+ *
+ * Los contadores solo se alimentan si el programa enlaza src/memory_hook.cpp,
+ * que reemplaza operator new/delete (lo hace el binario de benchmarks); sin él,
+ * fijar la fase cuesta una escritura atómica y enabled() devuelve false. La fase
+ * es única por proceso: con varios alineadores concurrentes las cifras se mezclan.
+ */
+class MemoryAccounting {
+public:
+    static const int PHASE_COUNT = static_cast<int>(MemoryPhase::COUNT);
+    static const int64_t LIVE_FLUSH_BYTES = 16 * 1024;
+    
+    /**
+     * Función avisada en cada cambio de fase (p. ej. para leer contadores de hardware)
+     */
+    using PhaseListener = void (*)(MemoryPhase previous, MemoryPhase next);
+
+    /**
+     * Indica si el hook de operator new está enlazado
+     */
+    static bool enabled() {
+        return hooked.load(std::memory_order_relaxed);
+    }
+
+    static MemoryPhase phase() {
+        return static_cast<MemoryPhase>(current_phase.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Cambia la fase en curso; su pico parte de los bytes vivos actuales
+     */
+    static void setPhase(MemoryPhase phase) {
+        int index = static_cast<int>(phase);
+        int previous = current_phase.exchange(index, std::memory_order_relaxed);
+        raisePeak(index, live_bytes.load(std::memory_order_relaxed));
+        PhaseListener listener = phase_listener.load(std::memory_order_acquire);
+        if (listener) {
+            listener(static_cast<MemoryPhase>(previous), phase);
+        }
+    }
+    
+    /**
+     * Registra la función avisada en cada cambio de fase (nullptr = ninguna)
+     */
+    static void setPhaseListener(PhaseListener listener) {
+        phase_listener.store(listener, std::memory_order_release);
+    }
+
+    /**
+     * Empieza una medición: los contadores y picos siguientes son relativos a este momento
+     */
+    static void reset() {
+        ThreadCounters* own = threadCounters();
+        if (own) {
+            flush(own, current_phase.load(std::memory_order_relaxed));
+        }
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            baseline_bytes[p].store(sumOver(&ThreadCounters::bytes, p), std::memory_order_relaxed);
+            baseline_allocations[p].store(sumOver(&ThreadCounters::allocations, p), std::memory_order_relaxed);
+        }
+        int64_t live = live_bytes.load(std::memory_order_relaxed);
+        baseline_live.store(live, std::memory_order_relaxed);
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            peak_live[p].store(live, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Reservas por fase desde el último reset(), indexadas por MemoryPhase
+     */
+    static std::vector<PhaseMemory> snapshot() {
+        std::vector<PhaseMemory> phases(PHASE_COUNT);
+        int64_t baseline = baseline_live.load(std::memory_order_relaxed);
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            phases[p].bytes_allocated = sumOver(&ThreadCounters::bytes, p) -
+                                        baseline_bytes[p].load(std::memory_order_relaxed);
+            phases[p].allocations = sumOver(&ThreadCounters::allocations, p) -
+                                    baseline_allocations[p].load(std::memory_order_relaxed);
+            int64_t peak = peak_live[p].load(std::memory_order_relaxed) - baseline;
+            phases[p].peak_live_bytes = peak > 0 ? static_cast<uint64_t>(peak) : 0;
+        }
+        return phases;
+    }
+
+    /**
+     * Registra una reserva del hilo actual (la llama el hook de operator new)
+     */
+    static void recordAllocation(size_t bytes) {
+        ThreadCounters* counters = threadCounters();
+        if (!counters) {
+            return;
+        }
+        int phase = current_phase.load(std::memory_order_relaxed);
+        bump(counters->bytes[phase], bytes);
+        bump(counters->allocations[phase], 1);
+        counters->pending_live += static_cast<int64_t>(bytes);
+        if (counters->pending_live >= LIVE_FLUSH_BYTES) {
+            flush(counters, phase);
+        }
+    }
+
+    /**
+     * Registra una liberación del hilo actual (la llama el hook de operator delete)
+     */
+    static void recordRelease(size_t bytes) {
+        ThreadCounters* counters = threadCounters();
+        if (!counters) {
+            return;
+        }
+        counters->pending_live -= static_cast<int64_t>(bytes);
+        if (counters->pending_live <= -LIVE_FLUSH_BYTES) {
+            flush(counters, current_phase.load(std::memory_order_relaxed));
+        }
+    }
+
+    /**
+     * Marca el hook como enlazado (desde el inicializador estático del hook)
+     */
+    static void markHooked() {
+        hooked.store(true, std::memory_order_relaxed);
+    }
+
+private:
+    // Contadores de un hilo: solo los escribe su dueño; se leen desde snapshot()
+    struct ThreadCounters {
+        std::atomic<uint64_t> bytes[PHASE_COUNT];
+        std::atomic<uint64_t> allocations[PHASE_COUNT];
+        int64_t pending_live;
+        ThreadCounters* next;
+    };
+
+    inline static std::atomic<bool> hooked{false};
+    inline static std::atomic<int> current_phase{0};
+    inline static std::atomic<int64_t> live_bytes{0};
+    inline static std::atomic<int64_t> baseline_live{0};
+    inline static std::atomic<int64_t> peak_live[PHASE_COUNT] = {};
+    inline static std::atomic<uint64_t> baseline_bytes[PHASE_COUNT] = {};
+    inline static std::atomic<uint64_t> baseline_allocations[PHASE_COUNT] = {};
+    inline static std::atomic<ThreadCounters*> registry{nullptr};
+    inline static std::atomic<PhaseListener> phase_listener{nullptr};
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void raisePeak(int phase, int64_t live) {
+        int64_t peak = peak_live[phase].load(std::memory_order_relaxed);
+        while (live > peak && !peak_live[phase].compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void flush(ThreadCounters* counters, int phase) {
+        int64_t delta = counters->pending_live;
+        counters->pending_live = 0;
+        int64_t live = live_bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+        if (delta > 0) {
+            raisePeak(phase, live);
+        }
+    }
+
+    static uint64_t sumOver(std::atomic<uint64_t> (ThreadCounters::*field)[PHASE_COUNT], int phase) {
+        uint64_t total = 0;
+        for (ThreadCounters* c = registry.load(std::memory_order_acquire); c; c = c->next) {
+            total += (c->*field)[phase].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Se reserva con malloc para no reentrar en operator new; los bloques de
+    // hilos terminados se conservan para que sus reservas sigan sumando
+    static ThreadCounters* threadCounters() {
+        thread_local ThreadCounters* counters = nullptr;
+        if (!counters) {
+            void* memory = std::malloc(sizeof(ThreadCounters));
+            if (!memory) {
+                return nullptr;
+            }
+            ThreadCounters* created = new (memory) ThreadCounters();
+            for (int p = 0; p < PHASE_COUNT; ++p) {
+                created->bytes[p].store(0, std::memory_order_relaxed);
+                created->allocations[p].store(0, std::memory_order_relaxed);
+            }
+            created->pending_live = 0;
+            created->next = registry.load(std::memory_order_relaxed);
+            while (!registry.compare_exchange_weak(created->next, created, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+            }
+            counters = created;
+        }
+        return counters;
+    }
+};
+
+/**
+ * Fija una fase mientras dura el ámbito y restaura la anterior al salir
+ */
+class MemoryPhaseScope {
+public:
+    explicit MemoryPhaseScope(MemoryPhase phase) : previous(MemoryAccounting::phase()) {
+        MemoryAccounting::setPhase(phase);
+    }
+
+    ~MemoryPhaseScope() {
+        MemoryAccounting::setPhase(previous);
+    }
+
+    /**
+     * Pasa a otra fase dentro del mismo ámbito
+     */
+    void set(MemoryPhase phase) {
+        MemoryAccounting::setPhase(phase);
+    }
+
+    MemoryPhaseScope(const MemoryPhaseScope&) = delete;
+    MemoryPhaseScope& operator=(const MemoryPhaseScope&) = delete;
+
+private:
+    MemoryPhase previous;
+};
+
+#endif // MEMORY_ACCOUNTING_H
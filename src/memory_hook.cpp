@@ -0,0 +1,132 @@
+// Reemplazo global de operator new/delete que alimenta MemoryAccounting.
+// Se enlaza solo en los binarios que miden memoria por fase (benchmark).
+
+#include "memory_accounting.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#elif __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+struct HookInstaller {
+    HookInstaller() { MemoryAccounting::markHooked(); }
+} hook_installer;
+
+// Tamaño real del bloque: el mismo en la reserva y en la liberación, sin cabeceras propias
+size_t blockSize(void* pointer, size_t alignment) {
+#ifdef _WIN32
+    return alignment ? _aligned_msize(pointer, alignment, 0) : _msize(pointer);
+#elif __APPLE__
+    (void)alignment;
+    return malloc_size(pointer);
+#else
+    (void)alignment;
+    return malloc_usable_size(pointer);
+#endif
+}
+
+void* rawAllocate(size_t size, size_t alignment) {
+#ifdef _WIN32
+    return alignment ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+    if (!alignment) {
+        return std::malloc(size);
+    }
+    // aligned_alloc exige un tamaño múltiplo de la alineación
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void rawRelease(void* pointer, size_t alignment) {
+#ifdef _WIN32
+    if (alignment) {
+        _aligned_free(pointer);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(pointer);
+}
+
+void* allocate(size_t size, size_t alignment, bool nothrow) {
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void* pointer = rawAllocate(size, alignment);
+        if (pointer) {
+            MemoryAccounting::recordAllocation(blockSize(pointer, alignment));
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow) {
+                return nullptr;
+            }
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void release(void* pointer, size_t alignment) {
+    if (!pointer) {
+        return;
+    }
+    MemoryAccounting::recordRelease(blockSize(pointer, alignment));
+    rawRelease(pointer, alignment);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocate(size, 0, false); }
+void* operator new[](size_t size) { return allocate(size, 0, false); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0, true); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0, true); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<size_t>(alignment), false);
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<size_t>(alignment), false);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment), true);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment), true);
+}
+
+void operator delete(void* pointer) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer) noexcept { release(pointer, 0); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer, 0); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer, 0); }
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
@@ -0,0 +1,102 @@
+#include "msa_api.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <sstream>
+
+std::vector<Sequence> MSAResult::toSequences() const {
+    std::vector<Sequence> sequences;
+    sequences.reserve(rows.size());
+    for (const auto& row : rows) {
+        sequences.emplace_back(row.header, row.toAlignedString());
+    }
+    return sequences;
+}
+
+std::string MSAResult::format(const std::string& format) const {
+    std::ostringstream output;
+    FastaIO::formatRows(rows, output, format);
+    return output.str();
+}
+
+MSAEngine::MSAEngine(const MSAOptions& options) : options(options) {
+    ThreadPool* pool = options.thread_pool;
+    if (!pool && options.num_threads != 1) {
+        owned_pool = std::make_unique<ThreadPool>(options.num_threads);
+        pool = owned_pool.get();
+    }
+
+    aligner.setVerbose(false);
+    aligner.setThreadPool(pool);
+    aligner.setProgressCallback(options.progress);
+    aligner.setTimeBudget(options.time_budget_seconds);
+    aligner.setMemoryBudget(options.max_memory_bytes);
+    aligner.setCancellationToken(options.cancel_token);
+}
+
+MSAEngine::~MSAEngine() = default;
+
+MSAResult MSAEngine::align(const std::vector<Sequence>& sequences) {
+    MSAResult result;
+
+    if (sequences.size() < 2) {
+        result.error = "Se necesitan al menos 2 secuencias para el alineamiento";
+        return result;
+    }
+
+    for (const auto& sequence : sequences) {
+        if (sequence.sequence.empty() || !FastaIO::validateSequence(sequence.sequence)) {
+            result.error = "Secuencia invalida: " + sequence.header;
+            return result;
+        }
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    try {
+        result.rows = options.result_cache
+            ? options.result_cache->align(aligner, sequences, &result.metrics.cache_hit)
+            : aligner.alignSequencesToRows(sequences);
+    } catch (const std::exception& e) {
+        result.error = std::string("Fallo en el alineamiento: ") + e.what();
+        return result;
+    }
+
+    if (aligner.wasCancelled()) {
+        result.cancelled = true;
+        result.error = "Alineamiento cancelado";
+        return result;
+    }
+
+    if (result.rows.empty()) {
+        result.error = "Fallo en el alineamiento";
+        return result;
+    }
+
+    auto stats = aligner.getAlignmentStats();
+    result.metrics.num_sequences = sequences.size();
+    result.metrics.final_length = stats["final_length"];
+    result.metrics.total_gaps = stats["total_gaps"];
+    result.metrics.degradations = aligner.getDegradations();
+    result.metrics.memory_strategies = aligner.getMemoryStrategies();
+    result.metrics.timings = aligner.getAlignmentTimings();
+    if (result.metrics.final_length > 0) {
+        result.metrics.gap_percentage = 100.0 * result.metrics.total_gaps /
+            (static_cast<double>(sequences.size()) * result.metrics.final_length);
+    }
+    result.metrics.elapsed_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    result.ok = true;
+    return result;
+}
+
+void MSAEngine::setLogSink(LogSink sink, LogLevel level) {
+    // Sin destino no se emite nada: nunca se cae en la consola del proceso
+    Logger::setLevel(sink ? level : LogLevel::Off);
+    Logger::setSink(std::move(sink));
+}
+
+MSAResult MSAEngine::alignFasta(const std::string& fasta_text) {
+    std::istringstream input(fasta_text);
+    return align(FastaIO::parseFasta(input, "texto FASTA"));
+}
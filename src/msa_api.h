@@ -0,0 +1,121 @@
+#ifndef MSA_API_H
+#define MSA_API_H
+
+#include "alignment.h"
+#include "io.h"
+#include "logger.h"
+#include "result_cache.h"
+#include <string>
+#include <vector>
+#include <memory>
+
+/**
+ * Opciones de la API embebible del alineador
+ */
+struct MSAOptions {
+    size_t num_threads;             // Hilos propios (1 = en serie, 0 = todos los núcleos)
+    ThreadPool* thread_pool;        // Pool externo opcional; tiene prioridad sobre num_threads
+    ProgressCallback progress;      // Notificaciones de progreso (opcional)
+    double time_budget_seconds;     // Presupuesto por alineamiento (0 = sin límite)
+    size_t max_memory_bytes;        // Límite de memoria por alineamiento (0 = sin límite)
+    const CancellationToken* cancel_token;  // Cancelación externa opcional
+    ResultCache* result_cache;      // Caché de resultados compartida (opcional)
+    
+    MSAOptions() : num_threads(1), thread_pool(nullptr), time_budget_seconds(0.0), max_memory_bytes(0),
+                   cancel_token(nullptr), result_cache(nullptr) {}
+};
+
+/**
+ * Métricas de un alineamiento
+ */
+struct MSAMetrics {
+    size_t num_sequences;
+    int final_length;
+    int total_gaps;
+    double gap_percentage;
+    double elapsed_seconds;
+    unsigned degradations;          // Máscara Degradation aplicada por el presupuesto
+    unsigned memory_strategies;     // Máscara MemoryStrategy aplicada por el límite de memoria
+    bool cache_hit;                 // Resultado servido desde la caché
+    AlignmentTimings timings;       // Tiempos por etapa (a cero si vino de la caché)
+    
+    MSAMetrics() : num_sequences(0), final_length(0), total_gaps(0),
+                   gap_percentage(0.0), elapsed_seconds(0.0), degradations(DEGRADE_NONE),
+                   memory_strategies(MEMORY_FULL), cache_hit(false) {}
+};
+
+/**
+ * Resultado de un alineamiento: filas, métricas y error si lo hubo
+ */
+struct MSAResult {
+    bool ok;
+    bool cancelled;
+    std::string error;
+    std::vector<AlignedRow> rows;
+    MSAMetrics metrics;
+    
+    MSAResult() : ok(false), cancelled(false) {}
+    
+    /**
+     * Materializa las filas como secuencias alineadas
+     * @return Secuencias con gaps
+     */
+    std::vector<Sequence> toSequences() const;
+    
+    /**
+     * Serializa el alineamiento en memoria
+     * @param format "fasta", "a3m" o "rle"
+     * @return Texto del alineamiento
+     */
+    std::string format(const std::string& format) const;
+};
+
+/**
+ * Punto de entrada para usar el alineador como biblioteca: no escribe en
+ * consola, informa el progreso por callback y devuelve errores en el resultado.
+ * Los avisos internos (degradaciones, cancelaciones, límite de memoria, E/S) solo
+ * llegan a la aplicación si instala un destino con setLogSink.
+ * Conserva el alineador y el pool entre llamadas; una instancia no debe usarse
+ * desde varios hilos a la vez (crear una por hilo).
+ */
+class MSAEngine {
+public:
+    /**
+     * Constructor
+     * @param options Opciones del motor
+     */
+    explicit MSAEngine(const MSAOptions& options = MSAOptions());
+    
+    /**
+     * Destructor
+     */
+    ~MSAEngine();
+    
+    /**
+     * Alinea un conjunto de secuencias
+     * @param sequences Secuencias sin alinear (mínimo 2)
+     * @return Resultado con filas y métricas
+     */
+    MSAResult align(const std::vector<Sequence>& sequences);
+    
+    /**
+     * Alinea secuencias recibidas como texto FASTA
+     * @param fasta_text Contenido FASTA
+     * @return Resultado con filas y métricas
+     */
+    MSAResult alignFasta(const std::string& fasta_text);
+    
+    /**
+     * Recibe los registros del alineador (compartido por todos los motores del proceso)
+     * @param sink Destino de los registros (nullptr = ninguno)
+     * @param level Nivel máximo entregado (LogLevel::Off = ninguno)
+     */
+    static void setLogSink(LogSink sink, LogLevel level = LogLevel::Warn);
+
+private:
+    MSAOptions options;
+    std::unique_ptr<ThreadPool> owned_pool;
+    MSAAligner aligner;
+};
+
+#endif // MSA_API_H
@@ -0,0 +1,245 @@
+#include "msa_c_api.h"
+#include "msa_api.h"
+#include "cancellation.h"
+#include <map>
+#include <memory>
+#include <new>
+
+struct msa_engine {
+    CancellationToken cancel_token;
+    std::unique_ptr<MSAEngine> engine;
+};
+
+struct msa_result {
+    MSAResult result;
+    std::vector<std::string> aligned_rows;
+    std::map<std::string, std::string> formatted;
+};
+
+namespace {
+    // Rearma la cancelación al terminar la llamada, por cualquier camino de salida
+    struct CancelRearm {
+        CancellationToken& token;
+        ~CancelRearm() {
+            token.reset();
+        }
+    };
+
+    msa_result* makeResult(MSAResult&& result) {
+        msa_result* handle = new (std::nothrow) msa_result();
+        if (!handle) {
+            return nullptr;
+        }
+
+        handle->result = std::move(result);
+        handle->aligned_rows.reserve(handle->result.rows.size());
+        for (const auto& row : handle->result.rows) {
+            handle->aligned_rows.push_back(row.toAlignedString());
+        }
+        return handle;
+    }
+
+    msa_result* makeError(const std::string& message) {
+        MSAResult result;
+        result.error = message;
+        return makeResult(std::move(result));
+    }
+}
+
+int msa_api_version(void) {
+    return MSA_API_VERSION;
+}
+
+void msa_set_log_callback(msa_log_fn callback, int max_level, void* user_data) {
+    try {
+        if (!callback || max_level < MSA_LOG_ERROR) {
+            MSAEngine::setLogSink(nullptr, LogLevel::Off);
+            return;
+        }
+        int level = max_level > MSA_LOG_DEBUG ? MSA_LOG_DEBUG : max_level;
+        MSAEngine::setLogSink([callback, user_data](LogLevel entry_level, const char* event, const std::string& line) {
+            callback(static_cast<int>(entry_level), event, line.c_str(), user_data);
+        }, static_cast<LogLevel>(level));
+    } catch (...) {
+        MSAEngine::setLogSink(nullptr, LogLevel::Off);
+    }
+}
+
+void msa_options_init(msa_options* options) {
+    if (!options) {
+        return;
+    }
+    options->struct_size = sizeof(msa_options);
+    options->num_threads = 1;
+    options->progress = nullptr;
+    options->user_data = nullptr;
+    options->time_budget_seconds = 0.0;
+}
+
+msa_engine* msa_engine_create(const msa_options* options) {
+    msa_options effective;
+    msa_options_init(&effective);
+    if (options) {
+        // Solo se copian los campos que conoce quien llama
+        size_t size = options->struct_size < sizeof(msa_options) ? options->struct_size : sizeof(msa_options);
+        if (size >= offsetof(msa_options, num_threads) + sizeof(effective.num_threads)) {
+            effective.num_threads = options->num_threads;
+        }
+        if (size >= offsetof(msa_options, user_data) + sizeof(effective.user_data)) {
+            effective.progress = options->progress;
+            effective.user_data = options->user_data;
+        }
+        if (size >= offsetof(msa_options, time_budget_seconds) + sizeof(effective.time_budget_seconds)) {
+            effective.time_budget_seconds = options->time_budget_seconds;
+        }
+    }
+
+    try {
+        MSAOptions engine_options;
+        engine_options.num_threads = effective.num_threads;
+        if (effective.progress) {
+            msa_progress_fn progress = effective.progress;
+            void* user_data = effective.user_data;
+            engine_options.progress = [progress, user_data](const std::string& stage, double fraction) {
+                progress(stage.c_str(), fraction, user_data);
+            };
+        }
+
+        engine_options.time_budget_seconds = effective.time_budget_seconds;
+
+        // El manejador se libera si el constructor del motor lanza
+        std::unique_ptr<msa_engine> handle(new msa_engine());
+        engine_options.cancel_token = &handle->cancel_token;
+        handle->engine = std::make_unique<MSAEngine>(engine_options);
+        return handle.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void msa_engine_destroy(msa_engine* engine) {
+    delete engine;
+}
+
+void msa_engine_cancel(msa_engine* engine) {
+    if (engine) {
+        engine->cancel_token.cancel();
+    }
+}
+
+void msa_engine_reset_cancel(msa_engine* engine) {
+    if (engine) {
+        engine->cancel_token.reset();
+    }
+}
+
+msa_result* msa_align(msa_engine* engine, const char* const* headers,
+                      const char* const* sequences, size_t count) {
+    if (!engine || (!sequences && count > 0)) {
+        return makeError("Argumentos invalidos");
+    }
+
+    CancelRearm rearm{engine->cancel_token};
+    try {
+        std::vector<Sequence> input;
+        input.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!sequences[i]) {
+                return makeError("Secuencia nula en la posicion " + std::to_string(i));
+            }
+            std::string header = (headers && headers[i]) ? headers[i] : "seq" + std::to_string(i + 1);
+            input.emplace_back(header, sequences[i]);
+        }
+        return makeResult(engine->engine->align(input));
+    } catch (const std::exception& e) {
+        return makeError(e.what());
+    } catch (...) {
+        return makeError("Error desconocido");
+    }
+}
+
+msa_result* msa_align_fasta(msa_engine* engine, const char* fasta_text) {
+    if (!engine || !fasta_text) {
+        return makeError("Argumentos invalidos");
+    }
+
+    CancelRearm rearm{engine->cancel_token};
+    try {
+        return makeResult(engine->engine->alignFasta(fasta_text));
+    } catch (const std::exception& e) {
+        return makeError(e.what());
+    } catch (...) {
+        return makeError("Error desconocido");
+    }
+}
+
+int msa_result_ok(const msa_result* result) {
+    return result && result->result.ok ? 1 : 0;
+}
+
+const char* msa_result_error(const msa_result* result) {
+    return result ? result->result.error.c_str() : "Resultado nulo";
+}
+
+size_t msa_result_num_rows(const msa_result* result) {
+    return result ? result->aligned_rows.size() : 0;
+}
+
+const char* msa_result_header(const msa_result* result, size_t index) {
+    if (!result || index >= result->result.rows.size()) {
+        return nullptr;
+    }
+    return result->result.rows[index].header.c_str();
+}
+
+const char* msa_result_row(const msa_result* result, size_t index) {
+    if (!result || index >= result->aligned_rows.size()) {
+        return nullptr;
+    }
+    return result->aligned_rows[index].c_str();
+}
+
+int msa_result_length(const msa_result* result) {
+    return result ? result->result.metrics.final_length : 0;
+}
+
+int msa_result_total_gaps(const msa_result* result) {
+    return result ? result->result.metrics.total_gaps : 0;
+}
+
+double msa_result_elapsed_seconds(const msa_result* result) {
+    return result ? result->result.metrics.elapsed_seconds : 0.0;
+}
+
+unsigned int msa_result_degradations(const msa_result* result) {
+    return result ? result->result.metrics.degradations : 0u;
+}
+
+int msa_result_cancelled(const msa_result* result) {
+    return result && result->result.cancelled ? 1 : 0;
+}
+
+const char* msa_result_format(msa_result* result, const char* format) {
+    if (!result || !format) {
+        return nullptr;
+    }
+
+    std::string name = format;
+    if (name != "fasta" && name != "a3m" && name != "rle") {
+        return nullptr;
+    }
+
+    try {
+        auto it = result->formatted.find(name);
+        if (it == result->formatted.end()) {
+            it = result->formatted.emplace(name, result->result.format(name)).first;
+        }
+        return it->second.c_str();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void msa_result_destroy(msa_result* result) {
+    delete result;
+}
@@ -0,0 +1,115 @@
+#ifndef MSA_C_API_H
+#define MSA_C_API_H
+
+/*
+ * Interfaz C estable del alineador para enlazar desde otros lenguajes.
+ * Los tipos son opacos y toda la memoria devuelta pertenece a la biblioteca:
+ * las cadenas de un resultado son válidas hasta msa_result_destroy.
+ * Ninguna función lanza excepciones ni escribe en consola: los avisos internos
+ * solo se entregan a la función instalada con msa_set_log_callback.
+ */
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#  ifdef MSA_BUILD_DLL
+#    define MSA_API __declspec(dllexport)
+#  else
+#    define MSA_API
+#  endif
+#else
+#  define MSA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSA_API_VERSION 4
+
+/* Degradaciones aplicadas al agotarse el presupuesto (ver msa_result_degradations) */
+#define MSA_DEGRADE_KMER_DISTANCES 0x1u
+#define MSA_DEGRADE_BANDED_DP      0x2u
+#define MSA_DEGRADE_NO_REFINEMENT  0x4u
+
+typedef struct msa_engine msa_engine;
+typedef struct msa_result msa_result;
+
+/* Función de progreso: etapa ("distances", "tree", "progressive", "rows", "done") y fracción [0, 1] */
+typedef void (*msa_progress_fn)(const char* stage, double fraction, void* user_data);
+
+/* Niveles de registro (ver msa_set_log_callback) */
+#define MSA_LOG_OFF   (-1)
+#define MSA_LOG_ERROR 0
+#define MSA_LOG_WARN  1
+#define MSA_LOG_INFO  2
+#define MSA_LOG_DEBUG 3
+
+/* Función de registro: nivel MSA_LOG_*, evento ("align.degraded", "io.warning", ...) y mensaje */
+typedef void (*msa_log_fn)(int level, const char* event, const char* message, void* user_data);
+
+/*
+ * Opciones del motor. struct_size permite agregar campos en versiones
+ * futuras sin romper binarios compilados contra esta cabecera:
+ * inicializar siempre con msa_options_init.
+ */
+typedef struct msa_options {
+    size_t struct_size;
+    unsigned int num_threads;       /* 1 = en serie, 0 = todos los núcleos */
+    msa_progress_fn progress;       /* NULL = sin notificaciones */
+    void* user_data;                /* Se pasa sin modificar a progress */
+    double time_budget_seconds;     /* Presupuesto por alineamiento, 0 = sin límite (versión 2) */
+} msa_options;
+
+/* Versión de la interfaz compilada en la biblioteca */
+MSA_API int msa_api_version(void);
+
+/* Entrega los registros hasta max_level a callback, desde un hilo de fondo de la
+   biblioteca y uno a la vez; es global para el proceso. NULL (valor por defecto)
+   descarta todos los registros (versión 3) */
+MSA_API void msa_set_log_callback(msa_log_fn callback, int max_level, void* user_data);
+
+/* Rellena las opciones con los valores por defecto */
+MSA_API void msa_options_init(msa_options* options);
+
+/* Crea un motor (NULL si falla); options puede ser NULL */
+MSA_API msa_engine* msa_engine_create(const msa_options* options);
+MSA_API void msa_engine_destroy(msa_engine* engine);
+
+/* Cancela el alineamiento en curso del motor (seguro desde otro hilo). Si llega
+   antes de que empiece una llamada a msa_align*, esa llamada vuelve cancelada;
+   cada llamada rearma la cancelación al terminar */
+MSA_API void msa_engine_cancel(msa_engine* engine);
+
+/* Descarta una cancelación pendiente que no llegó a aplicarse (versión 4) */
+MSA_API void msa_engine_reset_cancel(msa_engine* engine);
+
+/* Alinea count secuencias; headers puede ser NULL (se numeran seq1, seq2, ...) */
+MSA_API msa_result* msa_align(msa_engine* engine, const char* const* headers,
+                              const char* const* sequences, size_t count);
+
+/* Alinea secuencias recibidas como texto FASTA */
+MSA_API msa_result* msa_align_fasta(msa_engine* engine, const char* fasta_text);
+
+/* Consulta del resultado (siempre distinto de NULL salvo falta de memoria) */
+MSA_API int msa_result_ok(const msa_result* result);
+MSA_API const char* msa_result_error(const msa_result* result);
+MSA_API size_t msa_result_num_rows(const msa_result* result);
+MSA_API const char* msa_result_header(const msa_result* result, size_t index);
+MSA_API const char* msa_result_row(const msa_result* result, size_t index);
+MSA_API int msa_result_length(const msa_result* result);
+MSA_API int msa_result_total_gaps(const msa_result* result);
+MSA_API double msa_result_elapsed_seconds(const msa_result* result);
+MSA_API unsigned int msa_result_degradations(const msa_result* result);
+MSA_API int msa_result_cancelled(const msa_result* result);
+
+/* Alineamiento serializado en "fasta", "a3m" o "rle" (NULL si el formato no existe) */
+MSA_API const char* msa_result_format(msa_result* result, const char* format);
+
+MSA_API void msa_result_destroy(msa_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSA_C_API_H */
@@ -0,0 +1,199 @@
+#include "perf_counters.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* perfEventName(PerfEvent event) {
+    static const char* const names[] = {"cycles", "instructions", "cache_references",
+                                        "cache_misses", "branches", "branch_misses"};
+    int index = static_cast<int>(event);
+    return index >= 0 && index < PerfSample::EVENT_COUNT ? names[index] : "unknown";
+}
+
+void PerfSample::addDelta(const PerfSample& before, const PerfSample& after) {
+    for (int e = 0; e < EVENT_COUNT; ++e) {
+        if (!before.valid[e] || !after.valid[e]) {
+            continue;
+        }
+        values[e] += after.values[e] >= before.values[e] ? after.values[e] - before.values[e] : 0;
+        valid[e] = true;
+    }
+}
+
+PerfCounterGroup::PerfCounterGroup() : reason("contadores no abiertos") {}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    close();
+}
+
+#ifdef __linux__
+
+namespace {
+
+uint64_t hardwareConfig(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::CYCLES: return PERF_COUNT_HW_CPU_CYCLES;
+        case PerfEvent::INSTRUCTIONS: return PERF_COUNT_HW_INSTRUCTIONS;
+        case PerfEvent::CACHE_REFERENCES: return PERF_COUNT_HW_CACHE_REFERENCES;
+        case PerfEvent::CACHE_MISSES: return PERF_COUNT_HW_CACHE_MISSES;
+        case PerfEvent::BRANCHES: return PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+        case PerfEvent::BRANCH_MISSES: return PERF_COUNT_HW_BRANCH_MISSES;
+        default: return PERF_COUNT_HW_MAX;
+    }
+}
+
+int openEvent(PerfEvent event, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = hardwareConfig(event);
+    attr.disabled = group_fd == -1 ? 1 : 0;     // El líder arranca el grupo completo
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Hilo actual en cualquier CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+} // namespace
+
+bool PerfCounterGroup::open() {
+    if (available()) {
+        return true;
+    }
+
+    int last_error = 0;
+    for (int e = 0; e < PerfSample::EVENT_COUNT; ++e) {
+        PerfEvent event = static_cast<PerfEvent>(e);
+        int fd = openEvent(event, fds.empty() ? -1 : fds[0]);
+        if (fd < 0) {
+            last_error = errno;
+            continue;
+        }
+        fds.push_back(fd);
+        events.push_back(event);
+    }
+
+    if (fds.empty()) {
+        reason = std::string("perf_event_open: ") + std::strerror(last_error);
+        if (last_error == EACCES || last_error == EPERM) {
+            reason += " (revisar /proc/sys/kernel/perf_event_paranoid)";
+        }
+        return false;
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    if (ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0) {
+        reason = std::string("PERF_EVENT_IOC_ENABLE: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+    reason.clear();
+    return true;
+}
+
+void PerfCounterGroup::close() {
+    for (auto it = fds.rbegin(); it != fds.rend(); ++it) {
+        ::close(*it);
+    }
+    fds.clear();
+    events.clear();
+}
+
+bool PerfCounterGroup::read(PerfSample& sample) const {
+    sample = PerfSample();
+    if (fds.empty()) {
+        return false;
+    }
+
+    // Formato de grupo: nr, tiempo habilitado, tiempo en ejecución, un valor por evento
+    // Sin reservas: se lee dentro de los cambios de fase que cuenta el hook de memoria
+    uint64_t buffer[3 + PerfSample::EVENT_COUNT];
+    ssize_t expected = static_cast<ssize_t>((3 + fds.size()) * sizeof(uint64_t));
+    if (::read(fds[0], buffer, expected) != expected || buffer[0] != fds.size()) {
+        return false;
+    }
+
+    uint64_t enabled = buffer[1];
+    uint64_t running = buffer[2];
+    double scale = running > 0 && running < enabled ? static_cast<double>(enabled) / running : 1.0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        int index = static_cast<int>(events[i]);
+        sample.values[index] = static_cast<uint64_t>(buffer[3 + i] * scale);
+        sample.valid[index] = running > 0;
+    }
+    return true;
+}
+
+#else
+
+bool PerfCounterGroup::open() {
+    reason = "perf_event_open solo existe en Linux";
+    return false;
+}
+
+void PerfCounterGroup::close() {
+    fds.clear();
+    events.clear();
+}
+
+bool PerfCounterGroup::read(PerfSample& sample) const {
+    sample = PerfSample();
+    return false;
+}
+
+#endif
+
+PhasePerfRecorder* PhasePerfRecorder::active = nullptr;
+
+PhasePerfRecorder::PhasePerfRecorder(PerfCounterGroup& group)
+    : group(group), phases(MemoryAccounting::PHASE_COUNT), running(false) {}
+
+PhasePerfRecorder::~PhasePerfRecorder() {
+    if (running) {
+        stop();
+    }
+}
+
+void PhasePerfRecorder::start() {
+    phases.assign(MemoryAccounting::PHASE_COUNT, PerfSample());
+    if (!group.available() || active || !group.read(last)) {
+        return;
+    }
+    running = true;
+    active = this;
+    MemoryAccounting::setPhaseListener(&PhasePerfRecorder::onPhaseChange);
+}
+
+std::vector<PerfSample> PhasePerfRecorder::stop() {
+    if (running) {
+        attribute(MemoryAccounting::phase());
+        MemoryAccounting::setPhaseListener(nullptr);
+        active = nullptr;
+        running = false;
+    }
+    return phases;
+}
+
+void PhasePerfRecorder::attribute(MemoryPhase phase) {
+    PerfSample now;
+    if (!group.read(now)) {
+        return;
+    }
+    phases[static_cast<int>(phase)].addDelta(last, now);
+    last = now;
+}
+
+void PhasePerfRecorder::onPhaseChange(MemoryPhase previous, MemoryPhase next) {
+    (void)next;
+    if (active) {
+        active->attribute(previous);
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include "memory_accounting.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Eventos de hardware leídos en cada grupo
+ */
+enum class PerfEvent : int {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    CACHE_REFERENCES,
+    CACHE_MISSES,
+    BRANCHES,
+    BRANCH_MISSES,
+    COUNT
+};
+
+/**
+ * Nombre de un evento ("cycles", "instructions", ...)
+ */
+const char* perfEventName(PerfEvent event);
+
+/**
+ * Valores de los contadores (acumulados o diferencia entre dos lecturas).
+ * Un evento que el procesador o el kernel no ofrecen queda marcado como no válido
+ */
+struct PerfSample {
+    static const int EVENT_COUNT = static_cast<int>(PerfEvent::COUNT);
+
+    uint64_t values[EVENT_COUNT];
+    bool valid[EVENT_COUNT];
+
+    PerfSample() {
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            values[e] = 0;
+            valid[e] = false;
+        }
+    }
+
+    uint64_t value(PerfEvent event) const { return values[static_cast<int>(event)]; }
+    bool has(PerfEvent event) const { return valid[static_cast<int>(event)]; }
+
+    /**
+     * Instrucciones por ciclo (-1 si falta alguno de los dos contadores)
+     */
+    double ipc() const { return ratio(PerfEvent::INSTRUCTIONS, PerfEvent::CYCLES); }
+
+    /**
+     * Fracción de referencias a caché que fallaron (-1 si no hay contadores)
+     */
+    double cacheMissRate() const { return ratio(PerfEvent::CACHE_MISSES, PerfEvent::CACHE_REFERENCES); }
+
+    /**
+     * Fracción de saltos mal predichos (-1 si no hay contadores)
+     */
+    double branchMissRate() const { return ratio(PerfEvent::BRANCH_MISSES, PerfEvent::BRANCHES); }
+
+    /**
+     * Suma a esta muestra la diferencia entre dos lecturas acumuladas
+     */
+    void addDelta(const PerfSample& before, const PerfSample& after);
+
+private:
+    double ratio(PerfEvent numerator, PerfEvent denominator) const {
+        if (!has(numerator) || !has(denominator) || value(denominator) == 0) {
+            return -1.0;
+        }
+        return static_cast<double>(value(numerator)) / value(denominator);
+    }
+};
+
+/**
+ * Grupo de contadores de hardware del hilo actual (perf_event_open en Linux).
+ *
+ * Se abren los eventos de PerfEvent en un solo grupo para que el kernel los
+ * programe juntos; los que no existan se omiten. Solo se cuenta espacio de
+ * usuario, lo que basta con perf_event_paranoid <= 2. Si no se puede abrir
+ * ninguno (contenedores, máquinas virtuales sin PMU, otro sistema operativo)
+ * available() devuelve false y unavailableReason() explica por qué.
+ */
+class PerfCounterGroup {
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    /**
+     * Abre y activa el grupo (sin efecto si ya está abierto)
+     * @return true si al menos un contador quedó activo
+     */
+    bool open();
+
+    /**
+     * Cierra los contadores
+     */
+    void close();
+
+    bool available() const { return !fds.empty(); }
+    const std::string& unavailableReason() const { return reason; }
+
+    /**
+     * Lee los valores acumulados, escalados si el kernel multiplexó el grupo
+     * @return false si la lectura falló
+     */
+    bool read(PerfSample& sample) const;
+
+private:
+    std::vector<int> fds;              // fds[0] es el líder del grupo
+    std::vector<PerfEvent> events;     // Evento de cada descriptor
+    std::string reason;
+};
+
+/**
+ * Reparte las lecturas de un grupo entre las fases del alineamiento: en cada
+ * cambio de fase (MemoryAccounting) atribuye lo contado desde la lectura
+ * anterior a la fase que termina. Solo puede haber un registrador activo.
+ */
+class PhasePerfRecorder {
+public:
+    /**
+     * Constructor
+     * @param group Grupo ya abierto (si no está disponible el registrador no hace nada)
+     */
+    explicit PhasePerfRecorder(PerfCounterGroup& group);
+    ~PhasePerfRecorder();
+
+    PhasePerfRecorder(const PhasePerfRecorder&) = delete;
+    PhasePerfRecorder& operator=(const PhasePerfRecorder&) = delete;
+
+    /**
+     * Empieza a registrar desde la fase en curso
+     */
+    void start();
+
+    /**
+     * Deja de registrar
+     * @return Contadores por fase, indexados por MemoryPhase
+     */
+    std::vector<PerfSample> stop();
+
+private:
+    PerfCounterGroup& group;
+    PerfSample last;
+    std::vector<PerfSample> phases;
+    bool running;
+
+    void attribute(MemoryPhase phase);
+    static void onPhaseChange(MemoryPhase previous, MemoryPhase next);
+    static PhasePerfRecorder* active;
+};
+
+#endif // PERF_COUNTERS_H
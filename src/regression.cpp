@@ -0,0 +1,779 @@
+#include "regression.h"
+#include "benchmark.h"
+#include "json_util.h"
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+namespace {
+
+// Métricas de la puerta: tiempo total del alineamiento y sus etapas y subetapas
+struct RegressionMetric {
+    const char* name;
+    double AlignmentTimings::*field;   // nullptr = execution_time_ms del resultado
+};
+
+const RegressionMetric REGRESSION_METRICS[] = {
+    {"total", nullptr},
+    {"distances", &AlignmentTimings::distances_ms},
+    {"tree", &AlignmentTimings::tree_ms},
+    {"progressive", &AlignmentTimings::progressive_ms},
+    {"rows", &AlignmentTimings::rows_ms},
+    {"dp_fill", &AlignmentTimings::dp_fill_ms},
+    {"traceback", &AlignmentTimings::traceback_ms},
+    {"consensus", &AlignmentTimings::consensus_ms},
+    {"profile_merge", &AlignmentTimings::profile_merge_ms},
+};
+
+// Extensiones que cambian el rendimiento de los kernels; el resto de flags no se guarda
+const char* const SIMD_FLAGS[] = {
+    "sse2", "ssse3", "sse4_1", "sse4_2", "popcnt", "avx", "avx2", "fma", "bmi2",
+    "avx512f", "avx512bw", "avx512vl", "neon", "asimd", "sve", "sve2"
+};
+
+const int FORMAT_VERSION = 1;
+
+/**
+ * Valor JSON mínimo para leer líneas base (objetos, arreglos, cadenas, números, literales)
+ */
+struct JsonValue {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* get(const std::string& key) const {
+        for (const auto& member : members) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    double numberAt(const std::string& key, double fallback = 0.0) const {
+        const JsonValue* value = get(key);
+        return value && value->type == NUMBER ? value->number : fallback;
+    }
+
+    std::string stringAt(const std::string& key) const {
+        const JsonValue* value = get(key);
+        return value && value->type == STRING ? value->text : "";
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : text(text), pos(0) {}
+
+    bool parse(JsonValue& value) {
+        if (!parseValue(value)) {
+            return false;
+        }
+        skipSpace();
+        return pos == text.size();
+    }
+
+private:
+    const std::string& text;
+    size_t pos;
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+    }
+
+    bool literal(const char* word) {
+        size_t length = std::char_traits<char>::length(word);
+        if (text.compare(pos, length, word) != 0) {
+            return false;
+        }
+        pos += length;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (pos >= text.size() || text[pos] != '"') {
+            return false;
+        }
+        ++pos;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos >= text.size()) {
+                return false;
+            }
+            char escape = text[pos++];
+            switch (escape) {
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case 'r': out.push_back('\r'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    // Solo se escriben escapes de control (< 0x80)
+                    if (pos + 4 > text.size()) {
+                        return false;
+                    }
+                    out.push_back(static_cast<char>(std::stoi(text.substr(pos, 4), nullptr, 16)));
+                    pos += 4;
+                    break;
+                }
+                default: out.push_back(escape); break;
+            }
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        ++pos;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value) {
+        skipSpace();
+        if (pos >= text.size()) {
+            return false;
+        }
+        char c = text[pos];
+        if (c == '{') {
+            value.type = JsonValue::OBJECT;
+            ++pos;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                return true;
+            }
+            while (true) {
+                skipSpace();
+                std::string key;
+                if (!parseString(key)) {
+                    return false;
+                }
+                skipSpace();
+                if (pos >= text.size() || text[pos++] != ':') {
+                    return false;
+                }
+                value.members.emplace_back(key, JsonValue());
+                if (!parseValue(value.members.back().second)) {
+                    return false;
+                }
+                skipSpace();
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                    continue;
+                }
+                return pos < text.size() && text[pos++] == '}';
+            }
+        }
+        if (c == '[') {
+            value.type = JsonValue::ARRAY;
+            ++pos;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']') {
+                ++pos;
+                return true;
+            }
+            while (true) {
+                value.items.emplace_back();
+                if (!parseValue(value.items.back())) {
+                    return false;
+                }
+                skipSpace();
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                    continue;
+                }
+                return pos < text.size() && text[pos++] == ']';
+            }
+        }
+        if (c == '"') {
+            value.type = JsonValue::STRING;
+            return parseString(value.text);
+        }
+        if (literal("true")) {
+            value.type = JsonValue::BOOL;
+            value.boolean = true;
+            return true;
+        }
+        if (literal("false")) {
+            value.type = JsonValue::BOOL;
+            return true;
+        }
+        if (literal("null")) {
+            value.type = JsonValue::NUL;
+            return true;
+        }
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        value.number = std::strtod(start, &end);
+        if (end == start) {
+            return false;
+        }
+        value.type = JsonValue::NUMBER;
+        pos += static_cast<size_t>(end - start);
+        return true;
+    }
+};
+
+// P(Bin(n, 1/2) <= k)
+double binomialHalfCdf(int n, int k) {
+    double total = 0.0;
+    double term = std::pow(0.5, n);   // C(n, 0) / 2^n
+    for (int i = 0; i <= k; ++i) {
+        total += term;
+        term = term * (n - i) / (i + 1);
+    }
+    return total;
+}
+
+// Distribución exacta de U (sin empates): conteos de cada valor para tamaños n1, n2
+std::vector<double> mannWhitneyCounts(int n1, int n2) {
+    // counts[i][j][u]: formas de obtener U = u con i elementos de la primera muestra y j de la segunda
+    std::vector<std::vector<std::vector<double>>> counts(
+        n1 + 1, std::vector<std::vector<double>>(n2 + 1));
+    for (int i = 0; i <= n1; ++i) {
+        for (int j = 0; j <= n2; ++j) {
+            counts[i][j].assign(static_cast<size_t>(i) * j + 1, 0.0);
+            if (i == 0 || j == 0) {
+                counts[i][j][0] = 1.0;
+                continue;
+            }
+            // El mayor de todos es de la primera muestra (supera a los j de la segunda) o de la segunda
+            for (int u = 0; u <= i * j; ++u) {
+                double from_first = u >= j && u - j <= (i - 1) * j ? counts[i - 1][j][u - j] : 0.0;
+                double from_second = u <= i * (j - 1) ? counts[i][j - 1][u] : 0.0;
+                counts[i][j][u] = from_first + from_second;
+            }
+        }
+    }
+    return counts[n1][n2];
+}
+
+const size_t EXACT_LIMIT = 25;   // Tamaño máximo de cada muestra para la distribución exacta
+
+std::string currentTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    return buffer;
+}
+
+void writeSummary(std::ostream& json, const MetricSummary& metric) {
+    json << jsonString(metric.name) << ": {\"median\": " << metric.median
+         << ", \"ci_low\": " << metric.ci_low << ", \"ci_high\": " << metric.ci_high
+         << ", \"ci_coverage\": " << metric.ci_coverage << ", \"samples\": [";
+    for (size_t s = 0; s < metric.samples.size(); ++s) {
+        json << (s > 0 ? ", " : "") << metric.samples[s];
+    }
+    json << "]}";
+}
+
+} // namespace
+
+const char* regressionVerdictName(RegressionVerdict verdict) {
+    switch (verdict) {
+        case RegressionVerdict::REGRESSION: return "regression";
+        case RegressionVerdict::IMPROVEMENT: return "improvement";
+        default: return "unchanged";
+    }
+}
+
+MachineInfo MachineInfo::detect(int threads, bool arena) {
+    MachineInfo info;
+    info.threads = threads;
+    info.arena = arena;
+    info.hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+
+#if defined(__linux__)
+    info.os = "linux";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    std::string flags;
+    while (std::getline(cpuinfo, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+        std::string value = colon + 2 <= line.size() ? line.substr(colon + 2) : "";
+        if (info.cpu_model.empty() && (key == "model name" || key == "Hardware" || key == "cpu model")) {
+            info.cpu_model = value;
+        } else if (flags.empty() && (key == "flags" || key == "Features")) {
+            flags = " " + value + " ";
+        }
+    }
+    for (const char* flag : SIMD_FLAGS) {
+        if (flags.find(std::string(" ") + flag + " ") != std::string::npos) {
+            info.cpu_flags.push_back(flag);
+        }
+    }
+#elif defined(__APPLE__)
+    info.os = "macos";
+    char brand[256];
+    size_t size = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0) {
+        info.cpu_model = brand;
+    }
+#elif defined(_WIN32)
+    info.os = "windows";
+#endif
+    if (info.cpu_model.empty()) {
+        info.cpu_model = "desconocido";
+    }
+
+#if defined(__clang__)
+    info.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    info.compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    info.compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+    info.compiler = "desconocido";
+#endif
+
+    std::vector<std::string> build;
+#ifdef __OPTIMIZE__
+    build.push_back("optimize");
+#else
+    build.push_back("no-optimize");
+#endif
+#ifdef NDEBUG
+    build.push_back("NDEBUG");
+#endif
+#ifdef __SSE4_2__
+    build.push_back("sse4_2");
+#endif
+#ifdef __AVX2__
+    build.push_back("avx2");
+#endif
+#ifdef __AVX512F__
+    build.push_back("avx512f");
+#endif
+#ifdef __ARM_NEON
+    build.push_back("neon");
+#endif
+    for (size_t b = 0; b < build.size(); ++b) {
+        info.build_flags += (b > 0 ? " " : "") + build[b];
+    }
+    return info;
+}
+
+const MetricSummary* DatasetBaseline::metric(const std::string& name) const {
+    for (const auto& entry : metrics) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const DatasetBaseline* RegressionBaseline::dataset(const std::string& name) const {
+    for (const auto& entry : datasets) {
+        if (entry.dataset == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+RegressionGate::RegressionGate(const RegressionOptions& options) : options(options) {}
+
+MetricSummary RegressionGate::summarize(const std::string& name, const std::vector<double>& samples,
+                                        double confidence) {
+    MetricSummary summary;
+    summary.name = name;
+    summary.samples = samples;
+    if (samples.empty()) {
+        return summary;
+    }
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    int n = static_cast<int>(sorted.size());
+    summary.median = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+
+    // [x_(j+1), x_(n-j)] cubre la mediana con probabilidad 1 - 2 P(Bin(n, 1/2) <= j):
+    // se toma el j más grande que aún alcanza la confianza pedida
+    int j = 0;
+    while (j + 1 < n - 1 - j && 1.0 - 2.0 * binomialHalfCdf(n, j + 1) >= confidence) {
+        ++j;
+    }
+    summary.ci_low = sorted[j];
+    summary.ci_high = sorted[n - 1 - j];
+    summary.ci_coverage = n > 1 ? 1.0 - 2.0 * binomialHalfCdf(n, j) : 0.0;
+    return summary;
+}
+
+double RegressionGate::mannWhitneyPValue(const std::vector<double>& a, const std::vector<double>& b) {
+    size_t n1 = a.size();
+    size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1.0;
+    }
+
+    // Rangos medios de la muestra combinada
+    std::vector<std::pair<double, int>> pooled;
+    for (double value : a) {
+        pooled.emplace_back(value, 0);
+    }
+    for (double value : b) {
+        pooled.emplace_back(value, 1);
+    }
+    std::sort(pooled.begin(), pooled.end());
+    size_t total = pooled.size();
+    double rank_sum = 0.0;
+    double tie_term = 0.0;
+    for (size_t i = 0; i < total;) {
+        size_t k = i;
+        while (k < total && pooled[k].first == pooled[i].first) {
+            ++k;
+        }
+        double rank = (i + 1 + k) / 2.0;
+        for (size_t t = i; t < k; ++t) {
+            if (pooled[t].second == 0) {
+                rank_sum += rank;
+            }
+        }
+        double ties = static_cast<double>(k - i);
+        tie_term += ties * ties * ties - ties;
+        i = k;
+    }
+    double u = rank_sum - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+
+    if (tie_term == 0.0 && n1 <= EXACT_LIMIT && n2 <= EXACT_LIMIT) {
+        std::vector<double> counts = mannWhitneyCounts(static_cast<int>(n1), static_cast<int>(n2));
+        double all = 0.0;
+        for (double count : counts) {
+            all += count;
+        }
+        size_t observed = static_cast<size_t>(std::llround(u));
+        double lower = 0.0;
+        for (size_t v = 0; v <= observed; ++v) {
+            lower += counts[v];
+        }
+        double upper = 0.0;
+        for (size_t v = observed; v < counts.size(); ++v) {
+            upper += counts[v];
+        }
+        return std::min(1.0, 2.0 * std::min(lower, upper) / all);
+    }
+
+    double variance = n1 * n2 / 12.0 * ((total + 1) - tie_term / (static_cast<double>(total) * (total - 1)));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+    double z = std::max(0.0, std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::min(1.0, std::erfc(z / std::sqrt(2.0)));
+}
+
+RegressionBaseline RegressionGate::measure(Benchmark& benchmark, const std::vector<std::string>& datasets) const {
+    RegressionBaseline baseline;
+    baseline.created = currentTimestamp();
+    baseline.repetitions = std::max(1, options.repetitions);
+    baseline.warmup = std::max(0, options.warmup);
+    baseline.confidence = options.confidence;
+    baseline.machine = MachineInfo::detect(options.threads, options.arena);
+
+    for (const auto& path : datasets) {
+        std::vector<Sequence> sequences = FastaIO::readFasta(path);
+        if (sequences.empty()) {
+            LOG_ERROR("compare.error") << "Error: No se pudieron leer las secuencias de " << path;
+            return RegressionBaseline();
+        }
+
+        DatasetBaseline entry;
+        entry.dataset = path;
+        entry.num_sequences = static_cast<int>(sequences.size());
+
+        // Calentamiento: cachés, workspace DP de los hilos y arena
+        for (int w = 0; w < baseline.warmup; ++w) {
+            LOG_INFO("compare") << "Calentamiento " << (w + 1) << "/" << baseline.warmup << ": " << path;
+            benchmark.runSequenceBenchmark(sequences, path);
+        }
+
+        std::vector<std::vector<double>> samples(sizeof(REGRESSION_METRICS) / sizeof(REGRESSION_METRICS[0]));
+        for (int r = 0; r < baseline.repetitions; ++r) {
+            LOG_INFO("compare") << "Repeticion " << (r + 1) << "/" << baseline.repetitions << ": " << path;
+            BenchmarkResult result = benchmark.runSequenceBenchmark(sequences, path);
+            if (result.final_length == 0) {
+                LOG_ERROR("compare.error") << "Error: Fallo el alineamiento de " << path;
+                return RegressionBaseline();
+            }
+            entry.avg_length = result.original_avg_length;
+            for (size_t m = 0; m < samples.size(); ++m) {
+                const RegressionMetric& metric = REGRESSION_METRICS[m];
+                samples[m].push_back(metric.field ? result.timings.*metric.field : result.execution_time_ms);
+            }
+        }
+
+        for (size_t m = 0; m < samples.size(); ++m) {
+            entry.metrics.push_back(summarize(REGRESSION_METRICS[m].name, samples[m], options.confidence));
+        }
+        baseline.datasets.push_back(entry);
+    }
+    return baseline;
+}
+
+std::vector<MetricComparison> RegressionGate::compare(const RegressionBaseline& baseline,
+                                                      const RegressionBaseline& current) const {
+    const MachineInfo& before = baseline.machine;
+    const MachineInfo& now = current.machine;
+    if (before.cpu_model != now.cpu_model || before.compiler != now.compiler ||
+        before.build_flags != now.build_flags || before.threads != now.threads || before.arena != now.arena) {
+        LOG_WARN("compare").field("baseline_cpu", before.cpu_model).field("current_cpu", now.cpu_model)
+            << "Advertencia: La linea base se midio con otra maquina o configuracion ("
+            << before.cpu_model << ", " << before.compiler << ", " << before.threads << " hilos); "
+            << "los tiempos pueden no ser comparables";
+    }
+
+    std::vector<MetricComparison> comparisons;
+    for (const auto& entry : current.datasets) {
+        const DatasetBaseline* reference = baseline.dataset(entry.dataset);
+        if (!reference) {
+            LOG_WARN("compare").field("dataset", entry.dataset)
+                << "Advertencia: " << entry.dataset << " no esta en la linea base (se ignora)";
+            continue;
+        }
+        for (const auto& metric : entry.metrics) {
+            const MetricSummary* old_metric = reference->metric(metric.name);
+            if (!old_metric) {
+                continue;
+            }
+            MetricComparison comparison;
+            comparison.dataset = entry.dataset;
+            comparison.metric = metric.name;
+            comparison.baseline_median = old_metric->median;
+            comparison.current_median = metric.median;
+            comparison.relative_change = old_metric->median > 0.0
+                ? (metric.median - old_metric->median) / old_metric->median : 0.0;
+            comparison.p_value = mannWhitneyPValue(old_metric->samples, metric.samples);
+            comparisons.push_back(comparison);
+        }
+    }
+
+    // Holm: todas las métricas de todos los datasets forman una familia
+    std::vector<size_t> order(comparisons.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return comparisons[x].p_value < comparisons[y].p_value;
+    });
+    double running = 0.0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        MetricComparison& comparison = comparisons[order[k]];
+        running = std::max(running, std::min(1.0, (order.size() - k) * comparison.p_value));
+        comparison.adjusted_p = running;
+    }
+
+    double alpha = 1.0 - options.confidence;
+    for (auto& comparison : comparisons) {
+        double delta = comparison.current_median - comparison.baseline_median;
+        if (comparison.adjusted_p < alpha && std::fabs(comparison.relative_change) >= options.min_change &&
+            std::fabs(delta) >= options.min_delta_ms) {
+            comparison.verdict = delta > 0.0 ? RegressionVerdict::REGRESSION : RegressionVerdict::IMPROVEMENT;
+        }
+    }
+    return comparisons;
+}
+
+int RegressionGate::printComparison(const std::vector<MetricComparison>& comparisons) const {
+    std::ostringstream header;
+    header << std::left << std::setw(30) << "Dataset" << std::setw(15) << "Metrica"
+           << std::right << std::setw(12) << "Base ms" << std::setw(12) << "Actual ms"
+           << std::setw(10) << "Cambio" << std::setw(11) << "p (Holm)" << "  Veredicto";
+    LOG_INFO("compare") << header.str();
+    LOG_INFO("compare") << std::string(header.str().size(), '-');
+
+    int regressions = 0;
+    for (const auto& comparison : comparisons) {
+        std::string name = comparison.dataset;
+        size_t slash = name.find_last_of("/\\");
+        if (slash != std::string::npos) {
+            name = name.substr(slash + 1);
+        }
+        if (name.size() > 29) {
+            name = name.substr(0, 26) + "...";
+        }
+        std::ostringstream line;
+        line << std::left << std::setw(30) << name << std::setw(15) << comparison.metric
+             << std::right << std::fixed << std::setprecision(3)
+             << std::setw(12) << comparison.baseline_median << std::setw(12) << comparison.current_median
+             << std::setw(9) << std::setprecision(1) << comparison.relative_change * 100.0 << "%"
+             << std::setw(11) << std::setprecision(4) << comparison.adjusted_p
+             << "  " << regressionVerdictName(comparison.verdict);
+        if (comparison.verdict == RegressionVerdict::REGRESSION) {
+            ++regressions;
+            LOG_WARN("compare").field("dataset", comparison.dataset).field("metric", comparison.metric)
+                               .field("change", comparison.relative_change).field("p", comparison.adjusted_p)
+                << line.str();
+        } else {
+            LOG_INFO("compare") << line.str();
+        }
+    }
+
+    LOG_INFO("compare").field("regressions", regressions)
+        << "Regresiones significativas: " << regressions << " de " << comparisons.size() << " metricas";
+    return regressions;
+}
+
+void RegressionGate::exportComparison(const std::vector<MetricComparison>& comparisons,
+                                      const std::string& csv_file) const {
+    std::ofstream file(csv_file);
+
+    if (!file.is_open()) {
+        LOG_ERROR("compare.error") << "Error: No se pudo crear el archivo CSV " << csv_file;
+        return;
+    }
+
+    file << "Dataset,Metric,BaselineMedianMs,CurrentMedianMs,RelativeChange,PValue,HolmPValue,Verdict\n";
+    for (const auto& comparison : comparisons) {
+        file << comparison.dataset << "," << comparison.metric << "," << comparison.baseline_median << ","
+             << comparison.current_median << "," << comparison.relative_change << "," << comparison.p_value << ","
+             << comparison.adjusted_p << "," << regressionVerdictName(comparison.verdict) << "\n";
+    }
+
+    LOG_INFO("compare") << "Comparacion exportada a CSV: " << csv_file;
+}
+
+bool RegressionGate::saveBaseline(const RegressionBaseline& baseline, const std::string& json_file) {
+    std::ofstream json(json_file);
+
+    if (!json.is_open()) {
+        LOG_ERROR("compare.error") << "Error: No se pudo crear el archivo JSON " << json_file;
+        return false;
+    }
+
+    const MachineInfo& machine = baseline.machine;
+    json << std::setprecision(10);
+    json << "{\n  \"format\": \"msa-benchmark-baseline\",\n  \"version\": " << FORMAT_VERSION << ",\n"
+         << "  \"created\": " << jsonString(baseline.created) << ",\n"
+         << "  \"repetitions\": " << baseline.repetitions << ",\n"
+         << "  \"warmup\": " << baseline.warmup << ",\n"
+         << "  \"confidence\": " << baseline.confidence << ",\n"
+         << "  \"machine\": {\n"
+         << "    \"cpu_model\": " << jsonString(machine.cpu_model) << ",\n"
+         << "    \"cpu_flags\": [";
+    for (size_t f = 0; f < machine.cpu_flags.size(); ++f) {
+        json << (f > 0 ? ", " : "") << jsonString(machine.cpu_flags[f]);
+    }
+    json << "],\n"
+         << "    \"compiler\": " << jsonString(machine.compiler) << ",\n"
+         << "    \"build_flags\": " << jsonString(machine.build_flags) << ",\n"
+         << "    \"os\": " << jsonString(machine.os) << ",\n"
+         << "    \"hardware_threads\": " << machine.hardware_threads << ",\n"
+         << "    \"threads\": " << machine.threads << ",\n"
+         << "    \"arena\": " << (machine.arena ? "true" : "false") << "\n"
+         << "  },\n"
+         << "  \"datasets\": [";
+    for (size_t d = 0; d < baseline.datasets.size(); ++d) {
+        const DatasetBaseline& entry = baseline.datasets[d];
+        json << (d > 0 ? "," : "") << "\n    {\n"
+             << "      \"dataset\": " << jsonString(entry.dataset) << ",\n"
+             << "      \"num_sequences\": " << entry.num_sequences << ",\n"
+             << "      \"avg_length\": " << entry.avg_length << ",\n"
+             << "      \"metrics\": {";
+        for (size_t m = 0; m < entry.metrics.size(); ++m) {
+            json << (m > 0 ? "," : "") << "\n        ";
+            writeSummary(json, entry.metrics[m]);
+        }
+        json << "\n      }\n    }";
+    }
+    json << "\n  ]\n}\n";
+
+    LOG_INFO("compare") << "Linea base guardada en " << json_file;
+    return true;
+}
+
+bool RegressionGate::loadBaseline(const std::string& json_file, RegressionBaseline& baseline) {
+    std::ifstream file(json_file);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    JsonValue root;
+    JsonReader reader(text);
+    if (!reader.parse(root) || root.type != JsonValue::OBJECT ||
+        root.stringAt("format") != "msa-benchmark-baseline") {
+        LOG_ERROR("compare.error") << "Error: " << json_file << " no es una linea base de benchmarks";
+        return false;
+    }
+    if (static_cast<int>(root.numberAt("version")) != FORMAT_VERSION) {
+        LOG_ERROR("compare.error") << "Error: Version de linea base no soportada en " << json_file;
+        return false;
+    }
+
+    baseline = RegressionBaseline();
+    baseline.created = root.stringAt("created");
+    baseline.repetitions = static_cast<int>(root.numberAt("repetitions"));
+    baseline.warmup = static_cast<int>(root.numberAt("warmup"));
+    baseline.confidence = root.numberAt("confidence", 0.95);
+
+    if (const JsonValue* machine = root.get("machine")) {
+        baseline.machine.cpu_model = machine->stringAt("cpu_model");
+        baseline.machine.compiler = machine->stringAt("compiler");
+        baseline.machine.build_flags = machine->stringAt("build_flags");
+        baseline.machine.os = machine->stringAt("os");
+        baseline.machine.hardware_threads = static_cast<int>(machine->numberAt("hardware_threads"));
+        baseline.machine.threads = static_cast<int>(machine->numberAt("threads", 1));
+        const JsonValue* arena = machine->get("arena");
+        baseline.machine.arena = !arena || arena->type != JsonValue::BOOL || arena->boolean;
+        if (const JsonValue* flags = machine->get("cpu_flags")) {
+            for (const auto& flag : flags->items) {
+                baseline.machine.cpu_flags.push_back(flag.text);
+            }
+        }
+    }
+
+    const JsonValue* datasets = root.get("datasets");
+    if (!datasets || datasets->type != JsonValue::ARRAY) {
+        LOG_ERROR("compare.error") << "Error: " << json_file << " no contiene datasets";
+        return false;
+    }
+    for (const auto& item : datasets->items) {
+        DatasetBaseline entry;
+        entry.dataset = item.stringAt("dataset");
+        entry.num_sequences = static_cast<int>(item.numberAt("num_sequences"));
+        entry.avg_length = static_cast<int>(item.numberAt("avg_length"));
+        if (const JsonValue* metrics = item.get("metrics")) {
+            for (const auto& member : metrics->members) {
+                MetricSummary metric;
+                metric.name = member.first;
+                metric.median = member.second.numberAt("median");
+                metric.ci_low = member.second.numberAt("ci_low");
+                metric.ci_high = member.second.numberAt("ci_high");
+                metric.ci_coverage = member.second.numberAt("ci_coverage");
+                if (const JsonValue* samples = member.second.get("samples")) {
+                    for (const auto& sample : samples->items) {
+                        metric.samples.push_back(sample.number);
+                    }
+                }
+                entry.metrics.push_back(metric);
+            }
+        }
+        baseline.datasets.push_back(entry);
+    }
+    return true;
+}
@@ -0,0 +1,185 @@
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include <string>
+#include <vector>
+
+class Benchmark;
+
+/**
+ * Máquina y compilación con las que se midió una línea base
+ */
+struct MachineInfo {
+    std::string cpu_model;
+    std::vector<std::string> cpu_flags;    // Extensiones SIMD relevantes que anuncia la CPU
+    std::string compiler;
+    std::string build_flags;               // Optimización, NDEBUG y SIMD habilitado al compilar
+    std::string os;
+    int hardware_threads;
+    int threads;                           // Hilos con los que alineó el benchmark
+    bool arena;                            // Arena por alineamiento activada
+
+    MachineInfo() : hardware_threads(0), threads(1), arena(true) {}
+
+    /**
+     * Datos de la máquina actual
+     * @param threads Hilos del benchmark
+     * @param arena Si el benchmark usa la arena
+     */
+    static MachineInfo detect(int threads, bool arena);
+};
+
+/**
+ * Muestras de una métrica con su mediana e intervalo de confianza
+ */
+struct MetricSummary {
+    std::string name;              // "total", "distances", ..., "profile_merge"
+    std::vector<double> samples;   // Milisegundos de cada repetición
+    double median;
+    double ci_low;                 // Intervalo de la mediana por estadísticos de orden
+    double ci_high;
+    double ci_coverage;            // Cobertura real del intervalo (discreta; puede quedar bajo la pedida con pocas muestras)
+
+    MetricSummary() : median(0.0), ci_low(0.0), ci_high(0.0), ci_coverage(0.0) {}
+};
+
+/**
+ * Mediciones de un dataset
+ */
+struct DatasetBaseline {
+    std::string dataset;
+    int num_sequences;
+    int avg_length;
+    std::vector<MetricSummary> metrics;
+
+    DatasetBaseline() : num_sequences(0), avg_length(0) {}
+
+    const MetricSummary* metric(const std::string& name) const;
+};
+
+/**
+ * Línea base completa (lo que se guarda en JSON)
+ */
+struct RegressionBaseline {
+    std::string created;
+    int repetitions;
+    int warmup;
+    double confidence;
+    MachineInfo machine;
+    std::vector<DatasetBaseline> datasets;
+
+    RegressionBaseline() : repetitions(0), warmup(0), confidence(0.95) {}
+
+    const DatasetBaseline* dataset(const std::string& name) const;
+};
+
+/**
+ * Parámetros de la medición y del criterio de regresión
+ */
+struct RegressionOptions {
+    int repetitions;               // Ejecuciones medidas por dataset
+    int warmup;                    // Ejecuciones descartadas antes de medir
+    double confidence;             // Nivel de los intervalos y de la prueba (alfa = 1 - confidence)
+    double min_change;             // Cambio relativo mínimo de la mediana para reportar (0.05 = 5%)
+    double min_delta_ms;           // Cambio absoluto mínimo: debajo de esto se considera ruido
+    int threads;
+    bool arena;
+
+    RegressionOptions() : repetitions(10), warmup(2), confidence(0.95), min_change(0.05),
+                          min_delta_ms(0.1), threads(1), arena(true) {}
+};
+
+enum class RegressionVerdict {
+    UNCHANGED,
+    REGRESSION,
+    IMPROVEMENT
+};
+
+/**
+ * Comparación de una métrica de un dataset contra la línea base
+ */
+struct MetricComparison {
+    std::string dataset;
+    std::string metric;
+    double baseline_median;
+    double current_median;
+    double relative_change;        // (actual - base) / base
+    double p_value;                // Mann-Whitney bilateral
+    double adjusted_p;             // Corregido por Holm sobre todas las comparaciones
+    RegressionVerdict verdict;
+
+    MetricComparison() : baseline_median(0.0), current_median(0.0), relative_change(0.0),
+                         p_value(1.0), adjusted_p(1.0), verdict(RegressionVerdict::UNCHANGED) {}
+};
+
+/**
+ * Puerta de regresión: mide cada dataset varias veces tras un calentamiento,
+ * resume cada métrica con su mediana e intervalo de confianza y compara con
+ * una línea base guardada. Una métrica solo se marca como regresión si la
+ * prueba de Mann-Whitney sobre las muestras es significativa tras corregir
+ * por comparaciones múltiples (Holm) y además el cambio de la mediana supera
+ * los umbrales relativo y absoluto.
+ */
+class RegressionGate {
+public:
+    explicit RegressionGate(const RegressionOptions& options = RegressionOptions());
+
+    /**
+     * Mide los datasets con el benchmark dado
+     * @param benchmark Benchmark ya configurado (arena, pool)
+     * @param datasets Rutas FASTA
+     * @return Mediciones en formato de línea base (vacía si algún dataset no se pudo leer)
+     */
+    RegressionBaseline measure(Benchmark& benchmark, const std::vector<std::string>& datasets) const;
+
+    /**
+     * Compara una medición con la línea base (solo datasets y métricas presentes en ambas)
+     */
+    std::vector<MetricComparison> compare(const RegressionBaseline& baseline,
+                                          const RegressionBaseline& current) const;
+
+    /**
+     * Muestra la comparación como tabla
+     * @return Número de regresiones
+     */
+    int printComparison(const std::vector<MetricComparison>& comparisons) const;
+
+    /**
+     * Exporta la comparación a CSV
+     */
+    void exportComparison(const std::vector<MetricComparison>& comparisons, const std::string& csv_file) const;
+
+    /**
+     * Guarda una línea base en JSON
+     * @return false si no se pudo escribir
+     */
+    static bool saveBaseline(const RegressionBaseline& baseline, const std::string& json_file);
+
+    /**
+     * Lee una línea base guardada con saveBaseline
+     * @return false si el archivo no existe o no tiene el formato esperado
+     */
+    static bool loadBaseline(const std::string& json_file, RegressionBaseline& baseline);
+
+    /**
+     * Mediana e intervalo de confianza de la mediana (estadísticos de orden, binomial)
+     */
+    static MetricSummary summarize(const std::string& name, const std::vector<double>& samples,
+                                   double confidence);
+
+    /**
+     * Valor p bilateral de Mann-Whitney: exacto sin empates y muestras pequeñas,
+     * aproximación normal con corrección por empates en otro caso
+     */
+    static double mannWhitneyPValue(const std::vector<double>& a, const std::vector<double>& b);
+
+private:
+    RegressionOptions options;
+};
+
+/**
+ * Nombre de un veredicto ("regression", "improvement", "unchanged")
+ */
+const char* regressionVerdictName(RegressionVerdict verdict);
+
+#endif // REGRESSION_H
@@ -0,0 +1,337 @@
+#include "result_cache.h"
+#include "logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char CACHE_MAGIC[4] = {'M', 'S', 'A', 'C'};
+const char CACHE_VERSION = 1;
+const size_t ENTRY_OVERHEAD = 64;   // Nodos de la lista y del índice, aproximado
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool getVarint(const std::string& in, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+ResultCache::ResultCache(const ResultCacheOptions& options)
+    : options(options), bytes(0), hit_count(0), miss_count(0), eviction_count(0) {
+    if (!options.directory.empty()) {
+        std::error_code ec;
+        fs::create_directories(options.directory, ec);
+        if (ec) {
+            LOG_WARN("cache.error").field("directory", options.directory)
+                << "Advertencia: No se pudo crear el directorio de cache " << options.directory;
+            this->options.directory.clear();
+        }
+    }
+}
+
+std::string ResultCache::makeKey(const std::vector<Sequence>& sequences, const std::string& parameters) {
+    // Dos hashes de 64 bits independientes (FNV-1a y multiplicativo) sobre los mismos bytes
+    uint64_t h1 = 14695981039346656037ULL;
+    uint64_t h2 = 0x9E3779B97F4A7C15ULL;
+    auto mix = [&](const std::string& text) {
+        std::string length;
+        putVarint(length, text.size());
+        const std::string* parts[] = {&length, &text};
+        for (const std::string* part : parts) {
+            for (unsigned char c : *part) {
+                h1 = (h1 ^ c) * 1099511628211ULL;
+                h2 = (h2 + c) * 0xFF51AFD7ED558CCDULL;
+                h2 ^= h2 >> 29;
+            }
+        }
+    };
+
+    mix(parameters);
+    for (const auto& seq : sequences) {
+        mix(seq.sequence);
+    }
+
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << h1 << std::setw(16) << h2;
+    return key.str();
+}
+
+std::string ResultCache::encodeRows(const std::vector<AlignedRow>& rows) {
+    std::string data(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    data.push_back(CACHE_VERSION);
+    putVarint(data, rows.size());
+    for (const auto& row : rows) {
+        putVarint(data, row.residues.size());
+        putVarint(data, row.script.size());
+        for (const auto& edit : row.script) {
+            data.push_back(edit.op);
+            putVarint(data, static_cast<uint64_t>(edit.length));
+        }
+    }
+    return data;
+}
+
+bool ResultCache::decodeRows(const std::string& data, const std::vector<Sequence>& sequences,
+                             std::vector<AlignedRow>& rows) {
+    size_t pos = sizeof(CACHE_MAGIC) + 1;
+    if (data.size() < pos || data.compare(0, sizeof(CACHE_MAGIC), CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        data[sizeof(CACHE_MAGIC)] != CACHE_VERSION) {
+        return false;
+    }
+
+    uint64_t count = 0;
+    if (!getVarint(data, pos, count) || count != sequences.size()) {
+        return false;
+    }
+
+    rows.assign(sequences.size(), AlignedRow());
+    for (size_t r = 0; r < rows.size(); ++r) {
+        uint64_t residues = 0, ops = 0, length = 0, consumed = 0;
+        if (!getVarint(data, pos, residues) || residues != sequences[r].sequence.size() ||
+            !getVarint(data, pos, ops)) {
+            return false;
+        }
+        rows[r].header = sequences[r].header;
+        rows[r].residues = sequences[r].sequence;
+        rows[r].script.reserve(static_cast<size_t>(ops));
+        for (uint64_t o = 0; o < ops; ++o) {
+            if (pos >= data.size()) {
+                return false;
+            }
+            char op = data[pos++];
+            if ((op != 'M' && op != 'I' && op != 'D') || !getVarint(data, pos, length)) {
+                return false;
+            }
+            rows[r].script.emplace_back(op, static_cast<int>(length));
+            if (op != 'D') {
+                consumed += length;
+            }
+        }
+        // Los guiones deben consumir exactamente los residuos de la petición
+        if (consumed != residues) {
+            return false;
+        }
+    }
+    return pos == data.size();
+}
+
+bool ResultCache::lookup(const std::string& key, const std::vector<Sequence>& sequences,
+                         std::vector<AlignedRow>& rows) {
+    std::string data;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            data = it->second->second;
+            found = true;
+        }
+    }
+
+    if (!found && loadFromDisk(key, data)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        insertLocked(key, data);
+        found = true;
+    }
+
+    bool ok = found && decodeRows(data, sequences, rows);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ok) {
+        hit_count++;
+    } else {
+        miss_count++;
+        rows.clear();
+    }
+    return ok;
+}
+
+void ResultCache::store(const std::string& key, const std::vector<AlignedRow>& rows) {
+    std::string data = encodeRows(rows);
+    saveToDisk(key, data);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insertLocked(key, std::move(data));
+}
+
+std::vector<AlignedRow> ResultCache::align(MSAAligner& aligner, const std::vector<Sequence>& sequences,
+                                           bool* hit) {
+    std::string key = makeKey(sequences, aligner.parameterSignature());
+    std::vector<AlignedRow> rows;
+
+    bool found = lookup(key, sequences, rows);
+    if (hit) {
+        *hit = found;
+    }
+    if (found) {
+        aligner.adoptResult(rows);
+        LOG_DEBUG("cache.hit").field("key", key).field("sequences", sequences.size());
+        return rows;
+    }
+
+    rows = aligner.alignSequencesToRows(sequences);
+    // Hirschberg puede elegir otro camino óptimo que la matriz completa
+    if (!rows.empty() && !aligner.wasCancelled() && aligner.getDegradations() == DEGRADE_NONE &&
+        (aligner.getMemoryStrategies() & MEMORY_HIRSCHBERG) == 0) {
+        store(key, rows);
+    }
+    return rows;
+}
+
+void ResultCache::insertLocked(const std::string& key, std::string data) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        bytes -= it->second->first.size() + it->second->second.size() + ENTRY_OVERHEAD;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    size_t entry_bytes = key.size() + data.size() + ENTRY_OVERHEAD;
+    if (entry_bytes > options.max_bytes) {
+        return;
+    }
+
+    lru.emplace_front(key, std::move(data));
+    index[key] = lru.begin();
+    bytes += entry_bytes;
+
+    while (bytes > options.max_bytes || (options.max_entries > 0 && lru.size() > options.max_entries)) {
+        const Entry& oldest = lru.back();
+        bytes -= oldest.first.size() + oldest.second.size() + ENTRY_OVERHEAD;
+        index.erase(oldest.first);
+        lru.pop_back();
+        eviction_count++;
+    }
+}
+
+std::string ResultCache::entryPath(const std::string& key) const {
+    return (fs::path(options.directory) / (key + ".msac")).string();
+}
+
+bool ResultCache::loadFromDisk(const std::string& key, std::string& data) const {
+    if (options.directory.empty()) {
+        return false;
+    }
+
+    std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    // Marca el uso para la expulsión LRU del directorio
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void ResultCache::saveToDisk(const std::string& key, const std::string& data) const {
+    if (options.directory.empty()) {
+        return;
+    }
+
+    // Escritura atómica: otros procesos pueden compartir el directorio
+    std::ostringstream suffix;
+    suffix << ".tmp" << std::this_thread::get_id();
+    std::string path = entryPath(key);
+    std::string temp_path = path + suffix.str();
+    {
+        std::ofstream file(temp_path, std::ios::binary);
+        if (!file.is_open() || !file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            return;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return;
+    }
+    trimDisk();
+}
+
+void ResultCache::trimDisk() const {
+    struct DiskEntry {
+        fs::path path;
+        fs::file_time_type used;
+        uintmax_t size;
+    };
+
+    std::vector<DiskEntry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(options.directory, ec)) {
+        if (item.path().extension() != ".msac") {
+            continue;
+        }
+        DiskEntry entry{item.path(), item.last_write_time(ec), item.file_size(ec)};
+        if (!ec) {
+            total += entry.size;
+            entries.push_back(entry);
+        }
+    }
+    if (total <= options.max_bytes) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const DiskEntry& a, const DiskEntry& b) {
+        return a.used < b.used;
+    });
+    for (const auto& entry : entries) {
+        if (total <= options.max_bytes) {
+            break;
+        }
+        if (fs::remove(entry.path, ec)) {
+            total -= entry.size;
+        }
+    }
+}
+
+std::string ResultCache::statsReport() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned long lookups = hit_count + miss_count;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "cache_hits=" << hit_count << '\n';
+    report << "cache_misses=" << miss_count << '\n';
+    report << "cache_hit_rate=" << (lookups > 0 ? static_cast<double>(hit_count) / lookups : 0.0) << '\n';
+    report << "cache_entries=" << lru.size() << '\n';
+    report << "cache_bytes=" << bytes << '\n';
+    report << "cache_max_bytes=" << options.max_bytes << '\n';
+    report << "cache_evictions=" << eviction_count << '\n';
+    return report.str();
+}
+
+unsigned long ResultCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+unsigned long ResultCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
@@ -0,0 +1,125 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "alignment.h"
+#include "io.h"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Opciones de la caché de resultados
+ */
+struct ResultCacheOptions {
+    size_t max_bytes;               // Límite de memoria (y de disco si hay directorio)
+    size_t max_entries;             // Límite de entradas en memoria (0 = sin límite)
+    std::string directory;          // Directorio persistente opcional, compartible entre procesos
+
+    ResultCacheOptions() : max_bytes(256u * 1024u * 1024u), max_entries(0) {}
+};
+
+/**
+ * Caché de alineamientos direccionada por contenido.
+ *
+ * La clave es un hash de 128 bits de las secuencias de entrada (residuos en orden,
+ * tal como los deja el lector FASTA) y de todos los parámetros del alineador; los
+ * encabezados no forman parte de la clave. El valor guarda solo los guiones de
+ * edición en binario compacto (corridas con longitudes varint): los residuos y
+ * encabezados se toman de la petición al recuperar la entrada.
+ *
+ * Expulsión LRU por bytes y entradas. Es segura entre hilos; el directorio
+ * opcional permite reutilizar resultados entre ejecuciones.
+ */
+class ResultCache {
+public:
+    /**
+     * Constructor
+     * @param options Límites y directorio persistente
+     */
+    explicit ResultCache(const ResultCacheOptions& options);
+
+    /**
+     * Calcula la clave de un trabajo
+     * @param sequences Secuencias de entrada
+     * @param parameters Firma de parámetros del alineador (MSAAligner::parameterSignature)
+     * @return Clave hexadecimal de 32 caracteres
+     */
+    static std::string makeKey(const std::vector<Sequence>& sequences, const std::string& parameters);
+
+    /**
+     * Busca un resultado
+     * @param key Clave del trabajo
+     * @param sequences Secuencias de la petición (aportan encabezados y residuos)
+     * @param rows Filas recuperadas
+     * @return true si hubo acierto
+     */
+    bool lookup(const std::string& key, const std::vector<Sequence>& sequences,
+                std::vector<AlignedRow>& rows);
+
+    /**
+     * Guarda un resultado, expulsando las entradas menos usadas si hace falta
+     * @param key Clave del trabajo
+     * @param rows Filas alineadas
+     */
+    void store(const std::string& key, const std::vector<AlignedRow>& rows);
+
+    /**
+     * Alinea pasando por la caché. Los resultados degradados por presupuesto,
+     * cancelados o calculados con Hirschberg por el límite de memoria no se guardan
+     * @param aligner Alineador a usar en caso de fallo
+     * @param sequences Secuencias de entrada
+     * @param hit Si no es nulo, indica si hubo acierto
+     * @return Filas alineadas
+     */
+    std::vector<AlignedRow> align(MSAAligner& aligner, const std::vector<Sequence>& sequences,
+                                  bool* hit = nullptr);
+
+    /**
+     * Genera el reporte de aciertos, fallos y ocupación
+     * @return Líneas clave=valor con prefijo cache_
+     */
+    std::string statsReport() const;
+
+    unsigned long hits() const;
+    unsigned long misses() const;
+
+    /**
+     * Codifica los guiones de edición de las filas en binario compacto
+     */
+    static std::string encodeRows(const std::vector<AlignedRow>& rows);
+
+    /**
+     * Decodifica guiones de edición y los combina con las secuencias de la petición
+     * @return false si el contenido no corresponde a las secuencias
+     */
+    static bool decodeRows(const std::string& data, const std::vector<Sequence>& sequences,
+                           std::vector<AlignedRow>& rows);
+
+private:
+    using Entry = std::pair<std::string, std::string>;     // Clave y valor codificado
+
+    ResultCacheOptions options;
+    mutable std::mutex mutex;
+    std::list<Entry> lru;                                   // Más reciente al principio
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t bytes;
+    unsigned long hit_count;
+    unsigned long miss_count;
+    unsigned long eviction_count;
+
+    /**
+     * Inserta en memoria y aplica los límites (requiere el mutex)
+     */
+    void insertLocked(const std::string& key, std::string data);
+
+    std::string entryPath(const std::string& key) const;
+    bool loadFromDisk(const std::string& key, std::string& data) const;
+    void saveToDisk(const std::string& key, const std::string& data) const;
+    void trimDisk() const;
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,559 @@
+#include "synthetic.h"
+#include "logger.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace {
+
+const std::string DNA_RESIDUES = "ACGT";
+const std::string PROTEIN_RESIDUES = "ARNDCQEGHILKMFPSTWYV";
+const uint64_t START_COLUMN = ~0ULL;        // Antes de la primera columna
+const size_t FASTA_LINE_WIDTH = 80;         // Igual que FastaIO::formatFasta
+
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// SplitMix64: estado de 8 bytes, barato de sembrar por nodo
+class Rng {
+public:
+    Rng(uint64_t seed, uint64_t stream, uint64_t node) : state(mix(seed ^ mix(stream)) ^ mix(node)) {}
+
+    uint64_t next() {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    uint64_t below(uint64_t n) {
+        return next() % n;
+    }
+
+private:
+    uint64_t state;
+};
+
+enum Stream : uint64_t { TOPOLOGY = 1, EVOLUTION = 2 };
+
+uint64_t columnKey(uint32_t node, uint32_t index) {
+    return (static_cast<uint64_t>(node) << 32) | index;
+}
+
+std::string leafHeader(uint32_t leaf) {
+    return "Synthetic_Seq_" + std::to_string(leaf + 1);
+}
+
+// Bytes de un registro FASTA con el formato de FastaIO::formatFasta
+uint64_t recordBytes(size_t header_length, size_t sequence_length) {
+    return 1 + header_length + 1 + sequence_length + (sequence_length + FASTA_LINE_WIDTH - 1) / FASTA_LINE_WIDTH;
+}
+
+void appendRecord(std::string& out, const std::string& header, const std::string& sequence) {
+    out.push_back('>');
+    out += header;
+    out.push_back('\n');
+    for (size_t i = 0; i < sequence.size(); i += FASTA_LINE_WIDTH) {
+        out.append(sequence, i, FASTA_LINE_WIDTH);
+        out.push_back('\n');
+    }
+}
+
+// Archivo escrito por posición desde varios hilos
+class PositionalFile {
+public:
+    bool open(const std::string& path, uint64_t size) {
+        {
+            std::ofstream create(path, std::ios::binary | std::ios::trunc);
+            if (!create.is_open()) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::resize_file(path, size, ec);
+        if (ec) {
+            return false;
+        }
+        file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+        return file.is_open();
+    }
+
+    void write(uint64_t offset, const std::string& data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    bool close() {
+        file.close();
+        return !file.fail();
+    }
+
+private:
+    std::fstream file;
+    std::mutex mutex;
+};
+
+} // namespace
+
+SyntheticGenerator::SyntheticGenerator(const SyntheticOptions& options, ThreadPool* pool)
+    : options(options), pool(pool), branch_mean(0.0), track_columns(false), columns(0) {}
+
+bool SyntheticGenerator::validate() const {
+    if (options.num_sequences == 0 || options.num_sequences > (1u << 30) || options.length == 0 ||
+        options.length > 0xFFFFFFFFu) {
+        LOG_ERROR("synthetic.error") << "Error: Numero de secuencias o longitud fuera de rango";
+        return false;
+    }
+    if (options.divergence < 0.0 || options.indel_rate < 0.0 || options.mean_indel_length < 1.0 ||
+        options.max_indel_length == 0) {
+        LOG_ERROR("synthetic.error") << "Error: Parametros de evolucion invalidos";
+        return false;
+    }
+    return true;
+}
+
+const std::string& SyntheticGenerator::alphabet() const {
+    return options.protein ? PROTEIN_RESIDUES : DNA_RESIDUES;
+}
+
+void SyntheticGenerator::buildTree() {
+    size_t nodes = 2 * options.num_sequences - 1;
+    split.assign(nodes, 0);
+    depth.assign(nodes, 0);
+
+    // Recorrido explícito: un árbol aleatorio puede ser profundo
+    struct Pending {
+        uint32_t node, begin, end;
+    };
+    std::vector<Pending> stack = {{0, 0, static_cast<uint32_t>(options.num_sequences)}};
+    uint64_t leaf_depth_sum = 0;
+    while (!stack.empty()) {
+        Pending item = stack.back();
+        stack.pop_back();
+        uint32_t leaves = item.end - item.begin;
+        if (leaves == 1) {
+            leaf_depth_sum += depth[item.node];
+            continue;
+        }
+        Rng rng(options.seed, TOPOLOGY, item.node);
+        uint32_t middle = item.begin + 1 + static_cast<uint32_t>(rng.below(leaves - 1));
+        split[item.node] = middle;
+        uint32_t left = item.node + 1;
+        uint32_t right = item.node + 2 * (middle - item.begin);
+        depth[left] = depth[right] = depth[item.node] + 1;
+        stack.push_back({right, middle, item.end});
+        stack.push_back({left, item.begin, middle});
+    }
+
+    double average_depth = static_cast<double>(leaf_depth_sum) / options.num_sequences;
+    last_summary.average_depth = average_depth;
+    branch_mean = average_depth > 0.0 ? options.divergence / average_depth : 0.0;
+}
+
+void SyntheticGenerator::makeNode(uint32_t node, const Lineage* parent, Lineage& own, bool collect) {
+    Rng rng(options.seed, EVOLUTION, node);
+    const size_t residues = alphabet().size();
+    own.residues.clear();
+    own.columns.clear();
+
+    if (!parent) {
+        // Raíz: secuencia uniforme, sus columnas son el bloque inicial
+        own.residues.resize(options.length);
+        for (char& r : own.residues) {
+            r = static_cast<char>(rng.below(residues));
+        }
+        if (track_columns) {
+            own.columns.resize(options.length);
+            for (uint32_t k = 0; k < options.length; ++k) {
+                own.columns[k] = columnKey(node, k);
+            }
+            if (collect) {
+                insertions[node].push_back({START_COLUMN, 0, static_cast<uint32_t>(options.length)});
+                markable(node, static_cast<uint32_t>(options.length));
+            }
+        }
+        return;
+    }
+
+    // Longitud de rama exponencial; probabilidades por sitio de cada evento
+    double branch = -branch_mean * std::log(1.0 - rng.uniform());
+    double p_substitution = std::min(0.75, branch);
+    double p_indel = std::min(0.2, branch * options.indel_rate);
+    double p_event = p_substitution + p_indel;
+    double log_no_event = p_event > 0.0 ? std::log(1.0 - p_event) : 0.0;
+    double log_extend = std::log(1.0 - 1.0 / options.mean_indel_length);
+
+    auto gap = [&]() -> size_t {
+        if (p_event <= 0.0) {
+            return static_cast<size_t>(-1) / 2;
+        }
+        return static_cast<size_t>(std::log(1.0 - rng.uniform()) / log_no_event);
+    };
+    auto indelLength = [&]() -> size_t {
+        if (options.mean_indel_length <= 1.0) {
+            return 1;
+        }
+        size_t length = 1 + static_cast<size_t>(std::log(1.0 - rng.uniform()) / log_extend);
+        return std::min(length, options.max_indel_length);
+    };
+
+    const size_t n = parent->residues.size();
+    own.residues.reserve(n + n / 8 + 16);
+    if (track_columns) {
+        own.columns.reserve(n + n / 8 + 16);
+    }
+    uint32_t inserted = 0;
+    size_t i = 0;
+    size_t next = std::min(n, gap());
+    while (i < n) {
+        // Tramo sin eventos: copia directa
+        own.residues.append(parent->residues, i, next - i);
+        if (track_columns) {
+            own.columns.insert(own.columns.end(), parent->columns.begin() + i, parent->columns.begin() + next);
+        }
+        i = next;
+        if (i >= n) {
+            break;
+        }
+
+        double event = rng.uniform() * p_event;
+        if (event < p_substitution) {
+            char current = parent->residues[i];
+            own.residues.push_back(static_cast<char>((current + 1 + rng.below(residues - 1)) % residues));
+            if (track_columns) {
+                own.columns.push_back(parent->columns[i]);
+            }
+            ++i;
+        } else if (event < p_substitution + p_indel / 2) {
+            // Inserción tras el sitio i: columnas nuevas de este nodo
+            own.residues.push_back(parent->residues[i]);
+            size_t length = indelLength();
+            if (track_columns) {
+                own.columns.push_back(parent->columns[i]);
+                if (collect) {
+                    insertions[node].push_back({parent->columns[i], inserted, static_cast<uint32_t>(length)});
+                }
+                for (size_t k = 0; k < length; ++k) {
+                    own.columns.push_back(columnKey(node, inserted + static_cast<uint32_t>(k)));
+                }
+            }
+            for (size_t k = 0; k < length; ++k) {
+                own.residues.push_back(static_cast<char>(rng.below(residues)));
+            }
+            inserted += static_cast<uint32_t>(length);
+            ++i;
+        } else {
+            i += indelLength();
+        }
+        next = std::min(n, i + gap());
+    }
+
+    // Nunca una secuencia vacía: se conserva el primer sitio del padre
+    if (own.residues.empty() && n > 0) {
+        own.residues.push_back(parent->residues[0]);
+        if (track_columns) {
+            own.columns.push_back(parent->columns[0]);
+        }
+    }
+    // Las hojas del subárbol, que se visitan después, marcan las columnas nuevas que conservan
+    if (track_columns && collect) {
+        markable(node, inserted);
+    }
+}
+
+void SyntheticGenerator::markable(uint32_t node, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    present[node].reset(new std::atomic<unsigned char>[count]);
+    for (uint32_t k = 0; k < count; ++k) {
+        present[node][k].store(0, std::memory_order_relaxed);
+    }
+}
+
+void SyntheticGenerator::visit(uint32_t node, uint32_t begin, uint32_t end, const Lineage* parent,
+                               std::deque<Lineage>& levels, bool collect, const LeafSink& sink) {
+    while (levels.size() <= depth[node]) {
+        levels.emplace_back();
+    }
+    Lineage& own = levels[depth[node]];
+    makeNode(node, parent, own, collect);
+
+    if (end - begin == 1) {
+        if (collect) {
+            leaf_length[begin] = static_cast<uint32_t>(own.residues.size());
+            if (track_columns) {
+                for (uint64_t key : own.columns) {
+                    present[key >> 32][key & 0xFFFFFFFFu].store(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        if (sink) {
+            sink(begin, own);
+        }
+        return;
+    }
+    uint32_t middle = split[node];
+    visit(node + 1, begin, middle, &own, levels, collect, sink);
+    visit(node + 2 * (middle - begin), middle, end, &own, levels, collect, sink);
+}
+
+void SyntheticGenerator::simulate(bool collect, const LeafSink& sink) {
+    struct Task {
+        uint32_t node, begin, end;
+        bool has_parent;
+        Lineage parent;
+    };
+
+    // La parte alta del árbol se simula en serie hasta subárboles de `grain` hojas
+    size_t workers = pool ? pool->size() : 1;
+    uint32_t total = static_cast<uint32_t>(options.num_sequences);
+    uint32_t grain = workers > 1 ? std::max<uint32_t>(1, total / static_cast<uint32_t>(workers * 16)) : total;
+
+    std::vector<Task> tasks;
+    std::function<void(uint32_t, uint32_t, uint32_t, const Lineage*)> expand =
+        [&](uint32_t node, uint32_t begin, uint32_t end, const Lineage* parent) {
+        if (end - begin <= grain) {
+            tasks.push_back({node, begin, end, parent != nullptr, parent ? *parent : Lineage()});
+            return;
+        }
+        Lineage own;
+        makeNode(node, parent, own, collect);
+        uint32_t middle = split[node];
+        expand(node + 1, begin, middle, &own);
+        expand(node + 2 * (middle - begin), middle, end, &own);
+    };
+    expand(0, 0, total, nullptr);
+
+    auto runTask = [&](size_t t) {
+        Task& task = tasks[t];
+        std::deque<Lineage> levels;
+        visit(task.node, task.begin, task.end, task.has_parent ? &task.parent : nullptr, levels, collect, sink);
+    };
+    if (pool && tasks.size() > 1) {
+        pool->parallelFor(0, tasks.size(), runTask);
+    } else {
+        for (size_t t = 0; t < tasks.size(); ++t) {
+            runTask(t);
+        }
+    }
+}
+
+uint64_t SyntheticGenerator::denseColumn(uint64_t key) const {
+    return node_offset[key >> 32] + (key & 0xFFFFFFFFu);
+}
+
+void SyntheticGenerator::emitRun(const Insertion& run, uint32_t node, const std::vector<uint32_t>& bucket_start,
+                                 const std::vector<std::pair<uint32_t, Insertion>>& runs, uint32_t& next) {
+    for (uint32_t k = 0; k < run.count; ++k) {
+        uint64_t dense = node_offset[node] + run.first + k;
+        // Una columna que ninguna hoja conserva no se emite, pero sí lo insertado tras ella
+        if (present[node][run.first + k].load(std::memory_order_relaxed)) {
+            position[dense] = next++;
+        }
+        // Bloques insertados justo después de esta columna (los más profundos primero)
+        for (uint32_t r = bucket_start[dense]; r < bucket_start[dense + 1]; ++r) {
+            emitRun(runs[r].second, runs[r].first, bucket_start, runs, next);
+        }
+    }
+}
+
+void SyntheticGenerator::orderColumns() {
+    size_t nodes = insertions.size();
+    node_offset.assign(nodes + 1, 0);
+    for (size_t v = 0; v < nodes; ++v) {
+        uint64_t count = 0;
+        for (const auto& run : insertions[v]) {
+            count += run.count;
+        }
+        node_offset[v + 1] = node_offset[v] + count;
+    }
+    size_t keys = static_cast<size_t>(node_offset[nodes]);
+
+    // Bloques agrupados por la columna tras la que se insertaron (la última cubeta es el inicio).
+    // En un mismo linaje un bloque insertado más abajo en el árbol queda pegado a su columna,
+    // antes que los heredados; los de linajes distintos nunca coinciden en una fila
+    std::vector<uint32_t> bucket_start(keys + 2, 0);
+    auto bucketOf = [&](uint64_t attach) -> size_t {
+        return attach == START_COLUMN ? keys : static_cast<size_t>(denseColumn(attach));
+    };
+    for (size_t v = 0; v < nodes; ++v) {
+        for (const auto& run : insertions[v]) {
+            bucket_start[bucketOf(run.attach) + 1]++;
+        }
+    }
+    for (size_t b = 0; b + 1 < bucket_start.size(); ++b) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    std::vector<std::pair<uint32_t, Insertion>> runs(bucket_start.back());
+    std::vector<uint32_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t v = 0; v < nodes; ++v) {
+        for (const auto& run : insertions[v]) {
+            runs[fill[bucketOf(run.attach)]++] = {static_cast<uint32_t>(v), run};
+        }
+    }
+    for (size_t b = 0; b + 1 < bucket_start.size(); ++b) {
+        if (bucket_start[b + 1] - bucket_start[b] > 1) {
+            std::sort(runs.begin() + bucket_start[b], runs.begin() + bucket_start[b + 1],
+                      [this](const std::pair<uint32_t, Insertion>& a, const std::pair<uint32_t, Insertion>& b) {
+                          return depth[a.first] != depth[b.first] ? depth[a.first] > depth[b.first]
+                                                                  : a.first < b.first;
+                      });
+        }
+    }
+
+    position.assign(keys, 0);
+    uint32_t next = 0;
+    for (uint32_t r = bucket_start[keys]; r < bucket_start[keys + 1]; ++r) {
+        emitRun(runs[r].second, runs[r].first, bucket_start, runs, next);
+    }
+    columns = next;
+}
+
+std::string SyntheticGenerator::residueString(const Lineage& lineage) const {
+    const std::string& letters = alphabet();
+    std::string text(lineage.residues.size(), ' ');
+    for (size_t i = 0; i < text.size(); ++i) {
+        text[i] = letters[static_cast<unsigned char>(lineage.residues[i])];
+    }
+    return text;
+}
+
+std::string SyntheticGenerator::alignedRow(const Lineage& lineage) const {
+    const std::string& letters = alphabet();
+    std::string row(columns, '-');
+    for (size_t i = 0; i < lineage.residues.size(); ++i) {
+        row[position[denseColumn(lineage.columns[i])]] = letters[static_cast<unsigned char>(lineage.residues[i])];
+    }
+    return row;
+}
+
+void SyntheticGenerator::prepare(bool first_pass) {
+    last_summary = SyntheticSummary();
+    last_summary.sequences = options.num_sequences;
+    buildTree();
+    insertions.assign(track_columns ? split.size() : 0, std::vector<Insertion>());
+    present.clear();
+    present.resize(insertions.size());
+    leaf_length.assign(options.num_sequences, 0);
+    columns = 0;
+    if (!first_pass) {
+        return;
+    }
+
+    // Primera pasada: longitudes de las hojas y bloques insertados
+    simulate(true, LeafSink());
+    if (track_columns) {
+        orderColumns();
+        last_summary.columns = columns;
+    }
+    for (uint32_t length : leaf_length) {
+        last_summary.residues += length;
+    }
+}
+
+void SyntheticGenerator::finish(double seconds) {
+    last_summary.seconds = seconds;
+    insertions.clear();
+    present.clear();
+    position.clear();
+    LOG_INFO("synthetic").field("sequences", last_summary.sequences).field("residues", last_summary.residues)
+                         .field("columns", last_summary.columns).field("average_depth", last_summary.average_depth)
+                         .field("seconds", seconds)
+        << "Dataset sintetico: " << last_summary.sequences << " secuencias, " << last_summary.residues
+        << " residuos, profundidad media " << last_summary.average_depth
+        << (track_columns ? ", " + std::to_string(last_summary.columns) + " columnas" : std::string())
+        << " (" << seconds << " s)";
+}
+
+bool SyntheticGenerator::generate(std::vector<Sequence>& sequences, std::vector<Sequence>* alignment) {
+    if (!validate()) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    track_columns = alignment != nullptr;
+    prepare(track_columns);
+
+    sequences.assign(options.num_sequences, Sequence());
+    if (alignment) {
+        alignment->assign(options.num_sequences, Sequence());
+    }
+    // Segunda pasada: la misma simulación, ahora guardando las hojas (cada hilo escribe las suyas)
+    simulate(false, [&](uint32_t leaf, const Lineage& lineage) {
+        sequences[leaf] = Sequence(leafHeader(leaf), residueString(lineage));
+        if (alignment) {
+            (*alignment)[leaf] = Sequence(leafHeader(leaf), alignedRow(lineage));
+        }
+    });
+    last_summary.residues = 0;
+    for (const auto& seq : sequences) {
+        last_summary.residues += seq.sequence.size();
+    }
+
+    finish(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+bool SyntheticGenerator::generateToFiles(const std::string& fasta_path, const std::string& alignment_path) {
+    if (!validate()) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    track_columns = !alignment_path.empty();
+    prepare(true);
+
+    // Desplazamiento de cada registro: los hilos escriben sus hojas en su lugar
+    std::vector<uint64_t> fasta_offset(options.num_sequences + 1, 0);
+    std::vector<uint64_t> alignment_offset(track_columns ? options.num_sequences + 1 : 0, 0);
+    for (uint32_t leaf = 0; leaf < options.num_sequences; ++leaf) {
+        size_t header = leafHeader(leaf).size();
+        fasta_offset[leaf + 1] = fasta_offset[leaf] + recordBytes(header, leaf_length[leaf]);
+        if (track_columns) {
+            alignment_offset[leaf + 1] = alignment_offset[leaf] + recordBytes(header, columns);
+        }
+    }
+
+    PositionalFile fasta_file;
+    PositionalFile alignment_file;
+    if (!fasta_file.open(fasta_path, fasta_offset.back())) {
+        LOG_ERROR("synthetic.error") << "Error: No se pudo crear el archivo " << fasta_path;
+        return false;
+    }
+    if (track_columns && !alignment_file.open(alignment_path, alignment_offset.back())) {
+        LOG_ERROR("synthetic.error") << "Error: No se pudo crear el archivo " << alignment_path;
+        return false;
+    }
+
+    simulate(false, [&](uint32_t leaf, const Lineage& lineage) {
+        std::string record;
+        appendRecord(record, leafHeader(leaf), residueString(lineage));
+        fasta_file.write(fasta_offset[leaf], record);
+        if (track_columns) {
+            record.clear();
+            appendRecord(record, leafHeader(leaf), alignedRow(lineage));
+            alignment_file.write(alignment_offset[leaf], record);
+        }
+    });
+
+    bool ok = fasta_file.close() && (!track_columns || alignment_file.close());
+    if (!ok) {
+        LOG_ERROR("synthetic.error") << "Error: Fallo la escritura del dataset sintetico";
+        return false;
+    }
+    finish(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
@@ -0,0 +1,146 @@
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include "io.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Parámetros de la simulación de evolución
+ */
+struct SyntheticOptions {
+    size_t num_sequences;          // Hojas del árbol
+    size_t length;                 // Longitud de la secuencia raíz
+    bool protein;                  // Alfabeto de aminoácidos en lugar de ADN
+    double divergence;             // Sustituciones esperadas por sitio de la raíz a cada hoja
+    double indel_rate;             // Eventos de indel por sustitución (mitad inserciones, mitad eliminaciones)
+    double mean_indel_length;      // Longitud media de los indels (geométrica)
+    size_t max_indel_length;       // Tope de longitud de un indel
+    uint64_t seed;                 // Semilla: misma semilla y parámetros, mismo dataset
+
+    SyntheticOptions() : num_sequences(20), length(100), protein(false), divergence(0.1), indel_rate(0.1),
+                         mean_indel_length(2.0), max_indel_length(20), seed(42) {}
+};
+
+/**
+ * Resumen del último dataset generado
+ */
+struct SyntheticSummary {
+    size_t sequences;
+    size_t columns;                // Columnas del alineamiento verdadero (0 si no se pidió)
+    uint64_t residues;             // Residuos en las hojas
+    double average_depth;          // Profundidad media de las hojas
+    double seconds;
+
+    SyntheticSummary() : sequences(0), columns(0), residues(0), average_depth(0.0), seconds(0.0) {}
+};
+
+/**
+ * Generador determinista de datasets sintéticos por evolución sobre un árbol.
+ *
+ * La topología es un árbol binario aleatorio (cada nodo parte sus hojas en un
+ * punto uniforme) y las ramas tienen longitud exponencial, escalada para que
+ * la divergencia media raíz-hoja sea la pedida. Cada rama aplica sustituciones
+ * e indels con un generador propio sembrado con (semilla, nodo), por lo que el
+ * resultado no depende del número de hilos. Los subárboles se simulan en
+ * paralelo en el pool y los archivos se escriben por posición, sin tener todo
+ * el dataset en memoria.
+ *
+ * El alineamiento verdadero se reconstruye en dos pasadas: la primera registra
+ * dónde se insertó cada bloque nuevo y con eso se ordenan las columnas; la
+ * segunda repite la misma simulación y coloca cada residuo en su columna. Su
+ * ancho crece con los indels de todas las ramas: con miles de hojas conviene
+ * un indel_rate bajo.
+ */
+class SyntheticGenerator {
+public:
+    /**
+     * Constructor
+     * @param options Parámetros de la simulación
+     * @param pool Pool de hilos (nullptr = un solo hilo)
+     */
+    explicit SyntheticGenerator(const SyntheticOptions& options, ThreadPool* pool = nullptr);
+
+    /**
+     * Genera el dataset en memoria
+     * @param sequences Secuencias sin alinear (salida)
+     * @param alignment Alineamiento verdadero (salida; nullptr = no calcularlo)
+     * @return false si los parámetros no son válidos
+     */
+    bool generate(std::vector<Sequence>& sequences, std::vector<Sequence>* alignment = nullptr);
+
+    /**
+     * Genera el dataset directamente en archivos FASTA
+     * @param fasta_path Secuencias sin alinear
+     * @param alignment_path Alineamiento verdadero ("" = no escribirlo)
+     * @return false si los parámetros no son válidos o falló la escritura
+     */
+    bool generateToFiles(const std::string& fasta_path, const std::string& alignment_path = "");
+
+    /**
+     * Resumen de la última generación
+     */
+    const SyntheticSummary& summary() const { return last_summary; }
+
+private:
+    // Bloque de columnas nuevas de un nodo insertado tras la columna attach
+    struct Insertion {
+        uint64_t attach;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // Secuencia de un nodo: residuo (índice en el alfabeto) y columna de cada sitio
+    struct Lineage {
+        std::string residues;
+        std::vector<uint64_t> columns;
+    };
+
+    using LeafSink = std::function<void(uint32_t leaf, const Lineage& lineage)>;
+
+    SyntheticOptions options;
+    ThreadPool* pool;
+    SyntheticSummary last_summary;
+
+    // Árbol implícito en preorden: el nodo de hojas [begin, end) tiene hijos
+    // node + 1 (hojas [begin, split)) y node + 2 * (split - begin)
+    std::vector<uint32_t> split;
+    std::vector<uint32_t> depth;
+    double branch_mean;
+
+    // Alineamiento verdadero
+    bool track_columns;
+    std::vector<std::vector<Insertion>> insertions;   // Por nodo
+    std::vector<std::unique_ptr<std::atomic<unsigned char>[]>> present;   // Columnas del nodo presentes en alguna hoja
+    std::vector<uint64_t> node_offset;                // Primera columna densa de cada nodo
+    std::vector<uint32_t> position;                   // Columna densa -> columna del alineamiento
+    size_t columns;                                   // Columnas con algún residuo
+
+    std::vector<uint32_t> leaf_length;
+
+    bool validate() const;
+    const std::string& alphabet() const;
+    void buildTree();
+    void simulate(bool collect, const LeafSink& sink);
+    void visit(uint32_t node, uint32_t begin, uint32_t end, const Lineage* parent,
+               std::deque<Lineage>& levels, bool collect, const LeafSink& sink);
+    void makeNode(uint32_t node, const Lineage* parent, Lineage& own, bool collect);
+    void markable(uint32_t node, uint32_t count);
+    void orderColumns();
+    void emitRun(const Insertion& run, uint32_t node, const std::vector<uint32_t>& bucket_start,
+                 const std::vector<std::pair<uint32_t, Insertion>>& runs, uint32_t& next);
+    uint64_t denseColumn(uint64_t key) const;
+    std::string alignedRow(const Lineage& lineage) const;
+    std::string residueString(const Lineage& lineage) const;
+    void prepare(bool first_pass);
+    void finish(double seconds);
+};
+
+#endif // SYNTHETIC_H
@@ -0,0 +1,126 @@
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+
+namespace {
+    // Pool al que pertenece el hilo actual (nullptr fuera de los trabajadores)
+    thread_local const ThreadPool* current_pool = nullptr;
+
+    int64_t steadyNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : stopping(false), busy_ns(0), tasks_run(0), stats_since_ns(steadyNanoseconds()) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        tasks.push(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    current_pool = this;
+    TraceRecorder::setThreadName("worker " + std::to_string(index));
+
+    while (true) {
+        std::function<void()> task;
+        {
+            // La espera de trabajo aparece en la traza como "idle"
+            TraceSpan idle("idle", "pool");
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+            if (stopping && tasks.empty()) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        TraceSpan span("task", "pool");
+        task();
+    }
+}
+
+bool ThreadPool::isWorkerThread() const {
+    return current_pool == this;
+}
+
+ThreadPoolStats ThreadPool::stats() const {
+    ThreadPoolStats result;
+    result.workers = workers.size();
+    result.tasks = tasks_run.load(std::memory_order_relaxed);
+    result.busy_ms = busy_ns.load(std::memory_order_relaxed) / 1e6;
+    result.wall_ms = (steadyNanoseconds() - stats_since_ns.load(std::memory_order_relaxed)) / 1e6;
+    return result;
+}
+
+void ThreadPool::resetStats() {
+    busy_ns.store(0, std::memory_order_relaxed);
+    tasks_run.store(0, std::memory_order_relaxed);
+    stats_since_ns.store(steadyNanoseconds(), std::memory_order_relaxed);
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body) {
+    if (begin >= end) {
+        return;
+    }
+
+    size_t count = end - begin;
+    if (isWorkerThread() || workers.size() <= 1 || count == 1) {
+        for (size_t i = begin; i < end; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // Bloques mas pequenos que count/hilos para equilibrar filas de costo desigual
+    size_t num_chunks = std::min(count, workers.size() * 4);
+    size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(num_chunks);
+
+    for (size_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+        size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+        pending.push_back(submit([&body, chunk_begin, chunk_end]() {
+            for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                body(i);
+            }
+        }));
+    }
+
+    // Esperar a todos los bloques antes de propagar una posible excepcion
+    for (auto& future : pending) {
+        future.wait();
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+}
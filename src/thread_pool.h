@@ -0,0 +1,139 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+/**
+ * Ocupación del pool desde el último resetStats()
+ */
+struct ThreadPoolStats {
+    size_t workers;         // Hilos trabajadores
+    uint64_t tasks;         // Tareas ejecutadas
+    double busy_ms;         // Tiempo ejecutando tareas, sumado sobre los hilos
+    double wall_ms;         // Tiempo de pared transcurrido
+    
+    ThreadPoolStats() : workers(0), tasks(0), busy_ms(0.0), wall_ms(0.0) {}
+    
+    /**
+     * Tiempo ocioso de los trabajadores (capacidad no usada), sumado sobre los hilos
+     */
+    double idleMs() const {
+        double capacity = wall_ms * workers;
+        return capacity > busy_ms ? capacity - busy_ms : 0.0;
+    }
+    
+    /**
+     * Fracción de la capacidad del pool dedicada a tareas
+     */
+    double utilization() const {
+        double capacity = wall_ms * workers;
+        return capacity > 0.0 ? busy_ms / capacity : 0.0;
+    }
+};
+
+/**
+ * Pool de hilos de tamaño fijo compartido entre familias y etapas del alineador
+ */
+class ThreadPool {
+public:
+    /**
+     * Constructor
+     * @param num_threads Número de hilos trabajadores (0 = núcleos disponibles)
+     */
+    explicit ThreadPool(size_t num_threads = 0);
+    
+    /**
+     * Destructor: termina las tareas pendientes y une los hilos
+     */
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /**
+     * Encola una tarea para ejecución asíncrona
+     * @param task Tarea a ejecutar
+     * @return Futuro que se completa al terminar la tarea
+     */
+    template <typename F>
+    std::future<void> submit(F&& task) {
+        // El tiempo se acumula antes de completar el futuro: quien espera ya lo ve contado
+        auto packaged = std::make_shared<std::packaged_task<void()>>(
+            [this, task = std::forward<F>(task)]() mutable {
+                BusyScope busy(*this);
+                task();
+            });
+        std::future<void> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+    
+    /**
+     * Ejecuta body(i) para i en [begin, end) repartiendo bloques entre los hilos.
+     * Llamado desde un hilo del mismo pool se ejecuta en serie para evitar bloqueos.
+     * @param begin Primer índice
+     * @param end Índice final (exclusivo)
+     * @param body Función a ejecutar por índice
+     */
+    void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body);
+    
+    /**
+     * Número de hilos trabajadores
+     */
+    size_t size() const { return workers.size(); }
+    
+    /**
+     * Indica si el hilo actual pertenece a este pool
+     */
+    bool isWorkerThread() const;
+    
+    /**
+     * Ocupación acumulada desde el último resetStats() (o la creación del pool)
+     */
+    ThreadPoolStats stats() const;
+    
+    /**
+     * Reinicia la medición de ocupación
+     */
+    void resetStats();
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queue_mutex;
+    std::condition_variable condition;
+    bool stopping;
+    
+    // Ocupación: solo contadores atómicos, sin tocar el mutex de la cola
+    std::atomic<uint64_t> busy_ns;
+    std::atomic<uint64_t> tasks_run;
+    std::atomic<int64_t> stats_since_ns;
+    
+    struct BusyScope {
+        ThreadPool& pool;
+        std::chrono::steady_clock::time_point start;
+        
+        explicit BusyScope(ThreadPool& pool) : pool(pool), start(std::chrono::steady_clock::now()) {}
+        ~BusyScope() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            pool.busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                   std::memory_order_relaxed);
+            pool.tasks_run.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    
+    void enqueue(std::function<void()> task);
+    void workerLoop(size_t index);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,268 @@
+#include "trace.h"
+#include "json_util.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> TraceRecorder::active(false);
+
+namespace {
+
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    std::string name;
+    uint32_t tid;
+    uint64_t dropped;
+    bool exited;                   // El hilo terminó: se libera al iniciar la siguiente sesión
+
+    explicit ThreadBuffer(uint32_t tid) : tid(tid), dropped(0), exited(false) {}
+};
+
+// Los hilos que terminan conservan sus eventos hasta el volcado de la sesión
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    uint32_t next_tid = 0;
+    std::atomic<size_t> max_events{TraceRecorder::DEFAULT_MAX_EVENTS};
+    int64_t session_start_ns = 0;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Estado del hilo: el nombre se guarda aunque no haya sesión y el búfer se crea en el primer evento
+struct LocalState {
+    ThreadBuffer* buffer = nullptr;
+    std::string name;
+
+    ~LocalState() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->exited = true;
+        }
+    }
+};
+
+thread_local LocalState local_state;
+
+ThreadBuffer& localBuffer() {
+    if (!local_state.buffer) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.buffers.push_back(std::make_unique<ThreadBuffer>(reg.next_tid++));
+        local_state.buffer = reg.buffers.back().get();
+        local_state.buffer->name = local_state.name;
+    }
+    return *local_state.buffer;
+}
+
+// Microsegundos con resolución de nanosegundo, como espera el formato
+void appendMicroseconds(std::string& out, int64_t nanoseconds) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", nanoseconds / 1000.0);
+    out += text;
+}
+
+void appendEvent(std::string& out, const TraceEvent& event, uint32_t tid, int64_t origin_ns) {
+    out += "{\"name\":\"";
+    appendJsonEscaped(out, event.name);
+    out += "\",\"cat\":\"";
+    appendJsonEscaped(out, event.category);
+    out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+    out += std::to_string(tid);
+    out += ",\"ts\":";
+    appendMicroseconds(out, std::max<int64_t>(0, event.start_ns - origin_ns));
+    out += ",\"dur\":";
+    appendMicroseconds(out, event.duration_ns);
+    if (event.arg_count > 0) {
+        out += ",\"args\":{";
+        for (int a = 0; a < event.arg_count; ++a) {
+            char value[32];
+            std::snprintf(value, sizeof(value), "%.17g", event.args[a].value);
+            out += a > 0 ? ",\"" : "\"";
+            appendJsonEscaped(out, event.args[a].key);
+            out += "\":";
+            out += value;
+        }
+        out += '}';
+    }
+    out += '}';
+}
+
+} // namespace
+
+int64_t TraceRecorder::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceRecorder::start(size_t max_events_per_thread) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    // Los búferes de hilos terminados ya no recibirán eventos
+    reg.buffers.erase(std::remove_if(reg.buffers.begin(), reg.buffers.end(),
+        [](const std::unique_ptr<ThreadBuffer>& buffer) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            return buffer->exited;
+        }), reg.buffers.end());
+    for (auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+    reg.max_events.store(std::max<size_t>(1, max_events_per_thread), std::memory_order_relaxed);
+    reg.session_start_ns = now();
+    active.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::record(const TraceEvent& event) {
+    if (!enabled()) {
+        return;
+    }
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= registry().max_events.load(std::memory_order_relaxed)) {
+        ++buffer.dropped;
+        return;
+    }
+    buffer.events.push_back(event);
+}
+
+void TraceRecorder::setThreadName(const std::string& name) {
+    local_state.name = name;
+    if (local_state.buffer) {
+        std::lock_guard<std::mutex> lock(local_state.buffer->mutex);
+        local_state.buffer->name = name;
+    }
+}
+
+uint64_t TraceRecorder::dropped() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    uint64_t total = 0;
+    for (auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        total += buffer->dropped;
+    }
+    return total;
+}
+
+bool TraceRecorder::stop(const std::string& json_file) {
+    active.store(false, std::memory_order_relaxed);
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::ofstream file(json_file);
+    if (!file.is_open()) {
+        LOG_ERROR("trace.error") << "Error: No se pudo crear el archivo de traza " << json_file;
+        return false;
+    }
+
+    // Se escribe por hilo para no duplicar en memoria la traza completa
+    std::string out = "{\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"MSAligner\"}}";
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+    for (auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        if (buffer->events.empty()) {
+            continue;
+        }
+        std::string name = buffer->name.empty() ? "thread " + std::to_string(buffer->tid) : buffer->name;
+        out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        out += std::to_string(buffer->tid);
+        out += ",\"args\":{\"name\":\"";
+        appendJsonEscaped(out, name);
+        out += "\"}}";
+        for (const auto& event : buffer->events) {
+            out += ",\n";
+            appendEvent(out, event, buffer->tid, reg.session_start_ns);
+            if (out.size() > (size_t(1) << 20)) {
+                file << out;
+                out.clear();
+            }
+        }
+        events += buffer->events.size();
+        dropped += buffer->dropped;
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"events\":";
+    out += std::to_string(events);
+    out += ",\"dropped_events\":";
+    out += std::to_string(dropped);
+    out += "}}\n";
+    file << out;
+
+    if (!file) {
+        LOG_ERROR("trace.error") << "Error: Fallo la escritura de la traza " << json_file;
+        return false;
+    }
+    if (dropped > 0) {
+        LOG_WARN("trace").field("dropped", dropped)
+            << "Advertencia: Se descartaron " << dropped << " eventos de traza (bufer por hilo lleno)";
+    }
+    LOG_INFO("trace").field("events", events) << "Traza guardada en " << json_file << " (" << events << " eventos)";
+    return true;
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category) : open(TraceRecorder::enabled()) {
+    event.name = name;
+    event.category = category;
+    if (open) {
+        event.start_ns = TraceRecorder::now();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    end();
+}
+
+TraceSpan& TraceSpan::arg(const char* key, double value) {
+    if (open && event.arg_count < TraceEvent::MAX_ARGS) {
+        event.args[event.arg_count].key = key;
+        event.args[event.arg_count].value = value;
+        ++event.arg_count;
+    }
+    return *this;
+}
+
+void TraceSpan::next(const char* name) {
+    end();
+    event.name = name;
+    event.arg_count = 0;
+    open = TraceRecorder::enabled();
+    if (open) {
+        event.start_ns = TraceRecorder::now();
+    }
+}
+
+void TraceSpan::end() {
+    if (!open) {
+        return;
+    }
+    open = false;
+    event.duration_ns = TraceRecorder::now() - event.start_ns;
+    TraceRecorder::record(event);
+}
+
+TraceSession::TraceSession(const std::string& json_file) : json_file(json_file) {
+    if (!json_file.empty()) {
+        TraceRecorder::setThreadName("main");
+        TraceRecorder::start();
+    }
+}
+
+TraceSession::~TraceSession() {
+    if (!json_file.empty()) {
+        TraceRecorder::stop(json_file);
+    }
+}
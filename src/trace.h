@@ -0,0 +1,141 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Argumento numérico de un evento (la clave debe ser un literal)
+ */
+struct TraceArg {
+    const char* key;
+    double value;
+};
+
+/**
+ * Evento completo ("ph": "X") de la traza: nombre, categoría, inicio y duración
+ */
+struct TraceEvent {
+    static const int MAX_ARGS = 6;
+
+    const char* name;              // Literales: no se copian al registrar
+    const char* category;
+    int64_t start_ns;
+    int64_t duration_ns;
+    int arg_count;
+    TraceArg args[MAX_ARGS];
+
+    TraceEvent() : name(""), category(""), start_ns(0), duration_ns(0), arg_count(0), args() {}
+};
+
+/**
+ * Grabador de trazas en formato Chrome Trace Event (Perfetto, chrome://tracing).
+ *
+ * Cada hilo escribe en su propio búfer, creado en su primer evento de una
+ * sesión y con un mutex que solo se disputa al volcar la traza, así que
+ * registrar un evento cuesta una lectura del reloj y un push_back. Sin sesión
+ * activa, abrir un ámbito cuesta una lectura atómica y no se crea ningún búfer.
+ * Los búferes tienen un tope de eventos por hilo; lo que no cabe se cuenta como
+ * descartado en lugar de crecer sin límite. Los de hilos terminados se liberan
+ * al iniciar la siguiente sesión.
+ */
+class TraceRecorder {
+public:
+    static const size_t DEFAULT_MAX_EVENTS = size_t(1) << 18;   // Por hilo
+
+    /**
+     * Indica si hay una sesión activa (comprobación del camino rápido)
+     */
+    static bool enabled() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Inicia una sesión: descarta los eventos anteriores de todos los hilos
+     * @param max_events_per_thread Tope de eventos por hilo
+     */
+    static void start(size_t max_events_per_thread = DEFAULT_MAX_EVENTS);
+
+    /**
+     * Termina la sesión y escribe la traza
+     * @param json_file Archivo de salida
+     * @return false si no se pudo escribir
+     */
+    static bool stop(const std::string& json_file);
+
+    /**
+     * Nombre del hilo actual en la traza ("main", "worker 3", ...). Solo se
+     * guarda en el hilo: no crea el búfer
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Instante actual en nanosegundos (reloj monótono)
+     */
+    static int64_t now();
+
+    /**
+     * Registra un evento en el búfer del hilo actual (ignorado sin sesión)
+     */
+    static void record(const TraceEvent& event);
+
+    /**
+     * Eventos descartados por búferes llenos en la sesión actual
+     */
+    static uint64_t dropped();
+
+private:
+    static std::atomic<bool> active;
+};
+
+/**
+ * Ámbito de la traza: registra un evento desde la construcción hasta el
+ * destructor (o end()). Con next() se encadenan etapas consecutivas.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /**
+     * Agrega un argumento numérico (se ignoran los que excedan MAX_ARGS)
+     */
+    TraceSpan& arg(const char* key, double value);
+
+    /**
+     * Cierra el evento actual y abre otro con la misma categoría
+     */
+    void next(const char* name);
+
+    /**
+     * Cierra el evento antes del destructor
+     */
+    void end();
+
+private:
+    TraceEvent event;
+    bool open;
+};
+
+/**
+ * Sesión de traza ligada a un ámbito: inicia al construirse (si la ruta no es
+ * vacía) y escribe el archivo al destruirse, por cualquier camino de salida
+ */
+class TraceSession {
+public:
+    explicit TraceSession(const std::string& json_file);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    std::string json_file;
+};
+
+#endif // TRACE_H